@@ -16,41 +16,125 @@
 struct BroadwayOutput {
   GOutputStream *out;
   GString *buf;
+  GByteArray *frame;
+  GConverter *deflate;
+  guint64 payload_bytes;
+  guint64 wire_bytes;
   int error;
   guint32 serial;
 };
 
+/* Compresses @count bytes of @buf into @output->frame as a single
+ * permessage-deflate message (RFC 7692). The compression context is
+ * kept across messages, so repeated data in later messages (like
+ * node trees that only changed a little) compresses well.
+ */
+static gboolean
+deflate_message (BroadwayOutput *output,
+                 const void *buf, gsize count)
+{
+  const guint8 *in = buf;
+  gsize in_left = count;
+  gsize start = output->frame->len;
+  GConverterResult res;
+  gsize bytes_read, bytes_written;
+  gsize out_space;
+
+  while (TRUE)
+    {
+      out_space = MAX (in_left / 2, 4096);
+      g_byte_array_set_size (output->frame, output->frame->len + out_space);
+
+      res = g_converter_convert (output->deflate,
+                                 in, in_left,
+                                 output->frame->data + output->frame->len - out_space, out_space,
+                                 G_CONVERTER_FLUSH,
+                                 &bytes_read, &bytes_written, NULL);
+      if (res == G_CONVERTER_ERROR)
+        {
+          g_byte_array_set_size (output->frame, start);
+          return FALSE;
+        }
+
+      g_byte_array_set_size (output->frame, output->frame->len - out_space + bytes_written);
+      in += bytes_read;
+      in_left -= bytes_read;
+
+      /* A flush that fits in the output space has emitted everything */
+      if (in_left == 0 && bytes_written < out_space)
+        break;
+    }
+
+  /* The sync flush ends with an empty stored block, which the
+   * receiver adds back before inflating */
+  if (output->frame->len - start >= 4 &&
+      memcmp (output->frame->data + output->frame->len - 4, "\x00\x00\xff\xff", 4) == 0)
+    g_byte_array_set_size (output->frame, output->frame->len - 4);
+
+  return TRUE;
+}
+
 static void
 broadway_output_send_cmd (BroadwayOutput *output,
                           gboolean fin, BroadwayWSOpCode code,
                           const void *buf, gsize count)
 {
   gboolean mask = FALSE;
+  gboolean compressed = FALSE;
+  gboolean mid_header, long_header;
   guchar header[16];
   size_t p;
+  gsize len;
+
+  /* Reserve room for the largest header, and fill it in later when we
+   * know the (possibly compressed) payload size */
+  g_byte_array_set_size (output->frame, sizeof (header));
+
+  /* Control frames must not be compressed */
+  if (output->deflate && count > 0 && code < BROADWAY_WS_CNX_CLOSE)
+    {
+      compressed = deflate_message (output, buf, count);
+      /* The client's inflate context can't follow us anymore */
+      if (!compressed)
+        g_clear_object (&output->deflate);
+    }
+
+  if (!compressed)
+    g_byte_array_append (output->frame, buf, count);
 
-  gboolean mid_header = count > 125 && count <= 65535;
-  gboolean long_header = count > 65535;
+  len = output->frame->len - sizeof (header);
+
+  mid_header = len > 125 && len <= 65535;
+  long_header = len > 65535;
 
   /* NB. big-endian spec => bit 0 == MSB */
-  header[0] = ( (fin ? 0x80 : 0) | (code & 0x0f) );
+  header[0] = ( (fin ? 0x80 : 0) | (compressed ? 0x40 : 0) | (code & 0x0f) );
   header[1] = ( (mask ? 0x80 : 0) |
-                (mid_header ? 126 : long_header ? 127 : count) );
+                (mid_header ? 126 : long_header ? 127 : len) );
   p = 2;
   if (mid_header)
     {
-      *(guint16 *)(header + p) = GUINT16_TO_BE( (guint16)count );
+      *(guint16 *)(header + p) = GUINT16_TO_BE( (guint16)len );
       p += 2;
     }
   else if (long_header)
     {
-      *(guint64 *)(header + p) = GUINT64_TO_BE( count );
+      *(guint64 *)(header + p) = GUINT64_TO_BE( len );
       p += 8;
     }
   // FIXME: if we are paranoid we should 'mask' the data
-  // FIXME: we should really emit these as a single write
-  g_output_stream_write_all (output->out, header, p, NULL, NULL, NULL);
-  g_output_stream_write_all (output->out, buf, count, NULL, NULL, NULL);
+
+  /* Put the header right before the payload so the frame goes out in
+   * a single write */
+  memcpy (output->frame->data + sizeof (header) - p, header, p);
+
+  if (!g_output_stream_write_all (output->out,
+                                  output->frame->data + sizeof (header) - p, p + len,
+                                  NULL, NULL, NULL))
+    output->error = TRUE;
+
+  output->payload_bytes += count;
+  output->wire_bytes += p + len;
 }
 
 void broadway_output_pong (BroadwayOutput *output)
@@ -82,6 +166,7 @@ broadway_output_new (GOutputStream *out, guint32 serial)
 
   output->out = g_object_ref (out);
   output->buf = g_string_new ("");
+  output->frame = g_byte_array_new ();
   output->serial = serial;
 
   return output;
@@ -91,9 +176,32 @@ void
 broadway_output_free (BroadwayOutput *output)
 {
   g_object_unref (output->out);
+  g_string_free (output->buf, TRUE);
+  g_byte_array_unref (output->frame);
+  g_clear_object (&output->deflate);
   free (output);
 }
 
+/* Called once the client has agreed to permessage-deflate; all
+ * following data frames are sent compressed. */
+void
+broadway_output_enable_deflate (BroadwayOutput *output)
+{
+  if (output->deflate == NULL)
+    output->deflate = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW, -1));
+}
+
+void
+broadway_output_get_stats (BroadwayOutput *output,
+                           guint64        *payload_bytes,
+                           guint64        *wire_bytes)
+{
+  if (payload_bytes)
+    *payload_bytes = output->payload_bytes;
+  if (wire_bytes)
+    *wire_bytes = output->wire_bytes;
+}
+
 guint32
 broadway_output_get_next_serial (BroadwayOutput *output)
 {
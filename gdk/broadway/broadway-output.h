@@ -20,6 +20,10 @@ typedef enum {
 BroadwayOutput *broadway_output_new                 (GOutputStream  *out,
                                                      guint32         serial);
 void            broadway_output_free                (BroadwayOutput *output);
+void            broadway_output_enable_deflate      (BroadwayOutput *output);
+void            broadway_output_get_stats           (BroadwayOutput *output,
+                                                     guint64        *payload_bytes,
+                                                     guint64        *wire_bytes);
 int             broadway_output_flush               (BroadwayOutput *output);
 int             broadway_output_has_error           (BroadwayOutput *output);
 void            broadway_output_set_next_serial     (BroadwayOutput *output,
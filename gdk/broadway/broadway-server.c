@@ -113,6 +113,7 @@ struct BroadwayInput {
   gboolean seen_time;
   gint64 time_base;
   gboolean active;
+  gboolean deflate;
 };
 
 struct BroadwaySurface {
@@ -654,6 +655,53 @@ hex_dump (guchar *data, gsize len)
 #endif
 }
 
+/* Inflates a permessage-deflate message. We ask the client for
+ * client_no_context_takeover, so every message stands on its own.
+ */
+static GByteArray *
+inflate_message (const guchar *data, gsize len)
+{
+  static const guchar tail[] = { 0x00, 0x00, 0xff, 0xff };
+  GConverter *inflater;
+  GByteArray *in, *out;
+  GConverterResult res;
+  gsize bytes_read, bytes_written, pos;
+
+  in = g_byte_array_sized_new (len + sizeof (tail));
+  g_byte_array_append (in, data, len);
+  g_byte_array_append (in, tail, sizeof (tail));
+
+  inflater = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW));
+  out = g_byte_array_new ();
+  pos = 0;
+
+  do
+    {
+      g_byte_array_set_size (out, out->len + 4096);
+      res = g_converter_convert (inflater,
+                                 in->data + pos, in->len - pos,
+                                 out->data + out->len - 4096, 4096,
+                                 G_CONVERTER_FLUSH,
+                                 &bytes_read, &bytes_written, NULL);
+      g_byte_array_set_size (out, out->len - 4096 + bytes_written);
+      pos += bytes_read;
+    }
+  /* Done once all input is used and there was room left for output */
+  while (res != G_CONVERTER_ERROR && res != G_CONVERTER_FINISHED &&
+         (pos < in->len || bytes_written == 4096));
+
+  g_object_unref (inflater);
+  g_byte_array_unref (in);
+
+  if (res == G_CONVERTER_ERROR)
+    {
+      g_byte_array_unref (out);
+      return NULL;
+    }
+
+  return out;
+}
+
 static void
 parse_input (BroadwayInput *input)
 {
@@ -666,7 +714,7 @@ parse_input (BroadwayInput *input)
     {
       gsize len, payload_len;
       BroadwayWSOpCode code;
-      gboolean is_mask, fin;
+      gboolean is_mask, fin, compressed;
       guchar *buf, *data, *mask;
 
       buf = input->buffer->data;
@@ -677,6 +725,7 @@ parse_input (BroadwayInput *input)
 #endif
 
       fin = buf[0] & 0x80;
+      compressed = input->deflate && (buf[0] & 0x40);
       code = buf[0] & 0x0f;
       payload_len = buf[1] & 0x7f;
       is_mask = buf[1] & 0x80;
@@ -726,6 +775,18 @@ parse_input (BroadwayInput *input)
             g_warning ("can't yet accept fragmented input");
 #endif
           }
+        else if (compressed)
+          {
+            GByteArray *message = inflate_message (data, payload_len);
+
+            if (message)
+              {
+                parse_input_message (input, message->data);
+                g_byte_array_unref (message);
+              }
+            else
+              g_warning ("invalid compressed input");
+          }
         else
           {
             parse_input_message (input, data);
@@ -984,6 +1045,7 @@ start_input (HttpRequest *request)
   gsize data_buffer_size;
   GInputStream *in;
   const char *key;
+  gboolean deflate;
   GSocket *socket;
   int flag = 1;
 
@@ -995,10 +1057,13 @@ start_input (HttpRequest *request)
   key = NULL;
   origin = NULL;
   host = NULL;
+  deflate = FALSE;
   for (i = 0; lines[i] != NULL; i++)
     {
       if ((p = parse_line (lines[i], "Sec-WebSocket-Key")))
         key = p;
+      else if ((p = parse_line (lines[i], "Sec-WebSocket-Extensions")))
+        deflate = strstr (p, "permessage-deflate") != NULL;
       else if ((p = parse_line (lines[i], "Origin")))
         origin = p;
       else if ((p = parse_line (lines[i], "Host")))
@@ -1024,9 +1089,11 @@ start_input (HttpRequest *request)
                              "%s%s%s"
                              "Sec-WebSocket-Location: ws://%s/socket\r\n"
                              "Sec-WebSocket-Protocol: broadway\r\n"
+                             "%s"
                              "\r\n", accept,
                              origin?"Sec-WebSocket-Origin: ":"", origin?origin:"", origin?"\r\n":"",
-                             host);
+                             host,
+                             deflate?"Sec-WebSocket-Extensions: permessage-deflate; client_no_context_takeover\r\n":"");
       g_free (accept);
 
 #ifdef DEBUG_WEBSOCKETS
@@ -1058,6 +1125,9 @@ start_input (HttpRequest *request)
 
   input->output =
     broadway_output_new (g_io_stream_get_output_stream (request->connection), 0);
+  input->deflate = deflate;
+  if (deflate)
+    broadway_output_enable_deflate (input->output);
 
   /* This will free and close the data input stream, but we got all the buffered content already */
   http_request_free (request);
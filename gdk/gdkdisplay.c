@@ -376,9 +376,15 @@ gdk_display_dispose (GObject *object)
 
   _gdk_display_manager_remove_display (gdk_display_manager_get (), display);
 
-  g_list_free_full (display->queued_events, (GDestroyNotify) gdk_event_free);
-  display->queued_events = NULL;
-  display->queued_tail = NULL;
+  while (display->queued_events)
+    {
+      GList *node = display->queued_events;
+      GdkEvent *event = node->data;
+
+      _gdk_event_queue_remove_link (display, node);
+      g_list_free_1 (node);
+      gdk_event_free (event);
+    }
 
   G_OBJECT_CLASS (gdk_display_parent_class)->dispose (object);
 }
@@ -232,14 +232,21 @@ GList *
 _gdk_event_queue_append (GdkDisplay *display,
 			 GdkEvent   *event)
 {
-  display->queued_tail = g_list_append (display->queued_tail, event);
-  
-  if (!display->queued_events)
-    display->queued_events = display->queued_tail;
+  GList *node;
+
+  node = g_list_alloc ();
+  node->data = event;
+  node->prev = display->queued_tail;
+
+  if (display->queued_tail)
+    display->queued_tail->next = node;
   else
-    display->queued_tail = display->queued_tail->next;
+    display->queued_events = node;
 
-  return display->queued_tail;
+  display->queued_tail = node;
+  event->any.queue_link = node;
+
+  return node;
 }
 
 /**
@@ -258,10 +265,11 @@ _gdk_event_queue_insert_after (GdkDisplay *display,
                                GdkEvent   *sibling,
                                GdkEvent   *event)
 {
-  GList *prev = g_list_find (display->queued_events, sibling);
+  GList *prev = sibling->any.queue_link;
   if (prev && prev->next)
     {
       display->queued_events = g_list_insert_before (display->queued_events, prev->next, event);
+      event->any.queue_link = prev->next;
       return prev->next;
     }
   else
@@ -284,10 +292,11 @@ _gdk_event_queue_insert_before (GdkDisplay *display,
 				GdkEvent   *sibling,
 				GdkEvent   *event)
 {
-  GList *next = g_list_find (display->queued_events, sibling);
+  GList *next = sibling->any.queue_link;
   if (next)
     {
       display->queued_events = g_list_insert_before (display->queued_events, next, event);
+      event->any.queue_link = next->prev;
       return next->prev;
     }
   else
@@ -301,11 +310,16 @@ _gdk_event_queue_insert_before (GdkDisplay *display,
  * @node: node to remove
  * 
  * Removes a specified list node from the event queue.
+ * The node itself is not freed.
  **/
 void
 _gdk_event_queue_remove_link (GdkDisplay *display,
 			      GList      *node)
 {
+  GdkEvent *event = node->data;
+
+  event->any.queue_link = NULL;
+
   if (node->prev)
     node->prev->next = node->next;
   else
@@ -356,15 +370,17 @@ gdk_event_push_history (GdkEvent       *event,
   g_assert (event->any.type == GDK_MOTION_NOTIFY);
   g_assert (history_event->any.type == GDK_MOTION_NOTIFY);
 
-  hist = g_new0 (GdkTimeCoord, 1);
+  g_array_set_size (event->motion.history, event->motion.history->len + 1);
+  hist = &g_array_index (event->motion.history, GdkTimeCoord,
+                         event->motion.history->len - 1);
+
+  hist->time = history_event->motion.time;
 
   device = gdk_event_get_device (history_event);
   n_axes = gdk_device_get_n_axes (device);
 
-  for (i = 0; i <= MIN (n_axes, GDK_MAX_TIMECOORD_AXES); i++)
+  for (i = 0; i <= MIN (n_axes, GDK_MAX_TIMECOORD_AXES - 1); i++)
     gdk_event_get_axis (history_event, i, &hist->axes[i]);
-
-  event->motion.history = g_list_prepend (event->motion.history, hist);
 }
 
 void
@@ -375,6 +391,7 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
   GdkWindow *pending_motion_window = NULL;
   GdkDevice *pending_motion_device = NULL;
   GdkEvent *last_motion = NULL;
+  guint n_pending = 0;
 
   /* If the last N events in the event queue are motion notify
    * events for the same window, drop all but the last */
@@ -405,23 +422,39 @@ _gdk_event_queue_handle_motion_compression (GdkDisplay *display)
       pending_motion_window = event->any.window;
       pending_motion_device = event->any.device;
       pending_motions = tmp_list;
+      n_pending++;
 
       tmp_list = tmp_list->prev;
     }
 
+  /* Only button-pressed motions keep a history, so that drawing
+   * applications can still see every position the pointer went
+   * through. The storage for all dropped events is reserved at once.
+   */
+  if (n_pending > 1 &&
+      (last_motion->motion.state &
+       (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK |
+        GDK_BUTTON4_MASK | GDK_BUTTON5_MASK)))
+    {
+      if (last_motion->motion.history == NULL)
+        last_motion->motion.history = g_array_sized_new (FALSE, TRUE,
+                                                         sizeof (GdkTimeCoord),
+                                                         n_pending - 1);
+    }
+  else
+    last_motion = NULL;
+
   while (pending_motions && pending_motions->next != NULL)
     {
       GList *next = pending_motions->next;
+      GdkEvent *event = pending_motions->data;
 
-      if (last_motion &&
-          (last_motion->motion.state &
-           (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK | GDK_BUTTON3_MASK |
-            GDK_BUTTON4_MASK | GDK_BUTTON5_MASK)))
-        gdk_event_push_history (last_motion, pending_motions->data);
+      if (last_motion)
+        gdk_event_push_history (last_motion, event);
 
-      gdk_event_free (pending_motions->data);
-      display->queued_events = g_list_delete_link (display->queued_events,
-                                                   pending_motions);
+      _gdk_event_queue_remove_link (display, pending_motions);
+      g_list_free_1 (pending_motions);
+      gdk_event_free (event);
       pending_motions = next;
     }
 
@@ -591,12 +624,6 @@ gdk_event_get_pointer_emulated (GdkEvent *event)
   return (event->any.flags & GDK_EVENT_POINTER_EMULATED) != 0;
 }
 
-static GdkTimeCoord *
-copy_time_coord (const GdkTimeCoord *coord)
-{
-  return g_memdup (coord, sizeof (GdkTimeCoord));
-}
-
 /**
  * gdk_event_copy:
  * @event: a #GdkEvent
@@ -619,6 +646,9 @@ gdk_event_copy (const GdkEvent *event)
           EVENT_PAYLOAD (event),
           EVENT_PAYLOAD_SIZE);
 
+  /* The copy is not queued, even if the original is */
+  new_event->any.queue_link = NULL;
+
   if (new_event->any.window)
     g_object_ref (new_event->any.window);
   if (new_event->any.device)
@@ -680,8 +710,12 @@ gdk_event_copy (const GdkEvent *event)
 
       if (event->motion.history)
         {
-          new_event->motion.history = g_list_copy_deep (event->motion.history,
-                                                        (GCopyFunc) copy_time_coord, NULL);
+          new_event->motion.history = g_array_sized_new (FALSE, FALSE,
+                                                         sizeof (GdkTimeCoord),
+                                                         event->motion.history->len);
+          g_array_append_vals (new_event->motion.history,
+                               event->motion.history->data,
+                               event->motion.history->len);
         }
       break;
 
@@ -755,7 +789,8 @@ gdk_event_finalize (GObject *object)
     case GDK_MOTION_NOTIFY:
       g_clear_object (&event->motion.tool);
       g_free (event->motion.axes);
-      g_list_free_full (event->motion.history, g_free);
+      if (event->motion.history)
+        g_array_unref (event->motion.history);
       break;
 
     default:
@@ -2520,7 +2555,8 @@ gdk_event_get_axes (GdkEvent  *event,
  * @event: a #GdkEvent of type %GDK_MOTION_NOTIFY
  *
  * Retrieves the history of the @event motion, as a list of time and
- * coordinates.
+ * coordinates, oldest first. The #GdkTimeCoord structs are owned by
+ * @event and stay valid as long as it is alive.
  *
  * Returns: (transfer container) (element-type GdkTimeCoord) (nullable): a list
  *   of time and coordinates
@@ -2530,7 +2566,15 @@ gdk_event_get_axes (GdkEvent  *event,
 GList *
 gdk_event_get_motion_history (const GdkEvent *event)
 {
-  if (event->any.type != GDK_MOTION_NOTIFY)
+  GList *history = NULL;
+  gint i;
+
+  if (event->any.type != GDK_MOTION_NOTIFY || event->motion.history == NULL)
     return NULL;
-  return g_list_reverse (g_list_copy (event->motion.history));
+
+  for (i = event->motion.history->len - 1; i >= 0; i--)
+    history = g_list_prepend (history,
+                              &g_array_index (event->motion.history, GdkTimeCoord, i));
+
+  return history;
 }
@@ -46,6 +46,8 @@ struct _GdkEventClass
  * @type: the type of the event.
  * @window: the window which received the event.
  * @send_event: %TRUE if the event was sent explicitly.
+ * @queue_link: the node of the display event queue holding this
+ *   event, or %NULL if it is not queued.
  *
  * Contains the fields which are common to all event structs.
  * Any event pointer can safely be cast to a pointer to a #GdkEventAny to
@@ -61,6 +63,7 @@ struct _GdkEventAny
   GdkDevice *device;
   GdkDevice *source_device;
   GdkDisplay *display;
+  GList *queue_link;
 };
 
 /*
@@ -118,7 +121,7 @@ struct _GdkEventMotion
   guint state;
   GdkDeviceTool *tool;
   gdouble x_root, y_root;
-  GList *history;
+  GArray *history;
 };
 
 /*
@@ -181,6 +181,10 @@ struct _GdkWindow
   cairo_region_t *active_update_area;
   /* We store the old expose areas to support buffer-age optimizations */
   cairo_region_t *old_updated_area[2];
+  /* The areas exposed by the windowing system, as opposed to the ones
+     invalidated by the application. Renderers that track damage
+     themselves need to repaint these no matter what changed. */
+  cairo_region_t *exposed_area;
 
   GdkWindowState old_state;
   GdkWindowState state;
@@ -354,6 +358,7 @@ void _gdk_windowing_got_event                (GdkDisplay       *display,
 
 #define GDK_WINDOW_IS_MAPPED(window) (((window)->state & GDK_WINDOW_STATE_WITHDRAWN) == 0)
 
+cairo_region_t * gdk_window_take_exposed_area (GdkWindow *window);
 void _gdk_window_invalidate_for_expose (GdkWindow       *window,
                                         cairo_region_t       *region);
 
@@ -367,6 +367,8 @@ gdk_window_finalize (GObject *object)
       window->impl = NULL;
     }
 
+  g_clear_pointer (&window->exposed_area, cairo_region_destroy);
+
   if (window->impl_window != window)
     {
       g_object_unref (window->impl_window);
@@ -2675,11 +2677,40 @@ void
 _gdk_window_invalidate_for_expose (GdkWindow       *window,
 				   cairo_region_t       *region)
 {
+  if (window->exposed_area)
+    cairo_region_union (window->exposed_area, region);
+  else
+    window->exposed_area = cairo_region_copy (region);
+
   gdk_window_invalidate_maybe_recurse_full (window, region,
 					    (gboolean (*) (GdkWindow *, gpointer))gdk_window_has_no_impl,
 					    NULL);
 }
 
+/*< private >
+ * gdk_window_take_exposed_area:
+ * @window: a #GdkWindow
+ *
+ * Transfers the area of @window that was exposed by the windowing
+ * system since the last call to this function to the caller. Unlike
+ * the update area, this does not contain regions that were invalidated
+ * by the application.
+ *
+ * Returns: (transfer full) (nullable): the exposed area, or %NULL
+ **/
+cairo_region_t *
+gdk_window_take_exposed_area (GdkWindow *window)
+{
+  cairo_region_t *region;
+
+  g_return_val_if_fail (GDK_IS_WINDOW (window), NULL);
+
+  region = window->exposed_area;
+  window->exposed_area = NULL;
+
+  return region;
+}
+
 
 /**
  * gdk_window_get_update_area:
@@ -2768,6 +2799,8 @@ _gdk_window_clear_update_area (GdkWindow *window)
       cairo_region_destroy (window->update_area);
       window->update_area = NULL;
     }
+
+  g_clear_pointer (&window->exposed_area, cairo_region_destroy);
 }
 
 /**
@@ -6,6 +6,8 @@
 #include "gskprofilerprivate.h"
 #include "gdk/gdktextureprivate.h"
 #include "gdk/gdkgltextureprivate.h"
+#include "gdk/gdkglcontextprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
 
 #include <gdk/gdk.h>
 #include <epoxy/gl.h>
@@ -37,6 +39,8 @@ struct _GskGLDriver
     GQuark created_textures;
     GQuark reused_textures;
     GQuark surface_uploads;
+    GQuark texture_uploads;
+    GQuark uploaded_bytes;
   } counters;
 
   Fbo default_fbo;
@@ -129,6 +133,14 @@ gsk_gl_driver_init (GskGLDriver *self)
                                                              "surface_uploads",
                                                              "Texture uploads from surfaces this frame",
                                                              TRUE);
+  self->counters.texture_uploads = gsk_profiler_add_counter (self->profiler,
+                                                             "texture_uploads",
+                                                             "Texture uploads from GdkTextures this frame",
+                                                             TRUE);
+  self->counters.uploaded_bytes = gsk_profiler_add_counter (self->profiler,
+                                                            "uploaded_bytes",
+                                                            "Bytes of texture data uploaded this frame",
+                                                            TRUE);
 #endif
 }
 
@@ -192,10 +204,14 @@ gsk_gl_driver_end_frame (GskGLDriver *self)
   GSK_NOTE (OPENGL,
             g_message ("Textures created: %ld\n"
                      " Textures reused: %ld\n"
-                     " Surface uploads: %ld",
+                     " Surface uploads: %ld\n"
+                     " Texture uploads: %ld\n"
+                     "  Uploaded bytes: %ld",
                      gsk_profiler_counter_get (self->profiler, self->counters.created_textures),
                      gsk_profiler_counter_get (self->profiler, self->counters.reused_textures),
-                     gsk_profiler_counter_get (self->profiler, self->counters.surface_uploads)));
+                     gsk_profiler_counter_get (self->profiler, self->counters.surface_uploads),
+                     gsk_profiler_counter_get (self->profiler, self->counters.texture_uploads),
+                     gsk_profiler_counter_get (self->profiler, self->counters.uploaded_bytes)));
 #endif
 
   GSK_NOTE (OPENGL,
@@ -362,6 +378,141 @@ gsk_gl_driver_release_texture (gpointer data)
   t->user = NULL;
 }
 
+static void gsk_gl_driver_set_texture_parameters (GskGLDriver *driver,
+                                                  int          min_filter,
+                                                  int          mag_filter);
+
+static GdkGLContext *
+get_share_group (GdkGLContext *context)
+{
+  GdkGLContext *shared = gdk_gl_context_get_shared_context (context);
+
+  return shared != NULL ? shared : context;
+}
+
+/* Maps a memory format to a GL format/type pair that lets desktop GL read
+ * the pixels as they are. Only formats that are premultiplied (or have no
+ * alpha) qualify, since that is what the shaders expect.
+ */
+static gboolean
+get_gl_format_for_memory_format (GdkMemoryFormat  memory_format,
+                                 GLenum          *gl_format,
+                                 GLenum          *gl_type,
+                                 int             *bpp)
+{
+  switch ((int) memory_format)
+    {
+    case GDK_MEMORY_B8G8R8A8_PREMULTIPLIED:
+      *gl_format = GL_BGRA;
+      *gl_type = GL_UNSIGNED_BYTE;
+      *bpp = 4;
+      return TRUE;
+
+    case GDK_MEMORY_A8R8G8B8_PREMULTIPLIED:
+      *gl_format = GL_BGRA;
+#if G_BYTE_ORDER == G_LITTLE_ENDIAN
+      *gl_type = GL_UNSIGNED_INT_8_8_8_8;
+#else
+      *gl_type = GL_UNSIGNED_INT_8_8_8_8_REV;
+#endif
+      *bpp = 4;
+      return TRUE;
+
+    case GDK_MEMORY_R8G8B8:
+      *gl_format = GL_RGB;
+      *gl_type = GL_UNSIGNED_BYTE;
+      *bpp = 3;
+      return TRUE;
+
+    case GDK_MEMORY_B8G8R8:
+      *gl_format = GL_BGR;
+      *gl_type = GL_UNSIGNED_BYTE;
+      *bpp = 3;
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+upload_memory_texture (GskGLDriver      *self,
+                       GdkMemoryTexture *texture,
+                       Texture          *t)
+{
+  GLenum gl_format, gl_type;
+  gsize stride;
+  int bpp;
+
+  /* OpenGL ES keeps BGRA data swizzled in RGBA textures, so the
+   * native formats can only be used on desktop GL.
+   */
+  if (gdk_gl_context_get_use_es (self->gl_context))
+    return FALSE;
+
+  if (!get_gl_format_for_memory_format (gdk_memory_texture_get_format (texture),
+                                        &gl_format, &gl_type, &bpp))
+    return FALSE;
+
+  stride = gdk_memory_texture_get_stride (texture);
+  if (stride % bpp != 0)
+    return FALSE;
+
+  glPixelStorei (GL_UNPACK_ALIGNMENT, bpp == 4 ? 4 : 1);
+  glPixelStorei (GL_UNPACK_ROW_LENGTH, stride / bpp);
+
+  glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, t->width, t->height, 0, gl_format, gl_type,
+                gdk_memory_texture_get_data (texture));
+
+  glPixelStorei (GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei (GL_UNPACK_ALIGNMENT, 4);
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_add (self->profiler, self->counters.uploaded_bytes, stride * t->height);
+#endif
+
+  return TRUE;
+}
+
+static void
+gsk_gl_driver_init_texture_with_texture (GskGLDriver *self,
+                                         Texture     *t,
+                                         GdkTexture  *texture,
+                                         int          min_filter,
+                                         int          mag_filter)
+{
+  gsk_gl_driver_set_texture_parameters (self, min_filter, mag_filter);
+
+  if (!GDK_IS_MEMORY_TEXTURE (texture) ||
+      !upload_memory_texture (self, GDK_MEMORY_TEXTURE (texture), t))
+    {
+      int stride = t->width * 4;
+      guchar *data;
+
+      /* Convert straight into the layout GL wants; no need to go
+       * through a cairo surface for that.
+       */
+      data = g_malloc_n (t->height, stride);
+      gdk_texture_download (texture, data, stride);
+      gdk_gl_context_upload_texture (self->gl_context, data, t->width, t->height, stride, GL_TEXTURE_2D);
+      g_free (data);
+
+#ifdef G_ENABLE_DEBUG
+      gsk_profiler_counter_add (self->profiler, self->counters.uploaded_bytes, stride * t->height);
+#endif
+    }
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (self->profiler, self->counters.texture_uploads);
+#endif
+
+  t->min_filter = min_filter;
+  t->mag_filter = mag_filter;
+
+  if (t->min_filter != GL_NEAREST)
+    glGenerateMipmap (GL_TEXTURE_2D);
+}
+
 int
 gsk_gl_driver_get_texture_for_texture (GskGLDriver *driver,
                                        GdkTexture  *texture,
@@ -369,37 +520,59 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *driver,
                                        int          mag_filter)
 {
   Texture *t;
-  cairo_surface_t *surface;
 
   if (GDK_IS_GL_TEXTURE (texture))
     {
       GdkGLContext *texture_context = gdk_gl_texture_get_context ((GdkGLTexture *)texture);
 
-      if (texture_context != driver->gl_context)
+      if (texture_context == driver->gl_context)
         {
-          /* In this case, we have to temporarily make the texture's context the current one,
-           * download its data into our context and then create a texture from it. */
+          /* A GL texture from the same GL context is a simple task... */
+          return gdk_gl_texture_get_id (GDK_GL_TEXTURE (texture));
+        }
+      else if (get_share_group (texture_context) == get_share_group (driver->gl_context))
+        {
+          /* The contexts share their objects, so we can sample the texture
+           * directly once the commands producing it have been flushed. */
           gdk_gl_context_make_current (texture_context);
-          surface = gdk_texture_download_surface (texture);
+          glFlush ();
           gdk_gl_context_make_current (driver->gl_context);
+
+          return gdk_gl_texture_get_id (GDK_GL_TEXTURE (texture));
         }
       else
         {
-          /* A GL texture from the same GL context is a simple task... */
-          return gdk_gl_texture_get_id (GDK_GL_TEXTURE (texture));
+          /* In this case, we have to temporarily make the texture's context the current one,
+           * download its data into our context and then create a texture from it. */
+          cairo_surface_t *surface;
+
+          gdk_gl_context_make_current (texture_context);
+          surface = gdk_texture_download_surface (texture);
+          gdk_gl_context_make_current (driver->gl_context);
+
+          t = create_texture (driver, gdk_texture_get_width (texture), gdk_texture_get_height (texture));
+
+          if (gdk_texture_set_render_data (texture, driver, t, gsk_gl_driver_release_texture))
+            t->user = texture;
+
+          gsk_gl_driver_bind_source_texture (driver, t->texture_id);
+          gsk_gl_driver_init_texture_with_surface (driver,
+                                                   t->texture_id,
+                                                   surface,
+                                                   min_filter,
+                                                   mag_filter);
+          cairo_surface_destroy (surface);
+
+          return t->texture_id;
         }
     }
-  else
-    {
-      t = gdk_texture_get_render_data (texture, driver);
 
-      if (t)
-        {
-          if (t->min_filter == min_filter && t->mag_filter == mag_filter)
-            return t->texture_id;
-        }
+  t = gdk_texture_get_render_data (texture, driver);
 
-      surface = gdk_texture_download_surface (texture);
+  if (t)
+    {
+      if (t->min_filter == min_filter && t->mag_filter == mag_filter)
+        return t->texture_id;
     }
 
   t = create_texture (driver, gdk_texture_get_width (texture), gdk_texture_get_height (texture));
@@ -408,12 +581,7 @@ gsk_gl_driver_get_texture_for_texture (GskGLDriver *driver,
     t->user = texture;
 
   gsk_gl_driver_bind_source_texture (driver, t->texture_id);
-  gsk_gl_driver_init_texture_with_surface (driver,
-                                           t->texture_id,
-                                           surface,
-                                           min_filter,
-                                           mag_filter);
-  cairo_surface_destroy (surface);
+  gsk_gl_driver_init_texture_with_texture (driver, t, texture, min_filter, mag_filter);
 
   return t->texture_id;
 }
@@ -646,6 +814,8 @@ gsk_gl_driver_init_texture_with_surface (GskGLDriver     *self,
 
 #ifdef G_ENABLE_DEBUG
   gsk_profiler_counter_inc (self->profiler, self->counters.surface_uploads);
+  gsk_profiler_counter_add (self->profiler, self->counters.uploaded_bytes,
+                            cairo_image_surface_get_stride (surface) * t->height);
 #endif
 
   t->min_filter = min_filter;
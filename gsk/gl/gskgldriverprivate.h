@@ -14,6 +14,7 @@ G_DECLARE_FINAL_TYPE (GskGLDriver, gsk_gl_driver, GSK, GL_DRIVER, GObject)
 typedef struct {
   float position[2];
   float uv[2];
+  guint8 color[4];
 } GskQuadVertex;
 
 GskGLDriver *   gsk_gl_driver_new                       (GdkGLContext    *context);
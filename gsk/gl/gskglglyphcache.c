@@ -15,14 +15,25 @@
  * Glyphs that have not been used for the MAX_AGE frames are considered old. We keep
  * count of the pixels of each atlas that are taken up by old glyphs. We check the
  * fraction of old pixels every CHECK_INTERVAL frames, and if it is above MAX_OLD, then
- * we drop the atlas an all the glyphs contained in it from the cache.
+ * we drop the atlas an all the glyphs contained in it from the cache. Glyphs from a
+ * dropped atlas that are still in use get packed into the remaining atlases again.
+ *
+ * On top of that, we never keep more than MAX_ATLASES atlases around. If a new one
+ * is needed, the least recently used atlas gets dropped first, unless it has been
+ * used in the current frame.
  */
 
 #define MAX_AGE 60
 #define CHECK_INTERVAL 10
 #define MAX_OLD 0.333
+#define MAX_ATLASES 4
+
+/* Atlases are as big as the GL implementation allows, up to this size */
+#define MAX_ATLAS_SIZE 1024
 
-#define ATLAS_SIZE 512
+/* New shelves are rounded up to a multiple of this, so that glyphs
+ * of slightly different heights can share one */
+#define SHELF_GRANULARITY 4
 
 typedef struct
 {
@@ -46,20 +57,29 @@ static void     glyph_cache_key_free   (gpointer      v);
 static void     glyph_cache_value_free (gpointer      v);
 static void     dirty_glyph_free       (gpointer      v);
 
+static int
+get_atlas_size (GskGLGlyphCache *cache)
+{
+  return MIN (gsk_gl_driver_get_max_texture_size (cache->gl_driver), MAX_ATLAS_SIZE);
+}
+
 static GskGLGlyphAtlas *
 create_atlas (GskGLGlyphCache *cache)
 {
   GskGLGlyphAtlas *atlas;
+  int size;
+
+  size = get_atlas_size (cache);
 
   atlas = g_new0 (GskGLGlyphAtlas, 1);
-  atlas->width = ATLAS_SIZE;
-  atlas->height = ATLAS_SIZE;
-  atlas->y0 = 1;
+  atlas->width = size;
+  atlas->height = size;
   atlas->y = 1;
-  atlas->x = 1;
+  atlas->shelves = g_array_new (FALSE, FALSE, sizeof (GskGLGlyphShelf));
   atlas->image = NULL;
   atlas->num_glyphs = 0;
   atlas->dirty_glyphs = NULL;
+  atlas->timestamp = cache->timestamp;
 
   return atlas;
 }
@@ -74,10 +94,94 @@ free_atlas (gpointer v)
       g_assert (atlas->image->texture_id == 0);
       g_free (atlas->image);
     }
+  g_array_free (atlas->shelves, TRUE);
   g_list_free_full (atlas->dirty_glyphs, dirty_glyph_free);
   g_free (atlas);
 }
 
+/* Finds a place for a width x height rectangle, keeping a 1px gap
+ * to all neighbours. We put it on the lowest shelf it fits on, and
+ * open a new shelf instead if that would waste more than half of
+ * the shelf height. */
+static gboolean
+atlas_pack (GskGLGlyphAtlas *atlas,
+            int              width,
+            int              height,
+            int             *out_x,
+            int             *out_y)
+{
+  GskGLGlyphShelf *best = NULL;
+  guint i;
+
+  for (i = 0; i < atlas->shelves->len; i++)
+    {
+      GskGLGlyphShelf *shelf = &g_array_index (atlas->shelves, GskGLGlyphShelf, i);
+
+      if (shelf->height < height + 1 ||
+          shelf->x + width + 1 > atlas->width)
+        continue;
+
+      if (best == NULL || shelf->height < best->height)
+        best = shelf;
+    }
+
+  if (best == NULL || best->height > 2 * (height + 1))
+    {
+      GskGLGlyphShelf shelf;
+
+      shelf.height = MIN (((height + 1 + SHELF_GRANULARITY - 1) / SHELF_GRANULARITY) * SHELF_GRANULARITY,
+                          atlas->height - atlas->y);
+
+      if (shelf.height >= height + 1 && width + 2 <= atlas->width)
+        {
+          shelf.x = 1;
+          shelf.y = atlas->y;
+          atlas->y += shelf.height;
+          g_array_append_val (atlas->shelves, shelf);
+
+          best = &g_array_index (atlas->shelves, GskGLGlyphShelf, atlas->shelves->len - 1);
+        }
+      else if (best == NULL)
+        {
+          return FALSE;
+        }
+    }
+
+  *out_x = best->x;
+  *out_y = best->y;
+
+  best->x += width + 1;
+  atlas->used_pixels += width * height;
+
+  return TRUE;
+}
+
+static void
+drop_atlas (GskGLGlyphCache *self,
+            guint            index)
+{
+  GskGLGlyphAtlas *atlas = g_ptr_array_index (self->atlases, index);
+  GHashTableIter iter;
+  GlyphCacheKey *key;
+  GskGLCachedGlyph *value;
+
+  if (atlas->image)
+    {
+      gsk_gl_image_destroy (atlas->image, self->gl_driver);
+      atlas->image->texture_id = 0;
+    }
+
+  /* Remove all glyphs that point to this atlas */
+  g_hash_table_iter_init (&iter, self->hash_table);
+  while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
+    {
+      if (value->atlas == atlas)
+        g_hash_table_iter_remove (&iter);
+    }
+
+  g_ptr_array_remove_index (self->atlases, index);
+}
+
 void
 gsk_gl_glyph_cache_init (GskGLGlyphCache *self,
                          GskRenderer     *renderer,
@@ -86,10 +190,20 @@ gsk_gl_glyph_cache_init (GskGLGlyphCache *self,
   self->hash_table = g_hash_table_new_full (glyph_cache_hash, glyph_cache_equal,
                                             glyph_cache_key_free, glyph_cache_value_free);
   self->atlases = g_ptr_array_new_with_free_func (free_atlas);
-  g_ptr_array_add (self->atlases, create_atlas (self));
 
   self->renderer = renderer;
   self->gl_driver = gl_driver;
+
+#ifdef G_ENABLE_DEBUG
+  {
+    GskProfiler *profiler = gsk_renderer_get_profiler (renderer);
+
+    self->profile_counters.hits = gsk_profiler_add_counter (profiler, "glyph-cache-hits", "Glyph cache hits", TRUE);
+    self->profile_counters.misses = gsk_profiler_add_counter (profiler, "glyph-cache-misses", "Glyph cache misses", TRUE);
+    self->profile_counters.uploaded_bytes = gsk_profiler_add_counter (profiler, "glyph-upload-bytes", "Bytes of glyph data uploaded", TRUE);
+    self->profile_counters.atlas_fill = gsk_profiler_add_counter (profiler, "glyph-atlas-fill", "Glyph atlas fill, in percent", FALSE);
+  }
+#endif
 }
 
 void
@@ -158,61 +272,83 @@ dirty_glyph_free (gpointer v)
 
 static void
 add_to_cache (GskGLGlyphCache  *cache,
-              GlyphCacheKey        *key,
+              GlyphCacheKey    *key,
               GskGLCachedGlyph *value)
 {
-  GskGLGlyphAtlas *atlas;
-  int i;
+  GskGLGlyphAtlas *atlas = NULL;
+  guint i;
   DirtyGlyph *dirty;
   int width = value->draw_width * key->scale / 1024;
   int height = value->draw_height * key->scale / 1024;
+  int atlas_size;
+  int x, y;
+
+  /* atlas_pack() keeps a 1px gap around the glyph, even in an empty atlas.
+   * Glyphs that don't fit are not worth evicting an atlas for; the
+   * renderer skips empty glyphs. */
+  atlas_size = get_atlas_size (cache);
+  if (width + 2 > atlas_size || height + 2 > atlas_size)
+    {
+      GSK_RENDERER_NOTE (cache->renderer, GLYPH_CACHE,
+                g_message ("Glyph of size %dx%d does not fit into an atlas", width, height));
+      value->draw_width = 0;
+      value->draw_height = 0;
+      return;
+    }
 
   for (i = 0; i < cache->atlases->len; i++)
     {
-      int x, y, y0;
-
       atlas = g_ptr_array_index (cache->atlases, i);
-      x = atlas->x;
-      y = atlas->y;
-      y0 = atlas->y0;
-
-      if (atlas->x + width + 1 >= atlas->width)
-        {
-          /* start a new row */
-          y0 = y + 1;
-          x = 1;
-        }
-
-      if (y0 + height + 1 >= atlas->height)
-        continue;
 
-      atlas->y0 = y0;
-      atlas->x = x;
-      atlas->y = y;
-      break;
+      if (atlas_pack (atlas, width, height, &x, &y))
+        break;
     }
 
   if (i == cache->atlases->len)
     {
+      if (cache->atlases->len >= MAX_ATLASES)
+        {
+          guint lru = 0;
+
+          for (i = 1; i < cache->atlases->len; i++)
+            {
+              GskGLGlyphAtlas *a = g_ptr_array_index (cache->atlases, i);
+
+              if (a->timestamp < ((GskGLGlyphAtlas *)g_ptr_array_index (cache->atlases, lru))->timestamp)
+                lru = i;
+            }
+
+          /* Glyphs of atlases used in this frame are already referenced
+           * by render ops, so those have to stay around. */
+          atlas = g_ptr_array_index (cache->atlases, lru);
+          if (atlas->timestamp < cache->timestamp)
+            {
+              GSK_RENDERER_NOTE (cache->renderer, GLYPH_CACHE,
+                        g_message ("Evicting atlas %u (%d glyphs)", lru, atlas->num_glyphs));
+              drop_atlas (cache, lru);
+            }
+        }
+
       atlas = create_atlas (cache);
       g_ptr_array_add (cache->atlases, atlas);
+
+      if (!atlas_pack (atlas, width, height, &x, &y))
+        g_assert_not_reached ();
     }
 
-  value->tx = (float)atlas->x / atlas->width;
-  value->ty = (float)atlas->y0 / atlas->height;
+  value->tx = (float)x / atlas->width;
+  value->ty = (float)y / atlas->height;
   value->tw = (float)width / atlas->width;
   value->th = (float)height / atlas->height;
 
   value->atlas = atlas;
+  atlas->timestamp = cache->timestamp;
 
   dirty = g_new0 (DirtyGlyph, 1);
   dirty->key = key;
   dirty->value = value;
   atlas->dirty_glyphs = g_list_prepend (atlas->dirty_glyphs, dirty);
 
-  atlas->x = atlas->x + width + 1;
-  atlas->y = MAX (atlas->y, atlas->y0 + height + 1);
-
   atlas->num_glyphs++;
 
 #ifdef G_ENABLE_DEBUG
@@ -222,11 +358,12 @@ add_to_cache (GskGLGlyphCache  *cache,
       for (i = 0; i < cache->atlases->len; i++)
         {
           atlas = g_ptr_array_index (cache->atlases, i);
-          g_print ("\tGskGLGlyphAtlas %d (%dx%d): %d glyphs (%d dirty), %.2g%% old pixels, filled to %d, %d / %d\n",
+          g_print ("\tGskGLGlyphAtlas %d (%dx%d): %d glyphs (%d dirty), %.2g%% used, %.2g%% old pixels, %d shelves filled to %d\n",
                    i, atlas->width, atlas->height,
                    atlas->num_glyphs, g_list_length (atlas->dirty_glyphs),
+                   100.0 * (double)atlas->used_pixels / (double)(atlas->width * atlas->height),
                    100.0 * (double)atlas->old_pixels / (double)(atlas->width * atlas->height),
-                   atlas->x, atlas->y0, atlas->y);
+                   atlas->shelves->len, atlas->y);
         }
     }
 #endif
@@ -294,9 +431,18 @@ upload_dirty_glyphs (GskGLGlyphCache *self,
 
   num_regions = g_list_length (atlas->dirty_glyphs);
   regions = alloca (sizeof (GskImageRegion) * num_regions);
+  memset (regions, 0, sizeof (GskImageRegion) * num_regions);
 
   for (l = atlas->dirty_glyphs, i = 0; l; l = l->next, i++)
-    render_glyph (atlas, (DirtyGlyph *)l->data, &regions[i]);
+    {
+      render_glyph (atlas, (DirtyGlyph *)l->data, &regions[i]);
+
+#ifdef G_ENABLE_DEBUG
+      gsk_profiler_counter_add (gsk_renderer_get_profiler (self->renderer),
+                                self->profile_counters.uploaded_bytes,
+                                regions[i].height * regions[i].stride);
+#endif
+    }
 
   GSK_RENDERER_NOTE (self->renderer, GLYPH_CACHE,
             g_message ("uploading %d glyphs to cache", num_regions));
@@ -335,6 +481,13 @@ gsk_gl_glyph_cache_lookup (GskGLGlyphCache *cache,
 
           value->timestamp = cache->timestamp;
         }
+
+      if (value->atlas)
+        value->atlas->timestamp = cache->timestamp;
+
+#ifdef G_ENABLE_DEBUG
+      gsk_profiler_counter_inc (gsk_renderer_get_profiler (cache->renderer), cache->profile_counters.hits);
+#endif
     }
 
   if (create && value == NULL)
@@ -342,6 +495,10 @@ gsk_gl_glyph_cache_lookup (GskGLGlyphCache *cache,
       GlyphCacheKey *key;
       PangoRectangle ink_rect;
 
+#ifdef G_ENABLE_DEBUG
+      gsk_profiler_counter_inc (gsk_renderer_get_profiler (cache->renderer), cache->profile_counters.misses);
+#endif
+
       key = g_new0 (GlyphCacheKey, 1);
       value = g_new0 (GskGLCachedGlyph, 1);
 
@@ -400,6 +557,23 @@ gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self)
 
   self->timestamp++;
 
+#ifdef G_ENABLE_DEBUG
+  {
+    guint64 used = 0, total = 0;
+
+    for (i = 0; i < self->atlases->len; i++)
+      {
+        GskGLGlyphAtlas *atlas = g_ptr_array_index (self->atlases, i);
+
+        used += atlas->used_pixels;
+        total += atlas->width * atlas->height;
+      }
+
+    gsk_profiler_counter_set (gsk_renderer_get_profiler (self->renderer),
+                              self->profile_counters.atlas_fill,
+                              total > 0 ? 100 * used / total : 0);
+  }
+#endif
 
   if (self->timestamp % CHECK_INTERVAL != 0)
     return;
@@ -420,7 +594,7 @@ gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self)
         }
     }
 
-  /* look for atlases to drop, and create a mapping of updated texture indices */
+  /* look for atlases to drop */
   for (i = self->atlases->len - 1; i >= 0; i--)
     {
       GskGLGlyphAtlas *atlas = g_ptr_array_index (self->atlases, i);
@@ -431,22 +605,8 @@ gsk_gl_glyph_cache_begin_frame (GskGLGlyphCache *self)
                    g_message ("Dropping atlas %d (%g.2%% old)",
                             i, 100.0 * (double)atlas->old_pixels / (double)(atlas->width * atlas->height)));
 
-          if (atlas->image)
-            {
-              gsk_gl_image_destroy (atlas->image, self->gl_driver);
-              atlas->image->texture_id = 0;
-            }
-
-          /* Remove all glyphs that point to this atlas */
-          g_hash_table_iter_init (&iter, self->hash_table);
-          while (g_hash_table_iter_next (&iter, (gpointer *)&key, (gpointer *)&value))
-            {
-              if (value->atlas == atlas)
-                g_hash_table_iter_remove (&iter);
-            }
-          /* TODO: The above loop inside this other loop could be slow... */
-
-          g_ptr_array_remove_index (self->atlases, i);
+          dropped += atlas->num_glyphs;
+          drop_atlas (self, i);
         }
     }
 
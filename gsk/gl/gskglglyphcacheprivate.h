@@ -16,17 +16,35 @@ typedef struct
   GPtrArray *atlases;
 
   guint64 timestamp;
+
+#ifdef G_ENABLE_DEBUG
+  struct {
+    GQuark hits;
+    GQuark misses;
+    GQuark uploaded_bytes;
+    GQuark atlas_fill;
+  } profile_counters;
+#endif
 } GskGLGlyphCache;
 
+typedef struct
+{
+  int x;      /* Start of the free space in this shelf */
+  int y;
+  int height;
+} GskGLGlyphShelf;
 
 typedef struct
 {
   GskGLImage *image;
   int width, height;
-  int x, y, y0;
+  int y;      /* Start of the space below the last shelf */
+  GArray *shelves;
   int num_glyphs;
   GList *dirty_glyphs;
+  guint used_pixels;
   guint old_pixels;
+  guint64 timestamp; /* Last frame any of its glyphs was used in */
 } GskGLGlyphAtlas;
 
 typedef struct
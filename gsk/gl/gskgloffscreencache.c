@@ -0,0 +1,249 @@
+#include "config.h"
+
+#include "gskgloffscreencacheprivate.h"
+
+#include "gskdebugprivate.h"
+
+/* The children of opacity, color matrix, shadow and cross-fade nodes
+ * are rendered into an offscreen texture before being drawn. If the
+ * same subtree shows up again in a later frame, we reuse that texture
+ * instead of rendering the subtree again.
+ *
+ * Widgets keep their render nodes around while they don't change, so
+ * usually the very same node comes back. If it was recreated, we
+ * compare it to the cached node with gsk_render_node_diff(), which
+ * skips shared subtrees and is cheap compared to rendering.
+ *
+ * The cache never holds more than MAX_SIZE bytes of textures, and
+ * drops textures that have not been used for MAX_UNUSED_FRAMES frames.
+ * Textures bigger than a quarter of the budget are not cached.
+ */
+
+#define MAX_SIZE (32 * 1024 * 1024)
+#define MAX_UNUSED_FRAMES 10
+
+typedef struct
+{
+  GskRenderNode *node;
+  graphene_rect_t rect;
+  int scale_factor;
+  float opacity;
+  int texture_id;
+  gsize size;
+  int unused_frames;
+} CacheItem;
+
+static void
+cache_item_clear (CacheItem   *item,
+                  GskGLDriver *gl_driver)
+{
+  gsk_gl_driver_destroy_texture (gl_driver, item->texture_id);
+  gsk_render_node_unref (item->node);
+}
+
+static void
+remove_item (GskGLOffscreenCache *self,
+             GskGLDriver         *gl_driver,
+             guint                index)
+{
+  CacheItem *item = &g_array_index (self->items, CacheItem, index);
+
+  self->size -= item->size;
+  cache_item_clear (item, gl_driver);
+  g_array_remove_index_fast (self->items, index);
+}
+
+void
+gsk_gl_offscreen_cache_init (GskGLOffscreenCache *self,
+                             GskRenderer         *renderer)
+{
+  self->renderer = renderer;
+  self->items = g_array_new (FALSE, TRUE, sizeof (CacheItem));
+  self->size = 0;
+
+#ifdef G_ENABLE_DEBUG
+  {
+    GskProfiler *profiler = gsk_renderer_get_profiler (renderer);
+
+    self->profile_counters.hits = gsk_profiler_add_counter (profiler, "offscreen-cache-hits", "Offscreen cache hits", TRUE);
+    self->profile_counters.misses = gsk_profiler_add_counter (profiler, "offscreen-cache-misses", "Offscreen cache misses", TRUE);
+    self->profile_counters.size = gsk_profiler_add_counter (profiler, "offscreen-cache-size", "Offscreen cache size, in kB", FALSE);
+  }
+#endif
+}
+
+void
+gsk_gl_offscreen_cache_free (GskGLOffscreenCache *self,
+                             GskGLDriver         *gl_driver)
+{
+  guint i;
+
+  for (i = 0; i < self->items->len; i ++)
+    cache_item_clear (&g_array_index (self->items, CacheItem, i), gl_driver);
+
+  g_array_free (self->items, TRUE);
+  self->items = NULL;
+  self->size = 0;
+}
+
+void
+gsk_gl_offscreen_cache_begin_frame (GskGLOffscreenCache *self,
+                                    GskGLDriver         *gl_driver)
+{
+  guint i;
+
+  for (i = 0; i < self->items->len; )
+    {
+      CacheItem *item = &g_array_index (self->items, CacheItem, i);
+
+      if (item->unused_frames > MAX_UNUSED_FRAMES)
+        {
+          remove_item (self, gl_driver, i);
+        }
+      else
+        {
+          item->unused_frames ++;
+          i ++;
+        }
+    }
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_set (gsk_renderer_get_profiler (self->renderer),
+                            self->profile_counters.size,
+                            self->size / 1024);
+#endif
+}
+
+static gboolean
+node_renders_equal (GskRenderNode *node1,
+                    GskRenderNode *node2)
+{
+  cairo_region_t *region;
+  gboolean equal;
+
+  if (node1 == node2)
+    return TRUE;
+
+  if (gsk_render_node_get_node_type (node1) != gsk_render_node_get_node_type (node2) ||
+      !graphene_rect_equal (&node1->bounds, &node2->bounds))
+    return FALSE;
+
+  region = cairo_region_create ();
+  gsk_render_node_diff (node1, node2, region);
+  equal = cairo_region_is_empty (region);
+  cairo_region_destroy (region);
+
+  return equal;
+}
+
+/* Returns the id of a texture containing @node rendered into @rect
+ * with the given scale and inherited opacity, or 0 if there is none */
+int
+gsk_gl_offscreen_cache_lookup (GskGLOffscreenCache   *self,
+                               GskRenderNode         *node,
+                               const graphene_rect_t *rect,
+                               int                    scale_factor,
+                               float                  opacity)
+{
+  guint i;
+
+  for (i = 0; i < self->items->len; i ++)
+    {
+      CacheItem *item = &g_array_index (self->items, CacheItem, i);
+
+      if (item->scale_factor != scale_factor ||
+          item->opacity != opacity ||
+          !graphene_rect_equal (&item->rect, rect))
+        continue;
+
+      if (node_renders_equal (item->node, node))
+        {
+          /* Remember the new node, it is likely to come back unchanged */
+          if (item->node != node)
+            {
+              gsk_render_node_unref (item->node);
+              item->node = gsk_render_node_ref (node);
+            }
+
+          item->unused_frames = 0;
+#ifdef G_ENABLE_DEBUG
+          gsk_profiler_counter_inc (gsk_renderer_get_profiler (self->renderer), self->profile_counters.hits);
+#endif
+          return item->texture_id;
+        }
+    }
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (gsk_renderer_get_profiler (self->renderer), self->profile_counters.misses);
+#endif
+
+  return 0;
+}
+
+/* Makes room for a texture of the given size, dropping the least
+ * recently used textures if necessary. Returns %FALSE if the texture
+ * should not be cached. */
+gboolean
+gsk_gl_offscreen_cache_reserve (GskGLOffscreenCache *self,
+                                GskGLDriver         *gl_driver,
+                                int                  width,
+                                int                  height)
+{
+  gsize size = (gsize) width * height * 4;
+
+  if (size > MAX_SIZE / 4)
+    return FALSE;
+
+  while (self->size + size > MAX_SIZE)
+    {
+      guint i, lru = 0;
+
+      for (i = 1; i < self->items->len; i ++)
+        {
+          if (g_array_index (self->items, CacheItem, i).unused_frames >
+              g_array_index (self->items, CacheItem, lru).unused_frames)
+            lru = i;
+        }
+
+      /* Everything is in use in this frame */
+      if (self->items->len == 0 ||
+          g_array_index (self->items, CacheItem, lru).unused_frames == 0)
+        return FALSE;
+
+      GSK_RENDERER_NOTE (self->renderer, OPENGL,
+                         g_message ("Dropping cached offscreen texture %d",
+                                    g_array_index (self->items, CacheItem, lru).texture_id));
+      remove_item (self, gl_driver, lru);
+    }
+
+  return TRUE;
+}
+
+/* The cache takes ownership of @texture_id, which must be permanent */
+void
+gsk_gl_offscreen_cache_commit (GskGLOffscreenCache   *self,
+                               GskRenderNode         *node,
+                               const graphene_rect_t *rect,
+                               int                    scale_factor,
+                               float                  opacity,
+                               int                    width,
+                               int                    height,
+                               int                    texture_id)
+{
+  CacheItem *item;
+
+  g_assert (texture_id > 0);
+
+  g_array_set_size (self->items, self->items->len + 1);
+  item = &g_array_index (self->items, CacheItem, self->items->len - 1);
+
+  item->node = gsk_render_node_ref (node);
+  item->rect = *rect;
+  item->scale_factor = scale_factor;
+  item->opacity = opacity;
+  item->texture_id = texture_id;
+  item->size = (gsize) width * height * 4;
+  item->unused_frames = 0;
+
+  self->size += item->size;
+}
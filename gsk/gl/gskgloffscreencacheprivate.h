@@ -0,0 +1,50 @@
+#ifndef __GSK_GL_OFFSCREEN_CACHE_H__
+#define __GSK_GL_OFFSCREEN_CACHE_H__
+
+#include <glib.h>
+#include <graphene.h>
+#include "gskgldriverprivate.h"
+#include "gskrendererprivate.h"
+#include "gskrendernodeprivate.h"
+
+typedef struct
+{
+  GskRenderer *renderer;
+
+  GArray *items;
+  gsize size; /* in bytes */
+
+#ifdef G_ENABLE_DEBUG
+  struct {
+    GQuark hits;
+    GQuark misses;
+    GQuark size;
+  } profile_counters;
+#endif
+} GskGLOffscreenCache;
+
+void      gsk_gl_offscreen_cache_init           (GskGLOffscreenCache   *self,
+                                                 GskRenderer           *renderer);
+void      gsk_gl_offscreen_cache_free           (GskGLOffscreenCache   *self,
+                                                 GskGLDriver           *gl_driver);
+void      gsk_gl_offscreen_cache_begin_frame    (GskGLOffscreenCache   *self,
+                                                 GskGLDriver           *gl_driver);
+int       gsk_gl_offscreen_cache_lookup         (GskGLOffscreenCache   *self,
+                                                 GskRenderNode         *node,
+                                                 const graphene_rect_t *rect,
+                                                 int                    scale_factor,
+                                                 float                  opacity);
+gboolean  gsk_gl_offscreen_cache_reserve        (GskGLOffscreenCache   *self,
+                                                 GskGLDriver           *gl_driver,
+                                                 int                    width,
+                                                 int                    height);
+void      gsk_gl_offscreen_cache_commit         (GskGLOffscreenCache   *self,
+                                                 GskRenderNode         *node,
+                                                 const graphene_rect_t *rect,
+                                                 int                    scale_factor,
+                                                 float                  opacity,
+                                                 int                    width,
+                                                 int                    height,
+                                                 int                    texture_id);
+
+#endif
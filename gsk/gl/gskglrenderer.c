@@ -11,6 +11,8 @@
 #include "gskrendernodeprivate.h"
 #include "gskshaderbuilderprivate.h"
 #include "gskglglyphcacheprivate.h"
+#include "gskglshadowcacheprivate.h"
+#include "gskgloffscreencacheprivate.h"
 #include "gskglrenderopsprivate.h"
 #include "gskcairoblurprivate.h"
 
@@ -217,11 +219,14 @@ struct _GskGLRenderer
   GArray *render_ops;
 
   GskGLGlyphCache glyph_cache;
+  GskGLShadowCache shadow_cache;
+  GskGLOffscreenCache offscreen_cache;
 
 #ifdef G_ENABLE_DEBUG
   struct {
     GQuark frames;
     GQuark draw_calls;
+    GQuark quads;
   } profile_counters;
   struct {
     GQuark cpu_time;
@@ -978,6 +983,7 @@ render_outset_shadow_node (GskGLRenderer       *self,
   graphene_rect_t prev_viewport;
   graphene_matrix_t item_proj;
   GskRoundedRect prev_clip, blit_clip;
+  GskShadowKey key;
   int prev_render_target;
   int texture_id, render_target;
   int blurred_texture_id, blurred_render_target;
@@ -1002,77 +1008,87 @@ render_outset_shadow_node (GskGLRenderer       *self,
   texture_width = offset_outline.bounds.size.width   + blur_extra;
   texture_height = offset_outline.bounds.size.height + blur_extra;
 
-  texture_id = gsk_gl_driver_create_texture (self->gl_driver, texture_width, texture_height);
-  gsk_gl_driver_bind_source_texture (self->gl_driver, texture_id);
-  gsk_gl_driver_init_texture_empty (self->gl_driver, texture_id);
-  render_target = gsk_gl_driver_create_render_target (self->gl_driver, texture_id, FALSE, FALSE);
-
-
-  graphene_matrix_init_ortho (&item_proj,
-                              0, texture_width, 0, texture_height,
-                              ORTHO_NEAR_PLANE, ORTHO_FAR_PLANE);
-  graphene_matrix_scale (&item_proj, 1, -1, 1);
-  graphene_matrix_init_identity (&identity);
+  key.outline = offset_outline;
+  key.blur_radius = blur_radius;
+  key.color = *gsk_outset_shadow_node_peek_color (node);
 
-  prev_render_target = ops_set_render_target (builder, render_target);
-  op.op = OP_CLEAR;
-  ops_add (builder, &op);
-  prev_projection = ops_set_projection (builder, &item_proj);
-  prev_modelview = ops_set_modelview (builder, &identity);
-  prev_viewport = ops_set_viewport (builder, &GRAPHENE_RECT_INIT (0, 0, texture_width, texture_height));
+  blurred_texture_id = gsk_gl_shadow_cache_get_texture_id (&self->shadow_cache, &key);
+  if (blurred_texture_id == 0)
+    {
+      texture_id = gsk_gl_driver_create_texture (self->gl_driver, texture_width, texture_height);
+      gsk_gl_driver_bind_source_texture (self->gl_driver, texture_id);
+      gsk_gl_driver_init_texture_empty (self->gl_driver, texture_id);
+      render_target = gsk_gl_driver_create_render_target (self->gl_driver, texture_id, FALSE, FALSE);
+
+
+      graphene_matrix_init_ortho (&item_proj,
+                                  0, texture_width, 0, texture_height,
+                                  ORTHO_NEAR_PLANE, ORTHO_FAR_PLANE);
+      graphene_matrix_scale (&item_proj, 1, -1, 1);
+      graphene_matrix_init_identity (&identity);
+
+      prev_render_target = ops_set_render_target (builder, render_target);
+      op.op = OP_CLEAR;
+      ops_add (builder, &op);
+      prev_projection = ops_set_projection (builder, &item_proj);
+      prev_modelview = ops_set_modelview (builder, &identity);
+      prev_viewport = ops_set_viewport (builder, &GRAPHENE_RECT_INIT (0, 0, texture_width, texture_height));
+
+      /* Draw outline */
+      ops_set_program (builder, &self->color_program);
+      prev_clip = ops_set_clip (builder, &offset_outline);
+      ops_set_color (builder, gsk_outset_shadow_node_peek_color (node));
+      ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
+        { { 0,                            }, { 0, 1 }, },
+        { { 0,             texture_height }, { 0, 0 }, },
+        { { texture_width,                }, { 1, 1 }, },
 
-  /* Draw outline */
-  ops_set_program (builder, &self->color_program);
-  prev_clip = ops_set_clip (builder, &offset_outline);
-  ops_set_color (builder, gsk_outset_shadow_node_peek_color (node));
-  ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
-    { { 0,                            }, { 0, 1 }, },
-    { { 0,             texture_height }, { 0, 0 }, },
-    { { texture_width,                }, { 1, 1 }, },
+        { { texture_width, texture_height }, { 1, 0 }, },
+        { { 0,             texture_height }, { 0, 0 }, },
+        { { texture_width,                }, { 1, 1 }, },
+      });
 
-    { { texture_width, texture_height }, { 1, 0 }, },
-    { { 0,             texture_height }, { 0, 0 }, },
-    { { texture_width,                }, { 1, 1 }, },
-  });
+      blurred_texture_id = gsk_gl_driver_create_permanent_texture (self->gl_driver, texture_width, texture_height);
+      gsk_gl_driver_bind_source_texture (self->gl_driver, blurred_texture_id);
+      gsk_gl_driver_init_texture_empty (self->gl_driver, blurred_texture_id);
+      blurred_render_target = gsk_gl_driver_create_render_target (self->gl_driver, blurred_texture_id, TRUE, TRUE);
 
-  blurred_texture_id = gsk_gl_driver_create_texture (self->gl_driver, texture_width, texture_height);
-  gsk_gl_driver_bind_source_texture (self->gl_driver, blurred_texture_id);
-  gsk_gl_driver_init_texture_empty (self->gl_driver, blurred_texture_id);
-  blurred_render_target = gsk_gl_driver_create_render_target (self->gl_driver, blurred_texture_id, TRUE, TRUE);
+      ops_set_render_target (builder, blurred_render_target);
+      op.op = OP_CLEAR;
+      ops_add (builder, &op);
 
-  ops_set_render_target (builder, blurred_render_target);
-  op.op = OP_CLEAR;
-  ops_add (builder, &op);
+      gsk_rounded_rect_init_from_rect (&blit_clip,
+                                       &GRAPHENE_RECT_INIT (0, 0, texture_width, texture_height), 0.0f);
 
-  gsk_rounded_rect_init_from_rect (&blit_clip,
-                                   &GRAPHENE_RECT_INIT (0, 0, texture_width, texture_height), 0.0f);
+      ops_set_program (builder, &self->blur_program);
+      op.op = OP_CHANGE_BLUR;
+      op.blur.size.width = texture_width;
+      op.blur.size.height = texture_height;
+      op.blur.radius = blur_radius;
+      ops_add (builder, &op);
 
-  ops_set_program (builder, &self->blur_program);
-  op.op = OP_CHANGE_BLUR;
-  op.blur.size.width = texture_width;
-  op.blur.size.height = texture_height;
-  op.blur.radius = blur_radius;
-  ops_add (builder, &op);
+      ops_set_clip (builder, &blit_clip);
+      ops_set_texture (builder, texture_id);
+      ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
+        { { 0,             0              }, { 0, 1 }, },
+        { { 0,             texture_height }, { 0, 0 }, },
+        { { texture_width, 0              }, { 1, 1 }, },
 
-  ops_set_clip (builder, &blit_clip);
-  ops_set_texture (builder, texture_id);
-  ops_draw (builder, (GskQuadVertex[GL_N_VERTICES]) {
-    { { 0,             0              }, { 0, 1 }, },
-    { { 0,             texture_height }, { 0, 0 }, },
-    { { texture_width, 0              }, { 1, 1 }, },
+        { { texture_width, texture_height }, { 1, 0 }, },
+        { { 0,             texture_height }, { 0, 0 }, },
+        { { texture_width, 0              }, { 1, 1 }, },
+      });
 
-    { { texture_width, texture_height }, { 1, 0 }, },
-    { { 0,             texture_height }, { 0, 0 }, },
-    { { texture_width, 0              }, { 1, 1 }, },
-  });
 
+      ops_set_clip (builder, &prev_clip);
 
-  ops_set_clip (builder, &prev_clip);
+      ops_set_viewport (builder, &prev_viewport);
+      ops_set_modelview (builder, &prev_modelview);
+      ops_set_projection (builder, &prev_projection);
+      ops_set_render_target (builder, prev_render_target);
 
-  ops_set_viewport (builder, &prev_viewport);
-  ops_set_modelview (builder, &prev_modelview);
-  ops_set_projection (builder, &prev_projection);
-  ops_set_render_target (builder, prev_render_target);
+      gsk_gl_shadow_cache_commit (&self->shadow_cache, &key, blurred_texture_id);
+    }
 
   ops_set_program (builder, &self->outset_shadow_program);
   ops_set_texture (builder, blurred_texture_id);
@@ -1510,17 +1526,6 @@ apply_render_target_op (GskGLRenderer  *self,
     gsk_gl_renderer_setup_render_mode (self); /* Reset glScissor etc. */
 }
 
-static inline void
-apply_color_op (const Program  *program,
-                const RenderOp *op)
-{
-  OP_PRINT (" -> Color: (%f, %f, %f, %f)", op->color.red, op->color.green, op->color.blue, op->color.alpha);
-  /* TODO: We use color.color_location here and this is right for all three of the programs above,
-   *       but that's just a coincidence. */
-  glUniform4f (program->color.color_location,
-               op->color.red, op->color.green, op->color.blue, op->color.alpha);
-}
-
 static inline void
 apply_opacity_op (const Program  *program,
                   const RenderOp *op)
@@ -1829,12 +1834,6 @@ gsk_gl_renderer_create_programs (GskGLRenderer  *self,
       INIT_COMMON_UNIFORM_LOCATION (prog, modelview);
     }
 
-  /* color */
-  INIT_PROGRAM_UNIFORM_LOCATION (color, color);
-
-  /* coloring */
-  INIT_PROGRAM_UNIFORM_LOCATION (coloring, color);
-
   /* color matrix */
   INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_matrix);
   INIT_PROGRAM_UNIFORM_LOCATION (color_matrix, color_offset);
@@ -1918,6 +1917,8 @@ gsk_gl_renderer_realize (GskRenderer  *renderer,
     return FALSE;
 
   gsk_gl_glyph_cache_init (&self->glyph_cache, renderer, self->gl_driver);
+  gsk_gl_shadow_cache_init (&self->shadow_cache, renderer);
+  gsk_gl_offscreen_cache_init (&self->offscreen_cache, renderer);
 
   return TRUE;
 }
@@ -1942,6 +1943,8 @@ gsk_gl_renderer_unrealize (GskRenderer *renderer)
     glDeleteProgram (self->programs[i].id);
 
   gsk_gl_glyph_cache_free (&self->glyph_cache);
+  gsk_gl_shadow_cache_free (&self->shadow_cache, self->gl_driver);
+  gsk_gl_offscreen_cache_free (&self->offscreen_cache, self->gl_driver);
 
   g_clear_object (&self->gl_profiler);
   g_clear_object (&self->gl_driver);
@@ -2234,6 +2237,8 @@ add_offscreen_ops (GskGLRenderer   *self,
   graphene_rect_t prev_viewport;
   graphene_matrix_t item_proj;
   GskRoundedRect prev_clip;
+  graphene_rect_t rect;
+  gboolean cache = FALSE;
 
   /* We need the child node as a texture. If it already is one, we don't need to draw
    * it on a framebuffer of course. */
@@ -2252,7 +2257,28 @@ add_offscreen_ops (GskGLRenderer   *self,
       return;
     }
 
-  *texture_id = gsk_gl_driver_create_texture (self->gl_driver, width, height);
+  /* With the clip reset, the result only depends on the child, the area, the
+   * scale factor and the opacity, so we can keep it around for the next frames. */
+  if (reset_clip)
+    {
+      rect = GRAPHENE_RECT_INIT (min_x, min_y, max_x - min_x, max_y - min_y);
+      *texture_id = gsk_gl_offscreen_cache_lookup (&self->offscreen_cache,
+                                                   child_node, &rect, self->scale_factor,
+                                                   builder->current_opacity);
+      if (*texture_id != 0)
+        {
+          *is_offscreen = TRUE;
+          return;
+        }
+
+      cache = gsk_gl_offscreen_cache_reserve (&self->offscreen_cache, self->gl_driver,
+                                              ceilf (width), ceilf (height));
+    }
+
+  if (cache)
+    *texture_id = gsk_gl_driver_create_permanent_texture (self->gl_driver, width, height);
+  else
+    *texture_id = gsk_gl_driver_create_texture (self->gl_driver, width, height);
   gsk_gl_driver_bind_source_texture (self->gl_driver, *texture_id);
   gsk_gl_driver_init_texture_empty (self->gl_driver, *texture_id);
   render_target = gsk_gl_driver_create_render_target (self->gl_driver, *texture_id, TRUE, TRUE);
@@ -2290,6 +2316,10 @@ add_offscreen_ops (GskGLRenderer   *self,
   ops_set_projection (builder, &prev_projection);
   ops_set_render_target (builder, prev_render_target);
 
+  if (cache)
+    gsk_gl_offscreen_cache_commit (&self->offscreen_cache, child_node, &rect, self->scale_factor,
+                                   builder->current_opacity, ceilf (width), ceilf (height), *texture_id);
+
   *is_offscreen = TRUE;
 }
 
@@ -2302,6 +2332,9 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
   const Program *program = NULL;
   gsize buffer_index = 0;
   float *vertex_data = g_malloc (vertex_data_size);
+#ifdef G_ENABLE_DEBUG
+  GskProfiler *profiler = gsk_renderer_get_profiler (GSK_RENDERER (self));
+#endif
 
   /*g_message ("%s: Buffer size: %ld", __FUNCTION__, vertex_data_size);*/
 
@@ -2341,6 +2374,11 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
   glVertexAttribPointer (1, 2, GL_FLOAT, GL_FALSE,
                          sizeof (GskQuadVertex),
                          (void *) G_STRUCT_OFFSET (GskQuadVertex, uv));
+  /* 2 = color location */
+  glEnableVertexAttribArray (2);
+  glVertexAttribPointer (2, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                         sizeof (GskQuadVertex),
+                         (void *) G_STRUCT_OFFSET (GskQuadVertex, color));
 
   for (i = 0; i < n_ops; i ++)
     {
@@ -2394,12 +2432,6 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           apply_color_matrix_op (program, op);
           break;
 
-        case OP_CHANGE_COLOR:
-          /*g_assert (program == &self->color_program || program == &self->coloring_program ||*/
-                    /*program == &self->shadow_program);*/
-          apply_color_op (program, op);
-          break;
-
         case OP_CHANGE_BORDER_COLOR:
           apply_border_color_op (program, op);
           break;
@@ -2445,6 +2477,11 @@ gsk_gl_renderer_render_ops (GskGLRenderer *self,
           OP_PRINT (" -> draw %ld, size %ld and program %d\n",
                     op->draw.vao_offset, op->draw.vao_size, program->index);
           glDrawArrays (GL_TRIANGLES, op->draw.vao_offset, op->draw.vao_size);
+#ifdef G_ENABLE_DEBUG
+          gsk_profiler_counter_inc (profiler, self->profile_counters.draw_calls);
+          gsk_profiler_counter_add (profiler, self->profile_counters.quads,
+                                    op->draw.vao_size / GL_N_VERTICES);
+#endif
           break;
 
         default:
@@ -2501,6 +2538,8 @@ gsk_gl_renderer_do_render (GskRenderer           *renderer,
 
   gsk_gl_driver_begin_frame (self->gl_driver);
   gsk_gl_glyph_cache_begin_frame (&self->glyph_cache);
+  gsk_gl_shadow_cache_begin_frame (&self->shadow_cache, self->gl_driver);
+  gsk_gl_offscreen_cache_begin_frame (&self->offscreen_cache, self->gl_driver);
 
   memset (&render_op_builder, 0, sizeof (render_op_builder));
   render_op_builder.renderer = self;
@@ -2656,6 +2695,7 @@ gsk_gl_renderer_init (GskGLRenderer *self)
 
     self->profile_counters.frames = gsk_profiler_add_counter (profiler, "frames", "Frames", FALSE);
     self->profile_counters.draw_calls = gsk_profiler_add_counter (profiler, "draws", "glDrawArrays", TRUE);
+    self->profile_counters.quads = gsk_profiler_add_counter (profiler, "quads", "Quads drawn, before batching", TRUE);
 
     self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
     self->profile_timers.gpu_time = gsk_profiler_add_timer (profiler, "gpu-time", "GPU time", FALSE, TRUE);
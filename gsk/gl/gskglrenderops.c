@@ -272,16 +272,12 @@ void
 ops_set_color (RenderOpBuilder *builder,
                const GdkRGBA   *color)
 {
-  RenderOp op;
-
-  if (gdk_rgba_equal (color, &builder->program_state[builder->current_program->index].color))
-    return;
-
-  builder->program_state[builder->current_program->index].color = *color;
-
-  op.op = OP_CHANGE_COLOR;
-  op.color = *color;
-  g_array_append_val (builder->render_ops, op);
+  /* The color and coloring programs take their color from the vertex data,
+   * so changing it does not need an op and does not split the current draw. */
+  builder->current_color[0] = (guint8) (CLAMP (color->red,   0.0, 1.0) * 255.0 + 0.5);
+  builder->current_color[1] = (guint8) (CLAMP (color->green, 0.0, 1.0) * 255.0 + 0.5);
+  builder->current_color[2] = (guint8) (CLAMP (color->blue,  0.0, 1.0) * 255.0 + 0.5);
+  builder->current_color[3] = (guint8) (CLAMP (color->alpha, 0.0, 1.0) * 255.0 + 0.5);
 }
 
 void
@@ -354,6 +350,19 @@ ops_set_border_color (RenderOpBuilder *builder,
   g_array_append_val (builder->render_ops, op);
 }
 
+static inline void
+copy_vertex_data (RenderOpBuilder     *builder,
+                  GskQuadVertex        dest[GL_N_VERTICES],
+                  const GskQuadVertex  src[GL_N_VERTICES])
+{
+  int i;
+
+  memcpy (dest, src, sizeof (GskQuadVertex) * GL_N_VERTICES);
+
+  for (i = 0; i < GL_N_VERTICES; i ++)
+    memcpy (dest[i].color, builder->current_color, sizeof (builder->current_color));
+}
+
 void
 ops_draw (RenderOpBuilder     *builder,
           const GskQuadVertex  vertex_data[GL_N_VERTICES])
@@ -375,7 +384,7 @@ ops_draw (RenderOpBuilder     *builder,
       new_draw.draw.vao_size = last_op->draw.vao_size + GL_N_VERTICES;
 
       last_op->op = OP_CHANGE_VAO;
-      memcpy (&last_op->vertex_data, vertex_data, sizeof(GskQuadVertex) * GL_N_VERTICES);
+      copy_vertex_data (builder, last_op->vertex_data, vertex_data);
 
       /* Now add the DRAW */
       g_array_append_val (builder->render_ops, new_draw);
@@ -386,7 +395,7 @@ ops_draw (RenderOpBuilder     *builder,
       gsize offset = builder->buffer_size / sizeof (GskQuadVertex);
 
       op.op = OP_CHANGE_VAO;
-      memcpy (&op.vertex_data, vertex_data, sizeof(GskQuadVertex) * GL_N_VERTICES);
+      copy_vertex_data (builder, op.vertex_data, vertex_data);
       g_array_append_val (builder->render_ops, op);
 
       op.op = OP_DRAW;
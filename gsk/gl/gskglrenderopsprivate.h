@@ -15,7 +15,6 @@
 enum {
   OP_NONE,
   OP_CHANGE_OPACITY         =  1,
-  OP_CHANGE_COLOR           =  2,
   OP_CHANGE_PROJECTION      =  3,
   OP_CHANGE_MODELVIEW       =  4,
   OP_CHANGE_PROGRAM         =  5,
@@ -57,12 +56,6 @@ typedef struct
   int clip_corner_heights_location;
 
   union {
-    struct {
-      int color_location;
-    } color;
-    struct {
-      int color_location;
-    } coloring;
     struct {
       int color_matrix_location;
       int color_offset_location;
@@ -126,7 +119,6 @@ typedef struct
     const Program *program;
     int texture_id;
     int render_target_id;
-    GdkRGBA color;
     GskQuadVertex vertex_data[6];
     GskRoundedRect clip;
     graphene_rect_t viewport;
@@ -204,7 +196,6 @@ typedef struct
     float opacity;
     /* Per-program state */
     union {
-      GdkRGBA color;
       struct {
         graphene_matrix_t matrix;
         graphene_vec4_t offset;
@@ -226,6 +217,8 @@ typedef struct
   graphene_matrix_t current_projection;
   graphene_rect_t current_viewport;
   float current_opacity;
+  /* Not a uniform; ops_draw() writes this into every vertex */
+  guint8 current_color[4];
   float dx, dy;
 
   gsize buffer_size;
@@ -0,0 +1,128 @@
+#include "config.h"
+
+#include "gskglshadowcacheprivate.h"
+
+#include "gskdebugprivate.h"
+
+/* Blurred outset shadows are drawn from a small nine-slice texture
+ * that only depends on the corner radii, spread, blur radius and
+ * color of the shadow, which rarely change between frames. We keep
+ * those textures around and drop the ones that have not been used
+ * for MAX_UNUSED_FRAMES frames. */
+
+#define MAX_UNUSED_FRAMES 30
+
+typedef struct
+{
+  GskShadowKey key;
+  int texture_id;
+  int unused_frames;
+} CacheItem;
+
+void
+gsk_gl_shadow_cache_init (GskGLShadowCache *self,
+                          GskRenderer      *renderer)
+{
+  self->renderer = renderer;
+  self->textures = g_array_new (FALSE, TRUE, sizeof (CacheItem));
+
+#ifdef G_ENABLE_DEBUG
+  {
+    GskProfiler *profiler = gsk_renderer_get_profiler (renderer);
+
+    self->profile_counters.hits = gsk_profiler_add_counter (profiler, "shadow-cache-hits", "Shadow cache hits", TRUE);
+    self->profile_counters.misses = gsk_profiler_add_counter (profiler, "shadow-cache-misses", "Shadow cache misses", TRUE);
+  }
+#endif
+}
+
+void
+gsk_gl_shadow_cache_free (GskGLShadowCache *self,
+                          GskGLDriver      *gl_driver)
+{
+  guint i;
+
+  for (i = 0; i < self->textures->len; i ++)
+    {
+      const CacheItem *item = &g_array_index (self->textures, CacheItem, i);
+
+      gsk_gl_driver_destroy_texture (gl_driver, item->texture_id);
+    }
+
+  g_array_free (self->textures, TRUE);
+  self->textures = NULL;
+}
+
+void
+gsk_gl_shadow_cache_begin_frame (GskGLShadowCache *self,
+                                 GskGLDriver      *gl_driver)
+{
+  guint i, p;
+
+  /* Remove all textures that have been unused for a while */
+  for (i = 0, p = self->textures->len; i < p; i ++)
+    {
+      CacheItem *item = &g_array_index (self->textures, CacheItem, i);
+
+      if (item->unused_frames > MAX_UNUSED_FRAMES)
+        {
+          gsk_gl_driver_destroy_texture (gl_driver, item->texture_id);
+          g_array_remove_index_fast (self->textures, i);
+          p --;
+          i --;
+        }
+      else
+        {
+          item->unused_frames ++;
+        }
+    }
+}
+
+/* Returns 0 if there is no cached texture for @key */
+int
+gsk_gl_shadow_cache_get_texture_id (GskGLShadowCache   *self,
+                                    const GskShadowKey *key)
+{
+  guint i;
+
+  for (i = 0; i < self->textures->len; i ++)
+    {
+      CacheItem *item = &g_array_index (self->textures, CacheItem, i);
+
+      if (gsk_shadow_key_equal (key, &item->key))
+        {
+          item->unused_frames = 0;
+#ifdef G_ENABLE_DEBUG
+          gsk_profiler_counter_inc (gsk_renderer_get_profiler (self->renderer), self->profile_counters.hits);
+#endif
+          return item->texture_id;
+        }
+    }
+
+#ifdef G_ENABLE_DEBUG
+  gsk_profiler_counter_inc (gsk_renderer_get_profiler (self->renderer), self->profile_counters.misses);
+#endif
+
+  return 0;
+}
+
+/* The cache takes ownership of @texture_id, which must be permanent */
+void
+gsk_gl_shadow_cache_commit (GskGLShadowCache   *self,
+                            const GskShadowKey *key,
+                            int                 texture_id)
+{
+  CacheItem *item;
+
+  g_assert (texture_id > 0);
+
+  g_array_set_size (self->textures, self->textures->len + 1);
+  item = &g_array_index (self->textures, CacheItem, self->textures->len - 1);
+
+  item->key = *key;
+  item->texture_id = texture_id;
+  item->unused_frames = 0;
+
+  GSK_RENDERER_NOTE (self->renderer, OPENGL,
+                     g_message ("Caching shadow texture %d (%d cached)", texture_id, self->textures->len));
+}
@@ -0,0 +1,36 @@
+#ifndef __GSK_GL_SHADOW_CACHE_H__
+#define __GSK_GL_SHADOW_CACHE_H__
+
+#include <glib.h>
+#include "gskgldriverprivate.h"
+#include "gskroundedrectprivate.h"
+#include "gskrendererprivate.h"
+#include "gskshadowkeyprivate.h"
+
+typedef struct
+{
+  GskRenderer *renderer;
+
+  GArray *textures;
+
+#ifdef G_ENABLE_DEBUG
+  struct {
+    GQuark hits;
+    GQuark misses;
+  } profile_counters;
+#endif
+} GskGLShadowCache;
+
+void      gsk_gl_shadow_cache_init          (GskGLShadowCache          *self,
+                                             GskRenderer               *renderer);
+void      gsk_gl_shadow_cache_free          (GskGLShadowCache          *self,
+                                             GskGLDriver               *gl_driver);
+void      gsk_gl_shadow_cache_begin_frame   (GskGLShadowCache          *self,
+                                             GskGLDriver               *gl_driver);
+int       gsk_gl_shadow_cache_get_texture_id (GskGLShadowCache         *self,
+                                             const GskShadowKey        *key);
+void      gsk_gl_shadow_cache_commit        (GskGLShadowCache          *self,
+                                             const GskShadowKey        *key,
+                                             int                        texture_id);
+
+#endif
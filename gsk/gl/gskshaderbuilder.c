@@ -264,6 +264,12 @@ gsk_shader_builder_create_program (GskShaderBuilder *builder,
   program_id = glCreateProgram ();
   glAttachShader (program_id, vertex_id);
   glAttachShader (program_id, fragment_id);
+
+  /* These have to match the vertex layout set up by the renderer */
+  glBindAttribLocation (program_id, 0, "aPosition");
+  glBindAttribLocation (program_id, 1, "aUv");
+  glBindAttribLocation (program_id, 2, "aColor");
+
   glLinkProgram (program_id);
 
   glGetProgramiv (program_id, GL_LINK_STATUS, &status);
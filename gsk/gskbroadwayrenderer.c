@@ -8,11 +8,16 @@
 #include "gskrendernodeprivate.h"
 #include "gdk/gdktextureprivate.h"
 
+#include <string.h>
+
 
 struct _GskBroadwayRenderer
 {
   GskRenderer parent_instance;
 
+  /* graphene_rect_t of a texture node -> DeltaTexture */
+  GHashTable *delta_textures;
+  guint frame;
 };
 
 struct _GskBroadwayRendererClass
@@ -31,9 +36,11 @@ gsk_broadway_renderer_realize (GskRenderer  *self,
 }
 
 static void
-gsk_broadway_renderer_unrealize (GskRenderer *self)
+gsk_broadway_renderer_unrealize (GskRenderer *renderer)
 {
+  GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
 
+  g_hash_table_remove_all (self->delta_textures);
 }
 
 static GdkDrawingContext *
@@ -408,7 +415,7 @@ cached_texture_gone (gpointer data,
   g_hash_table_remove (gsk_broadway_node_cache, element->node);
 }
 
-static void
+static gboolean
 node_cache_store (GskRenderNode *node,
                   GdkTexture *texture,
                   float off_x,
@@ -431,14 +438,17 @@ node_cache_store (GskRenderNode *node,
       g_object_weak_ref (G_OBJECT (texture), cached_texture_gone, element);
       g_hash_table_insert (gsk_broadway_node_cache, element->node, element);
 
-      return;
+      return TRUE;
     }
+
+  return FALSE;
 }
 
 static GdkTexture *
-node_texture_fallback (GskRenderNode *node,
-                       float *off_x,
-                       float *off_y)
+node_texture_fallback (GskRenderNode    *node,
+                       float            *off_x,
+                       float            *off_y,
+                       cairo_surface_t **surface_out)
 {
   cairo_surface_t *surface;
   cairo_t *cr;
@@ -457,10 +467,270 @@ node_texture_fallback (GskRenderNode *node,
   texture = gdk_texture_new_for_surface (surface);
   *off_x =  x - node->bounds.origin.x;
   *off_y =  y - node->bounds.origin.y;
+  *surface_out = surface;
 
   return texture;
 }
 
+/* Cairo nodes and fallbacks that are not in the node cache produce a
+ * new texture every frame, even if only a few pixels changed. For
+ * those we remember the last texture we sent for the same rectangle,
+ * and if the new one differs in a small, opaque area we send just that
+ * area and draw it on top of the old texture. The base texture is
+ * always the last one sent in full, so patches never stack up.
+ */
+typedef struct {
+  graphene_rect_t rect;
+  cairo_surface_t *surface;
+  GdkTexture *texture;
+  guint frame;
+} DeltaTexture;
+
+/* Node bounds can have negative origins, and converting a negative
+ * float straight to an unsigned type is undefined, so go through int.
+ */
+static guint
+delta_texture_hash (const graphene_rect_t *rect)
+{
+  return (guint) (int) rect->origin.x ^
+         ((guint) (int) rect->origin.y << 8) ^
+         ((guint) (int) rect->size.width << 16) ^
+         ((guint) (int) rect->size.height << 24);
+}
+
+static gboolean
+delta_texture_equal (const graphene_rect_t *a,
+                     const graphene_rect_t *b)
+{
+  return graphene_rect_equal (a, b);
+}
+
+static void
+delta_texture_free (DeltaTexture *delta)
+{
+  cairo_surface_destroy (delta->surface);
+  g_object_unref (delta->texture);
+  g_free (delta);
+}
+
+/* Finds the bounding box of the pixels that differ between @a and @b,
+ * which must have the same size. Returns %FALSE if there are none.
+ */
+static gboolean
+find_changed_area (cairo_surface_t       *a,
+                   cairo_surface_t       *b,
+                   cairo_rectangle_int_t *area)
+{
+  int width = cairo_image_surface_get_width (a);
+  int height = cairo_image_surface_get_height (a);
+  int a_stride = cairo_image_surface_get_stride (a);
+  int b_stride = cairo_image_surface_get_stride (b);
+  const guchar *a_data = cairo_image_surface_get_data (a);
+  const guchar *b_data = cairo_image_surface_get_data (b);
+  int x, y, top, bottom, left, right;
+
+  for (top = 0; top < height; top++)
+    if (memcmp (a_data + top * a_stride, b_data + top * b_stride, width * 4) != 0)
+      break;
+
+  if (top == height)
+    return FALSE;
+
+  for (bottom = height - 1; bottom > top; bottom--)
+    if (memcmp (a_data + bottom * a_stride, b_data + bottom * b_stride, width * 4) != 0)
+      break;
+
+  left = width;
+  right = 0;
+  for (y = top; y <= bottom; y++)
+    {
+      const guint32 *a_row = (const guint32 *) (a_data + y * a_stride);
+      const guint32 *b_row = (const guint32 *) (b_data + y * b_stride);
+
+      for (x = 0; x < left; x++)
+        if (a_row[x] != b_row[x])
+          {
+            left = x;
+            break;
+          }
+
+      for (x = width - 1; x >= right; x--)
+        if (a_row[x] != b_row[x])
+          {
+            right = x + 1;
+            break;
+          }
+    }
+
+  area->x = left;
+  area->y = top;
+  area->width = right - left;
+  area->height = bottom + 1 - top;
+
+  return TRUE;
+}
+
+static gboolean
+area_is_opaque (cairo_surface_t             *surface,
+                const cairo_rectangle_int_t *area)
+{
+  int stride = cairo_image_surface_get_stride (surface);
+  const guchar *data = cairo_image_surface_get_data (surface);
+  int x, y;
+
+  for (y = area->y; y < area->y + area->height; y++)
+    {
+      const guint32 *row = (const guint32 *) (data + y * stride);
+
+      for (x = area->x; x < area->x + area->width; x++)
+        if ((row[x] >> 24) != 0xff)
+          return FALSE;
+    }
+
+  return TRUE;
+}
+
+static cairo_surface_t *
+copy_area (cairo_surface_t             *surface,
+           const cairo_rectangle_int_t *area)
+{
+  cairo_surface_t *copy;
+  cairo_t *cr;
+
+  copy = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, area->width, area->height);
+  cr = cairo_create (copy);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_surface (cr, surface, -area->x, -area->y);
+  cairo_paint (cr);
+  cairo_destroy (cr);
+
+  return copy;
+}
+
+static void
+add_texture_node (GskRenderer           *self,
+                  GArray                *nodes,
+                  GPtrArray             *node_textures,
+                  GdkTexture            *texture,
+                  const graphene_rect_t *rect,
+                  float                  offset_x,
+                  float                  offset_y)
+{
+  GdkDisplay *display = gsk_renderer_get_display (self);
+  guint32 texture_id;
+
+  g_ptr_array_add (node_textures, g_object_ref (texture)); /* Transfers ownership to node_textures */
+  texture_id = gdk_broadway_display_ensure_texture (display, texture);
+
+  add_uint32 (nodes, BROADWAY_NODE_TEXTURE);
+  add_rect (nodes, rect, offset_x, offset_y);
+  add_uint32 (nodes, texture_id);
+}
+
+/* Adds a texture node for @surface drawn at @rect, sending only the
+ * changed area if there is a suitable earlier texture for @rect.
+ * Consumes @texture, which must have been created for @surface.
+ */
+static void
+add_surface_texture_node (GskRenderer           *renderer,
+                          GArray                *nodes,
+                          GPtrArray             *node_textures,
+                          cairo_surface_t       *surface,
+                          GdkTexture            *texture,
+                          const graphene_rect_t *rect,
+                          float                  offset_x,
+                          float                  offset_y)
+{
+  GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (renderer);
+  DeltaTexture *delta;
+  cairo_rectangle_int_t area;
+  cairo_surface_t *patch_surface;
+  GdkTexture *patch;
+  graphene_rect_t patch_rect;
+  float scale_x, scale_y;
+  int width, height;
+
+  if (cairo_surface_get_type (surface) != CAIRO_SURFACE_TYPE_IMAGE ||
+      cairo_image_surface_get_format (surface) != CAIRO_FORMAT_ARGB32)
+    {
+      add_texture_node (renderer, nodes, node_textures, texture, rect, offset_x, offset_y);
+      g_object_unref (texture);
+      return;
+    }
+
+  cairo_surface_flush (surface);
+  width = cairo_image_surface_get_width (surface);
+  height = cairo_image_surface_get_height (surface);
+
+  delta = g_hash_table_lookup (self->delta_textures, rect);
+  if (delta != NULL &&
+      delta->frame != self->frame &&
+      cairo_image_surface_get_width (delta->surface) == width &&
+      cairo_image_surface_get_height (delta->surface) == height)
+    {
+      delta->frame = self->frame;
+
+      if (!find_changed_area (delta->surface, surface, &area))
+        {
+          add_texture_node (renderer, nodes, node_textures, delta->texture, rect, offset_x, offset_y);
+          g_object_unref (texture);
+          return;
+        }
+
+      /* Only opaque patches can simply be drawn over the old pixels */
+      if (area.width * area.height * 2 < width * height &&
+          area_is_opaque (surface, &area))
+        {
+          scale_x = rect->size.width / width;
+          scale_y = rect->size.height / height;
+          patch_rect = GRAPHENE_RECT_INIT (rect->origin.x + area.x * scale_x,
+                                           rect->origin.y + area.y * scale_y,
+                                           area.width * scale_x,
+                                           area.height * scale_y);
+
+          patch_surface = copy_area (surface, &area);
+          patch = gdk_texture_new_for_surface (patch_surface);
+          cairo_surface_destroy (patch_surface);
+
+          add_uint32 (nodes, BROADWAY_NODE_CONTAINER);
+          add_uint32 (nodes, 2);
+          add_texture_node (renderer, nodes, node_textures, delta->texture, rect, offset_x, offset_y);
+          add_texture_node (renderer, nodes, node_textures, patch, &patch_rect, offset_x, offset_y);
+
+          g_object_unref (patch);
+          g_object_unref (texture);
+          return;
+        }
+    }
+  else if (delta != NULL && delta->frame == self->frame)
+    {
+      /* Some other node with the same bounds owns this entry */
+      add_texture_node (renderer, nodes, node_textures, texture, rect, offset_x, offset_y);
+      g_object_unref (texture);
+      return;
+    }
+
+  add_texture_node (renderer, nodes, node_textures, texture, rect, offset_x, offset_y);
+
+  delta = g_new0 (DeltaTexture, 1);
+  delta->rect = *rect;
+  delta->surface = cairo_surface_reference (surface);
+  delta->texture = texture;
+  delta->frame = self->frame;
+  g_hash_table_replace (self->delta_textures, &delta->rect, delta);
+}
+
+static gboolean
+delta_texture_unused (gpointer key,
+                      gpointer value,
+                      gpointer data)
+{
+  DeltaTexture *delta = value;
+  GskBroadwayRenderer *self = data;
+
+  return delta->frame != self->frame;
+}
+
 /* Note: This tracks the offset so that we can convert
    the absolute coordinates of the GskRenderNodes to
    parent-relative which is what the dom uses, and
@@ -499,17 +769,11 @@ gsk_broadway_renderer_add_node (GskRenderer *self,
 
     case GSK_CAIRO_NODE:
       {
-        const cairo_surface_t *surface = gsk_cairo_node_peek_surface (node);
-        GdkTexture *texture;
-        guint32 texture_id;
+        cairo_surface_t *surface = (cairo_surface_t *) gsk_cairo_node_peek_surface (node);
 
-        texture = gdk_texture_new_for_surface ((cairo_surface_t *)surface);
-        g_ptr_array_add (node_textures, g_object_ref (texture)); /* Transfers ownership to node_textures */
-        texture_id = gdk_broadway_display_ensure_texture (display, texture);
-
-        add_uint32 (nodes, BROADWAY_NODE_TEXTURE);
-        add_rect (nodes, &node->bounds, offset_x, offset_y);
-        add_uint32 (nodes, texture_id);
+        add_surface_texture_node (self, nodes, node_textures,
+                                  surface, gdk_texture_new_for_surface (surface),
+                                  &node->bounds, offset_x, offset_y);
       }
       return;
 
@@ -663,12 +927,28 @@ gsk_broadway_renderer_add_node (GskRenderer *self,
 
     if (!texture)
       {
-        texture = node_texture_fallback (node, &t_off_x, &t_off_y);
+        cairo_surface_t *surface;
+
+        texture = node_texture_fallback (node, &t_off_x, &t_off_y, &surface);
 #if 0
         g_print ("Fallback %p for %s\n", texture, node->node_class->type_name);
 #endif
 
-        node_cache_store (node, texture, t_off_x, t_off_y);
+        if (!node_cache_store (node, texture, t_off_x, t_off_y))
+          {
+            graphene_rect_t rect = GRAPHENE_RECT_INIT (node->bounds.origin.x + t_off_x,
+                                                       node->bounds.origin.y + t_off_y,
+                                                       gdk_texture_get_width (texture),
+                                                       gdk_texture_get_height (texture));
+
+            add_surface_texture_node (self, nodes, node_textures,
+                                      surface, texture,
+                                      &rect, offset_x, offset_y);
+            cairo_surface_destroy (surface);
+            return;
+          }
+
+        cairo_surface_destroy (surface);
       }
 
     g_ptr_array_add (node_textures, texture); /* Transfers ownership to node_textures */
@@ -690,17 +970,37 @@ gsk_broadway_renderer_render (GskRenderer   *self,
   GArray *nodes = g_array_new (FALSE, FALSE, sizeof(guint32));
   GPtrArray *node_textures = g_ptr_array_new_with_free_func (g_object_unref);
 
+  GskBroadwayRenderer *broadway = GSK_BROADWAY_RENDERER (self);
+
+  broadway->frame++;
+
   gsk_broadway_renderer_add_node (self, nodes, node_textures, root, 0, 0);
   gdk_broadway_window_set_nodes (window, nodes, node_textures);
+
+  g_hash_table_foreach_remove (broadway->delta_textures, delta_texture_unused, broadway);
+
   g_array_unref (nodes);
   g_ptr_array_unref (node_textures);
 }
 
+static void
+gsk_broadway_renderer_finalize (GObject *object)
+{
+  GskBroadwayRenderer *self = GSK_BROADWAY_RENDERER (object);
+
+  g_hash_table_unref (self->delta_textures);
+
+  G_OBJECT_CLASS (gsk_broadway_renderer_parent_class)->finalize (object);
+}
+
 static void
 gsk_broadway_renderer_class_init (GskBroadwayRendererClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GskRendererClass *renderer_class = GSK_RENDERER_CLASS (klass);
 
+  gobject_class->finalize = gsk_broadway_renderer_finalize;
+
   renderer_class->begin_draw_frame = gsk_broadway_renderer_begin_draw_frame;
   renderer_class->realize = gsk_broadway_renderer_realize;
   renderer_class->unrealize = gsk_broadway_renderer_unrealize;
@@ -711,4 +1011,8 @@ gsk_broadway_renderer_class_init (GskBroadwayRendererClass *klass)
 static void
 gsk_broadway_renderer_init (GskBroadwayRenderer *self)
 {
+  self->delta_textures = g_hash_table_new_full ((GHashFunc) delta_texture_hash,
+                                                (GEqualFunc) delta_texture_equal,
+                                                NULL,
+                                                (GDestroyNotify) delta_texture_free);
 }
@@ -38,18 +38,17 @@
 
 #define get_box_filter_size(radius) ((int)(GAUSSIAN_SCALE_FACTOR * (radius)))
 
-/* Sadly, clang is picky about get_box_filter_size(2) not being a
- * constant expression, thus we have to use precomputed values.
+/* Up to this filter size, we replace the division in the inner loop by
+ * a multiplication with a 32 bit fixed point reciprocal. Since the sums
+ * we divide are always less than 256 * d, the result is exact as long
+ * as 256 * d * d < 2^32.
  */
-#define BOX_FILTER_SIZE_2 3
-#define BOX_FILTER_SIZE_3 5
-#define BOX_FILTER_SIZE_4 7
-#define BOX_FILTER_SIZE_5 9
-#define BOX_FILTER_SIZE_6 11
-#define BOX_FILTER_SIZE_7 13
-#define BOX_FILTER_SIZE_8 15
-#define BOX_FILTER_SIZE_9 16
-#define BOX_FILTER_SIZE_10 18
+#define MAX_RECIPROCAL_SIZE 4096
+
+/* Surfaces with more pixels than this get their rows blurred in
+ * parallel, one chunk of rows per thread */
+#define PARALLEL_MIN_PIXELS (256 * 256)
+#define PARALLEL_MIN_ROWS 16
 
 /* This applies a single box blur pass to a horizontal range of pixels;
  * since the box blur has the same weight for all pixels, we can
@@ -60,66 +59,74 @@
  * d is the filter width; for even d shift indicates how the blurred
  * result is aligned with the original - does ' x ' go to ' yy' (shift=1)
  * or 'yy ' (shift=-1)
+ *
+ * Pixels have N_CHANNELS channels that are all blurred the same way, so
+ * this works for A8 as well as premultiplied ARGB32. The channel loops
+ * have a constant trip count, which lets the compiler keep the sums in
+ * registers and vectorize them.
  */
+#define DEFINE_BLUR_XSPAN(name, N_CHANNELS)                                     \
+static void                                                                     \
+name (guchar *row,                                                              \
+      guchar *tmp_buffer,                                                       \
+      int     row_width,                                                        \
+      int     d,                                                                \
+      int     shift)                                                            \
+{                                                                               \
+  guint32 sum[N_CHANNELS] = { 0, };                                             \
+  guint64 reciprocal;                                                           \
+  int offset;                                                                   \
+  int i, c;                                                                     \
+                                                                                \
+  if (d % 2 == 1)                                                               \
+    offset = d / 2;                                                             \
+  else                                                                          \
+    offset = (d - shift) / 2;                                                   \
+                                                                                \
+  reciprocal = ((G_GUINT64_CONSTANT (1) << 32) + d - 1) / d;                    \
+                                                                                \
+  for (i = -d + offset; i < row_width + offset; i++)                            \
+    {                                                                           \
+      if (i >= 0 && i < row_width)                                              \
+        for (c = 0; c < N_CHANNELS; c++)                                        \
+          sum[c] += row[i * N_CHANNELS + c];                                    \
+                                                                                \
+      if (i >= offset)                                                          \
+        {                                                                       \
+          if (i >= d)                                                           \
+            for (c = 0; c < N_CHANNELS; c++)                                    \
+              sum[c] -= row[(i - d) * N_CHANNELS + c];                          \
+                                                                                \
+          if (G_LIKELY (d < MAX_RECIPROCAL_SIZE))                               \
+            for (c = 0; c < N_CHANNELS; c++)                                    \
+              tmp_buffer[(i - offset) * N_CHANNELS + c] =                       \
+                ((sum[c] + d / 2) * reciprocal) >> 32;                          \
+          else                                                                  \
+            for (c = 0; c < N_CHANNELS; c++)                                    \
+              tmp_buffer[(i - offset) * N_CHANNELS + c] = (sum[c] + d / 2) / d; \
+        }                                                                       \
+    }                                                                           \
+                                                                                \
+  memcpy (row, tmp_buffer, row_width * N_CHANNELS);                             \
+}
+
+DEFINE_BLUR_XSPAN (blur_xspan_a8, 1)
+DEFINE_BLUR_XSPAN (blur_xspan_argb32, 4)
+
+#undef DEFINE_BLUR_XSPAN
+
 static void
 blur_xspan (guchar *row,
             guchar *tmp_buffer,
             int     row_width,
+            int     n_channels,
             int     d,
             int     shift)
 {
-  int offset;
-  int sum = 0;
-  int i;
-
-  if (d % 2 == 1)
-    offset = d / 2;
+  if (n_channels == 1)
+    blur_xspan_a8 (row, tmp_buffer, row_width, d, shift);
   else
-    offset = (d - shift) / 2;
-
-  /* All the conditionals in here look slow, but the branches will
-   * be well predicted and there are enough different possibilities
-   * that trying to write this as a series of unconditional loops
-   * is hard and not an obvious win. The main slow down here seems
-   * to be the integer division per pixel; one possible optimization
-   * would be to accumulate into two 16-bit integer buffers and
-   * only divide down after all three passes. (SSE parallel implementation
-   * of the divide step is possible.)
-   */
-
-#define BLUR_ROW_KERNEL(D)                                      \
-  for (i = -(D) + offset; i < row_width + offset; i++)		\
-    {                                                           \
-      if (i >= 0 && i < row_width)                              \
-        sum += row[i];                                          \
-                                                                \
-      if (i >= offset)						\
-	{							\
-	  if (i >= (D))						\
-	    sum -= row[i - (D)];				\
-                                                                \
-	  tmp_buffer[i - offset] = (sum + (D) / 2) / (D);	\
-	}							\
-    }								\
-  break;
-
-  /* We unroll the values for d for radius 2-10 to avoid a generic
-   * divide operation (not radius 1, because its a no-op) */
-  switch (d)
-    {
-    case BOX_FILTER_SIZE_2: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_2);
-    case BOX_FILTER_SIZE_3: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_3);
-    case BOX_FILTER_SIZE_4: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_4);
-    case BOX_FILTER_SIZE_5: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_5);
-    case BOX_FILTER_SIZE_6: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_6);
-    case BOX_FILTER_SIZE_7: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_7);
-    case BOX_FILTER_SIZE_8: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_8);
-    case BOX_FILTER_SIZE_9: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_9);
-    case BOX_FILTER_SIZE_10: BLUR_ROW_KERNEL (BOX_FILTER_SIZE_10);
-    default: BLUR_ROW_KERNEL (d);
-    }
-
-  memcpy (row, tmp_buffer, row_width);
+    blur_xspan_argb32 (row, tmp_buffer, row_width, d, shift);
 }
 
 static void
@@ -127,13 +134,14 @@ blur_rows (guchar *dst_buffer,
            guchar *tmp_buffer,
            int     buffer_width,
            int     buffer_height,
+           int     n_channels,
            int     d)
 {
   int i;
 
   for (i = 0; i < buffer_height; i++)
     {
-      guchar *row = dst_buffer + i * buffer_width;
+      guchar *row = dst_buffer + i * buffer_width * n_channels;
 
       /* We want to produce a symmetric blur that spreads a pixel
        * equally far to the left and right. If d is odd that happens
@@ -143,19 +151,114 @@ blur_rows (guchar *dst_buffer,
        */
       if (d % 2 == 1)
         {
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
-          blur_xspan (row, tmp_buffer, buffer_width, d, 0);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, 0);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, 0);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, 0);
         }
       else
         {
-          blur_xspan (row, tmp_buffer, buffer_width, d, 1);
-          blur_xspan (row, tmp_buffer, buffer_width, d, -1);
-          blur_xspan (row, tmp_buffer, buffer_width, d + 1, 0);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, 1);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d, -1);
+          blur_xspan (row, tmp_buffer, buffer_width, n_channels, d + 1, 0);
         }
     }
 }
 
+typedef struct {
+  guchar *buffer;
+  int width;
+  int n_rows;
+  int n_channels;
+  int d;
+  GMutex *lock;
+  GCond *cond;
+  guint *pending;
+} BlurRowsJob;
+
+static void
+blur_rows_job (gpointer data,
+               gpointer user_data)
+{
+  BlurRowsJob *job = data;
+  guchar *tmp_buffer;
+
+  tmp_buffer = g_malloc (job->width * job->n_channels);
+  blur_rows (job->buffer, tmp_buffer, job->width, job->n_rows, job->n_channels, job->d);
+  g_free (tmp_buffer);
+
+  g_mutex_lock (job->lock);
+  (*job->pending)--;
+  if (*job->pending == 0)
+    g_cond_signal (job->cond);
+  g_mutex_unlock (job->lock);
+
+  g_free (job);
+}
+
+/* Like blur_rows(), but splits the rows of big buffers between
+ * several threads. */
+static void
+blur_rows_parallel (guchar *buffer,
+                    guchar *tmp_buffer,
+                    int     width,
+                    int     height,
+                    int     n_channels,
+                    int     d)
+{
+  static GThreadPool *pool = NULL;
+  static gsize n_threads = 0;
+  GMutex lock;
+  GCond cond;
+  guint pending;
+  int rows_per_job, y;
+
+  if (g_once_init_enter (&n_threads))
+    g_once_init_leave (&n_threads, CLAMP (g_get_num_processors (), 1, 16));
+
+  if (n_threads == 1 ||
+      width * height < PARALLEL_MIN_PIXELS ||
+      height < 2 * PARALLEL_MIN_ROWS)
+    {
+      blur_rows (buffer, tmp_buffer, width, height, n_channels, d);
+      return;
+    }
+
+  if (g_once_init_enter (&pool))
+    g_once_init_leave (&pool, g_thread_pool_new (blur_rows_job, NULL, n_threads, FALSE, NULL));
+
+  rows_per_job = MAX (PARALLEL_MIN_ROWS, (height + n_threads - 1) / n_threads);
+
+  g_mutex_init (&lock);
+  g_cond_init (&cond);
+  pending = 0;
+
+  g_mutex_lock (&lock);
+
+  for (y = 0; y < height; y += rows_per_job)
+    {
+      BlurRowsJob *job = g_new (BlurRowsJob, 1);
+
+      job->buffer = buffer + y * width * n_channels;
+      job->width = width;
+      job->n_rows = MIN (rows_per_job, height - y);
+      job->n_channels = n_channels;
+      job->d = d;
+      job->lock = &lock;
+      job->cond = &cond;
+      job->pending = &pending;
+
+      pending++;
+      g_thread_pool_push (pool, job, NULL);
+    }
+
+  while (pending > 0)
+    g_cond_wait (&cond, &lock);
+
+  g_mutex_unlock (&lock);
+  g_mutex_clear (&lock);
+  g_cond_clear (&cond);
+}
+
 /* Swaps width and height.
  */
 static void
@@ -185,34 +288,66 @@ flip_buffer (guchar *dst_buffer,
 #undef BLOCK_SIZE
 }
 
+/* Same as flip_buffer(), for 4 byte pixels */
+static void
+flip_buffer32 (guint32 *dst_buffer,
+               guint32 *src_buffer,
+               int      width,
+               int      height)
+{
+#define BLOCK_SIZE 8
+
+  int i0, j0;
+
+  for (i0 = 0; i0 < width; i0 += BLOCK_SIZE)
+    for (j0 = 0; j0 < height; j0 += BLOCK_SIZE)
+      {
+        int max_j = MIN(j0 + BLOCK_SIZE, height);
+        int max_i = MIN(i0 + BLOCK_SIZE, width);
+        int i, j;
+
+        for (i = i0; i < max_i; i++)
+          for (j = j0; j < max_j; j++)
+            dst_buffer[i * height + j] = src_buffer[j * width + i];
+      }
+#undef BLOCK_SIZE
+}
+
 static void
 _boxblur (guchar      *buffer,
           int          width,
           int          height,
+          int          n_channels,
           int          radius,
           GskBlurFlags flags)
 {
   guchar *flipped_buffer;
   int d = get_box_filter_size (radius);
 
-  flipped_buffer = g_malloc (width * height);
+  flipped_buffer = g_malloc (width * height * n_channels);
 
   if (flags & GSK_BLUR_Y)
     {
       /* Step 1: swap rows and columns */
-      flip_buffer (flipped_buffer, buffer, width, height);
+      if (n_channels == 1)
+        flip_buffer (flipped_buffer, buffer, width, height);
+      else
+        flip_buffer32 ((guint32 *) flipped_buffer, (guint32 *) buffer, width, height);
 
       /* Step 2: blur rows (really columns) */
-      blur_rows (flipped_buffer, buffer, height, width, d);
+      blur_rows_parallel (flipped_buffer, buffer, height, width, n_channels, d);
 
       /* Step 3: swap rows and columns */
-      flip_buffer (buffer, flipped_buffer, height, width);
+      if (n_channels == 1)
+        flip_buffer (buffer, flipped_buffer, height, width);
+      else
+        flip_buffer32 ((guint32 *) buffer, (guint32 *) flipped_buffer, height, width);
     }
 
   if (flags & GSK_BLUR_X)
     {
       /* Step 4: blur rows */
-      blur_rows (buffer, flipped_buffer, width, height, d);
+      blur_rows_parallel (buffer, flipped_buffer, width, height, n_channels, d);
     }
 
   g_free (flipped_buffer);
@@ -223,7 +358,8 @@ _boxblur (guchar      *buffer,
  * @surface: a cairo image surface.
  * @radius: the blur radius.
  *
- * Blurs the cairo image surface at the given radius.
+ * Blurs the cairo image surface at the given radius. The surface
+ * must be in %CAIRO_FORMAT_A8 or %CAIRO_FORMAT_ARGB32.
  */
 void
 gsk_cairo_blur_surface (cairo_surface_t* surface,
@@ -231,10 +367,12 @@ gsk_cairo_blur_surface (cairo_surface_t* surface,
                         GskBlurFlags     flags)
 {
   int radius = radius_d;
+  int n_channels;
 
   g_return_if_fail (surface != NULL);
   g_return_if_fail (cairo_surface_get_type (surface) == CAIRO_SURFACE_TYPE_IMAGE);
-  g_return_if_fail (cairo_image_surface_get_format (surface) == CAIRO_FORMAT_A8);
+  g_return_if_fail (cairo_image_surface_get_format (surface) == CAIRO_FORMAT_A8 ||
+                    cairo_image_surface_get_format (surface) == CAIRO_FORMAT_ARGB32);
 
   /* The code doesn't actually do any blurring for radius 1, as it
    * ends up with box filter size 1 */
@@ -244,13 +382,15 @@ gsk_cairo_blur_surface (cairo_surface_t* surface,
   if ((flags & (GSK_BLUR_X|GSK_BLUR_Y)) == 0)
     return;
 
+  n_channels = cairo_image_surface_get_format (surface) == CAIRO_FORMAT_A8 ? 1 : 4;
+
   /* Before we mess with the surface, execute any pending drawing. */
   cairo_surface_flush (surface);
 
   _boxblur (cairo_image_surface_get_data (surface),
-            cairo_image_surface_get_stride (surface),
+            cairo_image_surface_get_stride (surface) / n_channels,
             cairo_image_surface_get_height (surface),
-            radius, flags);
+            n_channels, radius, flags);
 
   /* Inform cairo we altered the surface contents. */
   cairo_surface_mark_dirty (surface);
@@ -6,6 +6,7 @@
 #include "gskrendererprivate.h"
 #include "gskrendernodeprivate.h"
 #include "gdk/gdktextureprivate.h"
+#include "gdk/gdkgltextureprivate.h"
 
 #ifdef G_ENABLE_DEBUG
 typedef struct {
@@ -44,6 +45,335 @@ gsk_cairo_renderer_unrealize (GskRenderer *renderer)
 
 }
 
+/* If GSK_CAIRO_THREADS is set to a number bigger than 1 and we draw to
+ * an image surface, the area to redraw is split into tiles that are
+ * rasterized in parallel by that many threads. Every tile gets its own
+ * image surface pointing into the memory of the target, so no two
+ * threads ever touch the same pixels or the same cairo objects.
+ *
+ * Render nodes are immutable, so drawing them from several threads is
+ * fine, with a few exceptions that node_can_draw_tiled() looks for:
+ * GL textures need their GL context to be downloaded, and blurs read
+ * pixels from outside the tile they are drawn into.
+ */
+#define TILE_SIZE 128
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  guint pending;
+} TileBatch;
+
+typedef struct {
+  TileBatch *batch;
+  GskRenderNode *root;
+  cairo_surface_t *surface;
+  cairo_matrix_t matrix;
+  const cairo_rectangle_list_t *clip;
+  graphene_rect_t bounds; /* of the tile, in user space */
+} Tile;
+
+static guint
+get_n_threads (void)
+{
+  static gsize n_threads = 0;
+
+  if (g_once_init_enter (&n_threads))
+    {
+      const char *env = g_getenv ("GSK_CAIRO_THREADS");
+      gsize n = env ? g_ascii_strtoull (env, NULL, 10) : 0;
+
+      g_once_init_leave (&n_threads, CLAMP (n, 1, 64));
+    }
+
+  return n_threads;
+}
+
+/* Returns %FALSE if drawing @node in tiles would not give the same
+ * result as drawing it in one go, or would not be thread-safe */
+static gboolean
+node_can_draw_tiled (GskRenderNode *node)
+{
+  guint i;
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        {
+          if (!node_can_draw_tiled (gsk_container_node_get_child (node, i)))
+            return FALSE;
+        }
+      return TRUE;
+
+    case GSK_TEXTURE_NODE:
+      return !GDK_IS_GL_TEXTURE (gsk_texture_node_get_texture (node));
+
+    case GSK_BLUR_NODE:
+      return FALSE;
+
+    case GSK_SHADOW_NODE:
+      for (i = 0; i < gsk_shadow_node_get_n_shadows (node); i++)
+        {
+          if (gsk_shadow_node_peek_shadow (node, i)->radius > 0)
+            return FALSE;
+        }
+      return node_can_draw_tiled (gsk_shadow_node_get_child (node));
+
+    case GSK_TRANSFORM_NODE:
+      return node_can_draw_tiled (gsk_transform_node_get_child (node));
+
+    case GSK_OPACITY_NODE:
+      return node_can_draw_tiled (gsk_opacity_node_get_child (node));
+
+    case GSK_COLOR_MATRIX_NODE:
+      return node_can_draw_tiled (gsk_color_matrix_node_get_child (node));
+
+    case GSK_REPEAT_NODE:
+      return node_can_draw_tiled (gsk_repeat_node_get_child (node));
+
+    case GSK_CLIP_NODE:
+      return node_can_draw_tiled (gsk_clip_node_get_child (node));
+
+    case GSK_ROUNDED_CLIP_NODE:
+      return node_can_draw_tiled (gsk_rounded_clip_node_get_child (node));
+
+    case GSK_BLEND_NODE:
+      return node_can_draw_tiled (gsk_blend_node_get_bottom_child (node)) &&
+             node_can_draw_tiled (gsk_blend_node_get_top_child (node));
+
+    case GSK_CROSS_FADE_NODE:
+      return node_can_draw_tiled (gsk_cross_fade_node_get_start_child (node)) &&
+             node_can_draw_tiled (gsk_cross_fade_node_get_end_child (node));
+
+    case GSK_NOT_A_RENDER_NODE:
+    case GSK_CAIRO_NODE:
+    case GSK_COLOR_NODE:
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+    case GSK_BORDER_NODE:
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+    case GSK_TEXT_NODE:
+    default:
+      return TRUE;
+    }
+}
+
+/* Like gsk_render_node_draw(), but skips container children that don't
+ * intersect @bounds */
+static void
+draw_node_culled (GskRenderNode         *node,
+                  cairo_t               *cr,
+                  const graphene_rect_t *bounds)
+{
+  graphene_rect_t intersection;
+  guint i;
+
+  if (!graphene_rect_intersection (&node->bounds, bounds, &intersection))
+    return;
+
+  if (gsk_render_node_get_node_type (node) == GSK_CONTAINER_NODE)
+    {
+      for (i = 0; i < gsk_container_node_get_n_children (node); i++)
+        draw_node_culled (gsk_container_node_get_child (node, i), cr, bounds);
+      return;
+    }
+
+  gsk_render_node_draw (node, cr);
+}
+
+static void
+render_tile (gpointer data,
+             gpointer user_data)
+{
+  Tile *tile = data;
+  TileBatch *batch = tile->batch;
+  cairo_t *cr;
+  int i;
+
+  cr = cairo_create (tile->surface);
+  cairo_set_matrix (cr, &tile->matrix);
+  for (i = 0; i < tile->clip->num_rectangles; i++)
+    {
+      const cairo_rectangle_t *r = &tile->clip->rectangles[i];
+
+      cairo_rectangle (cr, r->x, r->y, r->width, r->height);
+    }
+  cairo_clip (cr);
+
+  draw_node_culled (tile->root, cr, &tile->bounds);
+
+  cairo_destroy (cr);
+  cairo_surface_destroy (tile->surface);
+  g_free (tile);
+
+  g_mutex_lock (&batch->lock);
+  batch->pending--;
+  if (batch->pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->lock);
+}
+
+/* Converts a rectangle in pixels of the target surface to user space.
+ * Pixels are device space with the surface's device scale and offset
+ * applied, which cairo_device_to_user() knows nothing about. */
+static void
+pixels_to_user_bounds (cairo_t         *cr,
+                       double           scale_x,
+                       double           scale_y,
+                       double           offset_x,
+                       double           offset_y,
+                       double           x,
+                       double           y,
+                       double           width,
+                       double           height,
+                       graphene_rect_t *bounds)
+{
+  double px[4] = { x, x + width, x, x + width };
+  double py[4] = { y, y, y + height, y + height };
+  double x1 = G_MAXDOUBLE, y1 = G_MAXDOUBLE, x2 = -G_MAXDOUBLE, y2 = -G_MAXDOUBLE;
+  int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      px[i] = (px[i] - offset_x) / scale_x;
+      py[i] = (py[i] - offset_y) / scale_y;
+      cairo_device_to_user (cr, &px[i], &py[i]);
+      x1 = MIN (x1, px[i]);
+      y1 = MIN (y1, py[i]);
+      x2 = MAX (x2, px[i]);
+      y2 = MAX (y2, py[i]);
+    }
+
+  graphene_rect_init (bounds, x1, y1, x2 - x1, y2 - y1);
+}
+
+/* Returns %FALSE if @cr can't be drawn to in tiles */
+static gboolean
+gsk_cairo_renderer_draw_tiled (GskRenderer   *renderer,
+                               cairo_t       *cr,
+                               GskRenderNode *root)
+{
+  static GThreadPool *pool = NULL;
+  cairo_surface_t *target = cairo_get_target (cr);
+  cairo_rectangle_list_t *clip;
+  cairo_format_t format;
+  cairo_matrix_t matrix;
+  TileBatch batch;
+  double scale_x, scale_y, offset_x, offset_y;
+  int x1, y1, x2, y2, tx, ty, i;
+  guchar *data;
+  int stride;
+
+  if (get_n_threads () <= 1 ||
+      cairo_surface_get_type (target) != CAIRO_SURFACE_TYPE_IMAGE)
+    return FALSE;
+
+  format = cairo_image_surface_get_format (target);
+  if (format != CAIRO_FORMAT_ARGB32 && format != CAIRO_FORMAT_RGB24)
+    return FALSE;
+
+  if (!node_can_draw_tiled (root))
+    return FALSE;
+
+  cairo_surface_get_device_scale (target, &scale_x, &scale_y);
+  cairo_surface_get_device_offset (target, &offset_x, &offset_y);
+
+  clip = cairo_copy_clip_rectangle_list (cr);
+  if (clip->status != CAIRO_STATUS_SUCCESS || clip->num_rectangles == 0)
+    {
+      cairo_rectangle_list_destroy (clip);
+      return FALSE;
+    }
+
+  /* The area to redraw, in pixels */
+  x1 = y1 = G_MAXINT;
+  x2 = y2 = G_MININT;
+  for (i = 0; i < clip->num_rectangles; i++)
+    {
+      const cairo_rectangle_t *r = &clip->rectangles[i];
+      double px[2] = { r->x, r->x + r->width };
+      double py[2] = { r->y, r->y + r->height };
+
+      cairo_user_to_device (cr, &px[0], &py[0]);
+      cairo_user_to_device (cr, &px[1], &py[1]);
+      px[0] = px[0] * scale_x + offset_x;
+      px[1] = px[1] * scale_x + offset_x;
+      py[0] = py[0] * scale_y + offset_y;
+      py[1] = py[1] * scale_y + offset_y;
+      x1 = MIN (x1, floor (MIN (px[0], px[1])));
+      y1 = MIN (y1, floor (MIN (py[0], py[1])));
+      x2 = MAX (x2, ceil (MAX (px[0], px[1])));
+      y2 = MAX (y2, ceil (MAX (py[0], py[1])));
+    }
+  x1 = MAX (x1, 0);
+  y1 = MAX (y1, 0);
+  x2 = MIN (x2, cairo_image_surface_get_width (target));
+  y2 = MIN (y2, cairo_image_surface_get_height (target));
+
+  /* Not worth the overhead (or nothing to draw at all) */
+  if (x2 <= x1 || y2 <= y1 ||
+      (x2 - x1 <= TILE_SIZE && y2 - y1 <= TILE_SIZE))
+    {
+      cairo_rectangle_list_destroy (clip);
+      return FALSE;
+    }
+
+  if (pool == NULL)
+    pool = g_thread_pool_new (render_tile, NULL, get_n_threads (), FALSE, NULL);
+
+  GSK_RENDERER_NOTE (renderer, CAIRO,
+                     g_message ("Drawing %dx%d pixels in tiles", x2 - x1, y2 - y1));
+
+  cairo_surface_flush (target);
+  data = cairo_image_surface_get_data (target);
+  stride = cairo_image_surface_get_stride (target);
+  cairo_get_matrix (cr, &matrix);
+
+  g_mutex_init (&batch.lock);
+  g_cond_init (&batch.cond);
+  batch.pending = 0;
+
+  g_mutex_lock (&batch.lock);
+
+  for (ty = y1; ty < y2; ty += TILE_SIZE)
+    for (tx = x1; tx < x2; tx += TILE_SIZE)
+      {
+        int width = MIN (TILE_SIZE, x2 - tx);
+        int height = MIN (TILE_SIZE, y2 - ty);
+        Tile *tile;
+
+        tile = g_new (Tile, 1);
+        tile->batch = &batch;
+        tile->root = root;
+        tile->matrix = matrix;
+        tile->clip = clip;
+        pixels_to_user_bounds (cr, scale_x, scale_y, offset_x, offset_y,
+                               tx, ty, width, height, &tile->bounds);
+
+        tile->surface = cairo_image_surface_create_for_data (data + ty * stride + tx * 4,
+                                                             format, width, height, stride);
+        cairo_surface_set_device_scale (tile->surface, scale_x, scale_y);
+        cairo_surface_set_device_offset (tile->surface, offset_x - tx, offset_y - ty);
+
+        batch.pending++;
+        g_thread_pool_push (pool, tile, NULL);
+      }
+
+  while (batch.pending > 0)
+    g_cond_wait (&batch.cond, &batch.lock);
+
+  g_mutex_unlock (&batch.lock);
+  g_mutex_clear (&batch.lock);
+  g_cond_clear (&batch.cond);
+
+  cairo_rectangle_list_destroy (clip);
+  cairo_surface_mark_dirty (target);
+
+  return TRUE;
+}
+
 static void
 gsk_cairo_renderer_do_render (GskRenderer   *renderer,
                               cairo_t       *cr,
@@ -60,7 +390,8 @@ gsk_cairo_renderer_do_render (GskRenderer   *renderer,
   gsk_profiler_timer_begin (profiler, self->profile_timers.cpu_time);
 #endif
 
-  gsk_render_node_draw (root, cr);
+  if (!gsk_cairo_renderer_draw_tiled (renderer, cr, root))
+    gsk_render_node_draw (root, cr);
 
 #ifdef G_ENABLE_DEBUG
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
@@ -45,6 +45,8 @@
 
 #include "gskenumtypes.h"
 
+#include "gdk/gdkinternals.h"
+
 #include <graphene-gobject.h>
 #include <cairo-gobject.h>
 #include <gdk/gdk.h>
@@ -74,6 +76,14 @@ typedef struct
   GskRenderNode *root_node;
   GdkDisplay *display;
 
+  /* The root node of the last frame, and the window geometry it was
+   * rendered for. Used to compute the damage of the next frame.
+   */
+  GskRenderNode *prev_node;
+  int prev_width;
+  int prev_height;
+  int prev_scale;
+
   GskProfiler *profiler;
 
   GskDebugFlags debug_flags;
@@ -457,6 +467,8 @@ gsk_renderer_unrealize (GskRenderer *renderer)
 
   GSK_RENDERER_GET_CLASS (renderer)->unrealize (renderer);
 
+  g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
+
   priv->is_realized = FALSE;
 }
 
@@ -553,6 +565,12 @@ gsk_renderer_render (GskRenderer       *renderer,
 
   GSK_RENDERER_GET_CLASS (renderer)->render (renderer, root);
 
+  g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
+  priv->prev_node = gsk_render_node_ref (root);
+  priv->prev_width = gdk_window_get_width (priv->window);
+  priv->prev_height = gdk_window_get_height (priv->window);
+  priv->prev_scale = gdk_window_get_scale_factor (priv->window);
+
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (renderer, RENDERER))
     {
@@ -777,6 +795,11 @@ gsk_renderer_begin_draw_frame (GskRenderer          *renderer,
   g_return_val_if_fail (region != NULL, NULL);
   g_return_val_if_fail (priv->drawing_context == NULL, NULL);
 
+  /* If this frame doesn't end up rendering a node, the window contents
+   * no longer match the previous node.
+   */
+  g_clear_pointer (&priv->prev_node, gsk_render_node_unref);
+
 #ifdef G_ENABLE_DEBUG
   if (GSK_RENDERER_DEBUG_CHECK (renderer, FULL_REDRAW))
     {
@@ -799,6 +822,79 @@ gsk_renderer_begin_draw_frame (GskRenderer          *renderer,
   return priv->drawing_context;
 }
 
+/*< private >
+ * gsk_renderer_compute_damage:
+ * @renderer: a realized #GskRenderer
+ * @root: the #GskRenderNode that is going to be rendered next
+ * @region: the region that was invalidated
+ *
+ * Computes the region that needs to be redrawn to render @root, by
+ * comparing it to the root node of the previous frame and adding the
+ * areas exposed by the windowing system. This is usually much smaller
+ * than @region, which tends to be a generous approximation.
+ *
+ * If there is no previous frame to compare to, a copy of @region is
+ * returned.
+ *
+ * The result is meant to be passed to gsk_renderer_begin_draw_frame().
+ *
+ * Returns: (transfer full): the region to redraw
+ */
+cairo_region_t *
+gsk_renderer_compute_damage (GskRenderer          *renderer,
+                             GskRenderNode        *root,
+                             const cairo_region_t *region)
+{
+  GskRendererPrivate *priv = gsk_renderer_get_instance_private (renderer);
+  cairo_region_t *damage, *exposed;
+  GdkRectangle whole_window;
+
+  g_return_val_if_fail (GSK_IS_RENDERER (renderer), NULL);
+  g_return_val_if_fail (priv->is_realized, NULL);
+  g_return_val_if_fail (GSK_IS_RENDER_NODE (root), NULL);
+  g_return_val_if_fail (region != NULL, NULL);
+
+  whole_window = (GdkRectangle) {
+                     0, 0,
+                     gdk_window_get_width (priv->window),
+                     gdk_window_get_height (priv->window)
+                 };
+
+  exposed = gdk_window_take_exposed_area (priv->window);
+
+  if (priv->prev_node == NULL ||
+      priv->prev_width != whole_window.width ||
+      priv->prev_height != whole_window.height ||
+      priv->prev_scale != gdk_window_get_scale_factor (priv->window))
+    {
+      damage = cairo_region_copy (region);
+    }
+  else
+    {
+      damage = cairo_region_create ();
+      gsk_render_node_diff (priv->prev_node, root, damage);
+
+      if (exposed)
+        cairo_region_union (damage, exposed);
+
+      cairo_region_intersect_rectangle (damage, &whole_window);
+    }
+
+  g_clear_pointer (&exposed, cairo_region_destroy);
+
+  GSK_RENDERER_NOTE (renderer, RENDERER,
+                     {
+                       GdkRectangle extents;
+
+                       cairo_region_get_extents (damage, &extents);
+                       g_message ("Damage: %d rectangles, extents %d %d %d %d",
+                                  cairo_region_num_rectangles (damage),
+                                  extents.x, extents.y, extents.width, extents.height);
+                     });
+
+  return damage;
+}
+
 /**
  * gsk_renderer_end_draw_frame:
  * @renderer: a #GskRenderer
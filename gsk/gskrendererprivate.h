@@ -62,6 +62,9 @@ struct _GskRendererClass
 gboolean gsk_renderer_is_realized (GskRenderer *renderer);
 
 GskRenderNode *         gsk_renderer_get_root_node              (GskRenderer    *renderer);
+cairo_region_t *        gsk_renderer_compute_damage             (GskRenderer          *renderer,
+                                                                 GskRenderNode        *root,
+                                                                 const cairo_region_t *region);
 GdkDrawingContext *     gsk_renderer_get_drawing_context        (GskRenderer    *renderer);
 cairo_surface_t *       gsk_renderer_create_cairo_surface       (GskRenderer    *renderer,
                                                                  cairo_format_t  format,
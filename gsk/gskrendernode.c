@@ -42,6 +42,7 @@
 
 #include "gskdebugprivate.h"
 #include "gskrendererprivate.h"
+#include "gskrendernodebinaryprivate.h"
 
 #include <graphene-gobject.h>
 
@@ -68,12 +69,18 @@ gsk_render_node_finalize (GskRenderNode *self)
 
   g_clear_pointer (&self->name, g_free);
 
-  g_free (self);
+  g_slice_free1 (self->alloc_size, self);
 }
 
 /*< private >
  * gsk_render_node_new:
  * @node_class: class structure for this node
+ * @extra_size: bytes to allocate after the class' struct_size
+ *
+ * Nodes are allocated with the slice allocator. Snapshotting creates
+ * and frees lots of small nodes of the same few sizes every frame, and
+ * the per-thread magazines hand those back without going through
+ * malloc() each time.
  *
  * Returns: (transfer full): the newly created #GskRenderNode
  */
@@ -81,13 +88,18 @@ GskRenderNode *
 gsk_render_node_new (const GskRenderNodeClass *node_class, gsize extra_size)
 {
   GskRenderNode *self;
+  gsize size;
 
   g_return_val_if_fail (node_class != NULL, NULL);
   g_return_val_if_fail (node_class->node_type != GSK_NOT_A_RENDER_NODE, NULL);
 
-  self = g_malloc0 (node_class->struct_size + extra_size);
+  size = node_class->struct_size + extra_size;
+  g_return_val_if_fail (size <= G_MAXUINT, NULL);
+
+  self = g_slice_alloc0 (size);
 
   self->node_class = node_class;
+  self->alloc_size = size;
 
   self->ref_count = 1;
 
@@ -130,6 +142,79 @@ gsk_render_node_unref (GskRenderNode *node)
     gsk_render_node_finalize (node);
 }
 
+/*< private >
+ * gsk_render_node_add_to_region:
+ * @rect: a rectangle
+ * @region: the region to add @rect to
+ *
+ * Adds the smallest integer rectangle covering @rect to @region.
+ */
+void
+gsk_render_node_add_to_region (const graphene_rect_t *rect,
+                               cairo_region_t        *region)
+{
+  cairo_rectangle_int_t irect;
+
+  irect.x = floorf (rect->origin.x);
+  irect.y = floorf (rect->origin.y);
+  irect.width = ceilf (rect->origin.x + rect->size.width) - irect.x;
+  irect.height = ceilf (rect->origin.y + rect->size.height) - irect.y;
+
+  if (irect.width <= 0 || irect.height <= 0)
+    return;
+
+  cairo_region_union_rectangle (region, &irect);
+}
+
+/*< private >
+ * gsk_render_node_diff_impossible:
+ * @node1: a #GskRenderNode
+ * @node2: the #GskRenderNode to compare with
+ * @region: a #cairo_region_t to add the differences to
+ *
+ * Adds the bounds of both nodes to @region. This is the fallback for
+ * nodes that cannot be compared in a more fine-grained way.
+ */
+void
+gsk_render_node_diff_impossible (GskRenderNode  *node1,
+                                 GskRenderNode  *node2,
+                                 cairo_region_t *region)
+{
+  gsk_render_node_add_to_region (&node1->bounds, region);
+  gsk_render_node_add_to_region (&node2->bounds, region);
+}
+
+/*< private >
+ * gsk_render_node_diff:
+ * @node1: a #GskRenderNode
+ * @node2: the #GskRenderNode to compare with
+ * @region: a #cairo_region_t to add the differences to
+ *
+ * Compares @node1 and @node2 trying to compute the minimal region of
+ * changes. Subtrees that are shared between both nodes are skipped
+ * without looking at them, so this is cheap when only a small part of
+ * a tree was recreated.
+ *
+ * The result is a superset of the area where the renderings of both
+ * nodes differ; it is added to @region.
+ */
+void
+gsk_render_node_diff (GskRenderNode  *node1,
+                      GskRenderNode  *node2,
+                      cairo_region_t *region)
+{
+  if (node1 == node2)
+    return;
+
+  if (node1->node_class != node2->node_class)
+    {
+      gsk_render_node_diff_impossible (node1, node2, region);
+      return;
+    }
+
+  node1->node_class->diff (node1, node2, region);
+}
+
 /**
  * gsk_render_node_get_node_type:
  * @node: a #GskRenderNode
@@ -288,21 +373,9 @@ gsk_render_node_draw (GskRenderNode *node,
 GBytes *
 gsk_render_node_serialize (GskRenderNode *node)
 {
-  GVariant *node_variant, *variant;
-  GBytes *result;
-
-  node_variant = gsk_render_node_serialize_node (node);
-
-  variant = g_variant_new ("(suuv)",
-                           GSK_RENDER_NODE_SERIALIZATION_ID,
-                           (guint32) GSK_RENDER_NODE_SERIALIZATION_VERSION,
-                           (guint32) gsk_render_node_get_node_type (node),
-                           node_variant);
-
-  result = g_variant_get_data_as_bytes (variant);
-  g_variant_unref (variant);
+  g_return_val_if_fail (GSK_IS_RENDER_NODE (node), NULL);
 
-  return result;
+  return gsk_render_node_binary_serialize (node);
 }
 
 /**
@@ -362,6 +435,10 @@ gsk_render_node_deserialize (GBytes  *bytes,
   GVariant *variant, *node_variant;
   GskRenderNode *node = NULL;
 
+  if (gsk_render_node_binary_has_magic (bytes))
+    return gsk_render_node_binary_deserialize (bytes, error);
+
+  /* Data written by older versions uses GVariants */
   variant = g_variant_new_from_bytes (G_VARIANT_TYPE ("(suuv)"), bytes, FALSE);
 
   g_variant_get (variant, "(suuv)", &id_string, &version, &node_type, &node_variant);
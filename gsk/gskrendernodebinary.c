@@ -0,0 +1,1261 @@
+/* GSK - The GTK Scene Kit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gskrendernodebinaryprivate.h"
+
+#include "gskrendernodeprivate.h"
+#include "gskroundedrectprivate.h"
+#include "gdk/gdkmemorytextureprivate.h"
+#include "gdk/gdktextureprivate.h"
+
+#include <pango/pangocairo.h>
+#include <string.h>
+
+/* The binary render node format
+ *
+ * The format is flat, so a file can be used in place after loading or
+ * mapping it. It consists of:
+ *
+ *  - a GskBinaryHeader
+ *  - the string table: one guint32 file offset per string, followed by
+ *    the nul-terminated strings. Node names and font descriptions are
+ *    stored here, each one only once.
+ *  - the image table: one GskBinaryImage per texture or cairo surface,
+ *    followed by the pixel data in CAIRO_FORMAT_ARGB32, each image
+ *    aligned to 16 bytes. Textures used by more than one node are only
+ *    stored once, and loading does not copy the pixels.
+ *  - the nodes, in pre-order: each node starts with its type and name,
+ *    followed by its data and then its children.
+ *
+ * All numbers are stored in host byte order, and files from machines
+ * with a different byte order are rejected. Just like the GVariant
+ * format, this is meant for testing and debugging, not for storage.
+ */
+
+#define GSK_BINARY_MAGIC "GSKNODE"
+#define GSK_BINARY_VERSION 1
+#define GSK_BINARY_BYTE_ORDER 0x01020304
+#define GSK_BINARY_NONE G_MAXUINT32
+
+/* Deeper nesting than this is treated as invalid data */
+#define GSK_BINARY_MAX_DEPTH 4096
+
+typedef struct
+{
+  char    magic[8];
+  guint32 version;
+  guint32 byte_order;
+  guint32 n_strings;
+  guint32 strings_offset;
+  guint32 n_images;
+  guint32 images_offset;
+  guint32 nodes_offset;
+  guint32 nodes_size;
+} GskBinaryHeader;
+
+typedef struct
+{
+  guint32 width;
+  guint32 height;
+  guint32 stride;
+  guint32 offset;
+} GskBinaryImage;
+
+/*** Writing ***/
+
+typedef struct
+{
+  GByteArray *nodes;
+  GHashTable *string_indices;  /* string => index + 1 */
+  GPtrArray *strings;
+  GHashTable *image_indices;   /* GdkTexture or cairo_surface_t => index + 1 */
+  GPtrArray *images;           /* cairo_surface_t */
+} Writer;
+
+static void
+write_uint32 (Writer  *writer,
+              guint32  value)
+{
+  g_byte_array_append (writer->nodes, (const guint8 *) &value, sizeof (guint32));
+}
+
+static void
+write_float (Writer *writer,
+             float   value)
+{
+  g_byte_array_append (writer->nodes, (const guint8 *) &value, sizeof (float));
+}
+
+static void
+write_rect (Writer                *writer,
+            const graphene_rect_t *rect)
+{
+  write_float (writer, rect->origin.x);
+  write_float (writer, rect->origin.y);
+  write_float (writer, rect->size.width);
+  write_float (writer, rect->size.height);
+}
+
+static void
+write_point (Writer                 *writer,
+             const graphene_point_t *point)
+{
+  write_float (writer, point->x);
+  write_float (writer, point->y);
+}
+
+static void
+write_rgba (Writer        *writer,
+            const GdkRGBA *rgba)
+{
+  write_float (writer, rgba->red);
+  write_float (writer, rgba->green);
+  write_float (writer, rgba->blue);
+  write_float (writer, rgba->alpha);
+}
+
+static void
+write_rounded_rect (Writer               *writer,
+                    const GskRoundedRect *rect)
+{
+  int i;
+
+  write_rect (writer, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      write_float (writer, rect->corner[i].width);
+      write_float (writer, rect->corner[i].height);
+    }
+}
+
+static void
+write_matrix (Writer                  *writer,
+              const graphene_matrix_t *matrix)
+{
+  float values[16];
+
+  graphene_matrix_to_float (matrix, values);
+  g_byte_array_append (writer->nodes, (const guint8 *) values, sizeof (values));
+}
+
+static void
+write_string (Writer     *writer,
+              const char *string)
+{
+  guint index;
+
+  if (string == NULL)
+    {
+      write_uint32 (writer, GSK_BINARY_NONE);
+      return;
+    }
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (writer->string_indices, string));
+  if (index == 0)
+    {
+      char *copy = g_strdup (string);
+
+      g_ptr_array_add (writer->strings, copy);
+      index = writer->strings->len;
+      g_hash_table_insert (writer->string_indices, copy, GUINT_TO_POINTER (index));
+    }
+
+  write_uint32 (writer, index - 1);
+}
+
+/* Takes ownership of surface */
+static void
+write_image (Writer          *writer,
+             gconstpointer    key,
+             cairo_surface_t *surface)
+{
+  guint index;
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (writer->image_indices, key));
+  if (index == 0)
+    {
+      if (cairo_image_surface_get_format (surface) != CAIRO_FORMAT_ARGB32)
+        {
+          cairo_surface_t *argb;
+          cairo_t *cr;
+
+          argb = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                             cairo_image_surface_get_width (surface),
+                                             cairo_image_surface_get_height (surface));
+          cr = cairo_create (argb);
+          cairo_set_source_surface (cr, surface, 0, 0);
+          cairo_paint (cr);
+          cairo_destroy (cr);
+
+          cairo_surface_destroy (surface);
+          surface = argb;
+        }
+
+      cairo_surface_flush (surface);
+      g_ptr_array_add (writer->images, surface);
+      index = writer->images->len;
+      g_hash_table_insert (writer->image_indices, (gpointer) key, GUINT_TO_POINTER (index));
+    }
+  else
+    {
+      cairo_surface_destroy (surface);
+    }
+
+  write_uint32 (writer, index - 1);
+}
+
+static void write_node (Writer        *writer,
+                        GskRenderNode *node);
+
+static void
+write_node_data (Writer        *writer,
+                 GskRenderNode *node)
+{
+  graphene_rect_t bounds;
+  guint i, n;
+
+  gsk_render_node_get_bounds (node, &bounds);
+
+  switch (gsk_render_node_get_node_type (node))
+    {
+    case GSK_CONTAINER_NODE:
+      n = gsk_container_node_get_n_children (node);
+      write_uint32 (writer, n);
+      for (i = 0; i < n; i++)
+        write_node (writer, gsk_container_node_get_child (node, i));
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface = (cairo_surface_t *) gsk_cairo_node_peek_surface (node);
+
+        write_rect (writer, &bounds);
+        if (surface == NULL)
+          write_uint32 (writer, GSK_BINARY_NONE);
+        else
+          write_image (writer, surface, cairo_surface_reference (surface));
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      write_rect (writer, &bounds);
+      write_rgba (writer, gsk_color_node_peek_color (node));
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        const GskColorStop *stops = gsk_linear_gradient_node_peek_color_stops (node);
+
+        write_rect (writer, &bounds);
+        write_point (writer, gsk_linear_gradient_node_peek_start (node));
+        write_point (writer, gsk_linear_gradient_node_peek_end (node));
+        n = gsk_linear_gradient_node_get_n_color_stops (node);
+        write_uint32 (writer, n);
+        for (i = 0; i < n; i++)
+          {
+            write_float (writer, stops[i].offset);
+            write_rgba (writer, &stops[i].color);
+          }
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        const float *widths = gsk_border_node_peek_widths (node);
+        const GdkRGBA *colors = gsk_border_node_peek_colors (node);
+
+        write_rounded_rect (writer, gsk_border_node_peek_outline (node));
+        for (i = 0; i < 4; i++)
+          write_float (writer, widths[i]);
+        for (i = 0; i < 4; i++)
+          write_rgba (writer, &colors[i]);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        GdkTexture *texture = gsk_texture_node_get_texture (node);
+
+        write_rect (writer, &bounds);
+        write_image (writer, texture, gdk_texture_download_surface (texture));
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+      write_rounded_rect (writer, gsk_inset_shadow_node_peek_outline (node));
+      write_rgba (writer, gsk_inset_shadow_node_peek_color (node));
+      write_float (writer, gsk_inset_shadow_node_get_dx (node));
+      write_float (writer, gsk_inset_shadow_node_get_dy (node));
+      write_float (writer, gsk_inset_shadow_node_get_spread (node));
+      write_float (writer, gsk_inset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_OUTSET_SHADOW_NODE:
+      write_rounded_rect (writer, gsk_outset_shadow_node_peek_outline (node));
+      write_rgba (writer, gsk_outset_shadow_node_peek_color (node));
+      write_float (writer, gsk_outset_shadow_node_get_dx (node));
+      write_float (writer, gsk_outset_shadow_node_get_dy (node));
+      write_float (writer, gsk_outset_shadow_node_get_spread (node));
+      write_float (writer, gsk_outset_shadow_node_get_blur_radius (node));
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      write_matrix (writer, gsk_transform_node_peek_transform (node));
+      write_node (writer, gsk_transform_node_get_child (node));
+      break;
+
+    case GSK_OPACITY_NODE:
+      write_float (writer, gsk_opacity_node_get_opacity (node));
+      write_node (writer, gsk_opacity_node_get_child (node));
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        float offset[4];
+
+        graphene_vec4_to_float (gsk_color_matrix_node_peek_color_offset (node), offset);
+        write_matrix (writer, gsk_color_matrix_node_peek_color_matrix (node));
+        for (i = 0; i < 4; i++)
+          write_float (writer, offset[i]);
+        write_node (writer, gsk_color_matrix_node_get_child (node));
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      write_rect (writer, &bounds);
+      write_rect (writer, gsk_repeat_node_peek_child_bounds (node));
+      write_node (writer, gsk_repeat_node_get_child (node));
+      break;
+
+    case GSK_CLIP_NODE:
+      write_rect (writer, gsk_clip_node_peek_clip (node));
+      write_node (writer, gsk_clip_node_get_child (node));
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      write_rounded_rect (writer, gsk_rounded_clip_node_peek_clip (node));
+      write_node (writer, gsk_rounded_clip_node_get_child (node));
+      break;
+
+    case GSK_SHADOW_NODE:
+      n = gsk_shadow_node_get_n_shadows (node);
+      write_uint32 (writer, n);
+      for (i = 0; i < n; i++)
+        {
+          const GskShadow *shadow = gsk_shadow_node_peek_shadow (node, i);
+
+          write_rgba (writer, &shadow->color);
+          write_float (writer, shadow->dx);
+          write_float (writer, shadow->dy);
+          write_float (writer, shadow->radius);
+        }
+      write_node (writer, gsk_shadow_node_get_child (node));
+      break;
+
+    case GSK_BLEND_NODE:
+      write_uint32 (writer, gsk_blend_node_get_blend_mode (node));
+      write_node (writer, gsk_blend_node_get_bottom_child (node));
+      write_node (writer, gsk_blend_node_get_top_child (node));
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      write_float (writer, gsk_cross_fade_node_get_progress (node));
+      write_node (writer, gsk_cross_fade_node_get_start_child (node));
+      write_node (writer, gsk_cross_fade_node_get_end_child (node));
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        const PangoGlyphInfo *glyphs = gsk_text_node_peek_glyphs (node);
+        PangoFontDescription *desc;
+        char *font;
+
+        desc = pango_font_describe ((PangoFont *) gsk_text_node_peek_font (node));
+        font = pango_font_description_to_string (desc);
+        write_string (writer, font);
+        g_free (font);
+        pango_font_description_free (desc);
+
+        write_rect (writer, &bounds);
+        write_rgba (writer, gsk_text_node_peek_color (node));
+        write_float (writer, gsk_text_node_get_x (node));
+        write_float (writer, gsk_text_node_get_y (node));
+        n = gsk_text_node_get_num_glyphs (node);
+        write_uint32 (writer, n);
+        for (i = 0; i < n; i++)
+          {
+            write_uint32 (writer, glyphs[i].glyph);
+            write_uint32 (writer, glyphs[i].geometry.width);
+            write_uint32 (writer, glyphs[i].geometry.x_offset);
+            write_uint32 (writer, glyphs[i].geometry.y_offset);
+            write_uint32 (writer, glyphs[i].attr.is_cluster_start);
+          }
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      write_float (writer, gsk_blur_node_get_radius (node));
+      write_node (writer, gsk_blur_node_get_child (node));
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+write_node (Writer        *writer,
+            GskRenderNode *node)
+{
+  write_uint32 (writer, gsk_render_node_get_node_type (node));
+  write_string (writer, gsk_render_node_get_name (node));
+  write_node_data (writer, node);
+}
+
+static void
+append_padding (GByteArray *array,
+                guint       alignment)
+{
+  static const guint8 zeroes[16] = { 0, };
+
+  g_byte_array_append (array, zeroes, (alignment - array->len % alignment) % alignment);
+}
+
+GBytes *
+gsk_render_node_binary_serialize (GskRenderNode *node)
+{
+  GskBinaryHeader header = { GSK_BINARY_MAGIC, };
+  GByteArray *result;
+  Writer writer;
+  guint32 offset;
+  guint i;
+
+  writer.nodes = g_byte_array_new ();
+  writer.string_indices = g_hash_table_new (g_str_hash, g_str_equal);
+  writer.strings = g_ptr_array_new_with_free_func (g_free);
+  writer.image_indices = g_hash_table_new (NULL, NULL);
+  writer.images = g_ptr_array_new_with_free_func ((GDestroyNotify) cairo_surface_destroy);
+
+  write_node (&writer, node);
+
+  result = g_byte_array_new ();
+  g_byte_array_set_size (result, sizeof (GskBinaryHeader));
+
+  /* Strings */
+  header.n_strings = writer.strings->len;
+  header.strings_offset = result->len;
+  offset = header.strings_offset + header.n_strings * sizeof (guint32);
+  for (i = 0; i < writer.strings->len; i++)
+    {
+      g_byte_array_append (result, (const guint8 *) &offset, sizeof (guint32));
+      offset += strlen (g_ptr_array_index (writer.strings, i)) + 1;
+    }
+  for (i = 0; i < writer.strings->len; i++)
+    {
+      const char *s = g_ptr_array_index (writer.strings, i);
+
+      g_byte_array_append (result, (const guint8 *) s, strlen (s) + 1);
+    }
+
+  /* Images. We fill in the table once the pixel data is placed */
+  append_padding (result, sizeof (guint32));
+  header.n_images = writer.images->len;
+  header.images_offset = result->len;
+  g_byte_array_set_size (result, result->len + header.n_images * sizeof (GskBinaryImage));
+  for (i = 0; i < writer.images->len; i++)
+    {
+      cairo_surface_t *surface = g_ptr_array_index (writer.images, i);
+      GskBinaryImage image;
+
+      append_padding (result, 16);
+
+      image.width = cairo_image_surface_get_width (surface);
+      image.height = cairo_image_surface_get_height (surface);
+      image.stride = cairo_image_surface_get_stride (surface);
+      image.offset = result->len;
+
+      g_byte_array_append (result, cairo_image_surface_get_data (surface), image.stride * image.height);
+      memcpy (result->data + header.images_offset + i * sizeof (GskBinaryImage), &image, sizeof (GskBinaryImage));
+    }
+
+  /* Nodes */
+  append_padding (result, sizeof (guint32));
+  header.version = GSK_BINARY_VERSION;
+  header.byte_order = GSK_BINARY_BYTE_ORDER;
+  header.nodes_offset = result->len;
+  header.nodes_size = writer.nodes->len;
+  g_byte_array_append (result, writer.nodes->data, writer.nodes->len);
+
+  memcpy (result->data, &header, sizeof (GskBinaryHeader));
+
+  g_byte_array_unref (writer.nodes);
+  g_hash_table_unref (writer.string_indices);
+  g_ptr_array_unref (writer.strings);
+  g_hash_table_unref (writer.image_indices);
+  g_ptr_array_unref (writer.images);
+
+  return g_byte_array_free_to_bytes (result);
+}
+
+/*** Reading ***/
+
+typedef struct
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+
+  GskBinaryHeader header;
+  const char **strings;
+  GdkTexture **textures;
+  cairo_surface_t **surfaces;
+  PangoFont **fonts;
+  PangoContext *pango_context;
+
+  gsize pos;
+  gsize end;
+  guint depth;
+  gboolean failed;
+} Reader;
+
+static const cairo_user_data_key_t gsk_binary_bytes_key;
+
+static guint32
+read_uint32 (Reader *reader)
+{
+  guint32 value;
+
+  if (reader->failed || reader->end - reader->pos < sizeof (guint32))
+    {
+      reader->failed = TRUE;
+      return 0;
+    }
+
+  memcpy (&value, reader->data + reader->pos, sizeof (guint32));
+  reader->pos += sizeof (guint32);
+
+  return value;
+}
+
+static float
+read_float (Reader *reader)
+{
+  float value;
+
+  if (reader->failed || reader->end - reader->pos < sizeof (float))
+    {
+      reader->failed = TRUE;
+      return 0;
+    }
+
+  memcpy (&value, reader->data + reader->pos, sizeof (float));
+  reader->pos += sizeof (float);
+
+  return value;
+}
+
+static void
+read_rect (Reader          *reader,
+           graphene_rect_t *rect)
+{
+  rect->origin.x = read_float (reader);
+  rect->origin.y = read_float (reader);
+  rect->size.width = read_float (reader);
+  rect->size.height = read_float (reader);
+}
+
+static void
+read_point (Reader           *reader,
+            graphene_point_t *point)
+{
+  point->x = read_float (reader);
+  point->y = read_float (reader);
+}
+
+static void
+read_rgba (Reader  *reader,
+           GdkRGBA *rgba)
+{
+  rgba->red = read_float (reader);
+  rgba->green = read_float (reader);
+  rgba->blue = read_float (reader);
+  rgba->alpha = read_float (reader);
+}
+
+static void
+read_rounded_rect (Reader         *reader,
+                   GskRoundedRect *rect)
+{
+  int i;
+
+  read_rect (reader, &rect->bounds);
+  for (i = 0; i < 4; i++)
+    {
+      rect->corner[i].width = read_float (reader);
+      rect->corner[i].height = read_float (reader);
+    }
+}
+
+static void
+read_matrix (Reader            *reader,
+             graphene_matrix_t *matrix)
+{
+  float values[16];
+  int i;
+
+  for (i = 0; i < 16; i++)
+    values[i] = read_float (reader);
+
+  graphene_matrix_init_from_float (matrix, values);
+}
+
+static guint32
+read_count (Reader *reader,
+            gsize   element_size)
+{
+  guint32 n = read_uint32 (reader);
+
+  /* Don't allocate more than the data could possibly describe */
+  if (!reader->failed && n > (reader->end - reader->pos) / element_size)
+    {
+      reader->failed = TRUE;
+      return 0;
+    }
+
+  return n;
+}
+
+static const char *
+read_string (Reader *reader)
+{
+  guint32 index = read_uint32 (reader);
+
+  if (index == GSK_BINARY_NONE)
+    return NULL;
+
+  if (index >= reader->header.n_strings)
+    {
+      reader->failed = TRUE;
+      return NULL;
+    }
+
+  return reader->strings[index];
+}
+
+static gboolean
+read_image_info (Reader         *reader,
+                 guint32         index,
+                 GskBinaryImage *image)
+{
+  if (index >= reader->header.n_images)
+    return FALSE;
+
+  memcpy (image,
+          reader->data + reader->header.images_offset + index * sizeof (GskBinaryImage),
+          sizeof (GskBinaryImage));
+
+  return image->width > 0 && image->height > 0 &&
+         image->stride == cairo_format_stride_for_width (CAIRO_FORMAT_ARGB32, image->width) &&
+         image->offset % 16 == 0 &&
+         image->offset <= reader->size &&
+         image->height <= (reader->size - image->offset) / image->stride;
+}
+
+static GdkTexture *
+read_texture (Reader *reader)
+{
+  guint32 index = read_uint32 (reader);
+  GskBinaryImage image;
+  GBytes *pixels;
+
+  if (reader->failed || !read_image_info (reader, index, &image))
+    {
+      reader->failed = TRUE;
+      return NULL;
+    }
+
+  if (reader->textures[index] == NULL)
+    {
+      pixels = g_bytes_new_from_bytes (reader->bytes, image.offset, (gsize) image.stride * image.height);
+      reader->textures[index] = gdk_memory_texture_new (image.width, image.height,
+                                                        GDK_MEMORY_CAIRO_FORMAT_ARGB32,
+                                                        pixels, image.stride);
+      g_bytes_unref (pixels);
+    }
+
+  return reader->textures[index];
+}
+
+static cairo_surface_t *
+read_surface (Reader   *reader,
+              gboolean *has_surface)
+{
+  guint32 index = read_uint32 (reader);
+  GskBinaryImage image;
+
+  *has_surface = FALSE;
+
+  if (index == GSK_BINARY_NONE)
+    return NULL;
+
+  if (reader->failed || !read_image_info (reader, index, &image))
+    {
+      reader->failed = TRUE;
+      return NULL;
+    }
+
+  if (reader->surfaces[index] == NULL)
+    {
+      cairo_surface_t *surface;
+
+      /* The node only ever reads from the surface, so we can point it at our data */
+      surface = cairo_image_surface_create_for_data ((guchar *) reader->data + image.offset,
+                                                     CAIRO_FORMAT_ARGB32,
+                                                     image.width, image.height,
+                                                     image.stride);
+      cairo_surface_set_user_data (surface,
+                                   &gsk_binary_bytes_key,
+                                   g_bytes_ref (reader->bytes),
+                                   (cairo_destroy_func_t) g_bytes_unref);
+      reader->surfaces[index] = surface;
+    }
+
+  *has_surface = TRUE;
+
+  return reader->surfaces[index];
+}
+
+static PangoFont *
+read_font (Reader *reader)
+{
+  guint32 index = read_uint32 (reader);
+
+  if (reader->failed || index >= reader->header.n_strings)
+    {
+      reader->failed = TRUE;
+      return NULL;
+    }
+
+  if (reader->fonts[index] == NULL)
+    {
+      PangoFontDescription *desc;
+      PangoFontMap *fontmap;
+
+      fontmap = pango_cairo_font_map_get_default ();
+      if (reader->pango_context == NULL)
+        reader->pango_context = pango_font_map_create_context (fontmap);
+
+      desc = pango_font_description_from_string (reader->strings[index]);
+      reader->fonts[index] = pango_font_map_load_font (fontmap, reader->pango_context, desc);
+      pango_font_description_free (desc);
+
+      if (reader->fonts[index] == NULL)
+        reader->failed = TRUE;
+    }
+
+  return reader->fonts[index];
+}
+
+static GskRenderNode * read_node (Reader *reader);
+
+static GskRenderNode *
+read_node_data (Reader            *reader,
+                GskRenderNodeType  type)
+{
+  GskRenderNode *result = NULL;
+  GskRenderNode *child = NULL, *child2 = NULL;
+  graphene_rect_t bounds;
+  guint32 i, n;
+
+  switch (type)
+    {
+    case GSK_CONTAINER_NODE:
+      {
+        GskRenderNode **children;
+
+        n = read_count (reader, 2 * sizeof (guint32));
+        children = g_new0 (GskRenderNode *, MAX (n, 1));
+        for (i = 0; i < n && !reader->failed; i++)
+          children[i] = read_node (reader);
+
+        if (!reader->failed)
+          result = gsk_container_node_new (children, n);
+
+        for (i = 0; i < n; i++)
+          g_clear_pointer (&children[i], gsk_render_node_unref);
+        g_free (children);
+      }
+      break;
+
+    case GSK_CAIRO_NODE:
+      {
+        cairo_surface_t *surface;
+        gboolean has_surface;
+
+        read_rect (reader, &bounds);
+        surface = read_surface (reader, &has_surface);
+        if (reader->failed)
+          break;
+
+        if (has_surface)
+          result = gsk_cairo_node_new_for_surface (&bounds, surface);
+        else
+          result = gsk_cairo_node_new (&bounds);
+      }
+      break;
+
+    case GSK_COLOR_NODE:
+      {
+        GdkRGBA color;
+
+        read_rect (reader, &bounds);
+        read_rgba (reader, &color);
+        if (!reader->failed)
+          result = gsk_color_node_new (&color, &bounds);
+      }
+      break;
+
+    case GSK_LINEAR_GRADIENT_NODE:
+    case GSK_REPEATING_LINEAR_GRADIENT_NODE:
+      {
+        graphene_point_t start, end;
+        GskColorStop *stops;
+
+        read_rect (reader, &bounds);
+        read_point (reader, &start);
+        read_point (reader, &end);
+        n = read_count (reader, 5 * sizeof (float));
+        stops = g_new (GskColorStop, MAX (n, 1));
+        for (i = 0; i < n; i++)
+          {
+            stops[i].offset = read_float (reader);
+            read_rgba (reader, &stops[i].color);
+          }
+
+        if (!reader->failed && n >= 2)
+          result = (type == GSK_REPEATING_LINEAR_GRADIENT_NODE
+                    ? gsk_repeating_linear_gradient_node_new
+                    : gsk_linear_gradient_node_new) (&bounds, &start, &end, stops, n);
+        else
+          reader->failed = TRUE;
+
+        g_free (stops);
+      }
+      break;
+
+    case GSK_BORDER_NODE:
+      {
+        GskRoundedRect outline;
+        float widths[4];
+        GdkRGBA colors[4];
+
+        read_rounded_rect (reader, &outline);
+        for (i = 0; i < 4; i++)
+          widths[i] = read_float (reader);
+        for (i = 0; i < 4; i++)
+          read_rgba (reader, &colors[i]);
+
+        if (!reader->failed)
+          result = gsk_border_node_new (&outline, widths, colors);
+      }
+      break;
+
+    case GSK_TEXTURE_NODE:
+      {
+        GdkTexture *texture;
+
+        read_rect (reader, &bounds);
+        texture = read_texture (reader);
+        if (!reader->failed)
+          result = gsk_texture_node_new (texture, &bounds);
+      }
+      break;
+
+    case GSK_INSET_SHADOW_NODE:
+    case GSK_OUTSET_SHADOW_NODE:
+      {
+        GskRoundedRect outline;
+        GdkRGBA color;
+        float dx, dy, spread, radius;
+
+        read_rounded_rect (reader, &outline);
+        read_rgba (reader, &color);
+        dx = read_float (reader);
+        dy = read_float (reader);
+        spread = read_float (reader);
+        radius = read_float (reader);
+
+        if (!reader->failed)
+          result = (type == GSK_INSET_SHADOW_NODE
+                    ? gsk_inset_shadow_node_new
+                    : gsk_outset_shadow_node_new) (&outline, &color, dx, dy, spread, radius);
+      }
+      break;
+
+    case GSK_TRANSFORM_NODE:
+      {
+        graphene_matrix_t transform;
+
+        read_matrix (reader, &transform);
+        child = read_node (reader);
+        if (!reader->failed)
+          result = gsk_transform_node_new (child, &transform);
+      }
+      break;
+
+    case GSK_OPACITY_NODE:
+      {
+        float opacity;
+
+        opacity = read_float (reader);
+        child = read_node (reader);
+        if (!reader->failed)
+          result = gsk_opacity_node_new (child, opacity);
+      }
+      break;
+
+    case GSK_COLOR_MATRIX_NODE:
+      {
+        graphene_matrix_t matrix;
+        graphene_vec4_t offset;
+        float values[4];
+
+        read_matrix (reader, &matrix);
+        for (i = 0; i < 4; i++)
+          values[i] = read_float (reader);
+        graphene_vec4_init_from_float (&offset, values);
+        child = read_node (reader);
+        if (!reader->failed)
+          result = gsk_color_matrix_node_new (child, &matrix, &offset);
+      }
+      break;
+
+    case GSK_REPEAT_NODE:
+      {
+        graphene_rect_t child_bounds;
+
+        read_rect (reader, &bounds);
+        read_rect (reader, &child_bounds);
+        child = read_node (reader);
+        if (!reader->failed)
+          result = gsk_repeat_node_new (&bounds, child, &child_bounds);
+      }
+      break;
+
+    case GSK_CLIP_NODE:
+      {
+        graphene_rect_t clip;
+
+        read_rect (reader, &clip);
+        child = read_node (reader);
+        if (!reader->failed)
+          result = gsk_clip_node_new (child, &clip);
+      }
+      break;
+
+    case GSK_ROUNDED_CLIP_NODE:
+      {
+        GskRoundedRect clip;
+
+        read_rounded_rect (reader, &clip);
+        child = read_node (reader);
+        if (!reader->failed)
+          result = gsk_rounded_clip_node_new (child, &clip);
+      }
+      break;
+
+    case GSK_SHADOW_NODE:
+      {
+        GskShadow *shadows;
+
+        n = read_count (reader, 7 * sizeof (float));
+        shadows = g_new (GskShadow, MAX (n, 1));
+        for (i = 0; i < n; i++)
+          {
+            read_rgba (reader, &shadows[i].color);
+            shadows[i].dx = read_float (reader);
+            shadows[i].dy = read_float (reader);
+            shadows[i].radius = read_float (reader);
+          }
+        child = read_node (reader);
+
+        if (!reader->failed && n > 0)
+          result = gsk_shadow_node_new (child, shadows, n);
+        else
+          reader->failed = TRUE;
+
+        g_free (shadows);
+      }
+      break;
+
+    case GSK_BLEND_NODE:
+      {
+        guint32 blend_mode;
+
+        blend_mode = read_uint32 (reader);
+        child = read_node (reader);
+        child2 = read_node (reader);
+        if (blend_mode > GSK_BLEND_MODE_LUMINOSITY)
+          reader->failed = TRUE;
+        if (!reader->failed)
+          result = gsk_blend_node_new (child, child2, blend_mode);
+      }
+      break;
+
+    case GSK_CROSS_FADE_NODE:
+      {
+        float progress;
+
+        progress = read_float (reader);
+        child = read_node (reader);
+        child2 = read_node (reader);
+        if (!reader->failed)
+          result = gsk_cross_fade_node_new (child, child2, progress);
+      }
+      break;
+
+    case GSK_TEXT_NODE:
+      {
+        PangoFont *font;
+        PangoGlyphString *glyphs;
+        GdkRGBA color;
+        float x, y;
+
+        font = read_font (reader);
+        read_rect (reader, &bounds);
+        read_rgba (reader, &color);
+        x = read_float (reader);
+        y = read_float (reader);
+        n = read_count (reader, 5 * sizeof (guint32));
+        if (reader->failed)
+          break;
+
+        glyphs = pango_glyph_string_new ();
+        pango_glyph_string_set_size (glyphs, n);
+        for (i = 0; i < n; i++)
+          {
+            PangoGlyphInfo *glyph = &glyphs->glyphs[i];
+
+            glyph->glyph = read_uint32 (reader);
+            glyph->geometry.width = (gint32) read_uint32 (reader);
+            glyph->geometry.x_offset = (gint32) read_uint32 (reader);
+            glyph->geometry.y_offset = (gint32) read_uint32 (reader);
+            glyph->attr.is_cluster_start = read_uint32 (reader) ? 1 : 0;
+          }
+
+        if (!reader->failed)
+          result = gsk_text_node_new_with_bounds (font, glyphs, &color, x, y, &bounds);
+
+        pango_glyph_string_free (glyphs);
+      }
+      break;
+
+    case GSK_BLUR_NODE:
+      {
+        float radius;
+
+        radius = read_float (reader);
+        child = read_node (reader);
+        if (!reader->failed)
+          result = gsk_blur_node_new (child, radius);
+      }
+      break;
+
+    case GSK_NOT_A_RENDER_NODE:
+    default:
+      reader->failed = TRUE;
+      break;
+    }
+
+  g_clear_pointer (&child, gsk_render_node_unref);
+  g_clear_pointer (&child2, gsk_render_node_unref);
+
+  if (result == NULL)
+    reader->failed = TRUE;
+
+  return result;
+}
+
+static GskRenderNode *
+read_node (Reader *reader)
+{
+  GskRenderNodeType type;
+  const char *name;
+  GskRenderNode *node;
+
+  if (reader->depth >= GSK_BINARY_MAX_DEPTH)
+    reader->failed = TRUE;
+
+  type = read_uint32 (reader);
+  name = read_string (reader);
+  if (reader->failed)
+    return NULL;
+
+  reader->depth++;
+  node = read_node_data (reader, type);
+  reader->depth--;
+
+  if (reader->failed)
+    {
+      g_clear_pointer (&node, gsk_render_node_unref);
+      return NULL;
+    }
+
+  if (name)
+    gsk_render_node_set_name (node, name);
+
+  return node;
+}
+
+gboolean
+gsk_render_node_binary_has_magic (GBytes *bytes)
+{
+  const guchar *data;
+  gsize size;
+
+  data = g_bytes_get_data (bytes, &size);
+
+  return size >= sizeof (GskBinaryHeader) &&
+         memcmp (data, GSK_BINARY_MAGIC, sizeof (GSK_BINARY_MAGIC)) == 0;
+}
+
+static gboolean
+reader_init (Reader  *reader,
+             GBytes  *bytes,
+             GError **error)
+{
+  guint32 i;
+
+  memset (reader, 0, sizeof (Reader));
+  reader->bytes = g_bytes_ref (bytes);
+  reader->data = g_bytes_get_data (bytes, &reader->size);
+
+  if (!gsk_render_node_binary_has_magic (bytes))
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                   "Data not in GskRenderNode serialization format.");
+      return FALSE;
+    }
+
+  memcpy (&reader->header, reader->data, sizeof (GskBinaryHeader));
+
+  if (reader->header.version != GSK_BINARY_VERSION)
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_VERSION,
+                   "Format version %u not supported.", reader->header.version);
+      return FALSE;
+    }
+
+  if (reader->header.byte_order != GSK_BINARY_BYTE_ORDER)
+    {
+      g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_UNSUPPORTED_FORMAT,
+                   "Data was written on a machine with a different byte order.");
+      return FALSE;
+    }
+
+  if (reader->header.strings_offset > reader->size ||
+      reader->header.n_strings > (reader->size - reader->header.strings_offset) / sizeof (guint32) ||
+      reader->header.images_offset > reader->size ||
+      reader->header.n_images > (reader->size - reader->header.images_offset) / sizeof (GskBinaryImage) ||
+      reader->header.nodes_offset > reader->size ||
+      reader->header.nodes_size > reader->size - reader->header.nodes_offset)
+    goto invalid;
+
+  reader->strings = g_new (const char *, reader->header.n_strings);
+  for (i = 0; i < reader->header.n_strings; i++)
+    {
+      guint32 offset;
+      const char *end;
+
+      memcpy (&offset, reader->data + reader->header.strings_offset + i * sizeof (guint32), sizeof (guint32));
+      if (offset >= reader->size)
+        goto invalid;
+
+      end = memchr (reader->data + offset, '\0', reader->size - offset);
+      if (end == NULL ||
+          !g_utf8_validate ((const char *) reader->data + offset, end - (const char *) reader->data - offset, NULL))
+        goto invalid;
+
+      reader->strings[i] = (const char *) reader->data + offset;
+    }
+
+  reader->textures = g_new0 (GdkTexture *, reader->header.n_images);
+  reader->surfaces = g_new0 (cairo_surface_t *, reader->header.n_images);
+  reader->fonts = g_new0 (PangoFont *, reader->header.n_strings);
+
+  reader->pos = reader->header.nodes_offset;
+  reader->end = reader->header.nodes_offset + reader->header.nodes_size;
+
+  return TRUE;
+
+invalid:
+  g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_INVALID_DATA,
+               "Render node data is corrupt.");
+  return FALSE;
+}
+
+static void
+reader_clear (Reader *reader)
+{
+  guint32 i;
+
+  /* The nodes hold their own references to all of these */
+  if (reader->textures)
+    {
+      for (i = 0; i < reader->header.n_images; i++)
+        {
+          g_clear_object (&reader->textures[i]);
+          g_clear_pointer (&reader->surfaces[i], cairo_surface_destroy);
+        }
+    }
+  if (reader->fonts)
+    {
+      for (i = 0; i < reader->header.n_strings; i++)
+        g_clear_object (&reader->fonts[i]);
+    }
+
+  g_free (reader->textures);
+  g_free (reader->surfaces);
+  g_free (reader->fonts);
+  g_free (reader->strings);
+  g_clear_object (&reader->pango_context);
+  g_bytes_unref (reader->bytes);
+}
+
+GskRenderNode *
+gsk_render_node_binary_deserialize (GBytes  *bytes,
+                                    GError **error)
+{
+  GskRenderNode *node = NULL;
+  Reader reader;
+
+  if (reader_init (&reader, bytes, error))
+    {
+      node = read_node (&reader);
+
+      if (node == NULL)
+        g_set_error (error, GSK_SERIALIZATION_ERROR, GSK_SERIALIZATION_INVALID_DATA,
+                     "Render node data is corrupt.");
+    }
+
+  reader_clear (&reader);
+
+  return node;
+}
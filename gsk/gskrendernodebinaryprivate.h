@@ -0,0 +1,15 @@
+#ifndef __GSK_RENDER_NODE_BINARY_PRIVATE_H__
+#define __GSK_RENDER_NODE_BINARY_PRIVATE_H__
+
+#include "gskrendernode.h"
+
+G_BEGIN_DECLS
+
+GBytes *        gsk_render_node_binary_serialize        (GskRenderNode  *node);
+gboolean        gsk_render_node_binary_has_magic        (GBytes         *bytes);
+GskRenderNode * gsk_render_node_binary_deserialize      (GBytes         *bytes,
+                                                         GError        **error);
+
+G_END_DECLS
+
+#endif /* __GSK_RENDER_NODE_BINARY_PRIVATE_H__ */
@@ -42,6 +42,43 @@ check_variant_type (GVariant *variant,
   return TRUE;
 }
 
+static gboolean
+gsk_render_node_diff_is_empty (GskRenderNode *node1,
+                               GskRenderNode *node2)
+{
+  cairo_region_t *sub;
+  gboolean result;
+
+  if (node1 == node2)
+    return TRUE;
+
+  sub = cairo_region_create ();
+  gsk_render_node_diff (node1, node2, sub);
+  result = cairo_region_is_empty (sub);
+  cairo_region_destroy (sub);
+
+  return result;
+}
+
+static gboolean
+graphene_matrix_equal_exactly (const graphene_matrix_t *matrix1,
+                               const graphene_matrix_t *matrix2)
+{
+  float m1[16], m2[16];
+  guint i;
+
+  graphene_matrix_to_float (matrix1, m1);
+  graphene_matrix_to_float (matrix2, m2);
+
+  for (i = 0; i < 16; i++)
+    {
+      if (m1[i] != m2[i])
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 /*** GSK_COLOR_NODE ***/
 
 typedef struct _GskColorNode GskColorNode;
@@ -103,6 +140,21 @@ gsk_color_node_deserialize (GVariant  *variant,
   return gsk_color_node_new (&color, &GRAPHENE_RECT_INIT (x, y, w, h));
 }
 
+static void
+gsk_color_node_diff (GskRenderNode  *node1,
+                     GskRenderNode  *node2,
+                     cairo_region_t *region)
+{
+  GskColorNode *self1 = (GskColorNode *) node1;
+  GskColorNode *self2 = (GskColorNode *) node2;
+
+  if (graphene_rect_equal (&node1->bounds, &node2->bounds) &&
+      gdk_rgba_equal (&self1->color, &self2->color))
+    return;
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_COLOR_NODE_CLASS = {
   GSK_COLOR_NODE,
   sizeof (GskColorNode),
@@ -111,6 +163,7 @@ static const GskRenderNodeClass GSK_COLOR_NODE_CLASS = {
   gsk_color_node_draw,
   gsk_color_node_serialize,
   gsk_color_node_deserialize,
+  gsk_color_node_diff
 };
 
 const GdkRGBA *
@@ -279,6 +332,38 @@ gsk_repeating_linear_gradient_node_deserialize (GVariant  *variant,
   return gsk_linear_gradient_node_real_deserialize (variant, TRUE, error);
 }
 
+static void
+gsk_linear_gradient_node_diff (GskRenderNode  *node1,
+                               GskRenderNode  *node2,
+                               cairo_region_t *region)
+{
+  GskLinearGradientNode *self1 = (GskLinearGradientNode *) node1;
+  GskLinearGradientNode *self2 = (GskLinearGradientNode *) node2;
+
+  if (graphene_rect_equal (&node1->bounds, &node2->bounds) &&
+      graphene_point_equal (&self1->start, &self2->start) &&
+      graphene_point_equal (&self1->end, &self2->end) &&
+      self1->n_stops == self2->n_stops)
+    {
+      gsize i;
+
+      for (i = 0; i < self1->n_stops; i++)
+        {
+          GskColorStop *stop1 = &self1->stops[i];
+          GskColorStop *stop2 = &self2->stops[i];
+
+          if (stop1->offset != stop2->offset ||
+              !gdk_rgba_equal (&stop1->color, &stop2->color))
+            break;
+        }
+
+      if (i == self1->n_stops)
+        return;
+    }
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_LINEAR_GRADIENT_NODE_CLASS = {
   GSK_LINEAR_GRADIENT_NODE,
   sizeof (GskLinearGradientNode),
@@ -287,6 +372,7 @@ static const GskRenderNodeClass GSK_LINEAR_GRADIENT_NODE_CLASS = {
   gsk_linear_gradient_node_draw,
   gsk_linear_gradient_node_serialize,
   gsk_linear_gradient_node_deserialize,
+  gsk_linear_gradient_node_diff
 };
 
 static const GskRenderNodeClass GSK_REPEATING_LINEAR_GRADIENT_NODE_CLASS = {
@@ -297,6 +383,7 @@ static const GskRenderNodeClass GSK_REPEATING_LINEAR_GRADIENT_NODE_CLASS = {
   gsk_linear_gradient_node_draw,
   gsk_linear_gradient_node_serialize,
   gsk_repeating_linear_gradient_node_deserialize,
+  gsk_linear_gradient_node_diff
 };
 
 /**
@@ -578,6 +665,31 @@ gsk_border_node_deserialize (GVariant  *variant,
                               colors);
 }
 
+static void
+gsk_border_node_diff (GskRenderNode  *node1,
+                      GskRenderNode  *node2,
+                      cairo_region_t *region)
+{
+  GskBorderNode *self1 = (GskBorderNode *) node1;
+  GskBorderNode *self2 = (GskBorderNode *) node2;
+  guint i;
+
+  if (!gsk_rounded_rect_equal (&self1->outline, &self2->outline))
+    goto impossible;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (self1->border_width[i] != self2->border_width[i] ||
+          !gdk_rgba_equal (&self1->border_color[i], &self2->border_color[i]))
+        goto impossible;
+    }
+
+  return;
+
+impossible:
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_BORDER_NODE_CLASS = {
   GSK_BORDER_NODE,
   sizeof (GskBorderNode),
@@ -585,7 +697,8 @@ static const GskRenderNodeClass GSK_BORDER_NODE_CLASS = {
   gsk_border_node_finalize,
   gsk_border_node_draw,
   gsk_border_node_serialize,
-  gsk_border_node_deserialize
+  gsk_border_node_deserialize,
+  gsk_border_node_diff
 };
 
 const GskRoundedRect *
@@ -749,6 +862,21 @@ gsk_texture_node_deserialize (GVariant  *variant,
   return node;
 }
 
+static void
+gsk_texture_node_diff (GskRenderNode  *node1,
+                       GskRenderNode  *node2,
+                       cairo_region_t *region)
+{
+  GskTextureNode *self1 = (GskTextureNode *) node1;
+  GskTextureNode *self2 = (GskTextureNode *) node2;
+
+  if (graphene_rect_equal (&node1->bounds, &node2->bounds) &&
+      self1->texture == self2->texture)
+    return;
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_TEXTURE_NODE_CLASS = {
   GSK_TEXTURE_NODE,
   sizeof (GskTextureNode),
@@ -756,7 +884,8 @@ static const GskRenderNodeClass GSK_TEXTURE_NODE_CLASS = {
   gsk_texture_node_finalize,
   gsk_texture_node_draw,
   gsk_texture_node_serialize,
-  gsk_texture_node_deserialize
+  gsk_texture_node_deserialize,
+  gsk_texture_node_diff
 };
 
 /**
@@ -1255,6 +1384,25 @@ gsk_inset_shadow_node_deserialize (GVariant  *variant,
                                     &color, dx, dy, spread, radius);
 }
 
+static void
+gsk_inset_shadow_node_diff (GskRenderNode  *node1,
+                            GskRenderNode  *node2,
+                            cairo_region_t *region)
+{
+  GskInsetShadowNode *self1 = (GskInsetShadowNode *) node1;
+  GskInsetShadowNode *self2 = (GskInsetShadowNode *) node2;
+
+  if (gsk_rounded_rect_equal (&self1->outline, &self2->outline) &&
+      gdk_rgba_equal (&self1->color, &self2->color) &&
+      self1->dx == self2->dx &&
+      self1->dy == self2->dy &&
+      self1->spread == self2->spread &&
+      self1->blur_radius == self2->blur_radius)
+    return;
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_INSET_SHADOW_NODE_CLASS = {
   GSK_INSET_SHADOW_NODE,
   sizeof (GskInsetShadowNode),
@@ -1262,7 +1410,8 @@ static const GskRenderNodeClass GSK_INSET_SHADOW_NODE_CLASS = {
   gsk_inset_shadow_node_finalize,
   gsk_inset_shadow_node_draw,
   gsk_inset_shadow_node_serialize,
-  gsk_inset_shadow_node_deserialize
+  gsk_inset_shadow_node_deserialize,
+  gsk_inset_shadow_node_diff
 };
 
 /**
@@ -1556,6 +1705,25 @@ gsk_outset_shadow_node_deserialize (GVariant  *variant,
                                      &color, dx, dy, spread, radius);
 }
 
+static void
+gsk_outset_shadow_node_diff (GskRenderNode  *node1,
+                             GskRenderNode  *node2,
+                             cairo_region_t *region)
+{
+  GskOutsetShadowNode *self1 = (GskOutsetShadowNode *) node1;
+  GskOutsetShadowNode *self2 = (GskOutsetShadowNode *) node2;
+
+  if (gsk_rounded_rect_equal (&self1->outline, &self2->outline) &&
+      gdk_rgba_equal (&self1->color, &self2->color) &&
+      self1->dx == self2->dx &&
+      self1->dy == self2->dy &&
+      self1->spread == self2->spread &&
+      self1->blur_radius == self2->blur_radius)
+    return;
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_OUTSET_SHADOW_NODE_CLASS = {
   GSK_OUTSET_SHADOW_NODE,
   sizeof (GskOutsetShadowNode),
@@ -1563,7 +1731,8 @@ static const GskRenderNodeClass GSK_OUTSET_SHADOW_NODE_CLASS = {
   gsk_outset_shadow_node_finalize,
   gsk_outset_shadow_node_draw,
   gsk_outset_shadow_node_serialize,
-  gsk_outset_shadow_node_deserialize
+  gsk_outset_shadow_node_deserialize,
+  gsk_outset_shadow_node_diff
 };
 
 /**
@@ -1811,6 +1980,21 @@ gsk_cairo_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_cairo_node_diff (GskRenderNode  *node1,
+                     GskRenderNode  *node2,
+                     cairo_region_t *region)
+{
+  GskCairoNode *self1 = (GskCairoNode *) node1;
+  GskCairoNode *self2 = (GskCairoNode *) node2;
+
+  if (graphene_rect_equal (&node1->bounds, &node2->bounds) &&
+      self1->surface == self2->surface)
+    return;
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_CAIRO_NODE_CLASS = {
   GSK_CAIRO_NODE,
   sizeof (GskCairoNode),
@@ -1818,7 +2002,8 @@ static const GskRenderNodeClass GSK_CAIRO_NODE_CLASS = {
   gsk_cairo_node_finalize,
   gsk_cairo_node_draw,
   gsk_cairo_node_serialize,
-  gsk_cairo_node_deserialize
+  gsk_cairo_node_deserialize,
+  gsk_cairo_node_diff
 };
 
 const cairo_surface_t *
@@ -2068,6 +2253,48 @@ gsk_container_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_container_node_diff (GskRenderNode  *node1,
+                         GskRenderNode  *node2,
+                         cairo_region_t *region)
+{
+  GskContainerNode *self1 = (GskContainerNode *) node1;
+  GskContainerNode *self2 = (GskContainerNode *) node2;
+  guint start, end1, end2, i;
+
+  /* Skip the children that are shared at the start and at the end */
+  for (start = 0; start < MIN (self1->n_children, self2->n_children); start++)
+    {
+      if (self1->children[start] != self2->children[start])
+        break;
+    }
+
+  end1 = self1->n_children;
+  end2 = self2->n_children;
+  while (end1 > start && end2 > start &&
+         self1->children[end1 - 1] == self2->children[end2 - 1])
+    {
+      end1--;
+      end2--;
+    }
+
+  if (end1 - start == end2 - start)
+    {
+      /* Same number of children in between, so assume they replaced
+       * each other and compare them one by one.
+       */
+      for (i = start; i < end1; i++)
+        gsk_render_node_diff (self1->children[i], self2->children[i], region);
+    }
+  else
+    {
+      for (i = start; i < end1; i++)
+        gsk_render_node_add_to_region (&self1->children[i]->bounds, region);
+      for (i = start; i < end2; i++)
+        gsk_render_node_add_to_region (&self2->children[i]->bounds, region);
+    }
+}
+
 static const GskRenderNodeClass GSK_CONTAINER_NODE_CLASS = {
   GSK_CONTAINER_NODE,
   sizeof (GskContainerNode),
@@ -2075,7 +2302,8 @@ static const GskRenderNodeClass GSK_CONTAINER_NODE_CLASS = {
   gsk_container_node_finalize,
   gsk_container_node_draw,
   gsk_container_node_serialize,
-  gsk_container_node_deserialize
+  gsk_container_node_deserialize,
+  gsk_container_node_diff
 };
 
 /**
@@ -2251,6 +2479,40 @@ gsk_transform_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_transform_node_diff (GskRenderNode  *node1,
+                         GskRenderNode  *node2,
+                         cairo_region_t *region)
+{
+  GskTransformNode *self1 = (GskTransformNode *) node1;
+  GskTransformNode *self2 = (GskTransformNode *) node2;
+  cairo_region_t *sub;
+  int i, n;
+
+  if (!graphene_matrix_equal_exactly (&self1->transform, &self2->transform))
+    {
+      gsk_render_node_diff_impossible (node1, node2, region);
+      return;
+    }
+
+  sub = cairo_region_create ();
+  gsk_render_node_diff (self1->child, self2->child, sub);
+
+  n = cairo_region_num_rectangles (sub);
+  for (i = 0; i < n; i++)
+    {
+      cairo_rectangle_int_t rect;
+      graphene_rect_t child_rect, transformed_rect;
+
+      cairo_region_get_rectangle (sub, i, &rect);
+      graphene_rect_init (&child_rect, rect.x, rect.y, rect.width, rect.height);
+      graphene_matrix_transform_bounds (&self1->transform, &child_rect, &transformed_rect);
+      gsk_render_node_add_to_region (&transformed_rect, region);
+    }
+
+  cairo_region_destroy (sub);
+}
+
 static const GskRenderNodeClass GSK_TRANSFORM_NODE_CLASS = {
   GSK_TRANSFORM_NODE,
   sizeof (GskTransformNode),
@@ -2258,7 +2520,8 @@ static const GskRenderNodeClass GSK_TRANSFORM_NODE_CLASS = {
   gsk_transform_node_finalize,
   gsk_transform_node_draw,
   gsk_transform_node_serialize,
-  gsk_transform_node_deserialize
+  gsk_transform_node_deserialize,
+  gsk_transform_node_diff
 };
 
 /**
@@ -2404,6 +2667,20 @@ gsk_opacity_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_opacity_node_diff (GskRenderNode  *node1,
+                       GskRenderNode  *node2,
+                       cairo_region_t *region)
+{
+  GskOpacityNode *self1 = (GskOpacityNode *) node1;
+  GskOpacityNode *self2 = (GskOpacityNode *) node2;
+
+  if (self1->opacity == self2->opacity)
+    gsk_render_node_diff (self1->child, self2->child, region);
+  else
+    gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_OPACITY_NODE_CLASS = {
   GSK_OPACITY_NODE,
   sizeof (GskOpacityNode),
@@ -2411,7 +2688,8 @@ static const GskRenderNodeClass GSK_OPACITY_NODE_CLASS = {
   gsk_opacity_node_finalize,
   gsk_opacity_node_draw,
   gsk_opacity_node_serialize,
-  gsk_opacity_node_deserialize
+  gsk_opacity_node_deserialize,
+  gsk_opacity_node_diff
 };
 
 /**
@@ -2639,6 +2917,21 @@ gsk_color_matrix_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_color_matrix_node_diff (GskRenderNode  *node1,
+                            GskRenderNode  *node2,
+                            cairo_region_t *region)
+{
+  GskColorMatrixNode *self1 = (GskColorMatrixNode *) node1;
+  GskColorMatrixNode *self2 = (GskColorMatrixNode *) node2;
+
+  if (graphene_matrix_equal_exactly (&self1->color_matrix, &self2->color_matrix) &&
+      graphene_vec4_equal (&self1->color_offset, &self2->color_offset))
+    gsk_render_node_diff (self1->child, self2->child, region);
+  else
+    gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_COLOR_MATRIX_NODE_CLASS = {
   GSK_COLOR_MATRIX_NODE,
   sizeof (GskColorMatrixNode),
@@ -2646,7 +2939,8 @@ static const GskRenderNodeClass GSK_COLOR_MATRIX_NODE_CLASS = {
   gsk_color_matrix_node_finalize,
   gsk_color_matrix_node_draw,
   gsk_color_matrix_node_serialize,
-  gsk_color_matrix_node_deserialize
+  gsk_color_matrix_node_deserialize,
+  gsk_color_matrix_node_diff
 };
 
 /**
@@ -2827,6 +3121,23 @@ gsk_repeat_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_repeat_node_diff (GskRenderNode  *node1,
+                      GskRenderNode  *node2,
+                      cairo_region_t *region)
+{
+  GskRepeatNode *self1 = (GskRepeatNode *) node1;
+  GskRepeatNode *self2 = (GskRepeatNode *) node2;
+
+  /* A change anywhere in the child shows up in every repetition */
+  if (graphene_rect_equal (&node1->bounds, &node2->bounds) &&
+      graphene_rect_equal (&self1->child_bounds, &self2->child_bounds) &&
+      gsk_render_node_diff_is_empty (self1->child, self2->child))
+    return;
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_REPEAT_NODE_CLASS = {
   GSK_REPEAT_NODE,
   sizeof (GskRepeatNode),
@@ -2834,7 +3145,8 @@ static const GskRenderNodeClass GSK_REPEAT_NODE_CLASS = {
   gsk_repeat_node_finalize,
   gsk_repeat_node_draw,
   gsk_repeat_node_serialize,
-  gsk_repeat_node_deserialize
+  gsk_repeat_node_deserialize,
+  gsk_repeat_node_diff
 };
 
 /**
@@ -2972,6 +3284,34 @@ gsk_clip_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_clip_node_diff (GskRenderNode  *node1,
+                    GskRenderNode  *node2,
+                    cairo_region_t *region)
+{
+  GskClipNode *self1 = (GskClipNode *) node1;
+  GskClipNode *self2 = (GskClipNode *) node2;
+  cairo_region_t *sub;
+  cairo_region_t *clip;
+
+  if (!graphene_rect_equal (&self1->clip, &self2->clip))
+    {
+      gsk_render_node_diff_impossible (node1, node2, region);
+      return;
+    }
+
+  sub = cairo_region_create ();
+  gsk_render_node_diff (self1->child, self2->child, sub);
+
+  clip = cairo_region_create ();
+  gsk_render_node_add_to_region (&self1->clip, clip);
+  cairo_region_intersect (sub, clip);
+  cairo_region_union (region, sub);
+
+  cairo_region_destroy (clip);
+  cairo_region_destroy (sub);
+}
+
 static const GskRenderNodeClass GSK_CLIP_NODE_CLASS = {
   GSK_CLIP_NODE,
   sizeof (GskClipNode),
@@ -2979,7 +3319,8 @@ static const GskRenderNodeClass GSK_CLIP_NODE_CLASS = {
   gsk_clip_node_finalize,
   gsk_clip_node_draw,
   gsk_clip_node_serialize,
-  gsk_clip_node_deserialize
+  gsk_clip_node_deserialize,
+  gsk_clip_node_diff
 };
 
 /**
@@ -3133,6 +3474,34 @@ gsk_rounded_clip_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_rounded_clip_node_diff (GskRenderNode  *node1,
+                            GskRenderNode  *node2,
+                            cairo_region_t *region)
+{
+  GskRoundedClipNode *self1 = (GskRoundedClipNode *) node1;
+  GskRoundedClipNode *self2 = (GskRoundedClipNode *) node2;
+  cairo_region_t *sub;
+  cairo_region_t *clip;
+
+  if (!gsk_rounded_rect_equal (&self1->clip, &self2->clip))
+    {
+      gsk_render_node_diff_impossible (node1, node2, region);
+      return;
+    }
+
+  sub = cairo_region_create ();
+  gsk_render_node_diff (self1->child, self2->child, sub);
+
+  clip = cairo_region_create ();
+  gsk_render_node_add_to_region (&self1->clip.bounds, clip);
+  cairo_region_intersect (sub, clip);
+  cairo_region_union (region, sub);
+
+  cairo_region_destroy (clip);
+  cairo_region_destroy (sub);
+}
+
 static const GskRenderNodeClass GSK_ROUNDED_CLIP_NODE_CLASS = {
   GSK_ROUNDED_CLIP_NODE,
   sizeof (GskRoundedClipNode),
@@ -3140,7 +3509,8 @@ static const GskRenderNodeClass GSK_ROUNDED_CLIP_NODE_CLASS = {
   gsk_rounded_clip_node_finalize,
   gsk_rounded_clip_node_draw,
   gsk_rounded_clip_node_serialize,
-  gsk_rounded_clip_node_deserialize
+  gsk_rounded_clip_node_deserialize,
+  gsk_rounded_clip_node_diff
 };
 
 /**
@@ -3356,6 +3726,38 @@ gsk_shadow_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_shadow_node_diff (GskRenderNode  *node1,
+                      GskRenderNode  *node2,
+                      cairo_region_t *region)
+{
+  GskShadowNode *self1 = (GskShadowNode *) node1;
+  GskShadowNode *self2 = (GskShadowNode *) node2;
+  gsize i;
+
+  if (self1->n_shadows != self2->n_shadows)
+    goto impossible;
+
+  for (i = 0; i < self1->n_shadows; i++)
+    {
+      GskShadow *shadow1 = &self1->shadows[i];
+      GskShadow *shadow2 = &self2->shadows[i];
+
+      if (!gdk_rgba_equal (&shadow1->color, &shadow2->color) ||
+          shadow1->dx != shadow2->dx ||
+          shadow1->dy != shadow2->dy ||
+          shadow1->radius != shadow2->radius)
+        goto impossible;
+    }
+
+  /* Changes to the child also change its shadows */
+  if (gsk_render_node_diff_is_empty (self1->child, self2->child))
+    return;
+
+impossible:
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_SHADOW_NODE_CLASS = {
   GSK_SHADOW_NODE,
   sizeof (GskShadowNode),
@@ -3363,7 +3765,8 @@ static const GskRenderNodeClass GSK_SHADOW_NODE_CLASS = {
   gsk_shadow_node_finalize,
   gsk_shadow_node_draw,
   gsk_shadow_node_serialize,
-  gsk_shadow_node_deserialize
+  gsk_shadow_node_deserialize,
+  gsk_shadow_node_diff
 };
 
 /**
@@ -3570,6 +3973,25 @@ gsk_blend_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_blend_node_diff (GskRenderNode  *node1,
+                     GskRenderNode  *node2,
+                     cairo_region_t *region)
+{
+  GskBlendNode *self1 = (GskBlendNode *) node1;
+  GskBlendNode *self2 = (GskBlendNode *) node2;
+
+  if (self1->blend_mode == self2->blend_mode)
+    {
+      gsk_render_node_diff (self1->top, self2->top, region);
+      gsk_render_node_diff (self1->bottom, self2->bottom, region);
+    }
+  else
+    {
+      gsk_render_node_diff_impossible (node1, node2, region);
+    }
+}
+
 static const GskRenderNodeClass GSK_BLEND_NODE_CLASS = {
   GSK_BLEND_NODE,
   sizeof (GskBlendNode),
@@ -3577,7 +3999,8 @@ static const GskRenderNodeClass GSK_BLEND_NODE_CLASS = {
   gsk_blend_node_finalize,
   gsk_blend_node_draw,
   gsk_blend_node_serialize,
-  gsk_blend_node_deserialize
+  gsk_blend_node_deserialize,
+  gsk_blend_node_diff
 };
 
 /**
@@ -3740,6 +4163,25 @@ gsk_cross_fade_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_cross_fade_node_diff (GskRenderNode  *node1,
+                          GskRenderNode  *node2,
+                          cairo_region_t *region)
+{
+  GskCrossFadeNode *self1 = (GskCrossFadeNode *) node1;
+  GskCrossFadeNode *self2 = (GskCrossFadeNode *) node2;
+
+  if (self1->progress == self2->progress)
+    {
+      gsk_render_node_diff (self1->start, self2->start, region);
+      gsk_render_node_diff (self1->end, self2->end, region);
+    }
+  else
+    {
+      gsk_render_node_diff_impossible (node1, node2, region);
+    }
+}
+
 static const GskRenderNodeClass GSK_CROSS_FADE_NODE_CLASS = {
   GSK_CROSS_FADE_NODE,
   sizeof (GskCrossFadeNode),
@@ -3747,7 +4189,8 @@ static const GskRenderNodeClass GSK_CROSS_FADE_NODE_CLASS = {
   gsk_cross_fade_node_finalize,
   gsk_cross_fade_node_draw,
   gsk_cross_fade_node_serialize,
-  gsk_cross_fade_node_deserialize
+  gsk_cross_fade_node_deserialize,
+  gsk_cross_fade_node_diff
 };
 
 /**
@@ -3961,6 +4404,42 @@ gsk_text_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_text_node_diff (GskRenderNode  *node1,
+                    GskRenderNode  *node2,
+                    cairo_region_t *region)
+{
+  GskTextNode *self1 = (GskTextNode *) node1;
+  GskTextNode *self2 = (GskTextNode *) node2;
+
+  if (self1->font == self2->font &&
+      gdk_rgba_equal (&self1->color, &self2->color) &&
+      self1->x == self2->x &&
+      self1->y == self2->y &&
+      self1->num_glyphs == self2->num_glyphs)
+    {
+      guint i;
+
+      for (i = 0; i < self1->num_glyphs; i++)
+        {
+          PangoGlyphInfo *info1 = &self1->glyphs[i];
+          PangoGlyphInfo *info2 = &self2->glyphs[i];
+
+          if (info1->glyph != info2->glyph ||
+              info1->geometry.width != info2->geometry.width ||
+              info1->geometry.x_offset != info2->geometry.x_offset ||
+              info1->geometry.y_offset != info2->geometry.y_offset ||
+              info1->attr.is_cluster_start != info2->attr.is_cluster_start)
+            break;
+        }
+
+      if (i == self1->num_glyphs)
+        return;
+    }
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_TEXT_NODE_CLASS = {
   GSK_TEXT_NODE,
   sizeof (GskTextNode),
@@ -3968,7 +4447,8 @@ static const GskRenderNodeClass GSK_TEXT_NODE_CLASS = {
   gsk_text_node_finalize,
   gsk_text_node_draw,
   gsk_text_node_serialize,
-  gsk_text_node_deserialize
+  gsk_text_node_deserialize,
+  gsk_text_node_diff
 };
 
 /**
@@ -4132,148 +4612,6 @@ gsk_blur_node_finalize (GskRenderNode *node)
   gsk_render_node_unref (self->child);
 }
 
-static void
-blur_once (cairo_surface_t *src,
-           cairo_surface_t *dest,
-           int radius,
-           guchar *div_kernel_size)
-{
-  int width, height, src_rowstride, dest_rowstride, n_channels;
-  guchar *p_src, *p_dest, *c1, *c2;
-  gint x, y, i, i1, i2, width_minus_1, height_minus_1, radius_plus_1;
-  gint r, g, b, a;
-  guchar *p_dest_row, *p_dest_col;
-
-  width = cairo_image_surface_get_width (src);
-  height = cairo_image_surface_get_height (src);
-  n_channels = 4;
-  radius_plus_1 = radius + 1;
-
-  /* horizontal blur */
-  p_src = cairo_image_surface_get_data (src);
-  p_dest = cairo_image_surface_get_data (dest);
-  src_rowstride = cairo_image_surface_get_stride (src);
-  dest_rowstride = cairo_image_surface_get_stride (dest);
-
-  width_minus_1 = width - 1;
-  for (y = 0; y < height; y++)
-    {
-      /* calc the initial sums of the kernel */
-      r = g = b = a = 0;
-      for (i = -radius; i <= radius; i++)
-        {
-          c1 = p_src + (CLAMP (i, 0, width_minus_1) * n_channels);
-          r += c1[0];
-          g += c1[1];
-          b += c1[2];
-        }
-      p_dest_row = p_dest;
-      for (x = 0; x < width; x++)
-        {
-          /* set as the mean of the kernel */
-          p_dest_row[0] = div_kernel_size[r];
-          p_dest_row[1] = div_kernel_size[g];
-          p_dest_row[2] = div_kernel_size[b];
-          p_dest_row += n_channels;
-
-          /* the pixel to add to the kernel */
-          i1 = x + radius_plus_1;
-          if (i1 > width_minus_1)
-            i1 = width_minus_1;
-          c1 = p_src + (i1 * n_channels);
-
-          /* the pixel to remove from the kernel */
-          i2 = x - radius;
-          if (i2 < 0)
-            i2 = 0;
-          c2 = p_src + (i2 * n_channels);
-
-          /* calc the new sums of the kernel */
-          r += c1[0] - c2[0];
-          g += c1[1] - c2[1];
-          b += c1[2] - c2[2];
-        }
-
-      p_src += src_rowstride;
-      p_dest += dest_rowstride;
-    }
-
-  /* vertical blur */
-  p_src = cairo_image_surface_get_data (dest);
-  p_dest = cairo_image_surface_get_data (src);
-  src_rowstride = cairo_image_surface_get_stride (dest);
-  dest_rowstride = cairo_image_surface_get_stride (src);
-
-  height_minus_1 = height - 1;
-  for (x = 0; x < width; x++)
-    {
-      /* calc the initial sums of the kernel */
-      r = g = b = a = 0;
-      for (i = -radius; i <= radius; i++)
-        {
-          c1 = p_src + (CLAMP (i, 0, height_minus_1) * src_rowstride);
-          r += c1[0];
-          g += c1[1];
-          b += c1[2];
-        }
-
-      p_dest_col = p_dest;
-      for (y = 0; y < height; y++)
-        {
-          /* set as the mean of the kernel */
-
-          p_dest_col[0] = div_kernel_size[r];
-          p_dest_col[1] = div_kernel_size[g];
-          p_dest_col[2] = div_kernel_size[b];
-          p_dest_col += dest_rowstride;
-
-          /* the pixel to add to the kernel */
-          i1 = y + radius_plus_1;
-          if (i1 > height_minus_1)
-            i1 = height_minus_1;
-          c1 = p_src + (i1 * src_rowstride);
-
-          /* the pixel to remove from the kernel */
-          i2 = y - radius;
-          if (i2 < 0)
-            i2 = 0;
-          c2 = p_src + (i2 * src_rowstride);
-          /* calc the new sums of the kernel */
-          r += c1[0] - c2[0];
-          g += c1[1] - c2[1];
-          b += c1[2] - c2[2];
-        }
-
-      p_src += n_channels;
-      p_dest += n_channels;
-    }
-}
-
-static void
-blur_image_surface (cairo_surface_t *surface, int radius, int iterations)
-{
-  int kernel_size;
-  int i;
-  guchar *div_kernel_size;
-  cairo_surface_t *tmp;
-  int width, height;
-
-  width = cairo_image_surface_get_width (surface);
-  height = cairo_image_surface_get_height (surface);
-  tmp = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
-
-  kernel_size = 2 * radius + 1;
-  div_kernel_size = g_new (guchar, 256 * kernel_size);
-  for (i = 0; i < 256 * kernel_size; i++)
-    div_kernel_size[i] = (guchar) (i / kernel_size);
-
-  while (iterations-- > 0)
-    blur_once (surface, tmp, radius, div_kernel_size);
-
-  g_free (div_kernel_size);
-  cairo_surface_destroy (tmp);
-}
-
 static void
 gsk_blur_node_draw (GskRenderNode *node,
                     cairo_t       *cr)
@@ -4282,6 +4620,7 @@ gsk_blur_node_draw (GskRenderNode *node,
   cairo_pattern_t *pattern;
   cairo_surface_t *surface;
   cairo_surface_t *image_surface;
+  double x_scale;
 
   cairo_save (cr);
 
@@ -4296,8 +4635,10 @@ gsk_blur_node_draw (GskRenderNode *node,
 
   pattern = cairo_pop_group (cr);
   cairo_pattern_get_surface (pattern, &surface);
+  x_scale = 1;
+  cairo_surface_get_device_scale (surface, &x_scale, NULL);
   image_surface = cairo_surface_map_to_image (surface, NULL);
-  blur_image_surface (image_surface, (int)self->radius, 3);
+  gsk_cairo_blur_surface (image_surface, x_scale * self->radius, GSK_BLUR_X | GSK_BLUR_Y);
   cairo_surface_mark_dirty (surface);
   cairo_surface_unmap_image (surface, image_surface);
 
@@ -4346,6 +4687,22 @@ gsk_blur_node_deserialize (GVariant  *variant,
   return result;
 }
 
+static void
+gsk_blur_node_diff (GskRenderNode  *node1,
+                    GskRenderNode  *node2,
+                    cairo_region_t *region)
+{
+  GskBlurNode *self1 = (GskBlurNode *) node1;
+  GskBlurNode *self2 = (GskBlurNode *) node2;
+
+  /* Blurring spreads every change in the child to its surroundings */
+  if (self1->radius == self2->radius &&
+      gsk_render_node_diff_is_empty (self1->child, self2->child))
+    return;
+
+  gsk_render_node_diff_impossible (node1, node2, region);
+}
+
 static const GskRenderNodeClass GSK_BLUR_NODE_CLASS = {
   GSK_BLUR_NODE,
   sizeof (GskBlurNode),
@@ -4353,7 +4710,8 @@ static const GskRenderNodeClass GSK_BLUR_NODE_CLASS = {
   gsk_blur_node_finalize,
   gsk_blur_node_draw,
   gsk_blur_node_serialize,
-  gsk_blur_node_deserialize
+  gsk_blur_node_deserialize,
+  gsk_blur_node_diff
 };
 
 /**
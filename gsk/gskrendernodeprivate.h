@@ -15,6 +15,8 @@ struct _GskRenderNode
   const GskRenderNodeClass *node_class;
 
   volatile int ref_count;
+  /* Size of the allocation, which g_slice_free1() needs back */
+  guint alloc_size;
 
   /* Use for debugging */
   char *name;
@@ -34,6 +36,9 @@ struct _GskRenderNodeClass
   GVariant *      (* serialize)   (GskRenderNode  *node);
   GskRenderNode * (* deserialize) (GVariant       *variant,
                                    GError        **error);
+  void            (* diff)        (GskRenderNode  *node1,
+                                   GskRenderNode  *node2,
+                                   cairo_region_t *region);
 };
 
 GskRenderNode * gsk_render_node_new              (const GskRenderNodeClass  *node_class,
@@ -47,6 +52,15 @@ GskRenderNode * gsk_render_node_deserialize_node (GskRenderNodeType          typ
 GskRenderNode * gsk_cairo_node_new_for_surface   (const graphene_rect_t    *bounds,
                                                   cairo_surface_t          *surface);
 
+void            gsk_render_node_diff             (GskRenderNode             *node1,
+                                                  GskRenderNode             *node2,
+                                                  cairo_region_t            *region);
+void            gsk_render_node_diff_impossible  (GskRenderNode             *node1,
+                                                  GskRenderNode             *node2,
+                                                  cairo_region_t            *region);
+void            gsk_render_node_add_to_region    (const graphene_rect_t     *rect,
+                                                  cairo_region_t            *region);
+
 G_END_DECLS
 
 #endif /* __GSK_RENDER_NODE_PRIVATE_H__ */
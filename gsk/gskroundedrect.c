@@ -522,3 +522,20 @@ gsk_rounded_rect_to_float (const GskRoundedRect *self,
     }
 }
 
+gboolean
+gsk_rounded_rect_equal (const GskRoundedRect *rect1,
+                        const GskRoundedRect *rect2)
+{
+  guint i;
+
+  if (!graphene_rect_equal (&rect1->bounds, &rect2->bounds))
+    return FALSE;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (!graphene_size_equal (&rect1->corner[i], &rect2->corner[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
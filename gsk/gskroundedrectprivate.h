@@ -13,6 +13,8 @@ void                     gsk_rounded_rect_path                  (const GskRounde
                                                                  cairo_t                  *cr);
 void                     gsk_rounded_rect_to_float              (const GskRoundedRect     *self,
                                                                  float                     rect[12]);
+gboolean                 gsk_rounded_rect_equal                 (const GskRoundedRect     *rect1,
+                                                                 const GskRoundedRect     *rect2);
 
 G_END_DECLS
 
@@ -0,0 +1,52 @@
+/* GSK - The GTK Scene Kit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gskshadowkeyprivate.h"
+
+#include "gskroundedrectprivate.h"
+
+/* All fields are sizes, radii or color components, so they are never
+ * negative and the conversions to guint are well defined. */
+guint
+gsk_shadow_key_hash (const GskShadowKey *key)
+{
+  const GskRoundedRect *r = &key->outline;
+  guint hash;
+  int i;
+
+  hash = (guint) (r->bounds.size.width * 16) ^ ((guint) (r->bounds.size.height * 16) << 8);
+  for (i = 0; i < 4; i++)
+    hash = (hash << 5) ^ (guint) (r->corner[i].width * 16) ^ ((guint) (r->corner[i].height * 16) << 3);
+
+  hash ^= (guint) (key->blur_radius * 16) << 16;
+  hash ^= (guint) (key->color.alpha * 255) << 24;
+  hash ^= ((guint) (key->color.red * 255) << 16) |
+          ((guint) (key->color.green * 255) << 8) |
+          ((guint) (key->color.blue * 255));
+
+  return hash;
+}
+
+gboolean
+gsk_shadow_key_equal (const GskShadowKey *a,
+                      const GskShadowKey *b)
+{
+  return a->blur_radius == b->blur_radius &&
+         gdk_rgba_equal (&a->color, &b->color) &&
+         gsk_rounded_rect_equal (&a->outline, &b->outline);
+}
@@ -0,0 +1,28 @@
+#ifndef __GSK_SHADOW_KEY_PRIVATE_H__
+#define __GSK_SHADOW_KEY_PRIVATE_H__
+
+#include "gskroundedrect.h"
+
+#include <gdk/gdk.h>
+
+G_BEGIN_DECLS
+
+/* Everything that determines the pixels of a blurred shadow texture.
+ * The outline is the minimal one we draw into the texture, so it
+ * already includes the spread and does not depend on the size or
+ * position of the box casting the shadow. Renderers that cache
+ * shadow textures key them with this. */
+typedef struct
+{
+  GskRoundedRect outline;
+  float blur_radius;
+  GdkRGBA color;
+} GskShadowKey;
+
+guint                   gsk_shadow_key_hash                     (const GskShadowKey       *key);
+gboolean                gsk_shadow_key_equal                    (const GskShadowKey       *a,
+                                                                 const GskShadowKey       *b);
+
+G_END_DECLS
+
+#endif /* __GSK_SHADOW_KEY_PRIVATE_H__ */
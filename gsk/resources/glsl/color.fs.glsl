@@ -1,7 +1,5 @@
-uniform vec4 u_color;
-
 void main() {
-  vec4 color = u_color;
+  vec4 color = vColor;
 
   // Pre-multiply alpha
   color.rgb *= color.a;
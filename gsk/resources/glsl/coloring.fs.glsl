@@ -1,14 +1,12 @@
-uniform vec4 u_color;
-
 void main() {
   vec4 diffuse = Texture(u_source, vUv);
-  vec4 color = u_color;
+  vec4 color = vColor;
 
   // pre-multiply
   color.rgb *= color.a;
 
   // u_source is drawn using cairo, so already pre-multiplied.
-  color = vec4(u_color.rgb * diffuse.a * u_alpha, diffuse.a * color.a * u_alpha);
+  color = vec4(vColor.rgb * diffuse.a * u_alpha, diffuse.a * color.a * u_alpha);
 
   setOutputColor(color);
 }
@@ -14,6 +14,7 @@ uniform vec4 u_clip_corner_widths;
 uniform vec4 u_clip_corner_heights;
 
 varying vec2 vUv;
+varying vec4 vColor;
 
 
 struct RoundedRect
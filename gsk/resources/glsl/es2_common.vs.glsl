@@ -5,5 +5,7 @@ uniform mat4 u_modelview;
 
 attribute vec2 aPosition;
 attribute vec2 aUv;
+attribute vec4 aColor;
 
 varying vec2 vUv;
+varying vec4 vColor;
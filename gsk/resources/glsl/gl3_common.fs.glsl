@@ -14,6 +14,7 @@ uniform vec4 u_clip_corner_widths  = vec4(0, 0, 0, 0);
 uniform vec4 u_clip_corner_heights = vec4(0, 0, 0, 0);
 
 in vec2 vUv;
+in vec4 vColor;
 
 out vec4 outputColor;
 
@@ -3,5 +3,7 @@ uniform mat4 u_modelview;
 
 in vec2 aPosition;
 in vec2 aUv;
+in vec4 aColor;
 
 out vec2 vUv;
+out vec4 vColor;
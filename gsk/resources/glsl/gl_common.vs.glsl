@@ -2,5 +2,7 @@ uniform mat4 uMVP;
 
 attribute vec2 aPosition;
 attribute vec2 aUv;
+attribute vec4 aColor;
 
 varying vec2 vUv;
+varying vec4 vColor;
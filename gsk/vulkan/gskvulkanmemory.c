@@ -3,52 +3,351 @@
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanmemoryprivate.h"
 
-struct _GskVulkanMemory
-{
-  GdkVulkanContext *vulkan;
+#include <string.h>
 
-  gsize size;
+/* Device memory is allocated in large blocks per memory type and
+ * handed out in pieces, as drivers limit the number of allocations
+ * and vkAllocateMemory() is slow. Buffers and linear images live in
+ * different pools than optimal images, so we never need to care
+ * about bufferImageGranularity.
+ */
+#define BLOCK_SIZE (16 * 1024 * 1024)
+#define DEDICATED_SIZE (BLOCK_SIZE / 2)
+#define N_POOLS (VK_MAX_MEMORY_TYPES * 2)
 
+typedef struct _GskVulkanRange GskVulkanRange;
+typedef struct _GskVulkanBlock GskVulkanBlock;
+
+struct _GskVulkanRange
+{
+  VkDeviceSize offset;
+  VkDeviceSize size;
+};
+
+struct _GskVulkanBlock
+{
   VkDeviceMemory vk_memory;
+  VkDeviceSize size;
+  VkDeviceSize used;
+  guint n_allocations;
+  guint pool;
+  gboolean dedicated;
+
+  /* sorted by offset, adjacent ranges are always merged */
+  GArray *free_ranges;
+
+  guchar *map;
 };
 
-GskVulkanMemory *
-gsk_vulkan_memory_new (GdkVulkanContext      *context,
-                       uint32_t               allowed_types,
-                       VkMemoryPropertyFlags  flags,
-                       gsize                  size)
+struct _GskVulkanAllocator
 {
+  int ref_count;
+
+  GdkVulkanContext *vulkan;
+
   VkPhysicalDeviceMemoryProperties properties;
-  GskVulkanMemory *self;
-  uint32_t i;
 
-  self = g_slice_new0 (GskVulkanMemory);
+  GPtrArray *pools[N_POOLS];
+};
+
+struct _GskVulkanMemory
+{
+  GskVulkanAllocator *allocator;
+  GskVulkanBlock *block;
+
+  VkDeviceSize offset;
+  VkDeviceSize size;
+};
+
+static GQuark allocator_quark;
+
+GskVulkanAllocator *
+gsk_vulkan_allocator_get (GdkVulkanContext *context)
+{
+  GskVulkanAllocator *self;
+
+  if (G_UNLIKELY (allocator_quark == 0))
+    allocator_quark = g_quark_from_static_string ("gsk-vulkan-allocator");
 
+  self = g_object_get_qdata (G_OBJECT (context), allocator_quark);
+  if (self)
+    return gsk_vulkan_allocator_ref (self);
+
+  self = g_slice_new0 (GskVulkanAllocator);
+  self->ref_count = 1;
   self->vulkan = g_object_ref (context);
-  self->size = size;
 
   vkGetPhysicalDeviceMemoryProperties (gdk_vulkan_context_get_physical_device (context),
-                                       &properties);
+                                       &self->properties);
+
+  /* The context keeps a pointer only, we remove it when the last
+   * memory is gone, so the context can go away.
+   */
+  g_object_set_qdata (G_OBJECT (context), allocator_quark, self);
+
+  return self;
+}
+
+GskVulkanAllocator *
+gsk_vulkan_allocator_ref (GskVulkanAllocator *self)
+{
+  self->ref_count++;
+
+  return self;
+}
+
+static void
+gsk_vulkan_block_free (GskVulkanAllocator *self,
+                       GskVulkanBlock     *block)
+{
+  VkDevice device = gdk_vulkan_context_get_device (self->vulkan);
+
+  if (block->map)
+    vkUnmapMemory (device, block->vk_memory);
+
+  vkFreeMemory (device, block->vk_memory, NULL);
+
+  g_array_unref (block->free_ranges);
+  g_slice_free (GskVulkanBlock, block);
+}
+
+void
+gsk_vulkan_allocator_unref (GskVulkanAllocator *self)
+{
+  guint i, j;
+
+  self->ref_count--;
+  if (self->ref_count > 0)
+    return;
+
+  for (i = 0; i < N_POOLS; i++)
+    {
+      if (self->pools[i] == NULL)
+        continue;
+
+      for (j = 0; j < self->pools[i]->len; j++)
+        gsk_vulkan_block_free (self, g_ptr_array_index (self->pools[i], j));
+      g_ptr_array_unref (self->pools[i]);
+    }
+
+  g_object_set_qdata (G_OBJECT (self->vulkan), allocator_quark, NULL);
+  g_object_unref (self->vulkan);
+
+  g_slice_free (GskVulkanAllocator, self);
+}
+
+void
+gsk_vulkan_allocator_get_stats (GskVulkanAllocator      *self,
+                                GskVulkanAllocatorStats *stats)
+{
+  VkDeviceSize largest_free = 0;
+  guint i, j, k;
+
+  memset (stats, 0, sizeof (GskVulkanAllocatorStats));
+
+  for (i = 0; i < N_POOLS; i++)
+    {
+      if (self->pools[i] == NULL)
+        continue;
+
+      for (j = 0; j < self->pools[i]->len; j++)
+        {
+          GskVulkanBlock *block = g_ptr_array_index (self->pools[i], j);
+
+          stats->n_blocks++;
+          stats->n_allocations += block->n_allocations;
+          stats->allocated += block->size;
+          stats->used += block->used;
+
+          for (k = 0; k < block->free_ranges->len; k++)
+            largest_free = MAX (largest_free, g_array_index (block->free_ranges, GskVulkanRange, k).size);
+        }
+    }
+
+  /* How much of the free memory can not be used for one big allocation */
+  if (stats->allocated > stats->used)
+    stats->fragmentation = 100 - 100 * largest_free / (stats->allocated - stats->used);
+}
 
-  for (i = 0; i < properties.memoryTypeCount; i++)
+static guint
+gsk_vulkan_allocator_find_pool (GskVulkanAllocator    *self,
+                                uint32_t               allowed_types,
+                                VkMemoryPropertyFlags  flags,
+                                gboolean               linear)
+{
+  uint32_t i;
+
+  for (i = 0; i < self->properties.memoryTypeCount; i++)
     {
       if (!(allowed_types & (1 << i)))
         continue;
 
-      if ((properties.memoryTypes[i].propertyFlags & flags) == flags)
+      if ((self->properties.memoryTypes[i].propertyFlags & flags) == flags)
         break;
-  }
+    }
+
+  g_assert (i < self->properties.memoryTypeCount);
+
+  return 2 * i + (linear ? 1 : 0);
+}
+
+static GskVulkanBlock *
+gsk_vulkan_allocator_add_block (GskVulkanAllocator *self,
+                                guint               pool,
+                                VkDeviceSize        size,
+                                gboolean            dedicated)
+{
+  GskVulkanBlock *block;
 
-  g_assert (i < properties.memoryTypeCount);
+  block = g_slice_new0 (GskVulkanBlock);
+  block->size = size;
+  block->pool = pool;
+  block->dedicated = dedicated;
+  block->free_ranges = g_array_new (FALSE, FALSE, sizeof (GskVulkanRange));
+  g_array_append_val (block->free_ranges, ((GskVulkanRange) { 0, size }));
 
-  GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (context),
+  GSK_VK_CHECK (vkAllocateMemory, gdk_vulkan_context_get_device (self->vulkan),
                                   &(VkMemoryAllocateInfo) {
                                       .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
                                       .allocationSize = size,
-                                      .memoryTypeIndex = i
+                                      .memoryTypeIndex = pool / 2
                                   },
                                   NULL,
-                                  &self->vk_memory);
+                                  &block->vk_memory);
+
+  if (self->pools[pool] == NULL)
+    self->pools[pool] = g_ptr_array_new ();
+  g_ptr_array_add (self->pools[pool], block);
+
+  return block;
+}
+
+static gboolean
+gsk_vulkan_block_alloc (GskVulkanBlock *block,
+                        VkDeviceSize    size,
+                        VkDeviceSize    alignment,
+                        VkDeviceSize   *offset)
+{
+  guint i;
+
+  for (i = 0; i < block->free_ranges->len; i++)
+    {
+      GskVulkanRange *range = &g_array_index (block->free_ranges, GskVulkanRange, i);
+      VkDeviceSize start, end;
+
+      start = (range->offset + alignment - 1) / alignment * alignment;
+      end = range->offset + range->size;
+      if (start + size > end)
+        continue;
+
+      if (start + size < end)
+        {
+          GskVulkanRange after = { start + size, end - start - size };
+
+          g_array_insert_val (block->free_ranges, i + 1, after);
+          range = &g_array_index (block->free_ranges, GskVulkanRange, i);
+        }
+
+      if (start > range->offset)
+        range->size = start - range->offset;
+      else
+        g_array_remove_index (block->free_ranges, i);
+
+      block->used += size;
+      block->n_allocations++;
+      *offset = start;
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+gsk_vulkan_block_release (GskVulkanBlock *block,
+                          VkDeviceSize    offset,
+                          VkDeviceSize    size)
+{
+  GskVulkanRange *prev, *next;
+  guint i;
+
+  for (i = 0; i < block->free_ranges->len; i++)
+    {
+      if (g_array_index (block->free_ranges, GskVulkanRange, i).offset > offset)
+        break;
+    }
+
+  prev = i > 0 ? &g_array_index (block->free_ranges, GskVulkanRange, i - 1) : NULL;
+  next = i < block->free_ranges->len ? &g_array_index (block->free_ranges, GskVulkanRange, i) : NULL;
+
+  if (prev && prev->offset + prev->size == offset)
+    {
+      prev->size += size;
+      if (next && offset + size == next->offset)
+        {
+          prev->size += next->size;
+          g_array_remove_index (block->free_ranges, i);
+        }
+    }
+  else if (next && offset + size == next->offset)
+    {
+      next->offset = offset;
+      next->size += size;
+    }
+  else
+    {
+      g_array_insert_val (block->free_ranges, i, ((GskVulkanRange) { offset, size }));
+    }
+
+  block->used -= size;
+  block->n_allocations--;
+}
+
+GskVulkanMemory *
+gsk_vulkan_memory_new (GdkVulkanContext           *context,
+                       const VkMemoryRequirements *requirements,
+                       VkMemoryPropertyFlags       flags,
+                       gboolean                    linear)
+{
+  GskVulkanAllocator *allocator;
+  GskVulkanMemory *self;
+  GPtrArray *blocks;
+  VkDeviceSize alignment;
+  guint pool, i;
+
+  allocator = gsk_vulkan_allocator_get (context);
+
+  self = g_slice_new0 (GskVulkanMemory);
+  self->allocator = allocator;
+  self->size = requirements->size;
+
+  pool = gsk_vulkan_allocator_find_pool (allocator, requirements->memoryTypeBits, flags, linear);
+  alignment = MAX (requirements->alignment, 1);
+
+  if (self->size > DEDICATED_SIZE)
+    {
+      self->block = gsk_vulkan_allocator_add_block (allocator, pool, self->size, TRUE);
+      gsk_vulkan_block_alloc (self->block, self->size, 1, &self->offset);
+      return self;
+    }
+
+  blocks = allocator->pools[pool];
+  for (i = 0; blocks && i < blocks->len; i++)
+    {
+      GskVulkanBlock *block = g_ptr_array_index (blocks, i);
+
+      if (block->dedicated || block->size - block->used < self->size)
+        continue;
+
+      if (gsk_vulkan_block_alloc (block, self->size, alignment, &self->offset))
+        {
+          self->block = block;
+          return self;
+        }
+    }
+
+  self->block = gsk_vulkan_allocator_add_block (allocator, pool, BLOCK_SIZE, FALSE);
+  gsk_vulkan_block_alloc (self->block, self->size, alignment, &self->offset);
 
   return self;
 }
@@ -56,11 +355,36 @@ gsk_vulkan_memory_new (GdkVulkanContext      *context,
 void
 gsk_vulkan_memory_free (GskVulkanMemory *self)
 {
-  vkFreeMemory (gdk_vulkan_context_get_device (self->vulkan),
-                self->vk_memory,
-                NULL);
+  GskVulkanAllocator *allocator = self->allocator;
+  GskVulkanBlock *block = self->block;
 
-  g_object_unref (self->vulkan);
+  gsk_vulkan_block_release (block, self->offset, self->size);
+
+  /* Keep one empty block around per pool, so that short-lived staging
+   * buffers don't cause an allocation every frame.
+   */
+  if (block->n_allocations == 0)
+    {
+      GPtrArray *blocks = allocator->pools[block->pool];
+      gboolean keep = !block->dedicated;
+      guint i;
+
+      for (i = 0; keep && i < blocks->len; i++)
+        {
+          GskVulkanBlock *other = g_ptr_array_index (blocks, i);
+
+          if (other != block && other->n_allocations == 0 && !other->dedicated)
+            keep = FALSE;
+        }
+
+      if (!keep)
+        {
+          g_ptr_array_remove_fast (blocks, block);
+          gsk_vulkan_block_free (allocator, block);
+        }
+    }
+
+  gsk_vulkan_allocator_unref (allocator);
 
   g_slice_free (GskVulkanMemory, self);
 }
@@ -68,28 +392,40 @@ gsk_vulkan_memory_free (GskVulkanMemory *self)
 VkDeviceMemory
 gsk_vulkan_memory_get_device_memory (GskVulkanMemory *self)
 {
-  return self->vk_memory;
+  return self->block->vk_memory;
+}
+
+VkDeviceSize
+gsk_vulkan_memory_get_offset (GskVulkanMemory *self)
+{
+  return self->offset;
 }
 
 guchar *
 gsk_vulkan_memory_map (GskVulkanMemory *self)
 {
-  void *data;
+  GskVulkanBlock *block = self->block;
+
+  /* Blocks stay mapped until they are freed, several memories in
+   * the same block may be mapped at the same time.
+   */
+  if (block->map == NULL)
+    {
+      void *data;
 
-  GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (self->vulkan),
-                             self->vk_memory,
-                             0,
-                             self->size,
-                             0,
-                             &data);
+      GSK_VK_CHECK (vkMapMemory, gdk_vulkan_context_get_device (self->allocator->vulkan),
+                                 block->vk_memory,
+                                 0,
+                                 VK_WHOLE_SIZE,
+                                 0,
+                                 &data);
+      block->map = data;
+    }
 
-  return data;
+  return block->map + self->offset;
 }
 
 void
 gsk_vulkan_memory_unmap (GskVulkanMemory *self)
 {
-  vkUnmapMemory (gdk_vulkan_context_get_device (self->vulkan),
-                 self->vk_memory);
 }
-
@@ -5,15 +5,34 @@
 
 G_BEGIN_DECLS
 
+typedef struct _GskVulkanAllocator GskVulkanAllocator;
+typedef struct _GskVulkanAllocatorStats GskVulkanAllocatorStats;
 typedef struct _GskVulkanMemory GskVulkanMemory;
 
+struct _GskVulkanAllocatorStats
+{
+  guint n_blocks;
+  guint n_allocations;
+  VkDeviceSize allocated;
+  VkDeviceSize used;
+  guint fragmentation; /* in percent of the unused memory */
+};
+
+GskVulkanAllocator *    gsk_vulkan_allocator_get                        (GdkVulkanContext       *context);
+GskVulkanAllocator *    gsk_vulkan_allocator_ref                        (GskVulkanAllocator     *self);
+void                    gsk_vulkan_allocator_unref                      (GskVulkanAllocator     *self);
+
+void                    gsk_vulkan_allocator_get_stats                  (GskVulkanAllocator     *self,
+                                                                         GskVulkanAllocatorStats *stats);
+
 GskVulkanMemory *       gsk_vulkan_memory_new                           (GdkVulkanContext       *context,
-                                                                         uint32_t                allowed_types,
+                                                                         const VkMemoryRequirements *requirements,
                                                                          VkMemoryPropertyFlags   properties,
-                                                                         gsize                   size);
+                                                                         gboolean                linear);
 void                    gsk_vulkan_memory_free                          (GskVulkanMemory        *memory);
 
 VkDeviceMemory          gsk_vulkan_memory_get_device_memory             (GskVulkanMemory        *self);
+VkDeviceSize            gsk_vulkan_memory_get_offset                    (GskVulkanMemory        *self);
 
 guchar *                gsk_vulkan_memory_map                           (GskVulkanMemory        *self);
 void                    gsk_vulkan_memory_unmap                         (GskVulkanMemory        *self);
@@ -26,6 +26,12 @@
 #define DESCRIPTOR_POOL_MAXSETS 128
 #define DESCRIPTOR_POOL_MAXSETS_INCREASE 128
 
+/* Vertex data of all render passes of a frame is packed into one
+ * buffer that is reused for the next frame once the fence signaled.
+ */
+#define VERTEX_BUFFER_MIN_SIZE (64 * 1024)
+#define VERTEX_DATA_ALIGNMENT 16
+
 struct _GskVulkanRender
 {
   GskRenderer *renderer;
@@ -58,6 +64,11 @@ struct _GskVulkanRender
   GList *render_passes;
   GSList *cleanup_images;
 
+  GskVulkanBuffer *vertex_buffer;
+  gsize vertex_buffer_size;
+  gsize vertex_buffer_offset;
+  GSList *retired_vertex_buffers;
+
   GQuark render_pass_counter;
   GQuark gpu_time_timer;
 };
@@ -575,6 +586,33 @@ gsk_vulkan_render_prepare_descriptor_sets (GskVulkanRender *self)
     }
 }
 
+GskVulkanBuffer *
+gsk_vulkan_render_get_vertex_buffer (GskVulkanRender *self,
+                                     gsize            n_bytes,
+                                     gsize           *offset)
+{
+  if (self->vertex_buffer == NULL ||
+      self->vertex_buffer_offset + n_bytes > self->vertex_buffer_size)
+    {
+      /* Earlier render passes of this frame still use the old buffer */
+      if (self->vertex_buffer)
+        self->retired_vertex_buffers = g_slist_prepend (self->retired_vertex_buffers,
+                                                        self->vertex_buffer);
+
+      self->vertex_buffer_size = MAX (VERTEX_BUFFER_MIN_SIZE, 2 * self->vertex_buffer_size);
+      while (self->vertex_buffer_size < n_bytes)
+        self->vertex_buffer_size *= 2;
+
+      self->vertex_buffer = gsk_vulkan_buffer_new (self->vulkan, self->vertex_buffer_size);
+      self->vertex_buffer_offset = 0;
+    }
+
+  *offset = self->vertex_buffer_offset;
+  self->vertex_buffer_offset += (n_bytes + VERTEX_DATA_ALIGNMENT - 1) & ~(VERTEX_DATA_ALIGNMENT - 1);
+
+  return self->vertex_buffer;
+}
+
 void
 gsk_vulkan_render_draw (GskVulkanRender *self)
 {
@@ -669,6 +707,10 @@ gsk_vulkan_render_cleanup (GskVulkanRender *self)
   g_slist_free_full (self->cleanup_images, g_object_unref);
   self->cleanup_images = NULL;
 
+  g_slist_free_full (self->retired_vertex_buffers, (GDestroyNotify) gsk_vulkan_buffer_free);
+  self->retired_vertex_buffers = NULL;
+  self->vertex_buffer_offset = 0;
+
   g_clear_pointer (&self->clip, cairo_region_destroy);
   g_clear_object (&self->target);
 }
@@ -703,6 +745,7 @@ gsk_vulkan_render_free (GskVulkanRender *self)
     g_clear_object (&self->pipelines[i]);
 
   g_clear_pointer (&self->uploader, gsk_vulkan_uploader_free);
+  g_clear_pointer (&self->vertex_buffer, gsk_vulkan_buffer_free);
 
   for (i = 0; i < 3; i++)
     vkDestroyPipelineLayout (device,
@@ -8,6 +8,7 @@
 #include "gskrendernodeprivate.h"
 #include "gskvulkanbufferprivate.h"
 #include "gskvulkanimageprivate.h"
+#include "gskvulkanmemoryprivate.h"
 #include "gskvulkanpipelineprivate.h"
 #include "gskvulkanrenderprivate.h"
 #include "gskvulkanglyphcacheprivate.h"
@@ -30,6 +31,10 @@ typedef struct {
   GQuark render_passes;
   GQuark fallback_pixels;
   GQuark texture_pixels;
+  GQuark memory_blocks;
+  GQuark memory_allocations;
+  GQuark memory_allocated;
+  GQuark memory_fragmentation;
 } ProfileCounters;
 
 typedef struct {
@@ -48,6 +53,7 @@ struct _GskVulkanRenderer
   GskVulkanImage **targets;
 
   GskVulkanRender *render;
+  GskVulkanAllocator *allocator;
 
   GSList *textures;
 
@@ -125,6 +131,7 @@ gsk_vulkan_renderer_realize (GskRenderer  *renderer,
                     self);
   gsk_vulkan_renderer_update_images_cb (self->vulkan, self);
 
+  self->allocator = gsk_vulkan_allocator_get (self->vulkan);
   self->render = gsk_vulkan_render_new (renderer, self->vulkan);
 
   self->glyph_cache = gsk_vulkan_glyph_cache_new (renderer, self->vulkan);
@@ -150,6 +157,7 @@ gsk_vulkan_renderer_unrealize (GskRenderer *renderer)
   g_clear_pointer (&self->textures, (GDestroyNotify) g_slist_free);
 
   g_clear_pointer (&self->render, gsk_vulkan_render_free);
+  g_clear_pointer (&self->allocator, gsk_vulkan_allocator_unref);
 
   gsk_vulkan_renderer_free_targets (self);
   g_signal_handlers_disconnect_by_func(self->vulkan,
@@ -159,6 +167,22 @@ gsk_vulkan_renderer_unrealize (GskRenderer *renderer)
   g_clear_object (&self->vulkan);
 }
 
+#ifdef G_ENABLE_DEBUG
+static void
+gsk_vulkan_renderer_update_memory_counters (GskVulkanRenderer *self,
+                                            GskProfiler       *profiler)
+{
+  GskVulkanAllocatorStats stats;
+
+  gsk_vulkan_allocator_get_stats (self->allocator, &stats);
+
+  gsk_profiler_counter_set (profiler, self->profile_counters.memory_blocks, stats.n_blocks);
+  gsk_profiler_counter_set (profiler, self->profile_counters.memory_allocations, stats.n_allocations);
+  gsk_profiler_counter_set (profiler, self->profile_counters.memory_allocated, stats.allocated / 1024);
+  gsk_profiler_counter_set (profiler, self->profile_counters.memory_fragmentation, stats.fragmentation);
+}
+#endif
+
 static GdkTexture *
 gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
                                     GskRenderNode         *root,
@@ -204,6 +228,8 @@ gsk_vulkan_renderer_render_texture (GskRenderer           *renderer,
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
   gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
 
+  gsk_vulkan_renderer_update_memory_counters (self, profiler);
+
   gsk_profiler_push_samples (profiler);
 #endif
 
@@ -245,6 +271,8 @@ gsk_vulkan_renderer_render (GskRenderer   *renderer,
   cpu_time = gsk_profiler_timer_end (profiler, self->profile_timers.cpu_time);
   gsk_profiler_timer_set (profiler, self->profile_timers.cpu_time, cpu_time);
 
+  gsk_vulkan_renderer_update_memory_counters (self, profiler);
+
   gsk_profiler_push_samples (profiler);
 #endif
 }
@@ -289,6 +317,10 @@ gsk_vulkan_renderer_init (GskVulkanRenderer *self)
   self->profile_counters.render_passes = gsk_profiler_add_counter (profiler, "render-passes", "Render passes", FALSE);
   self->profile_counters.fallback_pixels = gsk_profiler_add_counter (profiler, "fallback-pixels", "Fallback pixels", TRUE);
   self->profile_counters.texture_pixels = gsk_profiler_add_counter (profiler, "texture-pixels", "Texture pixels", TRUE);
+  self->profile_counters.memory_blocks = gsk_profiler_add_counter (profiler, "memory-blocks", "Device memory blocks", FALSE);
+  self->profile_counters.memory_allocations = gsk_profiler_add_counter (profiler, "memory-allocations", "Device memory allocations", FALSE);
+  self->profile_counters.memory_allocated = gsk_profiler_add_counter (profiler, "memory-allocated", "Device memory (kB)", FALSE);
+  self->profile_counters.memory_fragmentation = gsk_profiler_add_counter (profiler, "memory-fragmentation", "Unusable free memory (%)", FALSE);
 
   self->profile_timers.cpu_time = gsk_profiler_add_timer (profiler, "cpu-time", "CPU time", FALSE, TRUE);
   if (GSK_RENDERER_DEBUG_CHECK (GSK_RENDERER (self), SYNC))
@@ -124,7 +124,7 @@ struct _GskVulkanRenderPass
   VkRenderPass render_pass;
   VkSemaphore signal_semaphore;
   GArray *wait_semaphores;
-  GskVulkanBuffer *vertex_data;
+  GskVulkanBuffer *vertex_data; /* owned by the GskVulkanRender */
 
   GQuark fallback_pixels;
   GQuark texture_pixels;
@@ -224,8 +224,6 @@ gsk_vulkan_render_pass_free (GskVulkanRenderPass *self)
   vkDestroyRenderPass (gdk_vulkan_context_get_device (self->vulkan),
                        self->render_pass,
                        NULL);
-  if (self->vertex_data)
-    gsk_vulkan_buffer_free (self->vertex_data);
   if (self->signal_semaphore != VK_NULL_HANDLE)
     vkDestroySemaphore (gdk_vulkan_context_get_device (self->vulkan),
                         self->signal_semaphore,
@@ -1419,13 +1417,13 @@ gsk_vulkan_render_pass_get_vertex_data (GskVulkanRenderPass *self,
 {
   if (self->vertex_data == NULL)
     {
-      gsize n_bytes;
+      gsize n_bytes, offset;
       guchar *data;
 
       n_bytes = gsk_vulkan_render_pass_count_vertex_data (self);
-      self->vertex_data = gsk_vulkan_buffer_new (self->vulkan, n_bytes);
+      self->vertex_data = gsk_vulkan_render_get_vertex_buffer (render, n_bytes, &offset);
       data = gsk_vulkan_buffer_map (self->vertex_data);
-      gsk_vulkan_render_pass_collect_vertex_data (self, render, data, 0, n_bytes);
+      gsk_vulkan_render_pass_collect_vertex_data (self, render, data, offset, offset + n_bytes);
       gsk_vulkan_buffer_unmap (self->vertex_data);
     }
 
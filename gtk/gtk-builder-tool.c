@@ -1048,6 +1048,367 @@ do_preview (int          *argc,
   g_free (css);
 }
 
+typedef struct {
+  GtkBuilder *builder;
+  GVariantBuilder events;
+  GArray *types;          /* type of each open <object> or <template> */
+  GParamSpec *pspec;      /* of the current <property>, if its value can be canonicalized */
+  GString *text;          /* of the current <property> */
+  GString *fragment;      /* XML of the current custom element */
+  gint fragment_depth;
+  gint fragment_line;
+  const gchar *fragment_parent;
+} CompileData;
+
+static gboolean
+is_core_element (const gchar *element_name)
+{
+  const gchar *core[] = {
+    "interface", "requires", "object", "template",
+    "child", "property", "signal", "placeholder", NULL
+  };
+
+  return g_strv_contains (core, element_name);
+}
+
+static void
+compile_add_event (CompileData          *data,
+                   GMarkupParseContext  *context,
+                   guchar                kind,
+                   const gchar          *name,
+                   const gchar          *text,
+                   const gchar         **names,
+                   const gchar         **values)
+{
+  const gchar *none[] = { NULL };
+  gint line, col;
+
+  g_markup_parse_context_get_position (context, &line, &col);
+  g_variant_builder_add (&data->events, "(yiiss^as^as)",
+                         kind, line, col, name, text,
+                         names ? names : none,
+                         values ? values : none);
+}
+
+static GType
+compile_lookup_type (CompileData  *data,
+                     const gchar  *element_name,
+                     const gchar **names,
+                     const gchar **values)
+{
+  GType type = G_TYPE_INVALID;
+  gint i;
+
+  for (i = 0; names[i]; i++)
+    {
+      if (strcmp (names[i], "class") == 0)
+        type = g_type_from_name (values[i]);
+    }
+
+  /* Templates are usually for types that only exist in the
+   * application, fall back to the parent type */
+  for (i = 0; type == G_TYPE_INVALID && names[i]; i++)
+    {
+      if (strcmp (element_name, "template") == 0 && strcmp (names[i], "parent") == 0)
+        type = g_type_from_name (values[i]);
+    }
+
+  return type;
+}
+
+static GParamSpec *
+compile_lookup_pspec (CompileData  *data,
+                      const gchar **names,
+                      const gchar **values)
+{
+  const gchar *name = NULL;
+  GObjectClass *class;
+  GParamSpec *pspec;
+  GType type, value_type;
+  gint i;
+
+  if (data->types->len == 0)
+    return NULL;
+
+  type = g_array_index (data->types, GType, data->types->len - 1);
+  if (type == G_TYPE_INVALID)
+    return NULL;
+
+  for (i = 0; names[i]; i++)
+    {
+      if (strcmp (names[i], "name") == 0)
+        name = values[i];
+      else if (strcmp (names[i], "translatable") == 0 ||
+               g_str_has_prefix (names[i], "bind-"))
+        return NULL;
+    }
+
+  if (name == NULL)
+    return NULL;
+
+  class = g_type_class_ref (type);
+  pspec = g_object_class_find_property (class, name);
+  g_type_class_unref (class);
+
+  if (pspec == NULL)
+    return NULL;
+
+  value_type = G_PARAM_SPEC_VALUE_TYPE (pspec);
+  if (!G_TYPE_IS_ENUM (value_type) &&
+      !G_TYPE_IS_FLAGS (value_type) &&
+      value_type != G_TYPE_BOOLEAN)
+    return NULL;
+
+  return pspec;
+}
+
+/* Replaces enum, flags and boolean values by numbers, which the
+ * loader can parse without looking up names
+ */
+static void
+compile_canonicalize_value (CompileData *data)
+{
+  GValue value = G_VALUE_INIT;
+  GType type;
+
+  if (data->pspec == NULL)
+    return;
+
+  type = G_PARAM_SPEC_VALUE_TYPE (data->pspec);
+  if (!gtk_builder_value_from_string_type (data->builder, type, data->text->str, &value, NULL))
+    return;
+
+  if (G_TYPE_IS_ENUM (type))
+    g_string_printf (data->text, "%d", g_value_get_enum (&value));
+  else if (G_TYPE_IS_FLAGS (type))
+    g_string_printf (data->text, "%u", g_value_get_flags (&value));
+  else
+    g_string_assign (data->text, g_value_get_boolean (&value) ? "1" : "0");
+
+  g_value_unset (&value);
+}
+
+static void
+compile_start_element (GMarkupParseContext  *context,
+                       const gchar          *element_name,
+                       const gchar         **names,
+                       const gchar         **values,
+                       gpointer              user_data,
+                       GError              **error)
+{
+  CompileData *data = user_data;
+  gint i;
+
+  if (data->fragment == NULL && !is_core_element (element_name))
+    {
+      const GSList *stack = g_markup_parse_context_get_element_stack (context);
+
+      data->fragment = g_string_new (NULL);
+      data->fragment_depth = 0;
+      data->fragment_parent = stack->next ? stack->next->data : "interface";
+      g_markup_parse_context_get_position (context, &data->fragment_line, NULL);
+    }
+
+  if (data->fragment)
+    {
+      g_string_append_printf (data->fragment, "<%s", element_name);
+      for (i = 0; names[i]; i++)
+        {
+          gchar *escaped = g_markup_escape_text (values[i], -1);
+          g_string_append_printf (data->fragment, " %s=\"%s\"", names[i], escaped);
+          g_free (escaped);
+        }
+      g_string_append_c (data->fragment, '>');
+      data->fragment_depth++;
+      return;
+    }
+
+  if (strcmp (element_name, "object") == 0 ||
+      strcmp (element_name, "template") == 0)
+    {
+      GType type = compile_lookup_type (data, element_name, names, values);
+      g_array_append_val (data->types, type);
+    }
+  else if (strcmp (element_name, "property") == 0)
+    {
+      data->pspec = compile_lookup_pspec (data, names, values);
+      data->text = g_string_new (NULL);
+    }
+
+  compile_add_event (data, context, GTK_BUILDER_COMPILED_START, element_name, "", names, values);
+}
+
+static void
+compile_end_element (GMarkupParseContext  *context,
+                     const gchar          *element_name,
+                     gpointer              user_data,
+                     GError              **error)
+{
+  CompileData *data = user_data;
+
+  if (data->fragment)
+    {
+      g_string_append_printf (data->fragment, "</%s>", element_name);
+      data->fragment_depth--;
+      if (data->fragment_depth == 0)
+        {
+          const gchar *none[] = { NULL };
+
+          g_variant_builder_add (&data->events, "(yiiss^as^as)",
+                                 GTK_BUILDER_COMPILED_FRAGMENT,
+                                 data->fragment_line, 0,
+                                 data->fragment_parent,
+                                 data->fragment->str,
+                                 none, none);
+          g_string_free (data->fragment, TRUE);
+          data->fragment = NULL;
+        }
+      return;
+    }
+
+  if (strcmp (element_name, "object") == 0 ||
+      strcmp (element_name, "template") == 0)
+    {
+      g_array_set_size (data->types, data->types->len - 1);
+    }
+  else if (strcmp (element_name, "property") == 0)
+    {
+      compile_canonicalize_value (data);
+      if (data->text->len > 0)
+        compile_add_event (data, context, GTK_BUILDER_COMPILED_TEXT, "", data->text->str, NULL, NULL);
+      g_string_free (data->text, TRUE);
+      data->text = NULL;
+      data->pspec = NULL;
+    }
+
+  compile_add_event (data, context, GTK_BUILDER_COMPILED_END, element_name, "", NULL, NULL);
+}
+
+static void
+compile_text (GMarkupParseContext  *context,
+              const gchar          *text,
+              gsize                 text_len,
+              gpointer              user_data,
+              GError              **error)
+{
+  CompileData *data = user_data;
+
+  if (data->fragment)
+    {
+      gchar *escaped = g_markup_escape_text (text, text_len);
+      g_string_append (data->fragment, escaped);
+      g_free (escaped);
+    }
+  else if (data->text)
+    g_string_append_len (data->text, text, text_len);
+}
+
+static GMarkupParser compile_parser = {
+  compile_start_element,
+  compile_end_element,
+  compile_text,
+  NULL,
+  NULL
+};
+
+static void
+do_compile (int          *argc,
+            const char ***argv)
+{
+  GMarkupParseContext *context;
+  GOptionContext *ctx;
+  CompileData data = { NULL, };
+  GVariant *compiled;
+  gchar *buffer;
+  gsize length;
+  char *output = NULL;
+  char **filenames = NULL;
+  const GOptionEntry entries[] = {
+    { "output", 0, 0, G_OPTION_ARG_FILENAME, &output, NULL, NULL },
+    { G_OPTION_REMAINING, 0, 0, G_OPTION_ARG_FILENAME_ARRAY, &filenames, NULL, NULL },
+    { NULL, }
+  };
+  GError *error = NULL;
+
+  ctx = g_option_context_new (NULL);
+  g_option_context_set_help_enabled (ctx, FALSE);
+  g_option_context_add_main_entries (ctx, entries, NULL);
+
+  if (!g_option_context_parse (ctx, argc, (char ***)argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+      exit (1);
+    }
+
+  g_option_context_free (ctx);
+
+  if (filenames == NULL)
+    {
+      g_printerr ("No .ui file specified\n");
+      exit (1);
+    }
+
+  if (g_strv_length (filenames) > 1)
+    {
+      g_printerr ("Can only compile a single .ui file\n");
+      exit (1);
+    }
+
+  if (!g_file_get_contents (filenames[0], &buffer, &length, &error))
+    {
+      g_printerr (_("Can’t load file: %s\n"), error->message);
+      exit (1);
+    }
+
+  data.builder = gtk_builder_new ();
+  data.types = g_array_new (FALSE, FALSE, sizeof (GType));
+  g_variant_builder_init (&data.events, G_VARIANT_TYPE ("a(yiissasas)"));
+
+  context = g_markup_parse_context_new (&compile_parser, G_MARKUP_TREAT_CDATA_AS_TEXT, &data, NULL);
+  if (!g_markup_parse_context_parse (context, buffer, length, &error) ||
+      !g_markup_parse_context_end_parse (context, &error))
+    {
+      g_printerr (_("Can’t parse file: %s\n"), error->message);
+      exit (1);
+    }
+  g_markup_parse_context_free (context);
+
+  compiled = g_variant_ref_sink (g_variant_new (GTK_BUILDER_COMPILED_FORMAT,
+                                                GTK_BUILDER_COMPILED_MAGIC,
+                                                GTK_BUILDER_COMPILED_VERSION,
+                                                &data.events));
+
+  /* Compiled files are always little endian */
+  if (G_BYTE_ORDER == G_BIG_ENDIAN)
+    {
+      GVariant *swapped = g_variant_take_ref (g_variant_byteswap (compiled));
+
+      g_variant_unref (compiled);
+      compiled = swapped;
+    }
+
+  if (output)
+    {
+      if (!g_file_set_contents (output, g_variant_get_data (compiled), g_variant_get_size (compiled), &error))
+        {
+          g_printerr ("Failed to write %s: %s\n", output, error->message);
+          exit (1);
+        }
+    }
+  else
+    {
+      fwrite (g_variant_get_data (compiled), 1, g_variant_get_size (compiled), stdout);
+    }
+
+  g_variant_unref (compiled);
+  g_array_unref (data.types);
+  g_object_unref (data.builder);
+  g_free (buffer);
+  g_free (output);
+  g_strfreev (filenames);
+}
+
 static void
 usage (void)
 {
@@ -1059,6 +1420,7 @@ usage (void)
              "  simplify [OPTIONS] Simplify the file\n"
              "  enumerate          List all named objects\n"
              "  preview [OPTIONS]  Preview the file\n"
+             "  compile [OPTIONS]  Write the compiled form of the file\n"
              "\n"
              "Simplify Options:\n"
              "  --replace          Replace the file\n"
@@ -1067,6 +1429,9 @@ usage (void)
              "  --id=ID            Preview only the named object\n"
              "  --css=FILE         Use style from CSS file\n"
              "\n"
+             "Compile Options:\n"
+             "  --output=FILE      Write to FILE instead of stdout\n"
+             "\n"
              "Perform various tasks on GtkBuilder .ui files.\n"));
   exit (1);
 }
@@ -1097,6 +1462,8 @@ main (int argc, const char *argv[])
     do_enumerate (argv[1]);
   else if (strcmp (argv[0], "preview") == 0)
     do_preview (&argc, &argv);
+  else if (strcmp (argv[0], "compile") == 0)
+    do_compile (&argc, &argv);
   else
     usage ();
 
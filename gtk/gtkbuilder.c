@@ -163,6 +163,13 @@
  * The possible values for the “type” attribute are described in the
  * sections describing the widget-specific portions of UI definitions.
  *
+ * UI definitions that are loaded often can be compiled with
+ * `gtk4-builder-tool compile`. All functions that load UI definitions
+ * from files, resources or strings with an explicit length also accept
+ * the compiled form, which loads faster as most of the XML parsing is
+ * done ahead of time. The .ui file stays the source, compiled files
+ * should be regenerated from it as part of the build.
+ *
  * # A GtkBuilder UI Definition
  *
  * |[
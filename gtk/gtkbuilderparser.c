@@ -75,6 +75,31 @@ state_pop (ParserData *data)
 #define state_peek_info(data, st) ((st*)state_peek(data))
 #define state_pop_info(data, st) ((st*)state_pop(data))
 
+static void
+get_position (ParserData *data,
+              gint       *line,
+              gint       *col)
+{
+  if (data->compiled)
+    {
+      *line = data->line;
+      if (col)
+        *col = data->col;
+    }
+  else
+    g_markup_parse_context_get_position (data->ctx, line, col);
+}
+
+static void
+prefix_error (ParserData  *data,
+              GError     **error)
+{
+  if (data->compiled)
+    g_prefix_error (error, "%s:%d:%d ", data->filename, data->line, data->col);
+  else
+    _gtk_builder_prefix_error (data->builder, data->ctx, error);
+}
+
 static void
 error_missing_attribute (ParserData   *data,
                          const gchar  *tag,
@@ -83,7 +108,7 @@ error_missing_attribute (ParserData   *data,
 {
   gint line, col;
 
-  g_markup_parse_context_get_position (data->ctx, &line, &col);
+  get_position (data, &line, &col);
 
   g_set_error (error,
                GTK_BUILDER_ERROR,
@@ -100,7 +125,7 @@ error_invalid_tag (ParserData   *data,
 {
   gint line, col;
 
-  g_markup_parse_context_get_position (data->ctx, &line, &col);
+  get_position (data, &line, &col);
 
   if (expected)
     g_set_error (error,
@@ -123,7 +148,7 @@ error_unhandled_tag (ParserData   *data,
 {
   gint line, col;
 
-  g_markup_parse_context_get_position (data->ctx, &line, &col);
+  get_position (data, &line, &col);
   g_set_error (error,
                GTK_BUILDER_ERROR,
                GTK_BUILDER_ERROR_UNHANDLED_TAG,
@@ -203,7 +228,7 @@ parse_requires (ParserData   *data,
                                     G_MARKUP_COLLECT_STRING, "version", &version,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -213,7 +238,7 @@ parse_requires (ParserData   *data,
                    GTK_BUILDER_ERROR,
                    GTK_BUILDER_ERROR_INVALID_VALUE,
                    "'version' attribute has malformed value '%s'", version);
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
   version_major = g_ascii_strtoll (split[0], NULL, 10);
@@ -281,7 +306,7 @@ parse_object (GMarkupParseContext  *context,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "id", &object_id,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -303,7 +328,7 @@ parse_object (GMarkupParseContext  *context,
                        GTK_BUILDER_ERROR,
                        GTK_BUILDER_ERROR_INVALID_TYPE_FUNCTION,
                        "Invalid type function '%s'", type_func);
-          _gtk_builder_prefix_error (data->builder, context, error);
+          prefix_error (data, error);
           return;
         }
     }
@@ -318,7 +343,7 @@ parse_object (GMarkupParseContext  *context,
                        GTK_BUILDER_ERROR,
                        GTK_BUILDER_ERROR_INVALID_VALUE,
                        "Invalid object type '%s'", object_class);
-          _gtk_builder_prefix_error (data->builder, context, error);
+          prefix_error (data, error);
           return;
        }
     }
@@ -368,11 +393,11 @@ parse_object (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR_DUPLICATE_ID,
                    "Duplicate object ID '%s' (previously on line %d)",
                    object_id, line);
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
       return;
     }
 
-  g_markup_parse_context_get_position (context, &line, NULL);
+  get_position (data, &line, NULL);
   g_hash_table_insert (data->object_ids, g_strdup (object_id), GINT_TO_POINTER (line));
 }
 
@@ -398,7 +423,7 @@ parse_template (GMarkupParseContext  *context,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "parent", &parent_class,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -409,7 +434,7 @@ parse_template (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR_UNHANDLED_TAG,
                    "Not expecting to handle a template (class '%s', parent '%s')",
                    object_class, parent_class ? parent_class : "GtkWidget");
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
       return;
     }
   else if (state_peek (data) != NULL)
@@ -426,7 +451,7 @@ parse_template (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR_TEMPLATE_MISMATCH,
                    "Parsed template definition for type '%s', expected type '%s'",
                    object_class, g_type_name (template_type));
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -440,7 +465,7 @@ parse_template (GMarkupParseContext  *context,
           g_set_error (error, GTK_BUILDER_ERROR,
                        GTK_BUILDER_ERROR_INVALID_VALUE,
                        "Invalid template parent type '%s'", parent_class);
-          _gtk_builder_prefix_error (data->builder, context, error);
+          prefix_error (data, error);
           return;
         }
       if (parent_type != expected_type)
@@ -449,7 +474,7 @@ parse_template (GMarkupParseContext  *context,
                        GTK_BUILDER_ERROR_TEMPLATE_MISMATCH,
                        "Template parent type '%s' does not match instance parent type '%s'.",
                        parent_class, g_type_name (expected_type));
-          _gtk_builder_prefix_error (data->builder, context, error);
+          prefix_error (data, error);
           return;
         }
     }
@@ -472,11 +497,11 @@ parse_template (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR_DUPLICATE_ID,
                    "Duplicate object ID '%s' (previously on line %d)",
                    object_class, line);
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
       return;
     }
 
-  g_markup_parse_context_get_position (context, &line, NULL);
+  get_position (data, &line, NULL);
   g_hash_table_insert (data->object_ids, g_strdup (object_class), GINT_TO_POINTER (line));
 }
 
@@ -520,7 +545,7 @@ parse_child (ParserData   *data,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "internal-child", &internal_child,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -580,7 +605,7 @@ parse_property (ParserData   *data,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "bind-flags", &bind_flags_str,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -593,7 +618,7 @@ parse_property (ParserData   *data,
                    GTK_BUILDER_ERROR_INVALID_PROPERTY,
                    "Invalid property: %s.%s",
                    g_type_name (object_info->type), name);
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -601,12 +626,12 @@ parse_property (ParserData   *data,
     {
       if (!_gtk_builder_flags_from_string (G_TYPE_BINDING_FLAGS, NULL, bind_flags_str, &bind_flags, error))
         {
-          _gtk_builder_prefix_error (data->builder, data->ctx, error);
+          prefix_error (data, error);
           return;
         }
     }
 
-  g_markup_parse_context_get_position (data->ctx, &line, &col);
+  get_position (data, &line, &col);
 
   if (bind_source && bind_property)
     {
@@ -687,7 +712,7 @@ parse_signal (ParserData   *data,
                                     G_MARKUP_COLLECT_TRISTATE|G_MARKUP_COLLECT_OPTIONAL, "swapped", &swapped,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -698,7 +723,7 @@ parse_signal (ParserData   *data,
                    GTK_BUILDER_ERROR_INVALID_SIGNAL,
                    "Invalid signal '%s' for type '%s'",
                    name, g_type_name (object_info->type));
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -757,7 +782,7 @@ parse_interface (ParserData   *data,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "domain", &domain,
                                     G_MARKUP_COLLECT_INVALID))
     {
-      _gtk_builder_prefix_error (data->builder, data->ctx, error);
+      prefix_error (data, error);
       return;
     }
 
@@ -1132,7 +1157,7 @@ end_element (GMarkupParseContext  *context,
                            req_info->library,
                            req_info->major, req_info->minor,
                            GTK_MAJOR_VERSION, GTK_MINOR_VERSION);
-              _gtk_builder_prefix_error (data->builder, context, error);
+              prefix_error (data, error);
            }
         }
       free_requires_info (req_info, NULL);
@@ -1153,10 +1178,26 @@ end_element (GMarkupParseContext  *context,
                    GTK_BUILDER_ERROR,
                    GTK_BUILDER_ERROR_UNHANDLED_TAG,
                    "Unhandled tag: <%s>", element_name);
-      _gtk_builder_prefix_error (data->builder, context, error);
+      prefix_error (data, error);
     }
 }
 
+static void
+append_property_text (ParserData  *data,
+                      const gchar *text,
+                      gsize        text_len)
+{
+  PropertyInfo *prop_info;
+
+  if (!data->stack)
+    return;
+
+  prop_info = state_peek_info (data, PropertyInfo);
+  g_assert (prop_info != NULL);
+
+  g_string_append_len (prop_info->text, text, text_len);
+}
+
 /* Called for character data */
 /* text is not nul-terminated */
 static void
@@ -1167,7 +1208,6 @@ text (GMarkupParseContext  *context,
       GError              **error)
 {
   ParserData *data = (ParserData*)user_data;
-  CommonInfo *info;
 
   if (data->subparser && data->subparser->start)
     {
@@ -1181,18 +1221,8 @@ text (GMarkupParseContext  *context,
       return;
     }
 
-  if (!data->stack)
-    return;
-
-  info = state_peek_info (data, CommonInfo);
-  g_assert (info != NULL);
-
   if (strcmp (g_markup_parse_context_get_element (context), "property") == 0)
-    {
-      PropertyInfo *prop_info = (PropertyInfo*)info;
-
-      g_string_append_len (prop_info->text, text, text_len);
-    }
+    append_property_text (data, text, text_len);
 }
 
 static void
@@ -1228,6 +1258,207 @@ static const GMarkupParser parser = {
   NULL,
 };
 
+/* Compiled files
+ *
+ * The events for the core elements are replayed directly, with the
+ * position they had in the .ui file, which skips all the tokenizing,
+ * entity decoding and whitespace handling of GMarkup. Custom buildable
+ * parsers and menus need a real GMarkupParseContext, so their elements
+ * are stored as XML fragments and parsed normally.
+ */
+
+static void
+fragment_start_element (GMarkupParseContext  *context,
+                        const gchar          *element_name,
+                        const gchar         **names,
+                        const gchar         **values,
+                        gpointer              user_data,
+                        GError              **error)
+{
+  /* The outermost element just stands in for the parent of the
+   * fragment, for _gtk_builder_check_parent() */
+  if (g_markup_parse_context_get_element_stack (context)->next == NULL)
+    return;
+
+  start_element (context, element_name, names, values, user_data, error);
+}
+
+static void
+fragment_end_element (GMarkupParseContext  *context,
+                      const gchar          *element_name,
+                      gpointer              user_data,
+                      GError              **error)
+{
+  if (g_markup_parse_context_get_element_stack (context)->next == NULL)
+    return;
+
+  end_element (context, element_name, user_data, error);
+}
+
+static void
+fragment_text (GMarkupParseContext  *context,
+               const gchar          *text_data,
+               gsize                 text_len,
+               gpointer              user_data,
+               GError              **error)
+{
+  if (g_markup_parse_context_get_element_stack (context)->next == NULL)
+    return;
+
+  text (context, text_data, text_len, user_data, error);
+}
+
+static const GMarkupParser fragment_parser = {
+  fragment_start_element,
+  fragment_end_element,
+  fragment_text,
+  NULL,
+};
+
+static gboolean
+parse_fragment (ParserData   *data,
+                gint          line,
+                const gchar  *parent,
+                const gchar  *xml,
+                GError      **error)
+{
+  GMarkupParseContext *ctx, *saved_ctx;
+  GString *str;
+  gboolean result;
+  gint i;
+
+  str = g_string_new (NULL);
+  g_string_append_printf (str, "<%s>", parent);
+  /* Pad the fragment, so that line numbers match the .ui file */
+  for (i = 1; i < line; i++)
+    g_string_append_c (str, '\n');
+  g_string_append (str, xml);
+  g_string_append_printf (str, "</%s>", parent);
+
+  ctx = g_markup_parse_context_new (&fragment_parser,
+                                    G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                    data, NULL);
+
+  saved_ctx = data->ctx;
+  data->ctx = ctx;
+  data->compiled = FALSE;
+
+  result = g_markup_parse_context_parse (ctx, str->str, str->len, error) &&
+           g_markup_parse_context_end_parse (ctx, error);
+
+  data->ctx = saved_ctx;
+  data->compiled = TRUE;
+
+  g_markup_parse_context_free (ctx);
+  g_string_free (str, TRUE);
+
+  return result;
+}
+
+static gboolean
+parse_compiled (ParserData   *data,
+                const gchar  *buffer,
+                gsize         length,
+                GError      **error)
+{
+  GBytes *bytes;
+  GVariant *compiled, *events;
+  GVariantIter iter;
+  GError *tmp_error = NULL;
+  guint32 version;
+  guchar kind;
+  gint32 line, col;
+  const gchar *name, *text_data;
+  const gchar **names, **values;
+
+  bytes = g_bytes_new_static (buffer, length);
+  compiled = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (GTK_BUILDER_COMPILED_FORMAT), bytes, FALSE));
+  g_bytes_unref (bytes);
+
+  /* Compiled files are always little endian */
+  if (G_BYTE_ORDER == G_BIG_ENDIAN)
+    {
+      GVariant *swapped = g_variant_take_ref (g_variant_byteswap (compiled));
+
+      g_variant_unref (compiled);
+      compiled = swapped;
+    }
+
+  g_variant_get_child (compiled, 1, "u", &version);
+  if (version != GTK_BUILDER_COMPILED_VERSION)
+    {
+      g_set_error (error,
+                   GTK_BUILDER_ERROR,
+                   GTK_BUILDER_ERROR_VERSION_MISMATCH,
+                   "%s: Compiled file has version %u, expected %u",
+                   data->filename, version, GTK_BUILDER_COMPILED_VERSION);
+      g_variant_unref (compiled);
+      return FALSE;
+    }
+
+  data->compiled = TRUE;
+
+  events = g_variant_get_child_value (compiled, 2);
+  g_variant_iter_init (&iter, events);
+  while (tmp_error == NULL &&
+         g_variant_iter_next (&iter, "(yii&s&s^a&s^a&s)",
+                              &kind, &line, &col, &name, &text_data, &names, &values))
+    {
+      data->line = line;
+      data->col = col;
+
+      switch (kind)
+        {
+        case GTK_BUILDER_COMPILED_START:
+          if (g_strv_length ((gchar **) names) == g_strv_length ((gchar **) values))
+            start_element (data->ctx, name, names, values, data, &tmp_error);
+          else
+            g_set_error (&tmp_error,
+                         GTK_BUILDER_ERROR,
+                         GTK_BUILDER_ERROR_INVALID_VALUE,
+                         "%s:%d:%d Corrupt compiled file",
+                         data->filename, line, col);
+          break;
+
+        case GTK_BUILDER_COMPILED_END:
+          end_element (data->ctx, name, data, &tmp_error);
+          break;
+
+        case GTK_BUILDER_COMPILED_TEXT:
+          append_property_text (data, text_data, strlen (text_data));
+          break;
+
+        case GTK_BUILDER_COMPILED_FRAGMENT:
+          parse_fragment (data, line, name, text_data, &tmp_error);
+          break;
+
+        default:
+          g_set_error (&tmp_error,
+                       GTK_BUILDER_ERROR,
+                       GTK_BUILDER_ERROR_INVALID_VALUE,
+                       "%s:%d:%d Corrupt compiled file",
+                       data->filename, line, col);
+          break;
+        }
+
+      g_free (names);
+      g_free (values);
+    }
+
+  data->compiled = FALSE;
+
+  g_variant_unref (events);
+  g_variant_unref (compiled);
+
+  if (tmp_error)
+    {
+      g_propagate_error (error, tmp_error);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 void
 _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
                                   const gchar  *filename,
@@ -1269,7 +1500,13 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
                                           G_MARKUP_TREAT_CDATA_AS_TEXT,
                                           &data, NULL);
 
-  if (!g_markup_parse_context_parse (data.ctx, buffer, length, error))
+  if (length >= sizeof (GTK_BUILDER_COMPILED_MAGIC) &&
+      memcmp (buffer, GTK_BUILDER_COMPILED_MAGIC, sizeof (GTK_BUILDER_COMPILED_MAGIC)) == 0)
+    {
+      if (!parse_compiled (&data, buffer, length, error))
+        goto out;
+    }
+  else if (!g_markup_parse_context_parse (data.ctx, buffer, length, error))
     goto out;
 
   _gtk_builder_finish (builder);
@@ -116,8 +116,33 @@ typedef struct {
   gint object_counter;
 
   GHashTable *object_ids;
+
+  /* When replaying a compiled file, the position of the current
+   * event in the original .ui file */
+  gboolean compiled;
+  gint line;
+  gint col;
 } ParserData;
 
+/* Compiled .ui files, as written by gtk-builder-tool compile.
+ *
+ * The GVariant starts with the magic string, so compiled data can be
+ * told apart from XML. The events are (kind, line, column, name, text,
+ * attribute names, attribute values) and replay the GMarkup callbacks
+ * for the elements that GtkBuilder handles itself. Everything else is
+ * kept as an XML fragment, with the name of its parent element.
+ */
+#define GTK_BUILDER_COMPILED_MAGIC "GtkBuilder compiled"
+#define GTK_BUILDER_COMPILED_VERSION 1
+#define GTK_BUILDER_COMPILED_FORMAT "(sua(yiissasas))"
+
+typedef enum {
+  GTK_BUILDER_COMPILED_START    = 's',
+  GTK_BUILDER_COMPILED_END      = 'e',
+  GTK_BUILDER_COMPILED_TEXT     = 't',
+  GTK_BUILDER_COMPILED_FRAGMENT = 'f'
+} GtkBuilderCompiledEvent;
+
 typedef GType (*GTypeGetFunc) (void);
 
 /* Things only GtkBuilder should use */
@@ -19,6 +19,7 @@
 
 #include "gtkcssarrayvalueprivate.h"
 #include "gtkcssimagevalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 
 #include <string.h>
@@ -368,6 +369,18 @@ gtk_css_value_array_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_value_array_serialize (const GtkCssValue *value,
+                               GtkCssSerializer  *serializer)
+{
+  guint i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_ARRAY);
+  gtk_css_serializer_write_uint32 (serializer, value->n_values);
+  for (i = 0; i < value->n_values; i++)
+    gtk_css_serializer_write_value (serializer, value->values[i]);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_ARRAY = {
   gtk_css_value_array_free,
   gtk_css_value_array_compute,
@@ -375,7 +388,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_ARRAY = {
   gtk_css_value_array_transition,
   gtk_css_value_array_is_dynamic,
   gtk_css_value_array_get_dynamic_value,
-  gtk_css_value_array_print
+  gtk_css_value_array_print,
+  gtk_css_value_array_serialize
 };
 
 GtkCssValue *
@@ -402,6 +416,36 @@ _gtk_css_array_value_new_from_array (GtkCssValue **values,
   return result;
 }
 
+GtkCssValue *
+gtk_css_array_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue **values, *result;
+  guint i, n_values;
+
+  n_values = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  if (n_values == 0)
+    return NULL;
+
+  values = g_new (GtkCssValue *, n_values);
+  for (i = 0; i < n_values; i++)
+    values[i] = gtk_css_deserializer_read_value (deserializer);
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      for (i = 0; i < n_values; i++)
+        g_clear_pointer (&values[i], _gtk_css_value_unref);
+      result = NULL;
+    }
+  else
+    {
+      result = _gtk_css_array_value_new_from_array (values, n_values);
+    }
+
+  g_free (values);
+
+  return result;
+}
+
 GtkCssValue *
 _gtk_css_array_value_parse (GtkCssParser *parser,
                             GtkCssValue  *(* parse_func) (GtkCssParser *parser))
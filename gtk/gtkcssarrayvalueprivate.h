@@ -31,6 +31,7 @@ GtkCssValue *       _gtk_css_array_value_new_from_array (GtkCssValue          **
                                                          guint                  n_values);
 GtkCssValue *       _gtk_css_array_value_parse          (GtkCssParser          *parser,
                                                          GtkCssValue *          (* parse_func) (GtkCssParser *));
+GtkCssValue *       gtk_css_array_value_deserialize     (GtkCssDeserializer    *deserializer);
 
 GtkCssValue *       _gtk_css_array_value_get_nth        (const GtkCssValue     *value,
                                                          guint                  i);
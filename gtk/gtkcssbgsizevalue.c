@@ -20,6 +20,7 @@
 #include "gtkcssbgsizevalueprivate.h"
 
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
@@ -152,6 +153,17 @@ gtk_css_value_bg_size_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_value_bg_size_serialize (const GtkCssValue *value,
+                                 GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_BG_SIZE);
+  gtk_css_serializer_write_uint32 (serializer, value->cover);
+  gtk_css_serializer_write_uint32 (serializer, value->contain);
+  gtk_css_serializer_write_value (serializer, value->x);
+  gtk_css_serializer_write_value (serializer, value->y);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_BG_SIZE = {
   gtk_css_value_bg_size_free,
   gtk_css_value_bg_size_compute,
@@ -159,7 +171,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_BG_SIZE = {
   gtk_css_value_bg_size_transition,
   NULL,
   NULL,
-  gtk_css_value_bg_size_print
+  gtk_css_value_bg_size_print,
+  gtk_css_value_bg_size_serialize
 };
 
 static GtkCssValue auto_singleton = { &GTK_CSS_VALUE_BG_SIZE, 1, FALSE, FALSE, NULL, NULL };
@@ -182,6 +195,33 @@ _gtk_css_bg_size_value_new (GtkCssValue *x,
   return result;
 }
 
+GtkCssValue *
+gtk_css_bg_size_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *x, *y;
+  gboolean cover, contain;
+
+  cover = gtk_css_deserializer_read_uint32 (deserializer);
+  contain = gtk_css_deserializer_read_uint32 (deserializer);
+  x = gtk_css_deserializer_read_number0 (deserializer);
+  y = gtk_css_deserializer_read_number0 (deserializer);
+
+  if (gtk_css_deserializer_has_failed (deserializer) ||
+      ((cover || contain) && (x || y)))
+    {
+      g_clear_pointer (&x, _gtk_css_value_unref);
+      g_clear_pointer (&y, _gtk_css_value_unref);
+      return NULL;
+    }
+
+  if (cover)
+    return _gtk_css_value_ref (&cover_singleton);
+  if (contain)
+    return _gtk_css_value_ref (&contain_singleton);
+
+  return _gtk_css_bg_size_value_new (x, y);
+}
+
 GtkCssValue *
 _gtk_css_bg_size_value_parse (GtkCssParser *parser)
 {
@@ -29,6 +29,7 @@ G_BEGIN_DECLS
 GtkCssValue *   _gtk_css_bg_size_value_new          (GtkCssValue            *x,
                                                      GtkCssValue            *y);
 GtkCssValue *   _gtk_css_bg_size_value_parse        (GtkCssParser           *parser);
+GtkCssValue *   gtk_css_bg_size_value_deserialize   (GtkCssDeserializer     *deserializer);
 
 void            _gtk_css_bg_size_value_compute_size (const GtkCssValue      *bg_size,
                                                      GtkCssImage            *image,
@@ -20,6 +20,7 @@
 #include "gtkcssbordervalueprivate.h"
 
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
@@ -139,6 +140,18 @@ gtk_css_value_border_print (const GtkCssValue *value,
     g_string_append (string, " fill");
 }
 
+static void
+gtk_css_value_border_serialize (const GtkCssValue *value,
+                                GtkCssSerializer  *serializer)
+{
+  guint i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_BORDER);
+  for (i = 0; i < 4; i++)
+    gtk_css_serializer_write_value (serializer, value->values[i]);
+  gtk_css_serializer_write_uint32 (serializer, value->fill);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_BORDER = {
   gtk_css_value_border_free,
   gtk_css_value_border_compute,
@@ -146,7 +159,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_BORDER = {
   gtk_css_value_border_transition,
   NULL,
   NULL,
-  gtk_css_value_border_print
+  gtk_css_value_border_print,
+  gtk_css_value_border_serialize
 };
 
 GtkCssValue *
@@ -166,6 +180,26 @@ _gtk_css_border_value_new (GtkCssValue *top,
   return result;
 }
 
+GtkCssValue *
+gtk_css_border_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *result;
+  guint i;
+
+  result = _gtk_css_border_value_new (NULL, NULL, NULL, NULL);
+  for (i = 0; i < 4; i++)
+    result->values[i] = gtk_css_deserializer_read_number0 (deserializer);
+  result->fill = gtk_css_deserializer_read_uint32 (deserializer) ? TRUE : FALSE;
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      _gtk_css_value_unref (result);
+      return NULL;
+    }
+
+  return result;
+}
+
 GtkCssValue *
 _gtk_css_border_value_parse (GtkCssParser           *parser,
                              GtkCssNumberParseFlags  flags,
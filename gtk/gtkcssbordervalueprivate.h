@@ -34,6 +34,7 @@ GtkCssValue *   _gtk_css_border_value_parse         (GtkCssParser           *par
                                                      GtkCssNumberParseFlags  flags,
                                                      gboolean                allow_auto,
                                                      gboolean                allow_fill);
+GtkCssValue *   gtk_css_border_value_deserialize    (GtkCssDeserializer     *deserializer);
 
 GtkCssValue *   _gtk_css_border_value_get_top       (const GtkCssValue      *value);
 GtkCssValue *   _gtk_css_border_value_get_right     (const GtkCssValue      *value);
@@ -19,6 +19,8 @@
 
 #include "gtkcsscalcvalueprivate.h"
 
+#include "gtkcssserializerprivate.h"
+
 #include <string.h>
 
 struct _GtkCssValue {
@@ -167,6 +169,18 @@ gtk_css_value_calc_print (const GtkCssValue *value,
   g_string_append (string, ")");
 }
 
+static void
+gtk_css_value_calc_serialize (const GtkCssValue *value,
+                              GtkCssSerializer  *serializer)
+{
+  gsize i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_CALC);
+  gtk_css_serializer_write_uint32 (serializer, value->n_terms);
+  for (i = 0; i < value->n_terms; i++)
+    gtk_css_serializer_write_value (serializer, value->terms[i]);
+}
+
 static double
 gtk_css_value_calc_get (const GtkCssValue *value,
                         double             one_hundred_percent)
@@ -251,7 +265,8 @@ static const GtkCssNumberValueClass GTK_CSS_VALUE_CALC = {
     gtk_css_number_value_transition,
     NULL,
     NULL,
-    gtk_css_value_calc_print
+    gtk_css_value_calc_print,
+    gtk_css_value_calc_serialize
   },
   gtk_css_value_calc_get,
   gtk_css_value_calc_get_dimension,
@@ -309,6 +324,33 @@ gtk_css_calc_value_new_sum (GtkCssValue *value1,
   return gtk_css_value_new_from_array (array);
 }
 
+GtkCssValue *
+gtk_css_calc_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *result;
+  gsize i, n_terms;
+
+  n_terms = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  if (n_terms == 0)
+    return NULL;
+
+  /* The terms were sorted and merged when the value was created,
+   * so we can take them as they are. */
+  result = gtk_css_calc_value_new (n_terms);
+  for (i = 0; i < n_terms; i++)
+    result->terms[i] = gtk_css_deserializer_read_number (deserializer);
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      for (i = 0; i < n_terms; i++)
+        g_clear_pointer (&result->terms[i], _gtk_css_value_unref);
+      g_slice_free1 (gtk_css_value_calc_get_size (n_terms), result);
+      return NULL;
+    }
+
+  return result;
+}
+
 GtkCssValue *   gtk_css_calc_value_parse_sum (GtkCssParser           *parser,
                                               GtkCssNumberParseFlags  flags);
 
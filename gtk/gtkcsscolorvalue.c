@@ -20,6 +20,7 @@
 #include "gtkcsscolorvalueprivate.h"
 
 #include "gtkcssrgbavalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkhslaprivate.h"
 #include "gtkstylepropertyprivate.h"
@@ -444,6 +445,50 @@ gtk_css_value_color_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_value_color_serialize (const GtkCssValue *value,
+                               GtkCssSerializer  *serializer)
+{
+  const GdkRGBA *rgba;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_COLOR);
+  gtk_css_serializer_write_uint32 (serializer, value->type);
+
+  switch (value->type)
+    {
+    case COLOR_TYPE_LITERAL:
+      rgba = _gtk_css_rgba_value_get_rgba (value->last_value);
+      gtk_css_serializer_write_double (serializer, rgba->red);
+      gtk_css_serializer_write_double (serializer, rgba->green);
+      gtk_css_serializer_write_double (serializer, rgba->blue);
+      gtk_css_serializer_write_double (serializer, rgba->alpha);
+      break;
+    case COLOR_TYPE_NAME:
+      gtk_css_serializer_write_string (serializer, value->sym_col.name);
+      break;
+    case COLOR_TYPE_SHADE:
+      gtk_css_serializer_write_value (serializer, value->sym_col.shade.color);
+      gtk_css_serializer_write_double (serializer, value->sym_col.shade.factor);
+      break;
+    case COLOR_TYPE_ALPHA:
+      gtk_css_serializer_write_value (serializer, value->sym_col.alpha.color);
+      gtk_css_serializer_write_double (serializer, value->sym_col.alpha.factor);
+      break;
+    case COLOR_TYPE_MIX:
+      gtk_css_serializer_write_value (serializer, value->sym_col.mix.color1);
+      gtk_css_serializer_write_value (serializer, value->sym_col.mix.color2);
+      gtk_css_serializer_write_double (serializer, value->sym_col.mix.factor);
+      break;
+    case COLOR_TYPE_CURRENT_COLOR:
+      break;
+    case COLOR_TYPE_WIN32:
+    default:
+      /* The theme is looked up at runtime */
+      gtk_css_serializer_fail (serializer);
+      break;
+    }
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_COLOR = {
   gtk_css_value_color_free,
   gtk_css_value_color_compute,
@@ -451,7 +496,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_COLOR = {
   gtk_css_value_color_transition,
   NULL,
   NULL,
-  gtk_css_value_color_print
+  gtk_css_value_color_print,
+  gtk_css_value_color_serialize
 };
 
 GtkCssValue *
@@ -584,6 +630,78 @@ _gtk_css_color_value_new_current_color (void)
   return _gtk_css_value_ref (&current_color);
 }
 
+GtkCssValue *
+gtk_css_color_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *color1, *color2, *result;
+  ColorType type;
+  GdkRGBA rgba;
+  double factor;
+
+  type = gtk_css_deserializer_read_uint32 (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+
+  switch (type)
+    {
+    case COLOR_TYPE_LITERAL:
+      rgba.red = gtk_css_deserializer_read_double (deserializer);
+      rgba.green = gtk_css_deserializer_read_double (deserializer);
+      rgba.blue = gtk_css_deserializer_read_double (deserializer);
+      rgba.alpha = gtk_css_deserializer_read_double (deserializer);
+      if (gtk_css_deserializer_has_failed (deserializer))
+        return NULL;
+      return _gtk_css_color_value_new_literal (&rgba);
+
+    case COLOR_TYPE_NAME:
+      {
+        const char *name = gtk_css_deserializer_read_string (deserializer);
+
+        if (name == NULL)
+          return NULL;
+        return _gtk_css_color_value_new_name (name);
+      }
+
+    case COLOR_TYPE_SHADE:
+    case COLOR_TYPE_ALPHA:
+      color1 = gtk_css_deserializer_read_color (deserializer);
+      factor = gtk_css_deserializer_read_double (deserializer);
+      if (gtk_css_deserializer_has_failed (deserializer))
+        {
+          g_clear_pointer (&color1, _gtk_css_value_unref);
+          return NULL;
+        }
+      if (type == COLOR_TYPE_SHADE)
+        result = _gtk_css_color_value_new_shade (color1, factor);
+      else
+        result = _gtk_css_color_value_new_alpha (color1, factor);
+      _gtk_css_value_unref (color1);
+      return result;
+
+    case COLOR_TYPE_MIX:
+      color1 = gtk_css_deserializer_read_color (deserializer);
+      color2 = gtk_css_deserializer_read_color (deserializer);
+      factor = gtk_css_deserializer_read_double (deserializer);
+      if (gtk_css_deserializer_has_failed (deserializer))
+        {
+          g_clear_pointer (&color1, _gtk_css_value_unref);
+          g_clear_pointer (&color2, _gtk_css_value_unref);
+          return NULL;
+        }
+      result = _gtk_css_color_value_new_mix (color1, color2, factor);
+      _gtk_css_value_unref (color1);
+      _gtk_css_value_unref (color2);
+      return result;
+
+    case COLOR_TYPE_CURRENT_COLOR:
+      return _gtk_css_color_value_new_current_color ();
+
+    case COLOR_TYPE_WIN32:
+    default:
+      return NULL;
+    }
+}
+
 typedef enum {
   COLOR_RGBA,
   COLOR_RGB,
@@ -40,6 +40,7 @@ GtkCssValue *   _gtk_css_color_value_new_mix            (GtkCssValue    *color1,
 GtkCssValue *   _gtk_css_color_value_new_win32          (const gchar    *theme_class,
                                                          gint            id);
 GtkCssValue *   _gtk_css_color_value_new_current_color  (void);
+GtkCssValue *   gtk_css_color_value_deserialize         (GtkCssDeserializer *deserializer);
 
 GtkCssValue *   _gtk_css_color_value_parse              (GtkCssParser   *parser);
 
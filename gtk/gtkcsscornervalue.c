@@ -20,6 +20,7 @@
 #include "gtkcsscornervalueprivate.h"
 
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
@@ -98,6 +99,15 @@ gtk_css_value_corner_print (const GtkCssValue *corner,
     }
 }
 
+static void
+gtk_css_value_corner_serialize (const GtkCssValue *corner,
+                                GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_CORNER);
+  gtk_css_serializer_write_value (serializer, corner->x);
+  gtk_css_serializer_write_value (serializer, corner->y);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_CORNER = {
   gtk_css_value_corner_free,
   gtk_css_value_corner_compute,
@@ -105,7 +115,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_CORNER = {
   gtk_css_value_corner_transition,
   NULL,
   NULL,
-  gtk_css_value_corner_print
+  gtk_css_value_corner_print,
+  gtk_css_value_corner_serialize
 };
 
 GtkCssValue *
@@ -151,6 +162,23 @@ _gtk_css_corner_value_parse (GtkCssParser *parser)
   return _gtk_css_corner_value_new (x, y);
 }
 
+GtkCssValue *
+gtk_css_corner_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *x, *y;
+
+  x = gtk_css_deserializer_read_number (deserializer);
+  y = gtk_css_deserializer_read_number (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      g_clear_pointer (&x, _gtk_css_value_unref);
+      g_clear_pointer (&y, _gtk_css_value_unref);
+      return NULL;
+    }
+
+  return _gtk_css_corner_value_new (x, y);
+}
+
 double
 _gtk_css_corner_value_get_x (const GtkCssValue *corner,
                              double             one_hundred_percent)
@@ -20,6 +20,7 @@
 #include "gtkcssdimensionvalueprivate.h"
 
 #include "gtkcssenumvalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkstylepropertyprivate.h"
 
 #include "fallback-c89.c"
@@ -204,6 +205,15 @@ gtk_css_value_dimension_print (const GtkCssValue *number,
     }
 }
 
+static void
+gtk_css_value_dimension_serialize (const GtkCssValue *number,
+                                   GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_DIMENSION);
+  gtk_css_serializer_write_uint32 (serializer, number->unit);
+  gtk_css_serializer_write_double (serializer, number->value);
+}
+
 static double
 gtk_css_value_dimension_get (const GtkCssValue *value,
                              double             one_hundred_percent)
@@ -278,7 +288,8 @@ static const GtkCssNumberValueClass GTK_CSS_VALUE_DIMENSION = {
     gtk_css_number_value_transition,
     NULL,
     NULL,
-    gtk_css_value_dimension_print
+    gtk_css_value_dimension_print,
+    gtk_css_value_dimension_serialize
   },
   gtk_css_value_dimension_get,
   gtk_css_value_dimension_get_dimension,
@@ -325,3 +336,17 @@ gtk_css_dimension_value_new (double     value,
   return result;
 }
 
+
+GtkCssValue *
+gtk_css_dimension_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssUnit unit;
+  double value;
+
+  unit = gtk_css_deserializer_read_uint32 (deserializer);
+  value = gtk_css_deserializer_read_double (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer) || unit > GTK_CSS_MS)
+    return NULL;
+
+  return gtk_css_dimension_value_new (value, unit);
+}
@@ -26,6 +26,7 @@ G_BEGIN_DECLS
 
 GtkCssValue *   gtk_css_dimension_value_new         (double                  value,
                                                      GtkCssUnit              unit);
+GtkCssValue *   gtk_css_dimension_value_deserialize (GtkCssDeserializer     *deserializer);
 /* This function implemented in gtkcssparser.c */
 GtkCssValue *   gtk_css_dimension_value_parse       (GtkCssParser           *parser,
                                                      GtkCssNumberParseFlags  flags);
@@ -19,6 +19,8 @@
 
 #include "gtkcsseasevalueprivate.h"
 
+#include "gtkcssserializerprivate.h"
+
 #include <math.h>
 
 typedef enum {
@@ -134,6 +136,30 @@ gtk_css_value_ease_print (const GtkCssValue *ease,
     }
 }
 
+static void
+gtk_css_value_ease_serialize (const GtkCssValue *ease,
+                              GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_EASE);
+  gtk_css_serializer_write_uint32 (serializer, ease->type);
+
+  switch (ease->type)
+    {
+    case GTK_CSS_EASE_CUBIC_BEZIER:
+      gtk_css_serializer_write_double (serializer, ease->u.cubic.x1);
+      gtk_css_serializer_write_double (serializer, ease->u.cubic.y1);
+      gtk_css_serializer_write_double (serializer, ease->u.cubic.x2);
+      gtk_css_serializer_write_double (serializer, ease->u.cubic.y2);
+      break;
+    case GTK_CSS_EASE_STEPS:
+      gtk_css_serializer_write_uint32 (serializer, ease->u.steps.steps);
+      gtk_css_serializer_write_uint32 (serializer, ease->u.steps.start);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_EASE = {
   gtk_css_value_ease_free,
   gtk_css_value_ease_compute,
@@ -141,7 +167,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_EASE = {
   gtk_css_value_ease_transition,
   NULL,
   NULL,
-  gtk_css_value_ease_print
+  gtk_css_value_ease_print,
+  gtk_css_value_ease_serialize
 };
 
 GtkCssValue *
@@ -329,6 +356,37 @@ _gtk_css_ease_value_parse (GtkCssParser *parser)
   return NULL;
 }
 
+GtkCssValue *
+gtk_css_ease_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  double x1, y1, x2, y2;
+  guint n_steps;
+  gboolean start;
+
+  switch (gtk_css_deserializer_read_uint32 (deserializer))
+    {
+    case GTK_CSS_EASE_CUBIC_BEZIER:
+      x1 = gtk_css_deserializer_read_double (deserializer);
+      y1 = gtk_css_deserializer_read_double (deserializer);
+      x2 = gtk_css_deserializer_read_double (deserializer);
+      y2 = gtk_css_deserializer_read_double (deserializer);
+      if (gtk_css_deserializer_has_failed (deserializer) ||
+          !(x1 >= 0.0 && x1 <= 1.0 && x2 >= 0.0 && x2 <= 1.0))
+        return NULL;
+      return _gtk_css_ease_value_new_cubic_bezier (x1, y1, x2, y2);
+
+    case GTK_CSS_EASE_STEPS:
+      n_steps = gtk_css_deserializer_read_uint32 (deserializer);
+      start = gtk_css_deserializer_read_uint32 (deserializer) ? TRUE : FALSE;
+      if (gtk_css_deserializer_has_failed (deserializer) || n_steps == 0)
+        return NULL;
+      return _gtk_css_ease_value_new_steps (n_steps, start);
+
+    default:
+      return NULL;
+    }
+}
+
 double
 _gtk_css_ease_value_transform (const GtkCssValue *ease,
                                double             progress)
@@ -31,6 +31,7 @@ GtkCssValue *   _gtk_css_ease_value_new_cubic_bezier  (double                x1,
                                                        double                y2);
 gboolean        _gtk_css_ease_value_can_parse         (GtkCssParser         *parser);
 GtkCssValue *   _gtk_css_ease_value_parse             (GtkCssParser         *parser);
+GtkCssValue *   gtk_css_ease_value_deserialize        (GtkCssDeserializer   *deserializer);
 
 double          _gtk_css_ease_value_transform         (const GtkCssValue    *ease,
                                                        double                progress);
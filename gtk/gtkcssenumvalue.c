@@ -21,6 +21,7 @@
 
 #include "gtkcssstyleprivate.h"
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkstyleproviderprivate.h"
 #include "gtksettingsprivate.h"
 
@@ -75,6 +76,11 @@ gtk_css_value_enum_print (const GtkCssValue *value,
   g_string_append (string, value->name);
 }
 
+/* defined at the end, after all the values */
+static void
+gtk_css_value_enum_serialize (const GtkCssValue *value,
+                              GtkCssSerializer  *serializer);
+
 /* GtkBorderStyle */
 
 static const GtkCssValueClass GTK_CSS_VALUE_BORDER_STYLE = {
@@ -84,7 +90,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_BORDER_STYLE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue border_style_values[] = {
@@ -141,7 +148,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_BLEND_MODE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue blend_mode_values[] = {
@@ -291,7 +299,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_SIZE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_size_values[] = {
@@ -347,7 +356,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_STYLE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_style_values[] = {
@@ -461,7 +471,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_WEIGHT = {
   gtk_css_value_font_weight_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_weight_values[] = {
@@ -536,7 +547,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_STRETCH = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_stretch_values[] = {
@@ -592,7 +604,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_TEXT_DECORATION_LINE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue text_decoration_line_values[] = {
@@ -642,7 +655,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_TEXT_DECORATION_STYLE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue text_decoration_style_values[] = {
@@ -692,7 +706,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_AREA = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue area_values[] = {
@@ -748,7 +763,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_DIRECTION = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue direction_values[] = {
@@ -808,7 +824,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_PLAY_STATE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue play_state_values[] = {
@@ -863,7 +880,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FILL_MODE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue fill_mode_values[] = {
@@ -920,7 +938,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_ICON_STYLE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue icon_style_values[] = {
@@ -976,7 +995,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_KERNING = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_kerning_values[] = {
@@ -1032,7 +1052,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIANT_POSITION = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_variant_position_values[] = {
@@ -1088,7 +1109,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIANT_CAPS = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_variant_caps_values[] = {
@@ -1148,7 +1170,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIANT_ALTERNATE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_value_enum_print
+  gtk_css_value_enum_print,
+  gtk_css_value_enum_serialize
 };
 
 static GtkCssValue font_variant_alternate_values[] = {
@@ -1261,7 +1284,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIANT_LIGATURE = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_font_variant_ligature_value_print
+  gtk_css_font_variant_ligature_value_print,
+  gtk_css_value_enum_serialize
 };
 
 static gboolean
@@ -1367,7 +1391,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIANT_NUMERIC = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_font_variant_numeric_value_print
+  gtk_css_font_variant_numeric_value_print,
+  gtk_css_value_enum_serialize
 };
 
 static gboolean
@@ -1470,7 +1495,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIANT_EAST_ASIAN = {
   gtk_css_value_enum_transition,
   NULL,
   NULL,
-  gtk_css_font_variant_east_asian_value_print
+  gtk_css_font_variant_east_asian_value_print,
+  gtk_css_value_enum_serialize
 };
 
 #ifdef _MSC_VER
@@ -1580,3 +1606,139 @@ _gtk_css_font_variant_east_asian_value_get (const GtkCssValue *value)
 
   return value->value;
 }
+
+/* serializing */
+
+static const struct {
+  GtkCssSerializedValueType type;
+  const GtkCssValueClass *klass;
+  GtkCssValue *values;          /* for enums */
+  const FlagsValue *flags;      /* for flags */
+  guint n_values;
+} enum_types[] = {
+  { GTK_CSS_SERIALIZED_VALUE_BORDER_STYLE, &GTK_CSS_VALUE_BORDER_STYLE, border_style_values, NULL, G_N_ELEMENTS (border_style_values) },
+  { GTK_CSS_SERIALIZED_VALUE_BLEND_MODE, &GTK_CSS_VALUE_BLEND_MODE, blend_mode_values, NULL, G_N_ELEMENTS (blend_mode_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_SIZE, &GTK_CSS_VALUE_FONT_SIZE, font_size_values, NULL, G_N_ELEMENTS (font_size_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_STYLE, &GTK_CSS_VALUE_FONT_STYLE, font_style_values, NULL, G_N_ELEMENTS (font_style_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_WEIGHT, &GTK_CSS_VALUE_FONT_WEIGHT, font_weight_values, NULL, G_N_ELEMENTS (font_weight_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_STRETCH, &GTK_CSS_VALUE_FONT_STRETCH, font_stretch_values, NULL, G_N_ELEMENTS (font_stretch_values) },
+  { GTK_CSS_SERIALIZED_VALUE_TEXT_DECORATION_LINE, &GTK_CSS_VALUE_TEXT_DECORATION_LINE, text_decoration_line_values, NULL, G_N_ELEMENTS (text_decoration_line_values) },
+  { GTK_CSS_SERIALIZED_VALUE_TEXT_DECORATION_STYLE, &GTK_CSS_VALUE_TEXT_DECORATION_STYLE, text_decoration_style_values, NULL, G_N_ELEMENTS (text_decoration_style_values) },
+  { GTK_CSS_SERIALIZED_VALUE_AREA, &GTK_CSS_VALUE_AREA, area_values, NULL, G_N_ELEMENTS (area_values) },
+  { GTK_CSS_SERIALIZED_VALUE_DIRECTION, &GTK_CSS_VALUE_DIRECTION, direction_values, NULL, G_N_ELEMENTS (direction_values) },
+  { GTK_CSS_SERIALIZED_VALUE_PLAY_STATE, &GTK_CSS_VALUE_PLAY_STATE, play_state_values, NULL, G_N_ELEMENTS (play_state_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FILL_MODE, &GTK_CSS_VALUE_FILL_MODE, fill_mode_values, NULL, G_N_ELEMENTS (fill_mode_values) },
+  { GTK_CSS_SERIALIZED_VALUE_ICON_STYLE, &GTK_CSS_VALUE_ICON_STYLE, icon_style_values, NULL, G_N_ELEMENTS (icon_style_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_KERNING, &GTK_CSS_VALUE_FONT_KERNING, font_kerning_values, NULL, G_N_ELEMENTS (font_kerning_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_POSITION, &GTK_CSS_VALUE_FONT_VARIANT_POSITION, font_variant_position_values, NULL, G_N_ELEMENTS (font_variant_position_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_CAPS, &GTK_CSS_VALUE_FONT_VARIANT_CAPS, font_variant_caps_values, NULL, G_N_ELEMENTS (font_variant_caps_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_ALTERNATE, &GTK_CSS_VALUE_FONT_VARIANT_ALTERNATE, font_variant_alternate_values, NULL, G_N_ELEMENTS (font_variant_alternate_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_LIGATURE, &GTK_CSS_VALUE_FONT_VARIANT_LIGATURE, NULL, font_variant_ligature_values, G_N_ELEMENTS (font_variant_ligature_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_NUMERIC, &GTK_CSS_VALUE_FONT_VARIANT_NUMERIC, NULL, font_variant_numeric_values, G_N_ELEMENTS (font_variant_numeric_values) },
+  { GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_EAST_ASIAN, &GTK_CSS_VALUE_FONT_VARIANT_EAST_ASIAN, NULL, font_variant_east_asian_values, G_N_ELEMENTS (font_variant_east_asian_values) }
+};
+
+/* Enums and flags are stored by name, so their numbering can change */
+static void
+gtk_css_value_enum_serialize (const GtkCssValue *value,
+                              GtkCssSerializer  *serializer)
+{
+  guint i, j, n_flags;
+
+  for (i = 0; i < G_N_ELEMENTS (enum_types); i++)
+    {
+      if (enum_types[i].klass == value->class)
+        break;
+    }
+  g_assert (i < G_N_ELEMENTS (enum_types));
+
+  gtk_css_serializer_write_uint32 (serializer, enum_types[i].type);
+
+  if (enum_types[i].values)
+    {
+      gtk_css_serializer_write_string (serializer, value->name);
+      return;
+    }
+
+  n_flags = 0;
+  for (j = 0; j < enum_types[i].n_values; j++)
+    {
+      if (value->value & enum_types[i].flags[j].value)
+        n_flags++;
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, n_flags);
+  for (j = 0; j < enum_types[i].n_values; j++)
+    {
+      if (value->value & enum_types[i].flags[j].value)
+        gtk_css_serializer_write_string (serializer, enum_types[i].flags[j].name);
+    }
+}
+
+GtkCssValue *
+gtk_css_enum_value_deserialize (GtkCssDeserializer        *deserializer,
+                                GtkCssSerializedValueType  type)
+{
+  const char *name;
+  guint i, j, n_flags;
+  int value;
+
+  for (i = 0; i < G_N_ELEMENTS (enum_types); i++)
+    {
+      if (enum_types[i].type == type)
+        break;
+    }
+  if (i == G_N_ELEMENTS (enum_types))
+    return NULL;
+
+  if (enum_types[i].values)
+    {
+      name = gtk_css_deserializer_read_string (deserializer);
+      if (name == NULL)
+        return NULL;
+
+      for (j = 0; j < enum_types[i].n_values; j++)
+        {
+          if (g_str_equal (enum_types[i].values[j].name, name))
+            return _gtk_css_value_ref (&enum_types[i].values[j]);
+        }
+
+      return NULL;
+    }
+
+  value = 0;
+  n_flags = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  while (n_flags-- > 0)
+    {
+      name = gtk_css_deserializer_read_string (deserializer);
+      if (name == NULL)
+        return NULL;
+
+      for (j = 0; j < enum_types[i].n_values; j++)
+        {
+          if (g_str_equal (enum_types[i].flags[j].name, name))
+            break;
+        }
+      if (j == enum_types[i].n_values)
+        return NULL;
+
+      value |= enum_types[i].flags[j].value;
+    }
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+
+  /* These check the combination is valid */
+  switch (type)
+    {
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_LIGATURE:
+      return _gtk_css_font_variant_ligature_value_new (value);
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_NUMERIC:
+      return _gtk_css_font_variant_numeric_value_new (value);
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_EAST_ASIAN:
+      return _gtk_css_font_variant_east_asian_value_new (value);
+    default:
+      g_assert_not_reached ();
+      return NULL;
+    }
+}
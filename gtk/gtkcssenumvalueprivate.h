@@ -22,6 +22,7 @@
 
 #include "gtkenums.h"
 #include "gtkcssparserprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcsstypesprivate.h"
 #include "gtkcssvalueprivate.h"
 
@@ -113,6 +114,9 @@ GtkCssFontVariantEastAsian _gtk_css_font_variant_east_asian_try_parse_one (GtkCs
                                                                       GtkCssFontVariantEastAsian base);
 GtkCssFontVariantEastAsian _gtk_css_font_variant_east_asian_value_get     (const GtkCssValue          *value);
 
+GtkCssValue *   gtk_css_enum_value_deserialize        (GtkCssDeserializer        *deserializer,
+                                                       GtkCssSerializedValueType  type);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_ENUM_VALUE_PRIVATE_H__ */
@@ -24,6 +24,7 @@
 
 #include "gtkcssfiltervalueprivate.h"
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 typedef union _GtkCssFilter GtkCssFilter;
 
@@ -692,6 +693,27 @@ gtk_css_value_filter_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_value_filter_serialize (const GtkCssValue *value,
+                                GtkCssSerializer  *serializer)
+{
+  guint i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_FILTER);
+  gtk_css_serializer_write_uint32 (serializer, value->n_filters);
+  for (i = 0; i < value->n_filters; i++)
+    {
+      const GtkCssFilter *filter = &value->filters[i];
+
+      if (filter->type == GTK_CSS_FILTER_DROP_SHADOW)
+        gtk_css_serializer_fail (serializer);
+
+      /* All the other filters look the same */
+      gtk_css_serializer_write_uint32 (serializer, filter->type);
+      gtk_css_serializer_write_value (serializer, filter->blur.value);
+    }
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_FILTER = {
   gtk_css_value_filter_free,
   gtk_css_value_filter_compute,
@@ -699,7 +721,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FILTER = {
   gtk_css_value_filter_transition,
   NULL,
   NULL,
-  gtk_css_value_filter_print
+  gtk_css_value_filter_print,
+  gtk_css_value_filter_serialize
 };
 
 static GtkCssValue none_singleton = { &GTK_CSS_VALUE_FILTER, 1, 0, {  { GTK_CSS_FILTER_NONE } } };
@@ -821,6 +844,48 @@ gtk_css_filter_parse (GtkCssFilter *filter,
   return TRUE;
 }
 
+GtkCssValue *
+gtk_css_filter_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *value;
+  guint i, n_filters;
+
+  n_filters = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  if (gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+  if (n_filters == 0)
+    return gtk_css_filter_value_new_none ();
+
+  value = gtk_css_filter_value_alloc (n_filters);
+  for (i = 0; i < n_filters; i++)
+    {
+      GtkCssFilter *filter = &value->filters[i];
+
+      filter->type = gtk_css_deserializer_read_uint32 (deserializer);
+      filter->blur.value = gtk_css_deserializer_read_number (deserializer);
+      if (filter->blur.value == NULL ||
+          filter->type <= GTK_CSS_FILTER_NONE ||
+          filter->type > GTK_CSS_FILTER_SEPIA ||
+          filter->type == GTK_CSS_FILTER_DROP_SHADOW)
+        {
+          g_clear_pointer (&filter->blur.value, _gtk_css_value_unref);
+          value->n_filters = i;
+          gtk_css_deserializer_fail (deserializer);
+          break;
+        }
+    }
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      for (i = 0; i < value->n_filters; i++)
+        gtk_css_filter_clear (&value->filters[i]);
+      g_slice_free1 (sizeof (GtkCssValue) + sizeof (GtkCssFilter) * (n_filters - 1), value);
+      return NULL;
+    }
+
+  return value;
+}
+
 GtkCssValue *
 gtk_css_filter_value_parse (GtkCssParser *parser)
 {
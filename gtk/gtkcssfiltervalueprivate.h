@@ -27,6 +27,7 @@ G_BEGIN_DECLS
 
 GtkCssValue *   gtk_css_filter_value_new_none           (void);
 GtkCssValue *   gtk_css_filter_value_parse              (GtkCssParser           *parser);
+GtkCssValue *   gtk_css_filter_value_deserialize        (GtkCssDeserializer     *deserializer);
 
 void            gtk_css_filter_value_push_snapshot      (const GtkCssValue      *filter,
                                                          GtkSnapshot            *snapshot);
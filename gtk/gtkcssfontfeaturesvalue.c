@@ -22,6 +22,7 @@
 #include "gtkcsstypesprivate.h"
 #include "gtkcssparserprivate.h"
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcssfontfeaturesvalueprivate.h"
 
 struct _GtkCssValue {
@@ -176,6 +177,30 @@ gtk_css_value_font_features_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_value_font_features_serialize (const GtkCssValue *value,
+                                       GtkCssSerializer  *serializer)
+{
+  GHashTableIter iter;
+  gpointer name, val;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_FONT_FEATURES);
+  if (value == default_font_features)
+    {
+      gtk_css_serializer_write_uint32 (serializer, TRUE);
+      return;
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, FALSE);
+  gtk_css_serializer_write_uint32 (serializer, g_hash_table_size (value->features));
+  g_hash_table_iter_init (&iter, value->features);
+  while (g_hash_table_iter_next (&iter, &name, &val))
+    {
+      gtk_css_serializer_write_string (serializer, name);
+      gtk_css_serializer_write_value (serializer, val);
+    }
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_FONT_FEATURES = {
   gtk_css_value_font_features_free,
   gtk_css_value_font_features_compute,
@@ -183,7 +208,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_FEATURES = {
   gtk_css_value_font_features_transition,
   NULL,
   NULL,
-  gtk_css_value_font_features_print
+  gtk_css_value_font_features_print,
+  gtk_css_value_font_features_serialize
 };
 
 static GtkCssValue *
@@ -268,6 +294,42 @@ gtk_css_font_features_value_parse (GtkCssParser *parser)
   return result;
 }
 
+GtkCssValue *
+gtk_css_font_features_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *result, *val;
+  const char *name;
+  guint i, n;
+
+  if (gtk_css_deserializer_read_uint32 (deserializer))
+    return gtk_css_font_features_value_new_default ();
+
+  n = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  result = gtk_css_font_features_value_new_empty ();
+
+  for (i = 0; i < n; i++)
+    {
+      name = gtk_css_deserializer_read_string (deserializer);
+      val = gtk_css_deserializer_read_number (deserializer);
+      if (name == NULL || val == NULL || !is_valid_opentype_tag (name))
+        {
+          g_clear_pointer (&val, _gtk_css_value_unref);
+          gtk_css_deserializer_fail (deserializer);
+          break;
+        }
+
+      gtk_css_font_features_value_add_feature (result, name, val);
+    }
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      _gtk_css_value_unref (result);
+      return NULL;
+    }
+
+  return result;
+}
+
 char *
 gtk_css_font_features_value_get_features (GtkCssValue *value)
 {
@@ -21,6 +21,7 @@
 
 #include "gtkcssparserprivate.h"
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcssfontvariationsvalueprivate.h"
 
 struct _GtkCssValue {
@@ -175,6 +176,30 @@ gtk_css_value_font_variations_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_value_font_variations_serialize (const GtkCssValue *value,
+                                         GtkCssSerializer  *serializer)
+{
+  GHashTableIter iter;
+  gpointer name, coord;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_FONT_VARIATIONS);
+  if (value == default_font_variations)
+    {
+      gtk_css_serializer_write_uint32 (serializer, TRUE);
+      return;
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, FALSE);
+  gtk_css_serializer_write_uint32 (serializer, g_hash_table_size (value->axes));
+  g_hash_table_iter_init (&iter, value->axes);
+  while (g_hash_table_iter_next (&iter, &name, &coord))
+    {
+      gtk_css_serializer_write_string (serializer, name);
+      gtk_css_serializer_write_value (serializer, coord);
+    }
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIATIONS = {
   gtk_css_value_font_variations_free,
   gtk_css_value_font_variations_compute,
@@ -182,7 +207,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_FONT_VARIATIONS = {
   gtk_css_value_font_variations_transition,
   NULL,
   NULL,
-  gtk_css_value_font_variations_print
+  gtk_css_value_font_variations_print,
+  gtk_css_value_font_variations_serialize
 };
 
 static GtkCssValue *
@@ -265,6 +291,42 @@ gtk_css_font_variations_value_parse (GtkCssParser *parser)
   return result;
 }
 
+GtkCssValue *
+gtk_css_font_variations_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *result, *coord;
+  const char *name;
+  guint i, n;
+
+  if (gtk_css_deserializer_read_uint32 (deserializer))
+    return gtk_css_font_variations_value_new_default ();
+
+  n = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  result = gtk_css_font_variations_value_new_empty ();
+
+  for (i = 0; i < n; i++)
+    {
+      name = gtk_css_deserializer_read_string (deserializer);
+      coord = gtk_css_deserializer_read_number (deserializer);
+      if (name == NULL || coord == NULL || !is_valid_opentype_tag (name))
+        {
+          g_clear_pointer (&coord, _gtk_css_value_unref);
+          gtk_css_deserializer_fail (deserializer);
+          break;
+        }
+
+      gtk_css_font_variations_value_add_axis (result, name, coord);
+    }
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      _gtk_css_value_unref (result);
+      return NULL;
+    }
+
+  return result;
+}
+
 char *
 gtk_css_font_variations_value_get_variations (GtkCssValue *value)
 {
@@ -28,6 +28,7 @@ G_BEGIN_DECLS
 GtkCssValue *   gtk_css_font_variations_value_new_default    (void);
 
 GtkCssValue *   gtk_css_font_variations_value_parse          (GtkCssParser *parser);
+GtkCssValue *   gtk_css_font_variations_value_deserialize    (GtkCssDeserializer *deserializer);
 
 char *          gtk_css_font_variations_value_get_variations (GtkCssValue  *value);
 
@@ -19,6 +19,7 @@
 
 #include "gtkcssiconthemevalueprivate.h"
 
+#include "gtkcssserializerprivate.h"
 #include "gtkicontheme.h"
 #include "gtksettingsprivate.h"
 #include "gtkstyleproviderprivate.h"
@@ -110,6 +111,17 @@ gtk_css_value_icon_theme_print (const GtkCssValue *icon_theme,
   g_string_append (string, "initial");
 }
 
+static void
+gtk_css_value_icon_theme_serialize (const GtkCssValue *icon_theme,
+                                    GtkCssSerializer  *serializer)
+{
+  /* Only the default theme, we can't recreate custom ones */
+  if (icon_theme->icontheme)
+    gtk_css_serializer_fail (serializer);
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_ICON_THEME);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_ICON_THEME = {
   gtk_css_value_icon_theme_free,
   gtk_css_value_icon_theme_compute,
@@ -117,7 +129,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_ICON_THEME = {
   gtk_css_value_icon_theme_transition,
   NULL,
   NULL,
-  gtk_css_value_icon_theme_print
+  gtk_css_value_icon_theme_print,
+  gtk_css_value_icon_theme_serialize
 };
 
 static GtkCssValue default_icon_theme_value = { &GTK_CSS_VALUE_ICON_THEME, 1, NULL, 0 };
@@ -165,6 +178,12 @@ gtk_css_icon_theme_value_parse (GtkCssParser *parser)
   return result;
 }
 
+GtkCssValue *
+gtk_css_icon_theme_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  return gtk_css_icon_theme_value_new (NULL);
+}
+
 GtkIconTheme *
 gtk_css_icon_theme_value_get_icon_theme (GtkCssValue *value)
 {
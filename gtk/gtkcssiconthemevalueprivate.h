@@ -30,6 +30,7 @@ G_BEGIN_DECLS
 GtkCssValue *   gtk_css_icon_theme_value_new            (GtkIconTheme           *icontheme);
 
 GtkCssValue *   gtk_css_icon_theme_value_parse          (GtkCssParser           *parser);
+GtkCssValue *   gtk_css_icon_theme_value_deserialize    (GtkCssDeserializer     *deserializer);
 
 GtkIconTheme *  gtk_css_icon_theme_value_get_icon_theme (GtkCssValue            *value);
 
@@ -21,6 +21,7 @@
 
 #include "gtkcssimageprivate.h"
 
+#include "gtkcssserializerprivate.h"
 #include "gtkcssstyleprivate.h"
 #include "gtksnapshot.h"
 
@@ -337,6 +338,27 @@ _gtk_css_image_print (GtkCssImage *image,
   klass->print (image, string);
 }
 
+void
+gtk_css_image_serialize (GtkCssImage      *image,
+                         GtkCssSerializer *serializer)
+{
+  GtkCssImageClass *klass;
+
+  g_return_if_fail (GTK_IS_CSS_IMAGE (image));
+  g_return_if_fail (serializer != NULL);
+
+  klass = GTK_CSS_IMAGE_GET_CLASS (image);
+
+  /* Loaded images, win32 theme parts and the like are not stored */
+  if (klass->serialize == NULL)
+    {
+      gtk_css_serializer_fail (serializer);
+      return;
+    }
+
+  klass->serialize (image, serializer);
+}
+
 /* Applies the algorithm outlined in
  * http://dev.w3.org/csswg/css3-images/#default-sizing
  */
@@ -25,6 +25,7 @@
 #include "gtkcssimagecrossfadeprivate.h"
 
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 G_DEFINE_TYPE (GtkCssImageCrossFade, _gtk_css_image_cross_fade, GTK_TYPE_CSS_IMAGE)
 
@@ -227,6 +228,18 @@ gtk_css_image_cross_fade_print (GtkCssImage *image,
   g_string_append (string, ")");
 }
 
+static void
+gtk_css_image_cross_fade_serialize (GtkCssImage      *image,
+                                    GtkCssSerializer *serializer)
+{
+  GtkCssImageCrossFade *cross_fade = GTK_CSS_IMAGE_CROSS_FADE (image);
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_CROSS_FADE);
+  gtk_css_serializer_write_double (serializer, cross_fade->progress);
+  gtk_css_serializer_write_image (serializer, cross_fade->start);
+  gtk_css_serializer_write_image (serializer, cross_fade->end);
+}
+
 static GtkCssImage *
 gtk_css_image_cross_fade_compute (GtkCssImage      *image,
                                   guint             property_id,
@@ -282,6 +295,7 @@ _gtk_css_image_cross_fade_class_init (GtkCssImageCrossFadeClass *klass)
   image_class->get_dynamic_image = gtk_css_image_cross_fade_get_dynamic_image;
   image_class->parse = gtk_css_image_cross_fade_parse;
   image_class->print = gtk_css_image_cross_fade_print;
+  image_class->serialize = gtk_css_image_cross_fade_serialize;
 
   object_class->dispose = gtk_css_image_cross_fade_dispose;
 }
@@ -311,3 +325,25 @@ _gtk_css_image_cross_fade_new (GtkCssImage *start,
   return GTK_CSS_IMAGE (cross_fade);
 }
 
+GtkCssImage *
+gtk_css_image_cross_fade_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImageCrossFade *cross_fade;
+  double progress;
+
+  progress = gtk_css_deserializer_read_double (deserializer);
+  if (!(progress >= 0.0 && progress <= 1.0))
+    return NULL;
+
+  cross_fade = g_object_new (GTK_TYPE_CSS_IMAGE_CROSS_FADE, NULL);
+  cross_fade->progress = progress;
+  cross_fade->start = gtk_css_deserializer_read_image (deserializer);
+  cross_fade->end = gtk_css_deserializer_read_image (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      g_object_unref (cross_fade);
+      return NULL;
+    }
+
+  return GTK_CSS_IMAGE (cross_fade);
+}
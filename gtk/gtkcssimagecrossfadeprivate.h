@@ -53,6 +53,7 @@ GType          _gtk_css_image_cross_fade_get_type             (void) G_GNUC_CONS
 GtkCssImage *  _gtk_css_image_cross_fade_new                  (GtkCssImage      *start,
                                                                GtkCssImage      *end,
                                                                double            progress);
+GtkCssImage *  gtk_css_image_cross_fade_deserialize           (GtkCssDeserializer *deserializer);
 
 G_END_DECLS
 
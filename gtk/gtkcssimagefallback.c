@@ -22,6 +22,7 @@
 #include "gtkcssimagefallbackprivate.h"
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkcssrgbavalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 #include "gtkstyleproviderprivate.h"
 
@@ -108,6 +109,22 @@ gtk_css_image_fallback_print (GtkCssImage *image,
   g_string_append (string, ")");
 }
 
+static void
+gtk_css_image_fallback_serialize (GtkCssImage      *image,
+                                  GtkCssSerializer *serializer)
+{
+  GtkCssImageFallback *fallback = GTK_CSS_IMAGE_FALLBACK (image);
+  int i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_FALLBACK);
+  gtk_css_serializer_write_uint32 (serializer, fallback->n_images);
+  for (i = 0; i < fallback->n_images; i++)
+    gtk_css_serializer_write_image (serializer, fallback->images[i]);
+  gtk_css_serializer_write_uint32 (serializer, fallback->color != NULL);
+  if (fallback->color)
+    gtk_css_serializer_write_value (serializer, fallback->color);
+}
+
 static void
 gtk_css_image_fallback_dispose (GObject *object)
 {
@@ -265,6 +282,7 @@ _gtk_css_image_fallback_class_init (GtkCssImageFallbackClass *klass)
   image_class->parse = gtk_css_image_fallback_parse;
   image_class->compute = gtk_css_image_fallback_compute;
   image_class->print = gtk_css_image_fallback_print;
+  image_class->serialize = gtk_css_image_fallback_serialize;
   image_class->equal = gtk_css_image_fallback_equal;
 
   object_class->dispose = gtk_css_image_fallback_dispose;
@@ -275,3 +293,40 @@ _gtk_css_image_fallback_init (GtkCssImageFallback *image_fallback)
 {
   image_fallback->used = -1;
 }
+
+GtkCssImage *
+gtk_css_image_fallback_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImageFallback *fallback;
+  guint32 i, n_images;
+
+  n_images = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  if (n_images > G_MAXINT || gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+
+  fallback = g_object_new (GTK_TYPE_CSS_IMAGE_FALLBACK, NULL);
+  fallback->images = g_new0 (GtkCssImage *, n_images);
+
+  for (i = 0; i < n_images; i++)
+    {
+      fallback->images[i] = gtk_css_deserializer_read_image (deserializer);
+      if (fallback->images[i] == NULL)
+        goto fail;
+      fallback->n_images++;
+    }
+
+  if (gtk_css_deserializer_read_uint32 (deserializer))
+    {
+      fallback->color = gtk_css_deserializer_read_color (deserializer);
+      if (fallback->color == NULL)
+        goto fail;
+    }
+  else if (n_images == 0)
+    goto fail;
+
+  return GTK_CSS_IMAGE (fallback);
+
+fail:
+  g_object_unref (fallback);
+  return NULL;
+}
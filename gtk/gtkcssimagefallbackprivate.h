@@ -54,6 +54,8 @@ struct _GtkCssImageFallbackClass
 
 GType          _gtk_css_image_fallback_get_type             (void) G_GNUC_CONST;
 
+GtkCssImage *  gtk_css_image_fallback_deserialize           (GtkCssDeserializer *deserializer);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_IMAGE_FALLBACK_PRIVATE_H__ */
@@ -25,6 +25,7 @@
 
 #include "gtkcssiconthemevalueprivate.h"
 #include "gtkcssrgbavalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtksettingsprivate.h"
 #include "gtksnapshot.h"
 #include "gtkstyleproviderprivate.h"
@@ -164,6 +165,16 @@ gtk_css_image_icon_theme_print (GtkCssImage *image,
   g_string_append (string, ")");
 }
 
+static void
+gtk_css_image_icon_theme_serialize (GtkCssImage      *image,
+                                    GtkCssSerializer *serializer)
+{
+  GtkCssImageIconTheme *icon_theme = GTK_CSS_IMAGE_ICON_THEME (image);
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_ICON_THEME);
+  gtk_css_serializer_write_string (serializer, icon_theme->name);
+}
+
 static GtkCssImage *
 gtk_css_image_icon_theme_compute (GtkCssImage      *image,
                                   guint             property_id,
@@ -216,6 +227,7 @@ _gtk_css_image_icon_theme_class_init (GtkCssImageIconThemeClass *klass)
   image_class->snapshot = gtk_css_image_icon_theme_snapshot;
   image_class->parse = gtk_css_image_icon_theme_parse;
   image_class->print = gtk_css_image_icon_theme_print;
+  image_class->serialize = gtk_css_image_icon_theme_serialize;
   image_class->compute = gtk_css_image_icon_theme_compute;
   image_class->equal = gtk_css_image_icon_theme_equal;
 
@@ -231,3 +243,19 @@ _gtk_css_image_icon_theme_init (GtkCssImageIconTheme *icon_theme)
   icon_theme->cached_texture = NULL;
 }
 
+
+GtkCssImage *
+gtk_css_image_icon_theme_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImageIconTheme *icon_theme;
+  const char *name;
+
+  name = gtk_css_deserializer_read_string (deserializer);
+  if (name == NULL)
+    return NULL;
+
+  icon_theme = g_object_new (GTK_TYPE_CSS_IMAGE_ICON_THEME, NULL);
+  icon_theme->name = g_strdup (name);
+
+  return GTK_CSS_IMAGE (icon_theme);
+}
@@ -59,6 +59,8 @@ struct _GtkCssImageIconThemeClass
 
 GType          _gtk_css_image_icon_theme_get_type             (void) G_GNUC_CONST;
 
+GtkCssImage *  gtk_css_image_icon_theme_deserialize           (GtkCssDeserializer *deserializer);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_IMAGE_ICON_THEME_PRIVATE_H__ */
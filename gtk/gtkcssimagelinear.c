@@ -27,6 +27,7 @@
 #include "gtkcssnumbervalueprivate.h"
 #include "gtkcssrgbavalueprivate.h"
 #include "gtkcssprovider.h"
+#include "gtkcssserializerprivate.h"
 
 G_DEFINE_TYPE (GtkCssImageLinear, _gtk_css_image_linear, GTK_TYPE_CSS_IMAGE)
 
@@ -444,6 +445,28 @@ gtk_css_image_linear_print (GtkCssImage *image,
   g_string_append (string, ")");
 }
 
+static void
+gtk_css_image_linear_serialize (GtkCssImage      *image,
+                                GtkCssSerializer *serializer)
+{
+  GtkCssImageLinear *linear = GTK_CSS_IMAGE_LINEAR (image);
+  guint i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_LINEAR);
+  gtk_css_serializer_write_uint32 (serializer, linear->repeating);
+  gtk_css_serializer_write_uint32 (serializer, linear->side);
+  gtk_css_serializer_write_value (serializer, linear->angle);
+  gtk_css_serializer_write_uint32 (serializer, linear->stops->len);
+  for (i = 0; i < linear->stops->len; i++)
+    {
+      GtkCssImageLinearColorStop *stop;
+
+      stop = &g_array_index (linear->stops, GtkCssImageLinearColorStop, i);
+      gtk_css_serializer_write_value (serializer, stop->color);
+      gtk_css_serializer_write_value (serializer, stop->offset);
+    }
+}
+
 static GtkCssImage *
 gtk_css_image_linear_compute (GtkCssImage      *image,
                               guint             property_id,
@@ -624,6 +647,7 @@ _gtk_css_image_linear_class_init (GtkCssImageLinearClass *klass)
   image_class->snapshot = gtk_css_image_linear_snapshot;
   image_class->parse = gtk_css_image_linear_parse;
   image_class->print = gtk_css_image_linear_print;
+  image_class->serialize = gtk_css_image_linear_serialize;
   image_class->compute = gtk_css_image_linear_compute;
   image_class->equal = gtk_css_image_linear_equal;
   image_class->transition = gtk_css_image_linear_transition;
@@ -648,3 +672,47 @@ _gtk_css_image_linear_init (GtkCssImageLinear *linear)
   g_array_set_clear_func (linear->stops, gtk_css_image_clear_color_stop);
 }
 
+GtkCssImage *
+gtk_css_image_linear_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImageLinear *linear;
+  guint32 repeating, side, i, n_stops;
+
+  linear = g_object_new (GTK_TYPE_CSS_IMAGE_LINEAR, NULL);
+
+  repeating = gtk_css_deserializer_read_uint32 (deserializer);
+  side = gtk_css_deserializer_read_uint32 (deserializer);
+  linear->angle = gtk_css_deserializer_read_number0 (deserializer);
+  if (repeating > 1 ||
+      side & ~((1 << GTK_CSS_TOP) | (1 << GTK_CSS_RIGHT) | (1 << GTK_CSS_BOTTOM) | (1 << GTK_CSS_LEFT)) ||
+      (side == 0) != (linear->angle != NULL))
+    goto fail;
+  linear->repeating = repeating;
+  linear->side = side;
+
+  n_stops = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  if (n_stops < 2)
+    goto fail;
+
+  for (i = 0; i < n_stops; i++)
+    {
+      GtkCssImageLinearColorStop stop;
+
+      stop.color = gtk_css_deserializer_read_color (deserializer);
+      stop.offset = gtk_css_deserializer_read_number0 (deserializer);
+      if (stop.color == NULL || gtk_css_deserializer_has_failed (deserializer))
+        {
+          g_clear_pointer (&stop.color, _gtk_css_value_unref);
+          g_clear_pointer (&stop.offset, _gtk_css_value_unref);
+          goto fail;
+        }
+
+      g_array_append_val (linear->stops, stop);
+    }
+
+  return GTK_CSS_IMAGE (linear);
+
+fail:
+  g_object_unref (linear);
+  return NULL;
+}
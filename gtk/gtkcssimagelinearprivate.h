@@ -58,6 +58,8 @@ struct _GtkCssImageLinearClass
 
 GType          _gtk_css_image_linear_get_type             (void) G_GNUC_CONST;
 
+GtkCssImage *  gtk_css_image_linear_deserialize           (GtkCssDeserializer *deserializer);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_IMAGE_LINEAR_PRIVATE_H__ */
@@ -88,6 +88,9 @@ struct _GtkCssImageClass
   /* print to CSS */
   void         (* print)                           (GtkCssImage                *image,
                                                     GString                    *string);
+  /* write for gtk_css_deserializer_read_image() (optional) */
+  void         (* serialize)                       (GtkCssImage                *image,
+                                                    GtkCssSerializer           *serializer);
 };
 
 GType          _gtk_css_image_get_type             (void) G_GNUC_CONST;
@@ -125,6 +128,8 @@ GtkCssImage *  gtk_css_image_get_dynamic_image     (GtkCssImage                *
                                                     gint64                      monotonic_time);
 void           _gtk_css_image_print                (GtkCssImage                *image,
                                                     GString                    *string);
+void           gtk_css_image_serialize             (GtkCssImage                *image,
+                                                    GtkCssSerializer           *serializer);
 
 void           _gtk_css_image_get_concrete_size    (GtkCssImage                *image,
                                                     double                      specified_width,
@@ -28,6 +28,7 @@
 #include "gtkcsspositionvalueprivate.h"
 #include "gtkcssrgbavalueprivate.h"
 #include "gtkcssprovider.h"
+#include "gtkcssserializerprivate.h"
 
 G_DEFINE_TYPE (GtkCssImageRadial, _gtk_css_image_radial, GTK_TYPE_CSS_IMAGE)
 
@@ -463,6 +464,31 @@ gtk_css_image_radial_print (GtkCssImage *image,
   g_string_append (string, ")");
 }
 
+static void
+gtk_css_image_radial_serialize (GtkCssImage      *image,
+                                GtkCssSerializer *serializer)
+{
+  GtkCssImageRadial *radial = GTK_CSS_IMAGE_RADIAL (image);
+  guint i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_RADIAL);
+  gtk_css_serializer_write_uint32 (serializer, radial->repeating);
+  gtk_css_serializer_write_uint32 (serializer, radial->circle);
+  gtk_css_serializer_write_uint32 (serializer, radial->size);
+  gtk_css_serializer_write_value (serializer, radial->sizes[0]);
+  gtk_css_serializer_write_value (serializer, radial->sizes[1]);
+  gtk_css_serializer_write_value (serializer, radial->position);
+  gtk_css_serializer_write_uint32 (serializer, radial->stops->len);
+  for (i = 0; i < radial->stops->len; i++)
+    {
+      GtkCssImageRadialColorStop *stop;
+
+      stop = &g_array_index (radial->stops, GtkCssImageRadialColorStop, i);
+      gtk_css_serializer_write_value (serializer, stop->color);
+      gtk_css_serializer_write_value (serializer, stop->offset);
+    }
+}
+
 static GtkCssImage *
 gtk_css_image_radial_compute (GtkCssImage      *image,
                               guint             property_id,
@@ -677,6 +703,7 @@ _gtk_css_image_radial_class_init (GtkCssImageRadialClass *klass)
   image_class->snapshot = gtk_css_image_radial_snapshot;
   image_class->parse = gtk_css_image_radial_parse;
   image_class->print = gtk_css_image_radial_print;
+  image_class->serialize = gtk_css_image_radial_serialize;
   image_class->compute = gtk_css_image_radial_compute;
   image_class->transition = gtk_css_image_radial_transition;
   image_class->equal = gtk_css_image_radial_equal;
@@ -701,3 +728,52 @@ _gtk_css_image_radial_init (GtkCssImageRadial *radial)
   g_array_set_clear_func (radial->stops, gtk_css_image_clear_color_stop);
 }
 
+GtkCssImage *
+gtk_css_image_radial_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImageRadial *radial;
+  guint32 repeating, circle, size, i, n_stops;
+
+  radial = g_object_new (GTK_TYPE_CSS_IMAGE_RADIAL, NULL);
+
+  repeating = gtk_css_deserializer_read_uint32 (deserializer);
+  circle = gtk_css_deserializer_read_uint32 (deserializer);
+  size = gtk_css_deserializer_read_uint32 (deserializer);
+  radial->sizes[0] = gtk_css_deserializer_read_number0 (deserializer);
+  radial->sizes[1] = gtk_css_deserializer_read_number0 (deserializer);
+  radial->position = gtk_css_deserializer_read_value_of_type (deserializer, GTK_CSS_SERIALIZED_VALUE_POSITION);
+  if (radial->position == NULL ||
+      repeating > 1 || circle > 1 || size > GTK_CSS_FARTHEST_CORNER ||
+      (size == GTK_CSS_EXPLICIT_SIZE && radial->sizes[0] == NULL) ||
+      (size == GTK_CSS_EXPLICIT_SIZE && !circle && radial->sizes[1] == NULL))
+    goto fail;
+  radial->repeating = repeating;
+  radial->circle = circle;
+  radial->size = size;
+
+  n_stops = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  if (n_stops < 2)
+    goto fail;
+
+  for (i = 0; i < n_stops; i++)
+    {
+      GtkCssImageRadialColorStop stop;
+
+      stop.color = gtk_css_deserializer_read_color (deserializer);
+      stop.offset = gtk_css_deserializer_read_number0 (deserializer);
+      if (stop.color == NULL || gtk_css_deserializer_has_failed (deserializer))
+        {
+          g_clear_pointer (&stop.color, _gtk_css_value_unref);
+          g_clear_pointer (&stop.offset, _gtk_css_value_unref);
+          goto fail;
+        }
+
+      g_array_append_val (radial->stops, stop);
+    }
+
+  return GTK_CSS_IMAGE (radial);
+
+fail:
+  g_object_unref (radial);
+  return NULL;
+}
@@ -68,6 +68,8 @@ struct _GtkCssImageRadialClass
 
 GType          _gtk_css_image_radial_get_type             (void) G_GNUC_CONST;
 
+GtkCssImage *  gtk_css_image_radial_deserialize           (GtkCssDeserializer *deserializer);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_IMAGE_RADIAL_PRIVATE_H__ */
@@ -23,6 +23,7 @@
 #include "gtkcssimageprivate.h"
 #include "gtkcsspalettevalueprivate.h"
 #include "gtkcssrgbavalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkiconthemeprivate.h"
 #include "gdkpixbufutilsprivate.h"
 
@@ -50,6 +51,22 @@ gtk_css_image_recolor_print (GtkCssImage *image,
   g_string_append (string, ")");
 }
 
+static void
+gtk_css_image_recolor_serialize (GtkCssImage      *image,
+                                 GtkCssSerializer *serializer)
+{
+  GtkCssImageRecolor *recolor = GTK_CSS_IMAGE_RECOLOR (image);
+  char *uri;
+
+  uri = g_file_get_uri (recolor->file);
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_RECOLOR);
+  gtk_css_serializer_write_string (serializer, uri);
+  gtk_css_serializer_write_uint32 (serializer, recolor->palette != NULL);
+  if (recolor->palette)
+    gtk_css_serializer_write_value (serializer, recolor->palette);
+  g_free (uri);
+}
+
 static void
 gtk_css_image_recolor_dispose (GObject *object)
 {
@@ -321,6 +338,7 @@ _gtk_css_image_recolor_class_init (GtkCssImageRecolorClass *klass)
   image_class->snapshot = gtk_css_image_recolor_snapshot;
   image_class->parse = gtk_css_image_recolor_parse;
   image_class->print = gtk_css_image_recolor_print;
+  image_class->serialize = gtk_css_image_recolor_serialize;
 
   object_class->dispose = gtk_css_image_recolor_dispose;
 }
@@ -329,3 +347,31 @@ static void
 _gtk_css_image_recolor_init (GtkCssImageRecolor *image_recolor)
 {
 }
+
+GtkCssImage *
+gtk_css_image_recolor_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImageRecolor *recolor;
+  const char *uri;
+  GtkCssValue *palette = NULL;
+
+  uri = gtk_css_deserializer_read_string (deserializer);
+  if (uri == NULL)
+    return NULL;
+
+  if (gtk_css_deserializer_read_uint32 (deserializer))
+    {
+      palette = gtk_css_deserializer_read_value_of_type (deserializer, GTK_CSS_SERIALIZED_VALUE_PALETTE);
+      if (palette == NULL)
+        return NULL;
+    }
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+
+  recolor = g_object_new (GTK_TYPE_CSS_IMAGE_RECOLOR, NULL);
+  recolor->file = g_file_new_for_uri (uri);
+  recolor->palette = palette;
+
+  return GTK_CSS_IMAGE (recolor);
+}
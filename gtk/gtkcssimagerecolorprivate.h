@@ -55,6 +55,8 @@ struct _GtkCssImageRecolorClass
 
 GType          _gtk_css_image_recolor_get_type             (void) G_GNUC_CONST;
 
+GtkCssImage *  gtk_css_image_recolor_deserialize           (GtkCssDeserializer *deserializer);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_IMAGE_RECOLOR_PRIVATE_H__ */
@@ -21,6 +21,7 @@
 
 #include "gtkcssimagescaledprivate.h"
 
+#include "gtkcssserializerprivate.h"
 #include "gtkstyleproviderprivate.h"
 
 G_DEFINE_TYPE (GtkCssImageScaled, _gtk_css_image_scaled, GTK_TYPE_CSS_IMAGE)
@@ -79,6 +80,22 @@ gtk_css_image_scaled_print (GtkCssImage *image,
   g_string_append (string, ")");
 }
 
+static void
+gtk_css_image_scaled_serialize (GtkCssImage      *image,
+                                GtkCssSerializer *serializer)
+{
+  GtkCssImageScaled *scaled = GTK_CSS_IMAGE_SCALED (image);
+  int i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_SCALED);
+  gtk_css_serializer_write_uint32 (serializer, scaled->n_images);
+  for (i = 0; i < scaled->n_images; i++)
+    {
+      gtk_css_serializer_write_image (serializer, scaled->images[i]);
+      gtk_css_serializer_write_uint32 (serializer, scaled->scales[i]);
+    }
+}
+
 static void
 gtk_css_image_scaled_dispose (GObject *object)
 {
@@ -230,6 +247,7 @@ _gtk_css_image_scaled_class_init (GtkCssImageScaledClass *klass)
   image_class->parse = gtk_css_image_scaled_parse;
   image_class->compute = gtk_css_image_scaled_compute;
   image_class->print = gtk_css_image_scaled_print;
+  image_class->serialize = gtk_css_image_scaled_serialize;
 
   object_class->dispose = gtk_css_image_scaled_dispose;
 }
@@ -238,3 +256,39 @@ static void
 _gtk_css_image_scaled_init (GtkCssImageScaled *image_scaled)
 {
 }
+
+GtkCssImage *
+gtk_css_image_scaled_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImageScaled *scaled;
+  guint32 i, n_images;
+
+  n_images = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  if (n_images == 0 || n_images > G_MAXINT)
+    return NULL;
+
+  scaled = g_object_new (GTK_TYPE_CSS_IMAGE_SCALED, NULL);
+  scaled->images = g_new0 (GtkCssImage *, n_images);
+  scaled->scales = g_new0 (int, n_images);
+
+  for (i = 0; i < n_images; i++)
+    {
+      guint32 scale;
+
+      scaled->images[i] = gtk_css_deserializer_read_image (deserializer);
+      if (scaled->images[i] == NULL)
+        goto fail;
+      scaled->n_images++;
+
+      scale = gtk_css_deserializer_read_uint32 (deserializer);
+      if (scale == 0 || scale > G_MAXINT)
+        goto fail;
+      scaled->scales[i] = scale;
+    }
+
+  return GTK_CSS_IMAGE (scaled);
+
+fail:
+  g_object_unref (scaled);
+  return NULL;
+}
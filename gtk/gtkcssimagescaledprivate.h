@@ -50,6 +50,8 @@ struct _GtkCssImageScaledClass
 
 GType          _gtk_css_image_scaled_get_type             (void) G_GNUC_CONST;
 
+GtkCssImage *  gtk_css_image_scaled_deserialize           (GtkCssDeserializer *deserializer);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_IMAGE_SCALED_PRIVATE_H__ */
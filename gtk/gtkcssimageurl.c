@@ -25,6 +25,7 @@
 
 #include "gtkcssimageinvalidprivate.h"
 #include "gtkcssimagepaintableprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkstyleproviderprivate.h"
 
 G_DEFINE_TYPE (GtkCssImageUrl, _gtk_css_image_url, GTK_TYPE_CSS_IMAGE)
@@ -181,6 +182,20 @@ gtk_css_image_url_print (GtkCssImage *image,
   _gtk_css_image_print (gtk_css_image_url_load_image (url, NULL), string);
 }
 
+static void
+gtk_css_image_url_serialize (GtkCssImage      *image,
+                             GtkCssSerializer *serializer)
+{
+  GtkCssImageUrl *url = GTK_CSS_IMAGE_URL (image);
+  char *uri;
+
+  /* Only the url, the image is loaded when it is needed */
+  uri = g_file_get_uri (url->file);
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_URL);
+  gtk_css_serializer_write_string (serializer, uri);
+  g_free (uri);
+}
+
 static void
 gtk_css_image_url_dispose (GObject *object)
 {
@@ -205,6 +220,7 @@ _gtk_css_image_url_class_init (GtkCssImageUrlClass *klass)
   image_class->snapshot = gtk_css_image_url_snapshot;
   image_class->parse = gtk_css_image_url_parse;
   image_class->print = gtk_css_image_url_print;
+  image_class->serialize = gtk_css_image_url_serialize;
   image_class->equal = gtk_css_image_url_equal;
   image_class->is_invalid = gtk_css_image_url_is_invalid;
 
@@ -216,3 +232,18 @@ _gtk_css_image_url_init (GtkCssImageUrl *image_url)
 {
 }
 
+GtkCssImage *
+gtk_css_image_url_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImageUrl *url;
+  const char *uri;
+
+  uri = gtk_css_deserializer_read_string (deserializer);
+  if (uri == NULL)
+    return NULL;
+
+  url = g_object_new (GTK_TYPE_CSS_IMAGE_URL, NULL);
+  url->file = g_file_new_for_uri (uri);
+
+  return GTK_CSS_IMAGE (url);
+}
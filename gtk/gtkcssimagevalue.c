@@ -20,6 +20,7 @@
 #include "gtkcssimagevalueprivate.h"
 
 #include "gtkcssimagecrossfadeprivate.h"
+#include "gtkcssserializerprivate.h"
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
@@ -122,6 +123,14 @@ gtk_css_value_image_print (const GtkCssValue *value,
     g_string_append (string, "none");
 }
 
+static void
+gtk_css_value_image_serialize (const GtkCssValue *value,
+                               GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_IMAGE);
+  gtk_css_serializer_write_image (serializer, value->image);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_IMAGE = {
   gtk_css_value_image_free,
   gtk_css_value_image_compute,
@@ -129,7 +138,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_IMAGE = {
   gtk_css_value_image_transition,
   gtk_css_value_image_is_dynamic,
   gtk_css_value_image_get_dynamic_value,
-  gtk_css_value_image_print
+  gtk_css_value_image_print,
+  gtk_css_value_image_serialize
 };
 
 GtkCssValue *
@@ -155,3 +165,14 @@ _gtk_css_image_value_get_image (const GtkCssValue *value)
   return value->image;
 }
 
+GtkCssValue *
+gtk_css_image_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssImage *image;
+
+  image = gtk_css_deserializer_read_image (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+
+  return _gtk_css_image_value_new (image);
+}
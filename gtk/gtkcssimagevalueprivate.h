@@ -26,6 +26,7 @@
 G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_image_value_new           (GtkCssImage         *image);
+GtkCssValue *   gtk_css_image_value_deserialize    (GtkCssDeserializer  *deserializer);
 
 GtkCssImage *   _gtk_css_image_value_get_image     (const GtkCssValue   *image);
 
@@ -20,6 +20,7 @@
 #include "gtkcssinheritvalueprivate.h"
 
 #include "gtkcssinitialvalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkstylecontextprivate.h"
 
 struct _GtkCssValue {
@@ -77,6 +78,13 @@ gtk_css_value_inherit_print (const GtkCssValue *value,
   g_string_append (string, "inherit");
 }
 
+static void
+gtk_css_value_inherit_serialize (const GtkCssValue *value,
+                                 GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_INHERIT);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_INHERIT = {
   gtk_css_value_inherit_free,
   gtk_css_value_inherit_compute,
@@ -84,7 +92,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_INHERIT = {
   gtk_css_value_inherit_transition,
   NULL,
   NULL,
-  gtk_css_value_inherit_print
+  gtk_css_value_inherit_print,
+  gtk_css_value_inherit_serialize
 };
 
 static GtkCssValue inherit = { &GTK_CSS_VALUE_INHERIT, 1 };
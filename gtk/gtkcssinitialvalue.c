@@ -21,6 +21,7 @@
 
 #include "gtkcssarrayvalueprivate.h"
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcssstringvalueprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtksettingsprivate.h"
@@ -101,6 +102,13 @@ gtk_css_value_initial_print (const GtkCssValue *value,
   g_string_append (string, "initial");
 }
 
+static void
+gtk_css_value_initial_serialize (const GtkCssValue *value,
+                                 GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_INITIAL);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_INITIAL = {
   gtk_css_value_initial_free,
   gtk_css_value_initial_compute,
@@ -108,7 +116,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_INITIAL = {
   gtk_css_value_initial_transition,
   NULL,
   NULL,
-  gtk_css_value_initial_print
+  gtk_css_value_initial_print,
+  gtk_css_value_initial_serialize
 };
 
 static GtkCssValue initial = { &GTK_CSS_VALUE_INITIAL, 1 };
@@ -20,6 +20,7 @@
 #include "gtkcsskeyframesprivate.h"
 
 #include "gtkcssarrayvalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcssshorthandpropertyprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkstylepropertyprivate.h"
@@ -434,6 +435,104 @@ _gtk_css_keyframes_print (GtkCssKeyframes *keyframes,
   g_free (sorted);
 }
 
+/* Properties are stored by name, so the data does not depend on
+ * the order properties are registered in. */
+void
+gtk_css_keyframes_serialize (GtkCssKeyframes  *keyframes,
+                             GtkCssSerializer *serializer)
+{
+  guint k, p;
+
+  gtk_css_serializer_write_uint32 (serializer, keyframes->n_keyframes);
+  for (k = 0; k < keyframes->n_keyframes; k++)
+    gtk_css_serializer_write_double (serializer, keyframes->keyframe_progress[k]);
+
+  gtk_css_serializer_write_uint32 (serializer, keyframes->n_properties);
+  for (p = 0; p < keyframes->n_properties; p++)
+    {
+      GtkCssStyleProperty *property = _gtk_css_style_property_lookup_by_id (keyframes->property_ids[p]);
+
+      gtk_css_serializer_write_string (serializer, _gtk_style_property_get_name (GTK_STYLE_PROPERTY (property)));
+    }
+
+  for (k = 0; k < keyframes->n_keyframes; k++)
+    {
+      for (p = 0; p < keyframes->n_properties; p++)
+        gtk_css_serializer_write_value (serializer, KEYFRAMES_VALUE (keyframes, k, p));
+    }
+}
+
+GtkCssKeyframes *
+gtk_css_keyframes_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssKeyframes *keyframes;
+  guint32 k, p, n_keyframes, n_properties;
+  guint *property_ids = NULL;
+
+  keyframes = gtk_css_keyframes_alloc ();
+
+  n_keyframes = gtk_css_deserializer_read_count (deserializer, sizeof (double));
+  if (n_keyframes < 2)
+    goto fail;
+  for (k = 0; k < n_keyframes; k++)
+    {
+      double progress = gtk_css_deserializer_read_double (deserializer);
+
+      /* must be sorted and unique, or adding them would reorder them */
+      if (!(progress >= 0.0 && progress <= 1.0) ||
+          (k > 0 && progress <= keyframes->keyframe_progress[k - 1]) ||
+          gtk_css_deserializer_has_failed (deserializer))
+        goto fail;
+
+      gtk_css_keyframes_add_keyframe (keyframes, progress);
+    }
+
+  n_properties = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  property_ids = g_new (guint, n_properties);
+  for (p = 0; p < n_properties; p++)
+    {
+      GtkStyleProperty *property;
+      const char *name;
+
+      name = gtk_css_deserializer_read_string (deserializer);
+      if (name == NULL)
+        goto fail;
+
+      property = _gtk_style_property_lookup (name);
+      if (!GTK_IS_CSS_STYLE_PROPERTY (property) ||
+          !_gtk_css_style_property_is_animated (GTK_CSS_STYLE_PROPERTY (property)))
+        goto fail;
+
+      property_ids[p] = _gtk_css_style_property_get_id (GTK_CSS_STYLE_PROPERTY (property));
+      gtk_css_keyframes_lookup_property (keyframes, property_ids[p]);
+    }
+  if (keyframes->n_properties != n_properties)
+    goto fail;
+
+  for (k = 0; k < n_keyframes; k++)
+    {
+      for (p = 0; p < n_properties; p++)
+        {
+          /* the index is final now that all properties were added */
+          guint i = gtk_css_keyframes_lookup_property (keyframes, property_ids[p]);
+
+          KEYFRAMES_VALUE (keyframes, k, i) = gtk_css_deserializer_read_value0 (deserializer);
+        }
+    }
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    goto fail;
+
+  g_free (property_ids);
+
+  return keyframes;
+
+fail:
+  g_free (property_ids);
+  _gtk_css_keyframes_unref (keyframes);
+  return NULL;
+}
+
 GtkCssKeyframes *
 _gtk_css_keyframes_compute (GtkCssKeyframes  *keyframes,
                             GtkStyleProvider *provider,
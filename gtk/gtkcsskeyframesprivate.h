@@ -35,6 +35,9 @@ void                _gtk_css_keyframes_unref                  (GtkCssKeyframes
 
 void                _gtk_css_keyframes_print                  (GtkCssKeyframes        *keyframes,
                                                                GString                *string);
+void                gtk_css_keyframes_serialize               (GtkCssKeyframes        *keyframes,
+                                                               GtkCssSerializer       *serializer);
+GtkCssKeyframes *   gtk_css_keyframes_deserialize             (GtkCssDeserializer     *deserializer);
 
 GtkCssKeyframes *   _gtk_css_keyframes_compute                (GtkCssKeyframes         *keyframes,
                                                                GtkStyleProvider        *provider,
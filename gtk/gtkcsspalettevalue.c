@@ -22,6 +22,7 @@
 #include "gtkcssiconthemevalueprivate.h"
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkcssrgbavalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
@@ -173,6 +174,30 @@ gtk_css_value_palette_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_value_palette_serialize (const GtkCssValue *value,
+                                 GtkCssSerializer  *serializer)
+{
+  GHashTableIter iter;
+  gpointer name, color;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_PALETTE);
+  if (value == default_palette)
+    {
+      gtk_css_serializer_write_uint32 (serializer, TRUE);
+      return;
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, FALSE);
+  gtk_css_serializer_write_uint32 (serializer, g_hash_table_size (value->colors));
+  g_hash_table_iter_init (&iter, value->colors);
+  while (g_hash_table_iter_next (&iter, &name, &color))
+    {
+      gtk_css_serializer_write_string (serializer, name);
+      gtk_css_serializer_write_value (serializer, color);
+    }
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_PALETTE = {
   gtk_css_value_palette_free,
   gtk_css_value_palette_compute,
@@ -180,7 +205,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_PALETTE = {
   gtk_css_value_palette_transition,
   NULL,
   NULL,
-  gtk_css_value_palette_print
+  gtk_css_value_palette_print,
+  gtk_css_value_palette_serialize
 };
 
 static GtkCssValue *
@@ -245,6 +271,41 @@ gtk_css_palette_value_parse (GtkCssParser *parser)
   return result;
 }
 
+GtkCssValue *
+gtk_css_palette_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *result, *color;
+  const char *name;
+  guint i, n_colors;
+
+  if (gtk_css_deserializer_read_uint32 (deserializer))
+    return gtk_css_palette_value_new_default ();
+
+  n_colors = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  result = gtk_css_palette_value_new_empty ();
+
+  for (i = 0; i < n_colors; i++)
+    {
+      name = gtk_css_deserializer_read_string (deserializer);
+      color = gtk_css_deserializer_read_color (deserializer);
+      if (name == NULL || color == NULL)
+        {
+          g_clear_pointer (&color, _gtk_css_value_unref);
+          break;
+        }
+
+      gtk_css_palette_value_add_color (result, name, color);
+    }
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      _gtk_css_value_unref (result);
+      return NULL;
+    }
+
+  return result;
+}
+
 const GdkRGBA *
 gtk_css_palette_value_get_color (GtkCssValue *value,
                                  const char  *name)
@@ -28,6 +28,7 @@ G_BEGIN_DECLS
 GtkCssValue *   gtk_css_palette_value_new_default       (void);
 
 GtkCssValue *   gtk_css_palette_value_parse             (GtkCssParser        *parser);
+GtkCssValue *   gtk_css_palette_value_deserialize       (GtkCssDeserializer  *deserializer);
 
 const GdkRGBA * gtk_css_palette_value_get_color         (GtkCssValue         *value,
                                                          const char          *color_name);
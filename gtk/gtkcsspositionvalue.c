@@ -20,6 +20,7 @@
 #include "gtkcsspositionvalueprivate.h"
 
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
@@ -149,6 +150,15 @@ done:
   _gtk_css_value_unref (center);
 }
 
+static void
+gtk_css_value_position_serialize (const GtkCssValue *position,
+                                  GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_POSITION);
+  gtk_css_serializer_write_value (serializer, position->x);
+  gtk_css_serializer_write_value (serializer, position->y);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_POSITION = {
   gtk_css_value_position_free,
   gtk_css_value_position_compute,
@@ -156,7 +166,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_POSITION = {
   gtk_css_value_position_transition,
   NULL,
   NULL,
-  gtk_css_value_position_print
+  gtk_css_value_position_print,
+  gtk_css_value_position_serialize
 };
 
 GtkCssValue *
@@ -172,6 +183,23 @@ _gtk_css_position_value_new (GtkCssValue *x,
   return result;
 }
 
+GtkCssValue *
+gtk_css_position_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *x, *y;
+
+  x = gtk_css_deserializer_read_number (deserializer);
+  y = gtk_css_deserializer_read_number (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      g_clear_pointer (&x, _gtk_css_value_unref);
+      g_clear_pointer (&y, _gtk_css_value_unref);
+      return NULL;
+    }
+
+  return _gtk_css_position_value_new (x, y);
+}
+
 static GtkCssValue *
 position_value_parse (GtkCssParser *parser, gboolean try)
 {
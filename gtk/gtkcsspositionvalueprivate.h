@@ -30,6 +30,7 @@ GtkCssValue *   _gtk_css_position_value_new           (GtkCssValue            *x
 GtkCssValue *   _gtk_css_position_value_parse         (GtkCssParser           *parser);
 GtkCssValue *   _gtk_css_position_value_try_parse     (GtkCssParser           *parser);
 GtkCssValue *   gtk_css_position_value_parse_spacing  (GtkCssParser           *parser);
+GtkCssValue *   gtk_css_position_value_deserialize    (GtkCssDeserializer     *deserializer);
 
 double          _gtk_css_position_value_get_x         (const GtkCssValue      *position,
                                                        double                  one_hundred_percent);
@@ -32,6 +32,7 @@
 #include "gtkcssparserprivate.h"
 #include "gtkcsssectionprivate.h"
 #include "gtkcssselectorprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcssshorthandpropertyprivate.h"
 #include "gtksettingsprivate.h"
 #include "gtkstyleprovider.h"
@@ -40,6 +41,7 @@
 #include "gtkstyleproviderprivate.h"
 #include "gtkwidgetpath.h"
 #include "gtkbindings.h"
+#include "gtkdebug.h"
 #include "gtkmarshalers.h"
 #include "gtkprivate.h"
 #include "gtkintl.h"
@@ -119,6 +121,11 @@ struct _GtkCssProviderPrivate
   GtkCssSelectorTree *tree;
   GResource *resource;
   gchar *path;
+
+  /* GtkCssCacheSource of all loaded files while parsing a theme that
+   * we want to write to the theme cache */
+  GArray *cache_sources;
+  gboolean cache_invalid;
 };
 
 enum {
@@ -141,6 +148,9 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
                                 GtkCssScanner  *scanner,
                                 GFile          *file,
                                 const char     *data);
+static void
+gtk_css_provider_add_cache_source (GtkCssProvider *provider,
+                                   GFile          *file);
 
 GQuark
 gtk_css_provider_error_quark (void)
@@ -336,6 +346,10 @@ gtk_css_provider_emit_error (GtkCssProvider *provider,
                              GtkCssScanner  *scanner,
                              const GError   *error)
 {
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+
+  priv->cache_invalid = TRUE;
+
   gtk_css_style_provider_emit_error (GTK_STYLE_PROVIDER (provider),
                                      scanner ? scanner->section : NULL,
                                      error);
@@ -901,6 +915,7 @@ parse_color_definition (GtkCssScanner *scanner)
 static gboolean
 parse_binding_set (GtkCssScanner *scanner)
 {
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (scanner->provider);
   GtkBindingSet *binding_set;
   char *name;
 
@@ -912,6 +927,9 @@ parse_binding_set (GtkCssScanner *scanner)
       return FALSE;
     }
 
+  /* Binding sets are global state, the cache can't restore them */
+  priv->cache_invalid = TRUE;
+
   name = _gtk_css_parser_try_ident (scanner->parser, TRUE);
   if (name == NULL)
     {
@@ -1383,8 +1401,12 @@ gtk_css_provider_load_internal (GtkCssProvider *css_provider,
 
   if (text == NULL)
     {
+      GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (css_provider);
       GError *load_error = NULL;
 
+      if (priv->cache_sources)
+        gtk_css_provider_add_cache_source (css_provider, file);
+
       bytes = g_file_load_bytes (file, NULL, NULL, &load_error);
 
       if (bytes)
@@ -1533,6 +1555,23 @@ gtk_css_provider_load_from_path (GtkCssProvider  *css_provider,
   g_object_unref (file);
 }
 
+static GFile *
+gtk_css_resource_file_new (const gchar *resource_path)
+{
+  GFile *file;
+  gchar *uri, *escaped;
+
+  escaped = g_uri_escape_string (resource_path,
+				 G_URI_RESERVED_CHARS_ALLOWED_IN_PATH, FALSE);
+  uri = g_strconcat ("resource://", escaped, NULL);
+  g_free (escaped);
+
+  file = g_file_new_for_uri (uri);
+  g_free (uri);
+
+  return file;
+}
+
 /**
  * gtk_css_provider_load_from_resource:
  * @css_provider: a #GtkCssProvider
@@ -1549,18 +1588,11 @@ gtk_css_provider_load_from_resource (GtkCssProvider *css_provider,
 			             const gchar    *resource_path)
 {
   GFile *file;
-  gchar *uri, *escaped;
 
   g_return_if_fail (GTK_IS_CSS_PROVIDER (css_provider));
   g_return_if_fail (resource_path != NULL);
 
-  escaped = g_uri_escape_string (resource_path,
-				 G_URI_RESERVED_CHARS_ALLOWED_IN_PATH, FALSE);
-  uri = g_strconcat ("resource://", escaped, NULL);
-  g_free (escaped);
-
-  file = g_file_new_for_uri (uri);
-  g_free (uri);
+  file = gtk_css_resource_file_new (resource_path);
 
   gtk_css_provider_load_from_file (css_provider, file);
 
@@ -1707,6 +1739,560 @@ _gtk_css_find_theme (const gchar *name,
   return path;
 }
 
+/* The theme cache
+ *
+ * Parsing a big theme like Adwaita takes a noticeable part of application
+ * startup, so themes loaded by name are written to a cache file in
+ * $XDG_CACHE_HOME/gtk-4.0/css after parsing. The file is written with
+ * GtkCssSerializer, see gtkcssserializer.c, and holds the parsed data:
+ *
+ *  - the GTK version
+ *  - every file that was read, with its size and modification time
+ *  - the names of all properties used by the rulesets
+ *  - the symbolic colors and keyframes
+ *  - the rulesets, as property plus value for every style
+ *  - the selector tree, with the rulesets it matches
+ *
+ * Loading it creates the values and the tree directly, without running
+ * the parser or rebuilding the tree. Checking if a cache is still valid
+ * only needs a stat() per file. Resources have no modification time, so
+ * for those the contents are hashed, which doesn't need a copy.
+ *
+ * Themes that had parsing errors or define binding sets are never cached,
+ * and neither are themes using values that can't be serialized.
+ */
+
+/* Format of the data after the serializer's header, bump when changing */
+#define CSS_CACHE_VERSION 1
+#define CSS_CACHE_GTK_VERSION (GTK_MAJOR_VERSION << 16 | GTK_MINOR_VERSION << 8 | GTK_MICRO_VERSION)
+
+typedef struct {
+  char *uri;
+  guint64 size;
+  guint64 stamp;
+} GtkCssCacheSource;
+
+static gboolean
+gtk_css_provider_cache_is_enabled (void)
+{
+#ifdef VERIFY_TREE
+  /* the rulesets from the cache have no selectors to verify against */
+  return FALSE;
+#else
+  return !gtk_keep_css_sections && !GTK_DEBUG_CHECK (NO_CSS_CACHE);
+#endif
+}
+
+static char *
+gtk_css_provider_get_cache_filename (GFile *file)
+{
+  char *uri, *checksum, *basename, *filename;
+
+  uri = g_file_get_uri (file);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+  basename = g_strconcat (checksum, ".cache", NULL);
+  filename = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "css", basename, NULL);
+
+  g_free (basename);
+  g_free (checksum);
+  g_free (uri);
+
+  return filename;
+}
+
+static gboolean
+gtk_css_provider_get_source_stamp (GFile   *file,
+                                   guint64 *size,
+                                   guint64 *stamp)
+{
+  if (g_file_has_uri_scheme (file, "resource"))
+    {
+      char *uri, *path;
+      GBytes *bytes;
+
+      uri = g_file_get_uri (file);
+      path = g_uri_unescape_string (uri + strlen ("resource://"), NULL);
+      bytes = g_resources_lookup_data (path, 0, NULL);
+      g_free (path);
+      g_free (uri);
+
+      if (bytes == NULL)
+        return FALSE;
+
+      *size = g_bytes_get_size (bytes);
+      *stamp = g_bytes_hash (bytes);
+      g_bytes_unref (bytes);
+    }
+  else
+    {
+      GFileInfo *info;
+
+      info = g_file_query_info (file,
+                                G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                G_FILE_ATTRIBUTE_TIME_MODIFIED ","
+                                G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                                G_FILE_QUERY_INFO_NONE,
+                                NULL, NULL);
+      if (info == NULL)
+        return FALSE;
+
+      *size = g_file_info_get_size (info);
+      *stamp = g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED) * G_USEC_PER_SEC
+               + g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
+      g_object_unref (info);
+    }
+
+  return TRUE;
+}
+
+/* Called before a file is read, so a change while we read it
+ * makes the stamp outdated instead of the cache */
+static void
+gtk_css_provider_add_cache_source (GtkCssProvider *provider,
+                                   GFile          *file)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+  GtkCssCacheSource source;
+
+  if (!gtk_css_provider_get_source_stamp (file, &source.size, &source.stamp))
+    {
+      priv->cache_invalid = TRUE;
+      return;
+    }
+
+  source.uri = g_file_get_uri (file);
+  g_array_append_val (priv->cache_sources, source);
+}
+
+static void
+gtk_css_cache_source_clear (gpointer data)
+{
+  GtkCssCacheSource *source = data;
+
+  g_free (source->uri);
+}
+
+static gboolean
+gtk_css_provider_cache_sources_are_valid (GtkCssDeserializer *deserializer)
+{
+  guint32 i, n_sources;
+
+  n_sources = gtk_css_deserializer_read_count (deserializer, sizeof (guint32) + 2 * sizeof (guint64));
+  if (n_sources == 0)
+    return FALSE;
+
+  for (i = 0; i < n_sources; i++)
+    {
+      const char *uri;
+      guint64 size, stamp, current_size, current_stamp;
+      gboolean valid;
+      GFile *file;
+
+      uri = gtk_css_deserializer_read_string (deserializer);
+      size = gtk_css_deserializer_read_uint64 (deserializer);
+      stamp = gtk_css_deserializer_read_uint64 (deserializer);
+      if (uri == NULL || gtk_css_deserializer_has_failed (deserializer))
+        return FALSE;
+
+      file = g_file_new_for_uri (uri);
+      valid = gtk_css_provider_get_source_stamp (file, &current_size, &current_stamp) &&
+              current_size == size &&
+              current_stamp == stamp;
+      g_object_unref (file);
+
+      if (!valid)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+gtk_css_provider_deserialize_colors (GtkCssProvider     *provider,
+                                     GtkCssDeserializer *deserializer)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+  guint32 i, n_colors;
+
+  n_colors = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  for (i = 0; i < n_colors; i++)
+    {
+      const char *name;
+      GtkCssValue *color;
+
+      name = gtk_css_deserializer_read_string (deserializer);
+      color = gtk_css_deserializer_read_color (deserializer);
+      if (name == NULL || color == NULL)
+        {
+          g_clear_pointer (&color, _gtk_css_value_unref);
+          return FALSE;
+        }
+
+      g_hash_table_insert (priv->symbolic_colors, g_strdup (name), color);
+    }
+
+  return !gtk_css_deserializer_has_failed (deserializer);
+}
+
+static gboolean
+gtk_css_provider_deserialize_keyframes (GtkCssProvider     *provider,
+                                        GtkCssDeserializer *deserializer)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+  guint32 i, n_keyframes;
+
+  n_keyframes = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+  for (i = 0; i < n_keyframes; i++)
+    {
+      const char *name;
+      GtkCssKeyframes *keyframes;
+
+      name = gtk_css_deserializer_read_string (deserializer);
+      if (name == NULL)
+        return FALSE;
+
+      keyframes = gtk_css_keyframes_deserialize (deserializer);
+      if (keyframes == NULL)
+        return FALSE;
+
+      g_hash_table_insert (priv->keyframes, g_strdup (name), keyframes);
+    }
+
+  return !gtk_css_deserializer_has_failed (deserializer);
+}
+
+static GtkCssStyleProperty **
+gtk_css_provider_deserialize_properties (GtkCssDeserializer *deserializer,
+                                         guint32            *n_properties)
+{
+  GtkCssStyleProperty **properties;
+  guint32 i;
+
+  *n_properties = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  properties = g_new (GtkCssStyleProperty *, *n_properties);
+  for (i = 0; i < *n_properties; i++)
+    {
+      GtkStyleProperty *property;
+      const char *name;
+
+      name = gtk_css_deserializer_read_string (deserializer);
+      if (name == NULL)
+        break;
+
+      property = _gtk_style_property_lookup (name);
+      if (!GTK_IS_CSS_STYLE_PROPERTY (property))
+        break;
+
+      properties[i] = GTK_CSS_STYLE_PROPERTY (property);
+    }
+
+  if (i < *n_properties || gtk_css_deserializer_has_failed (deserializer))
+    {
+      g_free (properties);
+      return NULL;
+    }
+
+  return properties;
+}
+
+static gboolean
+gtk_css_provider_deserialize_rulesets (GtkCssProvider     *provider,
+                                       GtkCssDeserializer *deserializer)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+  GtkCssStyleProperty **properties;
+  guint32 i, j, n_properties, n_rulesets;
+
+  properties = gtk_css_provider_deserialize_properties (deserializer, &n_properties);
+  if (properties == NULL)
+    return FALSE;
+
+  n_rulesets = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  g_array_set_size (priv->rulesets, n_rulesets);
+  memset (priv->rulesets->data, 0, n_rulesets * sizeof (GtkCssRuleset));
+  for (i = 0; i < n_rulesets; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+      guint32 n_styles;
+
+      /* empty rulesets keep their styles unset, like when parsing */
+      n_styles = gtk_css_deserializer_read_count (deserializer, 2 * sizeof (guint32));
+      if (n_styles == 0)
+        continue;
+
+      ruleset->styles = g_new0 (PropertyValue, n_styles);
+      ruleset->set_styles = _gtk_bitmask_new ();
+      ruleset->owns_styles = TRUE;
+
+      for (j = 0; j < n_styles; j++)
+        {
+          guint32 index = gtk_css_deserializer_read_uint32 (deserializer);
+          GtkCssValue *value = gtk_css_deserializer_read_value (deserializer);
+
+          if (value == NULL || index >= n_properties)
+            {
+              g_clear_pointer (&value, _gtk_css_value_unref);
+              break;
+            }
+
+          ruleset->styles[j].property = properties[index];
+          ruleset->styles[j].value = value;
+          ruleset->n_styles++;
+          ruleset->set_styles = _gtk_bitmask_set (ruleset->set_styles,
+                                                  _gtk_css_style_property_get_id (properties[index]),
+                                                  TRUE);
+        }
+
+      if (j < n_styles)
+        break;
+    }
+
+  g_free (properties);
+
+  return i == n_rulesets && !gtk_css_deserializer_has_failed (deserializer);
+}
+
+static gpointer
+gtk_css_provider_deserialize_match (guint32             index,
+                                    GtkCssSelectorTree *node,
+                                    gpointer            data)
+{
+  GtkCssProvider *provider = data;
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+  GtkCssRuleset *ruleset;
+
+  if (index >= priv->rulesets->len)
+    return NULL;
+
+  ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, index);
+  ruleset->selector_match = node;
+
+  return ruleset;
+}
+
+static gboolean
+gtk_css_provider_load_cache (GtkCssProvider *provider,
+                             GFile          *file)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+  GtkCssDeserializer *deserializer;
+  GMappedFile *mapped;
+  GBytes *bytes;
+  gboolean result = FALSE;
+  char *filename;
+  guint i;
+
+  filename = gtk_css_provider_get_cache_filename (file);
+  mapped = g_mapped_file_new (filename, FALSE, NULL);
+  g_free (filename);
+  if (mapped == NULL)
+    return FALSE;
+
+  bytes = g_mapped_file_get_bytes (mapped);
+  g_mapped_file_unref (mapped);
+
+  deserializer = gtk_css_deserializer_new (bytes);
+  g_bytes_unref (bytes);
+  if (deserializer == NULL)
+    return FALSE;
+
+  if (gtk_css_deserializer_read_uint32 (deserializer) != CSS_CACHE_VERSION ||
+      gtk_css_deserializer_read_uint32 (deserializer) != CSS_CACHE_GTK_VERSION ||
+      !gtk_css_provider_cache_sources_are_valid (deserializer))
+    goto out;
+
+  gtk_css_provider_reset (provider);
+
+  if (!gtk_css_provider_deserialize_colors (provider, deserializer) ||
+      !gtk_css_provider_deserialize_keyframes (provider, deserializer) ||
+      !gtk_css_provider_deserialize_rulesets (provider, deserializer))
+    goto out;
+
+  priv->tree = _gtk_css_selector_tree_deserialize (deserializer, gtk_css_provider_deserialize_match, provider);
+  if (gtk_css_deserializer_has_failed (deserializer) ||
+      !gtk_css_deserializer_is_eof (deserializer))
+    goto out;
+
+  /* Every ruleset must be reachable from the tree */
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      if (g_array_index (priv->rulesets, GtkCssRuleset, i).selector_match == NULL)
+        goto out;
+    }
+
+  gtk_style_provider_changed (GTK_STYLE_PROVIDER (provider));
+
+  result = TRUE;
+
+out:
+  if (!result)
+    gtk_css_provider_reset (provider);
+
+  gtk_css_deserializer_free (deserializer);
+
+  return result;
+}
+
+static guint32
+gtk_css_provider_serialize_match (gpointer match,
+                                  gpointer data)
+{
+  GtkCssProvider *provider = data;
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+
+  return (GtkCssRuleset *) match - (GtkCssRuleset *) priv->rulesets->data;
+}
+
+static GBytes *
+gtk_css_provider_serialize (GtkCssProvider *provider)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+  GtkCssSerializer *serializer;
+  GHashTable *property_indices;
+  GPtrArray *properties;
+  GHashTableIter iter;
+  gpointer key, value;
+  guint i, j;
+
+  serializer = gtk_css_serializer_new ();
+
+  gtk_css_serializer_write_uint32 (serializer, CSS_CACHE_VERSION);
+  gtk_css_serializer_write_uint32 (serializer, CSS_CACHE_GTK_VERSION);
+
+  gtk_css_serializer_write_uint32 (serializer, priv->cache_sources->len);
+  for (i = 0; i < priv->cache_sources->len; i++)
+    {
+      GtkCssCacheSource *source = &g_array_index (priv->cache_sources, GtkCssCacheSource, i);
+
+      gtk_css_serializer_write_string (serializer, source->uri);
+      gtk_css_serializer_write_uint64 (serializer, source->size);
+      gtk_css_serializer_write_uint64 (serializer, source->stamp);
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, g_hash_table_size (priv->symbolic_colors));
+  g_hash_table_iter_init (&iter, priv->symbolic_colors);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      gtk_css_serializer_write_string (serializer, key);
+      gtk_css_serializer_write_value (serializer, value);
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, g_hash_table_size (priv->keyframes));
+  g_hash_table_iter_init (&iter, priv->keyframes);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    {
+      gtk_css_serializer_write_string (serializer, key);
+      gtk_css_keyframes_serialize (value, serializer);
+    }
+
+  /* Write every property name once, the rulesets refer to them by index */
+  property_indices = g_hash_table_new (NULL, NULL);
+  properties = g_ptr_array_new ();
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+
+      for (j = 0; j < ruleset->n_styles; j++)
+        {
+          GtkCssStyleProperty *property = ruleset->styles[j].property;
+
+          if (g_hash_table_contains (property_indices, property))
+            continue;
+
+          g_hash_table_insert (property_indices, property, GUINT_TO_POINTER (properties->len));
+          g_ptr_array_add (properties, property);
+        }
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, properties->len);
+  for (i = 0; i < properties->len; i++)
+    gtk_css_serializer_write_string (serializer, _gtk_style_property_get_name (g_ptr_array_index (properties, i)));
+
+  gtk_css_serializer_write_uint32 (serializer, priv->rulesets->len);
+  for (i = 0; i < priv->rulesets->len; i++)
+    {
+      GtkCssRuleset *ruleset = &g_array_index (priv->rulesets, GtkCssRuleset, i);
+
+      gtk_css_serializer_write_uint32 (serializer, ruleset->n_styles);
+      for (j = 0; j < ruleset->n_styles; j++)
+        {
+          gtk_css_serializer_write_uint32 (serializer,
+                                           GPOINTER_TO_UINT (g_hash_table_lookup (property_indices,
+                                                                                  ruleset->styles[j].property)));
+          gtk_css_serializer_write_value (serializer, ruleset->styles[j].value);
+        }
+    }
+
+  g_ptr_array_free (properties, TRUE);
+  g_hash_table_unref (property_indices);
+
+  _gtk_css_selector_tree_serialize (priv->tree, serializer, gtk_css_provider_serialize_match, provider);
+
+  if (gtk_css_serializer_has_failed (serializer))
+    {
+      g_bytes_unref (gtk_css_serializer_free_to_bytes (serializer));
+      return NULL;
+    }
+
+  return gtk_css_serializer_free_to_bytes (serializer);
+}
+
+static void
+gtk_css_provider_save_cache (GtkCssProvider *provider,
+                             GFile          *file)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+  GBytes *bytes;
+  char *filename, *dirname;
+
+  if (priv->cache_invalid)
+    return;
+
+  bytes = gtk_css_provider_serialize (provider);
+  if (bytes == NULL)
+    return;
+
+  filename = gtk_css_provider_get_cache_filename (file);
+  dirname = g_path_get_dirname (filename);
+
+  /* Failing to write the cache is not an error, we'll just parse
+   * the theme again next time */
+  if (g_mkdir_with_parents (dirname, 0700) == 0)
+    g_file_set_contents (filename,
+                         g_bytes_get_data (bytes, NULL),
+                         g_bytes_get_size (bytes),
+                         NULL);
+
+  g_free (dirname);
+  g_free (filename);
+  g_bytes_unref (bytes);
+}
+
+static void
+gtk_css_provider_load_theme_file (GtkCssProvider *provider,
+                                  GFile          *file)
+{
+  GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
+
+  if (!gtk_css_provider_cache_is_enabled ())
+    {
+      gtk_css_provider_load_from_file (provider, file);
+      return;
+    }
+
+  if (gtk_css_provider_load_cache (provider, file))
+    return;
+
+  priv->cache_sources = g_array_new (FALSE, FALSE, sizeof (GtkCssCacheSource));
+  g_array_set_clear_func (priv->cache_sources, gtk_css_cache_source_clear);
+  priv->cache_invalid = FALSE;
+
+  gtk_css_provider_load_from_file (provider, file);
+  gtk_css_provider_save_cache (provider, file);
+
+  g_clear_pointer (&priv->cache_sources, g_array_unref);
+}
+
 /**
  * _gtk_css_provider_load_named:
  * @provider: a #GtkCssProvider
@@ -1742,7 +2328,10 @@ _gtk_css_provider_load_named (GtkCssProvider *provider,
 
   if (g_resources_get_info (resource_path, 0, NULL, NULL, NULL))
     {
-      gtk_css_provider_load_from_resource (provider, resource_path);
+      GFile *file = gtk_css_resource_file_new (resource_path);
+
+      gtk_css_provider_load_theme_file (provider, file);
+      g_object_unref (file);
       g_free (resource_path);
       return;
     }
@@ -1755,6 +2344,7 @@ _gtk_css_provider_load_named (GtkCssProvider *provider,
       GtkCssProviderPrivate *priv = gtk_css_provider_get_instance_private (provider);
       char *dir, *resource_file;
       GResource *resource;
+      GFile *file;
 
       dir = g_path_get_dirname (path);
       resource_file = g_build_filename (dir, "gtk.gresource", NULL);
@@ -1764,9 +2354,11 @@ _gtk_css_provider_load_named (GtkCssProvider *provider,
       if (resource != NULL)
         g_resources_register (resource);
 
-      gtk_css_provider_load_from_path (provider, path);
+      file = g_file_new_for_path (path);
+      gtk_css_provider_load_theme_file (provider, file);
+      g_object_unref (file);
 
-      /* Only set this after load, as load_from_path will clear it */
+      /* Only set this after load, as loading will clear it */
       priv->resource = resource;
       priv->path = dir;
 
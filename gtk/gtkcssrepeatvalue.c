@@ -20,6 +20,7 @@
 #include "gtkcssrepeatvalueprivate.h"
 
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 struct _GtkCssValue {
   GTK_CSS_VALUE_BASE
@@ -112,6 +113,24 @@ gtk_css_value_border_repeat_print (const GtkCssValue *repeat,
     }
 }
 
+static void
+gtk_css_value_background_repeat_serialize (const GtkCssValue *repeat,
+                                           GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_BACKGROUND_REPEAT);
+  gtk_css_serializer_write_uint32 (serializer, repeat->x);
+  gtk_css_serializer_write_uint32 (serializer, repeat->y);
+}
+
+static void
+gtk_css_value_border_repeat_serialize (const GtkCssValue *repeat,
+                                       GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_BORDER_REPEAT);
+  gtk_css_serializer_write_uint32 (serializer, repeat->x);
+  gtk_css_serializer_write_uint32 (serializer, repeat->y);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_BACKGROUND_REPEAT = {
   gtk_css_value_repeat_free,
   gtk_css_value_repeat_compute,
@@ -119,7 +138,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_BACKGROUND_REPEAT = {
   gtk_css_value_repeat_transition,
   NULL,
   NULL,
-  gtk_css_value_background_repeat_print
+  gtk_css_value_background_repeat_print,
+  gtk_css_value_background_repeat_serialize
 };
 
 static const GtkCssValueClass GTK_CSS_VALUE_BORDER_REPEAT = {
@@ -129,7 +149,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_BORDER_REPEAT = {
   gtk_css_value_repeat_transition,
   NULL,
   NULL,
-  gtk_css_value_border_repeat_print
+  gtk_css_value_border_repeat_print,
+  gtk_css_value_border_repeat_serialize
 };
 /* BACKGROUND REPEAT */
 
@@ -209,6 +230,21 @@ _gtk_css_background_repeat_value_try_parse (GtkCssParser *parser)
   return _gtk_css_background_repeat_value_new (x, y);
 }
 
+GtkCssValue *
+gtk_css_background_repeat_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssRepeatStyle x, y;
+
+  x = gtk_css_deserializer_read_uint32 (deserializer);
+  y = gtk_css_deserializer_read_uint32 (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer) ||
+      x >= G_N_ELEMENTS (background_repeat_values) ||
+      y >= G_N_ELEMENTS (background_repeat_values))
+    return NULL;
+
+  return _gtk_css_background_repeat_value_new (x, y);
+}
+
 GtkCssRepeatStyle
 _gtk_css_background_repeat_value_get_x (const GtkCssValue *repeat)
 {
@@ -298,6 +334,21 @@ _gtk_css_border_repeat_value_try_parse (GtkCssParser *parser)
   return _gtk_css_border_repeat_value_new (x, y);
 }
 
+GtkCssValue *
+gtk_css_border_repeat_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssRepeatStyle x, y;
+
+  x = gtk_css_deserializer_read_uint32 (deserializer);
+  y = gtk_css_deserializer_read_uint32 (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer) ||
+      x >= G_N_ELEMENTS (border_repeat_values) ||
+      y >= G_N_ELEMENTS (border_repeat_values))
+    return NULL;
+
+  return _gtk_css_border_repeat_value_new (x, y);
+}
+
 GtkCssRepeatStyle
 _gtk_css_border_repeat_value_get_x (const GtkCssValue *repeat)
 {
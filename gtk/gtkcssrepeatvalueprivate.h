@@ -36,12 +36,14 @@ typedef enum {
 GtkCssValue *       _gtk_css_background_repeat_value_new        (GtkCssRepeatStyle       x,
                                                                  GtkCssRepeatStyle       y);
 GtkCssValue *       _gtk_css_background_repeat_value_try_parse  (GtkCssParser           *parser);
+GtkCssValue *       gtk_css_background_repeat_value_deserialize (GtkCssDeserializer     *deserializer);
 GtkCssRepeatStyle   _gtk_css_background_repeat_value_get_x      (const GtkCssValue      *repeat);
 GtkCssRepeatStyle   _gtk_css_background_repeat_value_get_y      (const GtkCssValue      *repeat);
 
 GtkCssValue *       _gtk_css_border_repeat_value_new            (GtkCssRepeatStyle       x,
                                                                  GtkCssRepeatStyle       y);
 GtkCssValue *       _gtk_css_border_repeat_value_try_parse      (GtkCssParser           *parser);
+GtkCssValue *       gtk_css_border_repeat_value_deserialize     (GtkCssDeserializer     *deserializer);
 GtkCssRepeatStyle   _gtk_css_border_repeat_value_get_x          (const GtkCssValue      *repeat);
 GtkCssRepeatStyle   _gtk_css_border_repeat_value_get_y          (const GtkCssValue      *repeat);
 
@@ -23,6 +23,7 @@
 #include <string.h>
 
 #include "gtkcssprovider.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkstylecontextprivate.h"
 
 #if defined(_MSC_VER) && _MSC_VER >= 1500
@@ -1903,3 +1904,358 @@ _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder)
 
   return tree;
 }
+
+/* Serialization */
+
+#define GTK_CSS_SELECTOR_TREE_NO_NODE G_MAXUINT32
+
+static const GtkCssSelectorClass *selector_classes[] = {
+  &GTK_CSS_SELECTOR_DESCENDANT,
+  &GTK_CSS_SELECTOR_CHILD,
+  &GTK_CSS_SELECTOR_SIBLING,
+  &GTK_CSS_SELECTOR_ADJACENT,
+  &GTK_CSS_SELECTOR_ANY,
+  &GTK_CSS_SELECTOR_NOT_ANY,
+  &GTK_CSS_SELECTOR_NAME,
+  &GTK_CSS_SELECTOR_NOT_NAME,
+  &GTK_CSS_SELECTOR_CLASS,
+  &GTK_CSS_SELECTOR_NOT_CLASS,
+  &GTK_CSS_SELECTOR_ID,
+  &GTK_CSS_SELECTOR_NOT_ID,
+  &GTK_CSS_SELECTOR_PSEUDOCLASS_STATE,
+  &GTK_CSS_SELECTOR_NOT_PSEUDOCLASS_STATE,
+  &GTK_CSS_SELECTOR_PSEUDOCLASS_POSITION,
+  &GTK_CSS_SELECTOR_NOT_PSEUDOCLASS_POSITION
+};
+
+/* Nodes are collected in the same order subdivide_infos() allocated
+ * them, so parents always come before their children and siblings. */
+static void
+collect_nodes (const GtkCssSelectorTree *tree,
+               GHashTable               *indices,
+               GPtrArray                *nodes)
+{
+  while (tree != NULL)
+    {
+      g_hash_table_insert (indices, (gpointer) tree, GUINT_TO_POINTER (nodes->len));
+      g_ptr_array_add (nodes, (gpointer) tree);
+
+      collect_nodes (gtk_css_selector_tree_get_previous (tree), indices, nodes);
+
+      tree = gtk_css_selector_tree_get_sibling (tree);
+    }
+}
+
+static void
+write_node_index (GtkCssSerializer         *serializer,
+                  GHashTable               *indices,
+                  const GtkCssSelectorTree *node)
+{
+  if (node == NULL)
+    gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SELECTOR_TREE_NO_NODE);
+  else
+    gtk_css_serializer_write_uint32 (serializer, GPOINTER_TO_UINT (g_hash_table_lookup (indices, node)));
+}
+
+static void
+gtk_css_selector_serialize (const GtkCssSelector *selector,
+                            GtkCssSerializer     *serializer)
+{
+  gtk_css_serializer_write_string (serializer, selector->class->name);
+
+  if (selector->class == &GTK_CSS_SELECTOR_NAME ||
+      selector->class == &GTK_CSS_SELECTOR_NOT_NAME)
+    {
+      gtk_css_serializer_write_string (serializer, selector->name.name);
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_ID ||
+           selector->class == &GTK_CSS_SELECTOR_NOT_ID)
+    {
+      gtk_css_serializer_write_string (serializer, selector->id.name);
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_CLASS ||
+           selector->class == &GTK_CSS_SELECTOR_NOT_CLASS)
+    {
+      gtk_css_serializer_write_string (serializer, g_quark_to_string (selector->style_class.style_class));
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_PSEUDOCLASS_STATE ||
+           selector->class == &GTK_CSS_SELECTOR_NOT_PSEUDOCLASS_STATE)
+    {
+      gtk_css_serializer_write_uint32 (serializer, selector->state.state);
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_PSEUDOCLASS_POSITION ||
+           selector->class == &GTK_CSS_SELECTOR_NOT_PSEUDOCLASS_POSITION)
+    {
+      gtk_css_serializer_write_uint32 (serializer, selector->position.type);
+      gtk_css_serializer_write_uint64 (serializer, (gint64) selector->position.a);
+      gtk_css_serializer_write_uint64 (serializer, (gint64) selector->position.b);
+    }
+}
+
+static gboolean
+gtk_css_selector_deserialize (GtkCssSelector     *selector,
+                              GtkCssDeserializer *deserializer)
+{
+  const char *class_name;
+  guint i;
+
+  class_name = gtk_css_deserializer_read_string (deserializer);
+  if (class_name == NULL)
+    return FALSE;
+
+  for (i = 0; i < G_N_ELEMENTS (selector_classes); i++)
+    {
+      if (g_str_equal (selector_classes[i]->name, class_name))
+        break;
+    }
+  if (i == G_N_ELEMENTS (selector_classes))
+    return FALSE;
+
+  selector->class = selector_classes[i];
+
+  if (selector->class == &GTK_CSS_SELECTOR_NAME ||
+      selector->class == &GTK_CSS_SELECTOR_NOT_NAME ||
+      selector->class == &GTK_CSS_SELECTOR_ID ||
+      selector->class == &GTK_CSS_SELECTOR_NOT_ID ||
+      selector->class == &GTK_CSS_SELECTOR_CLASS ||
+      selector->class == &GTK_CSS_SELECTOR_NOT_CLASS)
+    {
+      const char *name = gtk_css_deserializer_read_string (deserializer);
+
+      if (name == NULL)
+        return FALSE;
+
+      if (selector->class == &GTK_CSS_SELECTOR_CLASS ||
+          selector->class == &GTK_CSS_SELECTOR_NOT_CLASS)
+        selector->style_class.style_class = g_quark_from_string (name);
+      else if (selector->class == &GTK_CSS_SELECTOR_ID ||
+               selector->class == &GTK_CSS_SELECTOR_NOT_ID)
+        selector->id.name = g_intern_string (name);
+      else
+        selector->name.name = g_intern_string (name);
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_PSEUDOCLASS_STATE ||
+           selector->class == &GTK_CSS_SELECTOR_NOT_PSEUDOCLASS_STATE)
+    {
+      selector->state.state = gtk_css_deserializer_read_uint32 (deserializer);
+      if (gtk_css_pseudoclass_name (selector->state.state) == NULL)
+        return FALSE;
+    }
+  else if (selector->class == &GTK_CSS_SELECTOR_PSEUDOCLASS_POSITION ||
+           selector->class == &GTK_CSS_SELECTOR_NOT_PSEUDOCLASS_POSITION)
+    {
+      guint32 type = gtk_css_deserializer_read_uint32 (deserializer);
+      gint64 a = (gint64) gtk_css_deserializer_read_uint64 (deserializer);
+      gint64 b = (gint64) gtk_css_deserializer_read_uint64 (deserializer);
+
+      if (type > POSITION_ONLY)
+        return FALSE;
+
+      selector->position.type = type;
+      selector->position.a = a;
+      selector->position.b = b;
+      /* must survive the bitfields */
+      if (selector->position.a != a || selector->position.b != b)
+        return FALSE;
+    }
+
+  return !gtk_css_deserializer_has_failed (deserializer);
+}
+
+/**
+ * _gtk_css_selector_tree_serialize:
+ * @tree: (nullable): the tree to serialize
+ * @serializer: the serializer to write to
+ * @func: function returning the index of a match
+ * @data: data passed to @func
+ *
+ * Writes the nodes of @tree in the order they are laid out in memory.
+ * Matches are written as the indices returned by @func, so the caller
+ * can store them along with the tree.
+ */
+void
+_gtk_css_selector_tree_serialize (const GtkCssSelectorTree         *tree,
+                                  GtkCssSerializer                 *serializer,
+                                  GtkCssSelectorTreeMatchIndexFunc  func,
+                                  gpointer                          data)
+{
+  GHashTable *indices;
+  GPtrArray *nodes;
+  guint i, j;
+
+  indices = g_hash_table_new (NULL, NULL);
+  nodes = g_ptr_array_new ();
+  collect_nodes (tree, indices, nodes);
+
+  gtk_css_serializer_write_uint32 (serializer, nodes->len);
+  for (i = 0; i < nodes->len; i++)
+    {
+      const GtkCssSelectorTree *node = g_ptr_array_index (nodes, i);
+      gpointer *matches;
+
+      gtk_css_selector_serialize (&node->selector, serializer);
+      write_node_index (serializer, indices, gtk_css_selector_tree_get_parent (node));
+      write_node_index (serializer, indices, gtk_css_selector_tree_get_previous (node));
+      write_node_index (serializer, indices, gtk_css_selector_tree_get_sibling (node));
+
+      matches = gtk_css_selector_tree_get_matches (node);
+      for (j = 0; matches && matches[j] != NULL; j++)
+        ;
+      gtk_css_serializer_write_uint32 (serializer, j);
+      for (j = 0; matches && matches[j] != NULL; j++)
+        gtk_css_serializer_write_uint32 (serializer, func (matches[j], data));
+    }
+
+  g_ptr_array_free (nodes, TRUE);
+  g_hash_table_unref (indices);
+}
+
+static gboolean
+read_node_index (GtkCssDeserializer *deserializer,
+                 guint32             n_nodes,
+                 gboolean            before,
+                 guint32             i,
+                 gint32             *index)
+{
+  guint32 node = gtk_css_deserializer_read_uint32 (deserializer);
+
+  if (node == GTK_CSS_SELECTOR_TREE_NO_NODE)
+    {
+      *index = GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET;
+      return TRUE;
+    }
+
+  /* Only allowing links in one direction makes loops impossible */
+  if (node >= n_nodes || (before ? node >= i : node <= i))
+    return FALSE;
+
+  *index = node;
+  return TRUE;
+}
+
+static gint32
+node_offset (const guint32 *offsets,
+             guint32        i,
+             gint32         index)
+{
+  if (index == GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET)
+    return GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET;
+
+  return (gint32) offsets[index] - (gint32) offsets[i];
+}
+
+/**
+ * _gtk_css_selector_tree_deserialize:
+ * @deserializer: the deserializer to read from
+ * @func: function turning a match index into the match
+ * @data: data passed to @func
+ *
+ * Reads back a tree written with _gtk_css_selector_tree_serialize().
+ * @func is called for every match once the tree is complete, with the
+ * node that matched, so the caller can set up its selector_match.
+ *
+ * Returns: the tree or %NULL if it was empty or the data is invalid.
+ *     Use gtk_css_deserializer_has_failed() to tell those apart.
+ */
+GtkCssSelectorTree *
+_gtk_css_selector_tree_deserialize (GtkCssDeserializer          *deserializer,
+                                    GtkCssSelectorTreeMatchFunc  func,
+                                    gpointer                     data)
+{
+  GtkCssSelectorTree *tree;
+  GByteArray *array;
+  GArray *match_indices;
+  guint32 *offsets, *n_matches;
+  guint32 i, j, k, n_nodes;
+  guint8 *blob;
+
+  /* class, parent, previous, sibling, number of matches */
+  n_nodes = gtk_css_deserializer_read_count (deserializer, 5 * sizeof (guint32));
+  if (n_nodes == 0)
+    return NULL;
+
+  array = g_byte_array_new ();
+  match_indices = g_array_new (FALSE, FALSE, sizeof (guint32));
+  offsets = g_new (guint32, n_nodes);
+  n_matches = g_new (guint32, n_nodes);
+
+  /* Lay out the nodes like subdivide_infos(), but keep node indices
+   * in the offsets until we know where every node ends up. */
+  for (i = 0; i < n_nodes; i++)
+    {
+      gint32 offset;
+
+      tree = alloc_tree (array, &offset);
+      offsets[i] = offset;
+      if (!gtk_css_selector_deserialize (&tree->selector, deserializer) ||
+          !read_node_index (deserializer, n_nodes, TRUE, i, &tree->parent_offset) ||
+          !read_node_index (deserializer, n_nodes, FALSE, i, &tree->previous_offset) ||
+          !read_node_index (deserializer, n_nodes, FALSE, i, &tree->sibling_offset))
+        goto fail;
+
+      n_matches[i] = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+      if (n_matches[i] > 0)
+        {
+          gpointer *matches;
+
+          tree->matches_offset = array->len - offset;
+          matches = g_new0 (gpointer, n_matches[i] + 1);
+          g_byte_array_append (array, (guint8 *) matches, (n_matches[i] + 1) * sizeof (gpointer));
+          g_free (matches);
+
+          for (j = 0; j < n_matches[i]; j++)
+            {
+              guint32 index = gtk_css_deserializer_read_uint32 (deserializer);
+              g_array_append_val (match_indices, index);
+            }
+        }
+      else
+        tree->matches_offset = GTK_CSS_SELECTOR_TREE_EMPTY_OFFSET;
+
+      if (gtk_css_deserializer_has_failed (deserializer) || array->len > G_MAXINT32)
+        goto fail;
+    }
+
+  blob = g_byte_array_free (array, FALSE);
+
+  /* Convert node indices to node-relative offsets and resolve the matches */
+  k = 0;
+  for (i = 0; i < n_nodes; i++)
+    {
+      gpointer *matches;
+
+      tree = (GtkCssSelectorTree *) (blob + offsets[i]);
+
+      tree->parent_offset = node_offset (offsets, i, tree->parent_offset);
+      tree->previous_offset = node_offset (offsets, i, tree->previous_offset);
+      tree->sibling_offset = node_offset (offsets, i, tree->sibling_offset);
+
+      matches = gtk_css_selector_tree_get_matches (tree);
+      for (j = 0; j < n_matches[i]; j++)
+        {
+          matches[j] = func (g_array_index (match_indices, guint32, k++), tree, data);
+          if (matches[j] == NULL)
+            {
+              g_free (blob);
+              array = NULL;
+              goto fail;
+            }
+        }
+    }
+
+  tree = (GtkCssSelectorTree *) blob;
+  goto out;
+
+fail:
+  gtk_css_deserializer_fail (deserializer);
+  if (array)
+    g_byte_array_free (array, TRUE);
+  tree = NULL;
+
+out:
+  g_array_free (match_indices, TRUE);
+  g_free (n_matches);
+  g_free (offsets);
+
+  return tree;
+}
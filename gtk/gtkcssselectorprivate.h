@@ -27,6 +27,12 @@ typedef union _GtkCssSelector GtkCssSelector;
 typedef struct _GtkCssSelectorTree GtkCssSelectorTree;
 typedef struct _GtkCssSelectorTreeBuilder GtkCssSelectorTreeBuilder;
 
+typedef guint32  (* GtkCssSelectorTreeMatchIndexFunc) (gpointer                  match,
+                                                       gpointer                  data);
+typedef gpointer (* GtkCssSelectorTreeMatchFunc)      (guint32                   index,
+                                                       GtkCssSelectorTree       *node,
+                                                       gpointer                  data);
+
 GtkCssSelector *  _gtk_css_selector_parse           (GtkCssParser           *parser);
 void              _gtk_css_selector_free            (GtkCssSelector         *selector);
 
@@ -57,6 +63,14 @@ void                       _gtk_css_selector_tree_builder_add   (GtkCssSelectorT
 GtkCssSelectorTree *       _gtk_css_selector_tree_builder_build (GtkCssSelectorTreeBuilder *builder);
 void                       _gtk_css_selector_tree_builder_free  (GtkCssSelectorTreeBuilder *builder);
 
+void                _gtk_css_selector_tree_serialize    (const GtkCssSelectorTree         *tree,
+                                                         GtkCssSerializer                 *serializer,
+                                                         GtkCssSelectorTreeMatchIndexFunc  func,
+                                                         gpointer                          data);
+GtkCssSelectorTree *_gtk_css_selector_tree_deserialize  (GtkCssDeserializer               *deserializer,
+                                                         GtkCssSelectorTreeMatchFunc       func,
+                                                         gpointer                          data);
+
 const char *gtk_css_pseudoclass_name (GtkStateFlags flags);
 
 G_END_DECLS
@@ -0,0 +1,928 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkcssserializerprivate.h"
+
+#include "gtkcssarrayvalueprivate.h"
+#include "gtkcssbgsizevalueprivate.h"
+#include "gtkcssbordervalueprivate.h"
+#include "gtkcsscalcvalueprivate.h"
+#include "gtkcsscolorvalueprivate.h"
+#include "gtkcsscornervalueprivate.h"
+#include "gtkcssdimensionvalueprivate.h"
+#include "gtkcsseasevalueprivate.h"
+#include "gtkcssenumvalueprivate.h"
+#include "gtkcssfiltervalueprivate.h"
+#include "gtkcssfontfeaturesvalueprivate.h"
+#include "gtkcssfontvariationsvalueprivate.h"
+#include "gtkcssiconthemevalueprivate.h"
+#include "gtkcssimagecrossfadeprivate.h"
+#include "gtkcssimagefallbackprivate.h"
+#include "gtkcssimageiconthemeprivate.h"
+#include "gtkcssimagelinearprivate.h"
+#include "gtkcssimageradialprivate.h"
+#include "gtkcssimagerecolorprivate.h"
+#include "gtkcssimagescaledprivate.h"
+#include "gtkcssimageurlprivate.h"
+#include "gtkcssimagevalueprivate.h"
+#include "gtkcssinheritvalueprivate.h"
+#include "gtkcssinitialvalueprivate.h"
+#include "gtkcsspalettevalueprivate.h"
+#include "gtkcsspositionvalueprivate.h"
+#include "gtkcssrepeatvalueprivate.h"
+#include "gtkcssshadowsvalueprivate.h"
+#include "gtkcssshadowvalueprivate.h"
+#include "gtkcssstringvalueprivate.h"
+#include "gtkcsstransformvalueprivate.h"
+#include "gtkcssunsetvalueprivate.h"
+
+#include <string.h>
+
+/* The serialized CSS format
+ *
+ * This stores parsed CSS values so they can be recreated without going
+ * through the parser again. It is used by the theme cache in
+ * gtkcssprovider.c. The data consists of:
+ *
+ *  - a GtkCssSerializedHeader
+ *  - the string table: one guint32 offset per string, followed by the
+ *    nul-terminated strings.
+ *  - the value table: one GtkCssSerializedRange per value, followed by
+ *    the values. Each value starts with its GtkCssSerializedValueType,
+ *    values it contains are stored as their index in the table, and
+ *    values with the same data are only stored once. A value only
+ *    refers to values before it, so the whole table is created in one
+ *    pass when loading.
+ *  - the data written by the user of the serializer, which refers to
+ *    values and strings by index, too.
+ *
+ * Properties, enums and the like are stored by name, not by their
+ * numeric id, so the data stays valid when those change. Numbers are
+ * stored in host byte order, and data from machines with a different
+ * byte order is rejected.
+ */
+
+#define GTK_CSS_SERIALIZER_MAGIC "GTKCSS"
+#define GTK_CSS_SERIALIZER_VERSION 1
+#define GTK_CSS_SERIALIZER_BYTE_ORDER 0x01020304
+#define GTK_CSS_SERIALIZER_NONE G_MAXUINT32
+
+/* Deeper nesting than this is treated as invalid data */
+#define GTK_CSS_SERIALIZER_MAX_DEPTH 256
+
+typedef struct
+{
+  char    magic[8];
+  guint32 version;
+  guint32 byte_order;
+  guint32 n_strings;
+  guint32 strings_offset;
+  guint32 n_values;
+  guint32 values_offset;
+  guint32 data_offset;
+  guint32 data_size;
+} GtkCssSerializedHeader;
+
+typedef struct
+{
+  guint32 offset;
+  guint32 size;
+} GtkCssSerializedRange;
+
+/*** Writing ***/
+
+struct _GtkCssSerializer
+{
+  GByteArray *data;            /* where we are writing to right now */
+  GHashTable *string_indices;  /* string => index + 1 */
+  GPtrArray *strings;
+  GHashTable *value_indices;   /* GtkCssValue => index + 1 */
+  GHashTable *data_indices;    /* GBytes of a value => index + 1 */
+  GPtrArray *values;           /* GBytes */
+  gboolean failed;
+};
+
+GtkCssSerializer *
+gtk_css_serializer_new (void)
+{
+  GtkCssSerializer *serializer;
+
+  serializer = g_slice_new0 (GtkCssSerializer);
+
+  serializer->data = g_byte_array_new ();
+  serializer->string_indices = g_hash_table_new (g_str_hash, g_str_equal);
+  serializer->strings = g_ptr_array_new_with_free_func (g_free);
+  serializer->value_indices = g_hash_table_new_full (NULL, NULL, (GDestroyNotify) gtk_css_value_unref, NULL);
+  serializer->data_indices = g_hash_table_new (g_bytes_hash, g_bytes_equal);
+  serializer->values = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+
+  return serializer;
+}
+
+static void
+append_padding (GByteArray *array,
+                guint       alignment)
+{
+  static const guint8 zeroes[16] = { 0, };
+
+  if (array->len % alignment)
+    g_byte_array_append (array, zeroes, alignment - array->len % alignment);
+}
+
+/**
+ * gtk_css_serializer_free_to_bytes:
+ * @serializer: a #GtkCssSerializer
+ *
+ * Frees @serializer and returns the data written to it.
+ *
+ * Returns: (nullable): the serialized data or %NULL if writing
+ *     failed
+ **/
+GBytes *
+gtk_css_serializer_free_to_bytes (GtkCssSerializer *serializer)
+{
+  GtkCssSerializedHeader header = { GTK_CSS_SERIALIZER_MAGIC, };
+  GByteArray *result = NULL;
+  guint32 offset;
+  guint i;
+
+  if (!serializer->failed)
+    {
+      result = g_byte_array_new ();
+      g_byte_array_set_size (result, sizeof (GtkCssSerializedHeader));
+
+      /* Strings */
+      header.n_strings = serializer->strings->len;
+      header.strings_offset = result->len;
+      offset = header.strings_offset + header.n_strings * sizeof (guint32);
+      for (i = 0; i < serializer->strings->len; i++)
+        {
+          g_byte_array_append (result, (const guint8 *) &offset, sizeof (guint32));
+          offset += strlen (g_ptr_array_index (serializer->strings, i)) + 1;
+        }
+      for (i = 0; i < serializer->strings->len; i++)
+        {
+          const char *s = g_ptr_array_index (serializer->strings, i);
+
+          g_byte_array_append (result, (const guint8 *) s, strlen (s) + 1);
+        }
+
+      /* Values. We fill in the table while placing the data */
+      append_padding (result, sizeof (guint32));
+      header.n_values = serializer->values->len;
+      header.values_offset = result->len;
+      g_byte_array_set_size (result, result->len + header.n_values * sizeof (GtkCssSerializedRange));
+      for (i = 0; i < serializer->values->len; i++)
+        {
+          GBytes *bytes = g_ptr_array_index (serializer->values, i);
+          GtkCssSerializedRange range;
+          gconstpointer data;
+          gsize size;
+
+          data = g_bytes_get_data (bytes, &size);
+          range.offset = result->len;
+          range.size = size;
+          g_byte_array_append (result, data, size);
+
+          memcpy (result->data + header.values_offset + i * sizeof (GtkCssSerializedRange),
+                  &range, sizeof (GtkCssSerializedRange));
+        }
+
+      /* Data */
+      header.version = GTK_CSS_SERIALIZER_VERSION;
+      header.byte_order = GTK_CSS_SERIALIZER_BYTE_ORDER;
+      header.data_offset = result->len;
+      header.data_size = serializer->data->len;
+      g_byte_array_append (result, serializer->data->data, serializer->data->len);
+
+      memcpy (result->data, &header, sizeof (GtkCssSerializedHeader));
+    }
+
+  g_byte_array_unref (serializer->data);
+  g_hash_table_unref (serializer->string_indices);
+  g_ptr_array_unref (serializer->strings);
+  g_hash_table_unref (serializer->value_indices);
+  g_hash_table_unref (serializer->data_indices);
+  g_ptr_array_unref (serializer->values);
+
+  g_slice_free (GtkCssSerializer, serializer);
+
+  if (result == NULL)
+    return NULL;
+
+  return g_byte_array_free_to_bytes (result);
+}
+
+/**
+ * gtk_css_serializer_fail:
+ * @serializer: a #GtkCssSerializer
+ *
+ * Marks @serializer as failed, because something was written that
+ * can't be stored. Writing can continue, but
+ * gtk_css_serializer_free_to_bytes() will return %NULL.
+ **/
+void
+gtk_css_serializer_fail (GtkCssSerializer *serializer)
+{
+  serializer->failed = TRUE;
+}
+
+gboolean
+gtk_css_serializer_has_failed (GtkCssSerializer *serializer)
+{
+  return serializer->failed;
+}
+
+void
+gtk_css_serializer_write_uint32 (GtkCssSerializer *serializer,
+                                 guint32           value)
+{
+  g_byte_array_append (serializer->data, (const guint8 *) &value, sizeof (guint32));
+}
+
+void
+gtk_css_serializer_write_uint64 (GtkCssSerializer *serializer,
+                                 guint64           value)
+{
+  g_byte_array_append (serializer->data, (const guint8 *) &value, sizeof (guint64));
+}
+
+void
+gtk_css_serializer_write_double (GtkCssSerializer *serializer,
+                                 double            value)
+{
+  g_byte_array_append (serializer->data, (const guint8 *) &value, sizeof (double));
+}
+
+void
+gtk_css_serializer_write_string (GtkCssSerializer *serializer,
+                                 const char       *string)
+{
+  guint index;
+
+  if (string == NULL)
+    {
+      gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZER_NONE);
+      return;
+    }
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (serializer->string_indices, string));
+  if (index == 0)
+    {
+      char *copy = g_strdup (string);
+
+      g_ptr_array_add (serializer->strings, copy);
+      index = serializer->strings->len;
+      g_hash_table_insert (serializer->string_indices, copy, GUINT_TO_POINTER (index));
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, index - 1);
+}
+
+/**
+ * gtk_css_serializer_write_value:
+ * @serializer: a #GtkCssSerializer
+ * @value: (nullable): the value to write
+ *
+ * Adds @value to the value table of @serializer, if it isn't in
+ * there yet, and writes its index. Use
+ * gtk_css_deserializer_read_value() to read it back, or
+ * gtk_css_deserializer_read_value0() if @value may be %NULL.
+ **/
+void
+gtk_css_serializer_write_value (GtkCssSerializer  *serializer,
+                                const GtkCssValue *value)
+{
+  guint index;
+
+  if (value == NULL)
+    {
+      gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZER_NONE);
+      return;
+    }
+
+  index = GPOINTER_TO_UINT (g_hash_table_lookup (serializer->value_indices, value));
+  if (index == 0)
+    {
+      GByteArray *data;
+      GBytes *bytes;
+
+      /* Values inside of this one end up in the table first */
+      data = serializer->data;
+      serializer->data = g_byte_array_new ();
+      gtk_css_value_serialize (value, serializer);
+      bytes = g_byte_array_free_to_bytes (serializer->data);
+      serializer->data = data;
+
+      index = GPOINTER_TO_UINT (g_hash_table_lookup (serializer->data_indices, bytes));
+      if (index == 0)
+        {
+          g_ptr_array_add (serializer->values, bytes);
+          index = serializer->values->len;
+          g_hash_table_insert (serializer->data_indices, bytes, GUINT_TO_POINTER (index));
+        }
+      else
+        {
+          g_bytes_unref (bytes);
+        }
+
+      g_hash_table_insert (serializer->value_indices,
+                           gtk_css_value_ref ((GtkCssValue *) value),
+                           GUINT_TO_POINTER (index));
+    }
+
+  gtk_css_serializer_write_uint32 (serializer, index - 1);
+}
+
+/**
+ * gtk_css_serializer_write_image:
+ * @serializer: a #GtkCssSerializer
+ * @image: (nullable): the image to write
+ *
+ * Writes @image. Unlike values, images are written in place.
+ **/
+void
+gtk_css_serializer_write_image (GtkCssSerializer *serializer,
+                                GtkCssImage      *image)
+{
+  if (image == NULL)
+    {
+      gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_IMAGE_NONE);
+      return;
+    }
+
+  gtk_css_image_serialize (image, serializer);
+}
+
+/*** Reading ***/
+
+struct _GtkCssDeserializer
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size;
+
+  GtkCssSerializedHeader header;
+  const char **strings;
+  GtkCssValue **values;
+  GtkCssSerializedValueType *types;
+  guint n_values;              /* number of values created so far */
+
+  gsize pos;
+  gsize end;
+  guint depth;
+  gboolean failed;
+};
+
+void
+gtk_css_deserializer_fail (GtkCssDeserializer *deserializer)
+{
+  deserializer->failed = TRUE;
+}
+
+gboolean
+gtk_css_deserializer_has_failed (GtkCssDeserializer *deserializer)
+{
+  return deserializer->failed;
+}
+
+gboolean
+gtk_css_deserializer_is_eof (GtkCssDeserializer *deserializer)
+{
+  return deserializer->pos == deserializer->end;
+}
+
+guint32
+gtk_css_deserializer_read_uint32 (GtkCssDeserializer *deserializer)
+{
+  guint32 value;
+
+  if (deserializer->failed || deserializer->end - deserializer->pos < sizeof (guint32))
+    {
+      deserializer->failed = TRUE;
+      return 0;
+    }
+
+  memcpy (&value, deserializer->data + deserializer->pos, sizeof (guint32));
+  deserializer->pos += sizeof (guint32);
+
+  return value;
+}
+
+/**
+ * gtk_css_deserializer_read_count:
+ * @deserializer: a #GtkCssDeserializer
+ * @element_size: the minimum size of a counted element in the data
+ *
+ * Reads the number of elements that follow. This fails if the
+ * remaining data is too small to hold that many, so it is safe to
+ * allocate memory for all of them.
+ *
+ * Returns: the number of elements
+ **/
+guint32
+gtk_css_deserializer_read_count (GtkCssDeserializer *deserializer,
+                                 gsize               element_size)
+{
+  guint32 n = gtk_css_deserializer_read_uint32 (deserializer);
+
+  if (!deserializer->failed && n > (deserializer->end - deserializer->pos) / element_size)
+    {
+      deserializer->failed = TRUE;
+      return 0;
+    }
+
+  return n;
+}
+
+guint64
+gtk_css_deserializer_read_uint64 (GtkCssDeserializer *deserializer)
+{
+  guint64 value;
+
+  if (deserializer->failed || deserializer->end - deserializer->pos < sizeof (guint64))
+    {
+      deserializer->failed = TRUE;
+      return 0;
+    }
+
+  memcpy (&value, deserializer->data + deserializer->pos, sizeof (guint64));
+  deserializer->pos += sizeof (guint64);
+
+  return value;
+}
+
+double
+gtk_css_deserializer_read_double (GtkCssDeserializer *deserializer)
+{
+  double value;
+
+  if (deserializer->failed || deserializer->end - deserializer->pos < sizeof (double))
+    {
+      deserializer->failed = TRUE;
+      return 0;
+    }
+
+  memcpy (&value, deserializer->data + deserializer->pos, sizeof (double));
+  deserializer->pos += sizeof (double);
+
+  return value;
+}
+
+/**
+ * gtk_css_deserializer_read_string:
+ * @deserializer: a #GtkCssDeserializer
+ *
+ * Reads a string written by gtk_css_serializer_write_string().
+ *
+ * Returns: (nullable): the string. It is owned by @deserializer
+ *     and must be copied by users that want to keep it.
+ **/
+const char *
+gtk_css_deserializer_read_string (GtkCssDeserializer *deserializer)
+{
+  guint32 index = gtk_css_deserializer_read_uint32 (deserializer);
+
+  if (deserializer->failed || index == GTK_CSS_SERIALIZER_NONE)
+    return NULL;
+
+  if (index >= deserializer->header.n_strings)
+    {
+      deserializer->failed = TRUE;
+      return NULL;
+    }
+
+  return deserializer->strings[index];
+}
+
+/**
+ * gtk_css_deserializer_read_value0:
+ * @deserializer: a #GtkCssDeserializer
+ *
+ * Reads a value written by gtk_css_serializer_write_value().
+ *
+ * Returns: (transfer full) (nullable): the value or %NULL if %NULL
+ *     was written or reading failed
+ **/
+GtkCssValue *
+gtk_css_deserializer_read_value0 (GtkCssDeserializer *deserializer)
+{
+  guint32 index = gtk_css_deserializer_read_uint32 (deserializer);
+
+  if (deserializer->failed || index == GTK_CSS_SERIALIZER_NONE)
+    return NULL;
+
+  /* Also ensures values only refer to values that come before them */
+  if (index >= deserializer->n_values)
+    {
+      deserializer->failed = TRUE;
+      return NULL;
+    }
+
+  return gtk_css_value_ref (deserializer->values[index]);
+}
+
+/**
+ * gtk_css_deserializer_read_value:
+ * @deserializer: a #GtkCssDeserializer
+ *
+ * Like gtk_css_deserializer_read_value0(), but fails if the value
+ * is %NULL.
+ *
+ * Returns: (transfer full) (nullable): the value or %NULL if reading
+ *     failed
+ **/
+GtkCssValue *
+gtk_css_deserializer_read_value (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *value;
+
+  value = gtk_css_deserializer_read_value0 (deserializer);
+  if (value == NULL)
+    deserializer->failed = TRUE;
+
+  return value;
+}
+
+#define TYPE_MASK(type) (G_GUINT64_CONSTANT (1) << (type))
+
+static GtkCssValue *
+gtk_css_deserializer_read_value_of_types (GtkCssDeserializer *deserializer,
+                                          guint64             type_mask,
+                                          gboolean            allow_none)
+{
+  guint32 index = gtk_css_deserializer_read_uint32 (deserializer);
+
+  if (allow_none && index == GTK_CSS_SERIALIZER_NONE)
+    return NULL;
+
+  if (deserializer->failed ||
+      index >= deserializer->n_values ||
+      (TYPE_MASK (deserializer->types[index]) & type_mask) == 0)
+    {
+      deserializer->failed = TRUE;
+      return NULL;
+    }
+
+  return gtk_css_value_ref (deserializer->values[index]);
+}
+
+/**
+ * gtk_css_deserializer_read_value_of_type:
+ * @deserializer: a #GtkCssDeserializer
+ * @type: the type the value must have
+ *
+ * Like gtk_css_deserializer_read_value(), but also fails if the
+ * value was not written with the given @type. Use this where other
+ * code relies on getting a specific kind of value.
+ *
+ * Returns: (transfer full) (nullable): the value or %NULL if reading
+ *     failed
+ **/
+GtkCssValue *
+gtk_css_deserializer_read_value_of_type (GtkCssDeserializer        *deserializer,
+                                         GtkCssSerializedValueType  type)
+{
+  return gtk_css_deserializer_read_value_of_types (deserializer, TYPE_MASK (type), FALSE);
+}
+
+/**
+ * gtk_css_deserializer_read_number:
+ * @deserializer: a #GtkCssDeserializer
+ *
+ * Like gtk_css_deserializer_read_value_of_type(), but for the
+ * different kinds of numbers.
+ *
+ * Returns: (transfer full) (nullable): the value or %NULL if reading
+ *     failed
+ **/
+GtkCssValue *
+gtk_css_deserializer_read_number (GtkCssDeserializer *deserializer)
+{
+  return gtk_css_deserializer_read_value_of_types (deserializer,
+                                                   TYPE_MASK (GTK_CSS_SERIALIZED_VALUE_DIMENSION) |
+                                                   TYPE_MASK (GTK_CSS_SERIALIZED_VALUE_CALC),
+                                                   FALSE);
+}
+
+/**
+ * gtk_css_deserializer_read_number0:
+ * @deserializer: a #GtkCssDeserializer
+ *
+ * Like gtk_css_deserializer_read_number(), but allows %NULL.
+ *
+ * Returns: (transfer full) (nullable): the value or %NULL if %NULL
+ *     was written or reading failed
+ **/
+GtkCssValue *
+gtk_css_deserializer_read_number0 (GtkCssDeserializer *deserializer)
+{
+  return gtk_css_deserializer_read_value_of_types (deserializer,
+                                                   TYPE_MASK (GTK_CSS_SERIALIZED_VALUE_DIMENSION) |
+                                                   TYPE_MASK (GTK_CSS_SERIALIZED_VALUE_CALC),
+                                                   TRUE);
+}
+
+/**
+ * gtk_css_deserializer_read_color:
+ * @deserializer: a #GtkCssDeserializer
+ *
+ * Like gtk_css_deserializer_read_value_of_type(), but for colors.
+ *
+ * Returns: (transfer full) (nullable): the value or %NULL if reading
+ *     failed
+ **/
+GtkCssValue *
+gtk_css_deserializer_read_color (GtkCssDeserializer *deserializer)
+{
+  return gtk_css_deserializer_read_value_of_type (deserializer, GTK_CSS_SERIALIZED_VALUE_COLOR);
+}
+
+static GtkCssImage *
+gtk_css_deserializer_read_image_data (GtkCssDeserializer        *deserializer,
+                                      GtkCssSerializedImageType  type)
+{
+  switch (type)
+    {
+    case GTK_CSS_SERIALIZED_IMAGE_URL:
+      return gtk_css_image_url_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_IMAGE_ICON_THEME:
+      return gtk_css_image_icon_theme_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_IMAGE_SCALED:
+      return gtk_css_image_scaled_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_IMAGE_RECOLOR:
+      return gtk_css_image_recolor_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_IMAGE_LINEAR:
+      return gtk_css_image_linear_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_IMAGE_RADIAL:
+      return gtk_css_image_radial_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_IMAGE_CROSS_FADE:
+      return gtk_css_image_cross_fade_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_IMAGE_FALLBACK:
+      return gtk_css_image_fallback_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_IMAGE_NONE:
+    default:
+      return NULL;
+    }
+}
+
+/**
+ * gtk_css_deserializer_read_image:
+ * @deserializer: a #GtkCssDeserializer
+ *
+ * Reads an image written by gtk_css_serializer_write_image().
+ *
+ * Returns: (transfer full) (nullable): the image or %NULL if %NULL
+ *     was written or reading failed
+ **/
+GtkCssImage *
+gtk_css_deserializer_read_image (GtkCssDeserializer *deserializer)
+{
+  GtkCssSerializedImageType type;
+  GtkCssImage *image;
+
+  if (deserializer->depth >= GTK_CSS_SERIALIZER_MAX_DEPTH)
+    deserializer->failed = TRUE;
+
+  type = gtk_css_deserializer_read_uint32 (deserializer);
+  if (deserializer->failed || type == GTK_CSS_SERIALIZED_IMAGE_NONE)
+    return NULL;
+
+  deserializer->depth++;
+  image = gtk_css_deserializer_read_image_data (deserializer, type);
+  deserializer->depth--;
+
+  if (image == NULL)
+    deserializer->failed = TRUE;
+  else if (deserializer->failed)
+    g_clear_object (&image);
+
+  return image;
+}
+
+static GtkCssValue *
+gtk_css_deserializer_read_value_data (GtkCssDeserializer        *deserializer,
+                                      GtkCssSerializedValueType  type)
+{
+  switch (type)
+    {
+    case GTK_CSS_SERIALIZED_VALUE_INITIAL:
+      return _gtk_css_initial_value_new ();
+    case GTK_CSS_SERIALIZED_VALUE_INHERIT:
+      return _gtk_css_inherit_value_new ();
+    case GTK_CSS_SERIALIZED_VALUE_UNSET:
+      return _gtk_css_unset_value_new ();
+    case GTK_CSS_SERIALIZED_VALUE_DIMENSION:
+      return gtk_css_dimension_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_CALC:
+      return gtk_css_calc_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_COLOR:
+      return gtk_css_color_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_CORNER:
+      return gtk_css_corner_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_STRING:
+      return gtk_css_string_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_IDENT:
+      return gtk_css_ident_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_ICON_THEME:
+      return gtk_css_icon_theme_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_BORDER:
+      return gtk_css_border_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_BG_SIZE:
+      return gtk_css_bg_size_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_BACKGROUND_REPEAT:
+      return gtk_css_background_repeat_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_BORDER_REPEAT:
+      return gtk_css_border_repeat_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_POSITION:
+      return gtk_css_position_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_PALETTE:
+      return gtk_css_palette_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_EASE:
+      return gtk_css_ease_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_ARRAY:
+      return gtk_css_array_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_SHADOWS:
+      return gtk_css_shadows_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_SHADOW:
+      return gtk_css_shadow_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_TRANSFORM:
+      return gtk_css_transform_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_FILTER:
+      return gtk_css_filter_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_FONT_FEATURES:
+      return gtk_css_font_features_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIATIONS:
+      return gtk_css_font_variations_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_IMAGE:
+      return gtk_css_image_value_deserialize (deserializer);
+    case GTK_CSS_SERIALIZED_VALUE_BORDER_STYLE:
+    case GTK_CSS_SERIALIZED_VALUE_BLEND_MODE:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_SIZE:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_STYLE:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_WEIGHT:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_STRETCH:
+    case GTK_CSS_SERIALIZED_VALUE_TEXT_DECORATION_LINE:
+    case GTK_CSS_SERIALIZED_VALUE_TEXT_DECORATION_STYLE:
+    case GTK_CSS_SERIALIZED_VALUE_AREA:
+    case GTK_CSS_SERIALIZED_VALUE_DIRECTION:
+    case GTK_CSS_SERIALIZED_VALUE_PLAY_STATE:
+    case GTK_CSS_SERIALIZED_VALUE_FILL_MODE:
+    case GTK_CSS_SERIALIZED_VALUE_ICON_STYLE:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_KERNING:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_POSITION:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_CAPS:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_ALTERNATE:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_LIGATURE:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_NUMERIC:
+    case GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_EAST_ASIAN:
+      return gtk_css_enum_value_deserialize (deserializer, type);
+    default:
+      return NULL;
+    }
+}
+
+static gboolean
+gtk_css_deserializer_read_values (GtkCssDeserializer *deserializer)
+{
+  guint32 i;
+
+  deserializer->values = g_new0 (GtkCssValue *, deserializer->header.n_values);
+  deserializer->types = g_new0 (GtkCssSerializedValueType, deserializer->header.n_values);
+
+  for (i = 0; i < deserializer->header.n_values; i++)
+    {
+      GtkCssSerializedRange range;
+      GtkCssSerializedValueType type;
+      GtkCssValue *value;
+
+      memcpy (&range,
+              deserializer->data + deserializer->header.values_offset + i * sizeof (GtkCssSerializedRange),
+              sizeof (GtkCssSerializedRange));
+      if (range.offset > deserializer->size ||
+          range.size > deserializer->size - range.offset)
+        return FALSE;
+
+      deserializer->pos = range.offset;
+      deserializer->end = range.offset + range.size;
+
+      type = gtk_css_deserializer_read_uint32 (deserializer);
+      if (deserializer->failed)
+        return FALSE;
+
+      value = gtk_css_deserializer_read_value_data (deserializer, type);
+      if (value == NULL)
+        return FALSE;
+
+      deserializer->values[i] = value;
+      deserializer->types[i] = type;
+      deserializer->n_values++;
+
+      if (deserializer->failed || deserializer->pos != deserializer->end)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * gtk_css_deserializer_new:
+ * @bytes: data created with gtk_css_serializer_free_to_bytes()
+ *
+ * Checks @bytes and creates all the values in it. The remaining
+ * data can then be read with the gtk_css_deserializer_read_*()
+ * functions.
+ *
+ * Returns: (nullable): a new #GtkCssDeserializer or %NULL if @bytes
+ *     is not valid
+ **/
+GtkCssDeserializer *
+gtk_css_deserializer_new (GBytes *bytes)
+{
+  GtkCssDeserializer *deserializer;
+  guint32 i;
+
+  deserializer = g_slice_new0 (GtkCssDeserializer);
+  deserializer->bytes = g_bytes_ref (bytes);
+  deserializer->data = g_bytes_get_data (bytes, &deserializer->size);
+
+  if (deserializer->size < sizeof (GtkCssSerializedHeader) ||
+      memcmp (deserializer->data, GTK_CSS_SERIALIZER_MAGIC, sizeof (GTK_CSS_SERIALIZER_MAGIC)) != 0)
+    goto invalid;
+
+  memcpy (&deserializer->header, deserializer->data, sizeof (GtkCssSerializedHeader));
+
+  if (deserializer->header.version != GTK_CSS_SERIALIZER_VERSION ||
+      deserializer->header.byte_order != GTK_CSS_SERIALIZER_BYTE_ORDER)
+    goto invalid;
+
+  if (deserializer->header.strings_offset > deserializer->size ||
+      deserializer->header.n_strings > (deserializer->size - deserializer->header.strings_offset) / sizeof (guint32) ||
+      deserializer->header.values_offset > deserializer->size ||
+      deserializer->header.n_values > (deserializer->size - deserializer->header.values_offset) / sizeof (GtkCssSerializedRange) ||
+      deserializer->header.data_offset > deserializer->size ||
+      deserializer->header.data_size > deserializer->size - deserializer->header.data_offset)
+    goto invalid;
+
+  deserializer->strings = g_new (const char *, deserializer->header.n_strings);
+  for (i = 0; i < deserializer->header.n_strings; i++)
+    {
+      guint32 offset;
+      const char *end;
+
+      memcpy (&offset, deserializer->data + deserializer->header.strings_offset + i * sizeof (guint32), sizeof (guint32));
+      if (offset >= deserializer->size)
+        goto invalid;
+
+      end = memchr (deserializer->data + offset, '\0', deserializer->size - offset);
+      if (end == NULL ||
+          !g_utf8_validate ((const char *) deserializer->data + offset, end - (const char *) deserializer->data - offset, NULL))
+        goto invalid;
+
+      deserializer->strings[i] = (const char *) deserializer->data + offset;
+    }
+
+  if (!gtk_css_deserializer_read_values (deserializer))
+    goto invalid;
+
+  deserializer->pos = deserializer->header.data_offset;
+  deserializer->end = deserializer->header.data_offset + deserializer->header.data_size;
+
+  return deserializer;
+
+invalid:
+  gtk_css_deserializer_free (deserializer);
+  return NULL;
+}
+
+void
+gtk_css_deserializer_free (GtkCssDeserializer *deserializer)
+{
+  guint i;
+
+  /* Values we returned hold their own references */
+  for (i = 0; i < deserializer->n_values; i++)
+    gtk_css_value_unref (deserializer->values[i]);
+
+  g_free (deserializer->values);
+  g_free (deserializer->types);
+  g_free (deserializer->strings);
+  g_bytes_unref (deserializer->bytes);
+
+  g_slice_free (GtkCssDeserializer, deserializer);
+}
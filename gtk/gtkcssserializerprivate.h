@@ -0,0 +1,132 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_CSS_SERIALIZER_PRIVATE_H__
+#define __GTK_CSS_SERIALIZER_PRIVATE_H__
+
+#include "gtkcssimageprivate.h"
+#include "gtkcssvalueprivate.h"
+
+G_BEGIN_DECLS
+
+/* Every serialized value and image starts with one of these.
+ * Changing the numbering or the data written for any of them
+ * requires bumping GTK_CSS_SERIALIZER_VERSION. */
+typedef enum /*< skip >*/ {
+  GTK_CSS_SERIALIZED_VALUE_INITIAL,
+  GTK_CSS_SERIALIZED_VALUE_INHERIT,
+  GTK_CSS_SERIALIZED_VALUE_UNSET,
+  GTK_CSS_SERIALIZED_VALUE_DIMENSION,
+  GTK_CSS_SERIALIZED_VALUE_CALC,
+  GTK_CSS_SERIALIZED_VALUE_COLOR,
+  GTK_CSS_SERIALIZED_VALUE_CORNER,
+  GTK_CSS_SERIALIZED_VALUE_STRING,
+  GTK_CSS_SERIALIZED_VALUE_IDENT,
+  GTK_CSS_SERIALIZED_VALUE_ICON_THEME,
+  GTK_CSS_SERIALIZED_VALUE_BORDER,
+  GTK_CSS_SERIALIZED_VALUE_BG_SIZE,
+  GTK_CSS_SERIALIZED_VALUE_BACKGROUND_REPEAT,
+  GTK_CSS_SERIALIZED_VALUE_BORDER_REPEAT,
+  GTK_CSS_SERIALIZED_VALUE_POSITION,
+  GTK_CSS_SERIALIZED_VALUE_PALETTE,
+  GTK_CSS_SERIALIZED_VALUE_EASE,
+  GTK_CSS_SERIALIZED_VALUE_ARRAY,
+  GTK_CSS_SERIALIZED_VALUE_SHADOWS,
+  GTK_CSS_SERIALIZED_VALUE_SHADOW,
+  GTK_CSS_SERIALIZED_VALUE_TRANSFORM,
+  GTK_CSS_SERIALIZED_VALUE_FILTER,
+  GTK_CSS_SERIALIZED_VALUE_FONT_FEATURES,
+  GTK_CSS_SERIALIZED_VALUE_FONT_VARIATIONS,
+  GTK_CSS_SERIALIZED_VALUE_IMAGE,
+  /* enums, see gtkcssenumvalue.c */
+  GTK_CSS_SERIALIZED_VALUE_BORDER_STYLE,
+  GTK_CSS_SERIALIZED_VALUE_BLEND_MODE,
+  GTK_CSS_SERIALIZED_VALUE_FONT_SIZE,
+  GTK_CSS_SERIALIZED_VALUE_FONT_STYLE,
+  GTK_CSS_SERIALIZED_VALUE_FONT_WEIGHT,
+  GTK_CSS_SERIALIZED_VALUE_FONT_STRETCH,
+  GTK_CSS_SERIALIZED_VALUE_TEXT_DECORATION_LINE,
+  GTK_CSS_SERIALIZED_VALUE_TEXT_DECORATION_STYLE,
+  GTK_CSS_SERIALIZED_VALUE_AREA,
+  GTK_CSS_SERIALIZED_VALUE_DIRECTION,
+  GTK_CSS_SERIALIZED_VALUE_PLAY_STATE,
+  GTK_CSS_SERIALIZED_VALUE_FILL_MODE,
+  GTK_CSS_SERIALIZED_VALUE_ICON_STYLE,
+  GTK_CSS_SERIALIZED_VALUE_FONT_KERNING,
+  GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_POSITION,
+  GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_CAPS,
+  GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_ALTERNATE,
+  GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_LIGATURE,
+  GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_NUMERIC,
+  GTK_CSS_SERIALIZED_VALUE_FONT_VARIANT_EAST_ASIAN
+} GtkCssSerializedValueType;
+
+typedef enum /*< skip >*/ {
+  GTK_CSS_SERIALIZED_IMAGE_NONE,
+  GTK_CSS_SERIALIZED_IMAGE_URL,
+  GTK_CSS_SERIALIZED_IMAGE_ICON_THEME,
+  GTK_CSS_SERIALIZED_IMAGE_SCALED,
+  GTK_CSS_SERIALIZED_IMAGE_RECOLOR,
+  GTK_CSS_SERIALIZED_IMAGE_LINEAR,
+  GTK_CSS_SERIALIZED_IMAGE_RADIAL,
+  GTK_CSS_SERIALIZED_IMAGE_CROSS_FADE,
+  GTK_CSS_SERIALIZED_IMAGE_FALLBACK
+} GtkCssSerializedImageType;
+
+GtkCssSerializer *      gtk_css_serializer_new                  (void);
+GBytes *                gtk_css_serializer_free_to_bytes        (GtkCssSerializer       *serializer);
+
+void                    gtk_css_serializer_fail                 (GtkCssSerializer       *serializer);
+gboolean                gtk_css_serializer_has_failed           (GtkCssSerializer       *serializer);
+
+void                    gtk_css_serializer_write_uint32         (GtkCssSerializer       *serializer,
+                                                                 guint32                 value);
+void                    gtk_css_serializer_write_uint64         (GtkCssSerializer       *serializer,
+                                                                 guint64                 value);
+void                    gtk_css_serializer_write_double         (GtkCssSerializer       *serializer,
+                                                                 double                  value);
+void                    gtk_css_serializer_write_string         (GtkCssSerializer       *serializer,
+                                                                 const char             *string);
+void                    gtk_css_serializer_write_value          (GtkCssSerializer       *serializer,
+                                                                 const GtkCssValue      *value);
+void                    gtk_css_serializer_write_image          (GtkCssSerializer       *serializer,
+                                                                 GtkCssImage            *image);
+
+GtkCssDeserializer *    gtk_css_deserializer_new                (GBytes                 *bytes);
+void                    gtk_css_deserializer_free               (GtkCssDeserializer     *deserializer);
+
+void                    gtk_css_deserializer_fail               (GtkCssDeserializer     *deserializer);
+gboolean                gtk_css_deserializer_has_failed         (GtkCssDeserializer     *deserializer);
+gboolean                gtk_css_deserializer_is_eof             (GtkCssDeserializer     *deserializer);
+
+guint32                 gtk_css_deserializer_read_uint32        (GtkCssDeserializer     *deserializer);
+guint32                 gtk_css_deserializer_read_count         (GtkCssDeserializer     *deserializer,
+                                                                 gsize                   element_size);
+guint64                 gtk_css_deserializer_read_uint64        (GtkCssDeserializer     *deserializer);
+double                  gtk_css_deserializer_read_double        (GtkCssDeserializer     *deserializer);
+const char *            gtk_css_deserializer_read_string        (GtkCssDeserializer     *deserializer);
+GtkCssValue *           gtk_css_deserializer_read_value         (GtkCssDeserializer     *deserializer);
+GtkCssValue *           gtk_css_deserializer_read_value0        (GtkCssDeserializer     *deserializer);
+GtkCssValue *           gtk_css_deserializer_read_value_of_type (GtkCssDeserializer     *deserializer,
+                                                                 GtkCssSerializedValueType type);
+GtkCssValue *           gtk_css_deserializer_read_number        (GtkCssDeserializer     *deserializer);
+GtkCssValue *           gtk_css_deserializer_read_number0       (GtkCssDeserializer     *deserializer);
+GtkCssValue *           gtk_css_deserializer_read_color         (GtkCssDeserializer     *deserializer);
+GtkCssImage *           gtk_css_deserializer_read_image         (GtkCssDeserializer     *deserializer);
+
+G_END_DECLS
+
+#endif /* __GTK_CSS_SERIALIZER_PRIVATE_H__ */
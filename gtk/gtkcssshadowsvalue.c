@@ -23,6 +23,7 @@
 
 #include <math.h>
 
+#include "gtkcssserializerprivate.h"
 #include "gtkcssshadowvalueprivate.h"
 #include "gtksnapshot.h"
 
@@ -199,6 +200,18 @@ gtk_css_value_shadows_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_value_shadows_serialize (const GtkCssValue *value,
+                                 GtkCssSerializer  *serializer)
+{
+  guint i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_SHADOWS);
+  gtk_css_serializer_write_uint32 (serializer, value->len);
+  for (i = 0; i < value->len; i++)
+    gtk_css_serializer_write_value (serializer, value->values[i]);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_SHADOWS = {
   gtk_css_value_shadows_free,
   gtk_css_value_shadows_compute,
@@ -206,7 +219,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_SHADOWS = {
   gtk_css_value_shadows_transition,
   NULL,
   NULL,
-  gtk_css_value_shadows_print
+  gtk_css_value_shadows_print,
+  gtk_css_value_shadows_serialize
 };
 
 static GtkCssValue none_singleton = { &GTK_CSS_VALUE_SHADOWS, 1, 0, { NULL } };
@@ -263,6 +277,38 @@ _gtk_css_shadows_value_parse (GtkCssParser *parser,
   return result;
 }
 
+GtkCssValue *
+gtk_css_shadows_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue **values, *result;
+  guint i, len;
+
+  len = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  if (gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+  if (len == 0)
+    return _gtk_css_shadows_value_new_none ();
+
+  values = g_new (GtkCssValue *, len);
+  for (i = 0; i < len; i++)
+    values[i] = gtk_css_deserializer_read_value_of_type (deserializer, GTK_CSS_SERIALIZED_VALUE_SHADOW);
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      for (i = 0; i < len; i++)
+        g_clear_pointer (&values[i], _gtk_css_value_unref);
+      result = NULL;
+    }
+  else
+    {
+      result = gtk_css_shadows_value_new (values, len);
+    }
+
+  g_free (values);
+
+  return result;
+}
+
 gboolean
 _gtk_css_shadows_value_is_none (const GtkCssValue *shadows)
 {
@@ -33,6 +33,7 @@ G_BEGIN_DECLS
 GtkCssValue *   _gtk_css_shadows_value_new_none       (void);
 GtkCssValue *   _gtk_css_shadows_value_parse          (GtkCssParser             *parser,
                                                        gboolean                  box_shadow_mode);
+GtkCssValue *   gtk_css_shadows_value_deserialize     (GtkCssDeserializer       *deserializer);
 
 gboolean        _gtk_css_shadows_value_is_none        (const GtkCssValue        *shadows);
 
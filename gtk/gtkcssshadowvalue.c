@@ -24,6 +24,7 @@
 #include "gtkcsscolorvalueprivate.h"
 #include "gtkcssnumbervalueprivate.h"
 #include "gtkcssrgbavalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtksnapshot.h"
 #include "gtkstylecontextprivate.h"
 #include "gtkpango.h"
@@ -154,6 +155,19 @@ gtk_css_value_shadow_print (const GtkCssValue *shadow,
 
 }
 
+static void
+gtk_css_value_shadow_serialize (const GtkCssValue *shadow,
+                                GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_SHADOW);
+  gtk_css_serializer_write_value (serializer, shadow->hoffset);
+  gtk_css_serializer_write_value (serializer, shadow->voffset);
+  gtk_css_serializer_write_value (serializer, shadow->radius);
+  gtk_css_serializer_write_value (serializer, shadow->spread);
+  gtk_css_serializer_write_uint32 (serializer, shadow->inset);
+  gtk_css_serializer_write_value (serializer, shadow->color);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_SHADOW = {
   gtk_css_value_shadow_free,
   gtk_css_value_shadow_compute,
@@ -161,7 +175,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_SHADOW = {
   gtk_css_value_shadow_transition,
   NULL,
   NULL,
-  gtk_css_value_shadow_print
+  gtk_css_value_shadow_print,
+  gtk_css_value_shadow_serialize
 };
 
 static GtkCssValue *
@@ -201,6 +216,32 @@ _gtk_css_shadow_value_new_for_transition (GtkCssValue *target)
                                    _gtk_css_rgba_value_new_from_rgba (&transparent));
 }
 
+GtkCssValue *
+gtk_css_shadow_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *hoffset, *voffset, *radius, *spread, *color;
+  gboolean inset;
+
+  hoffset = gtk_css_deserializer_read_number (deserializer);
+  voffset = gtk_css_deserializer_read_number (deserializer);
+  radius = gtk_css_deserializer_read_number (deserializer);
+  spread = gtk_css_deserializer_read_number (deserializer);
+  inset = gtk_css_deserializer_read_uint32 (deserializer) ? TRUE : FALSE;
+  color = gtk_css_deserializer_read_color (deserializer);
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      g_clear_pointer (&hoffset, _gtk_css_value_unref);
+      g_clear_pointer (&voffset, _gtk_css_value_unref);
+      g_clear_pointer (&radius, _gtk_css_value_unref);
+      g_clear_pointer (&spread, _gtk_css_value_unref);
+      g_clear_pointer (&color, _gtk_css_value_unref);
+      return NULL;
+    }
+
+  return gtk_css_shadow_value_new (hoffset, voffset, radius, spread, inset, color);
+}
+
 static gboolean
 value_is_done_parsing (GtkCssParser *parser)
 {
@@ -21,11 +21,13 @@
 
 #include "gtkcssstaticstyleprivate.h"
 
+#include "gtkcssanimatedstyleprivate.h"
 #include "gtkcssanimationprivate.h"
 #include "gtkcssarrayvalueprivate.h"
 #include "gtkcssenumvalueprivate.h"
 #include "gtkcssinheritvalueprivate.h"
 #include "gtkcssinitialvalueprivate.h"
+#include "gtkcsslookupprivate.h"
 #include "gtkcssnumbervalueprivate.h"
 #include "gtkcsssectionprivate.h"
 #include "gtkcssshorthandpropertyprivate.h"
@@ -39,6 +41,241 @@
 #include "gtkstylepropertyprivate.h"
 #include "gtkstyleproviderprivate.h"
 
+/* Computed values are kept in refcounted groups of related properties.
+ * Groups are immutable once the style is computed, so styles can share
+ * them: a group that only contains inherited properties and has nothing
+ * specified is taken from the parent, and a group that was computed
+ * without any specified values is replaced by an equal shared one.
+ */
+struct _GtkCssValues
+{
+  guint ref_count;
+  guint n_values;
+  GtkCssValue *values[1];
+};
+
+static const guint core_properties[] = {
+  GTK_CSS_PROPERTY_COLOR,
+  GTK_CSS_PROPERTY_DPI,
+  GTK_CSS_PROPERTY_FONT_SIZE,
+  GTK_CSS_PROPERTY_ICON_THEME,
+  GTK_CSS_PROPERTY_ICON_PALETTE
+};
+
+static const guint font_properties[] = {
+  GTK_CSS_PROPERTY_FONT_FAMILY,
+  GTK_CSS_PROPERTY_FONT_STYLE,
+  GTK_CSS_PROPERTY_FONT_WEIGHT,
+  GTK_CSS_PROPERTY_FONT_STRETCH,
+  GTK_CSS_PROPERTY_LETTER_SPACING,
+  GTK_CSS_PROPERTY_TEXT_SHADOW,
+  GTK_CSS_PROPERTY_CARET_COLOR,
+  GTK_CSS_PROPERTY_SECONDARY_CARET_COLOR,
+  GTK_CSS_PROPERTY_FONT_FEATURE_SETTINGS,
+  GTK_CSS_PROPERTY_FONT_VARIATION_SETTINGS
+};
+
+static const guint font_variant_properties[] = {
+  GTK_CSS_PROPERTY_TEXT_DECORATION_LINE,
+  GTK_CSS_PROPERTY_TEXT_DECORATION_COLOR,
+  GTK_CSS_PROPERTY_TEXT_DECORATION_STYLE,
+  GTK_CSS_PROPERTY_FONT_KERNING,
+  GTK_CSS_PROPERTY_FONT_VARIANT_LIGATURES,
+  GTK_CSS_PROPERTY_FONT_VARIANT_POSITION,
+  GTK_CSS_PROPERTY_FONT_VARIANT_CAPS,
+  GTK_CSS_PROPERTY_FONT_VARIANT_NUMERIC,
+  GTK_CSS_PROPERTY_FONT_VARIANT_ALTERNATES,
+  GTK_CSS_PROPERTY_FONT_VARIANT_EAST_ASIAN
+};
+
+static const guint icon_properties[] = {
+  GTK_CSS_PROPERTY_ICON_SIZE,
+  GTK_CSS_PROPERTY_ICON_SHADOW,
+  GTK_CSS_PROPERTY_ICON_STYLE
+};
+
+static const guint background_properties[] = {
+  GTK_CSS_PROPERTY_BACKGROUND_COLOR,
+  GTK_CSS_PROPERTY_BOX_SHADOW,
+  GTK_CSS_PROPERTY_BACKGROUND_CLIP,
+  GTK_CSS_PROPERTY_BACKGROUND_ORIGIN,
+  GTK_CSS_PROPERTY_BACKGROUND_SIZE,
+  GTK_CSS_PROPERTY_BACKGROUND_POSITION,
+  GTK_CSS_PROPERTY_BACKGROUND_REPEAT,
+  GTK_CSS_PROPERTY_BACKGROUND_IMAGE,
+  GTK_CSS_PROPERTY_BACKGROUND_BLEND_MODE
+};
+
+static const guint border_properties[] = {
+  GTK_CSS_PROPERTY_BORDER_TOP_STYLE,
+  GTK_CSS_PROPERTY_BORDER_TOP_WIDTH,
+  GTK_CSS_PROPERTY_BORDER_LEFT_STYLE,
+  GTK_CSS_PROPERTY_BORDER_LEFT_WIDTH,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_STYLE,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_WIDTH,
+  GTK_CSS_PROPERTY_BORDER_RIGHT_STYLE,
+  GTK_CSS_PROPERTY_BORDER_RIGHT_WIDTH,
+  GTK_CSS_PROPERTY_BORDER_TOP_LEFT_RADIUS,
+  GTK_CSS_PROPERTY_BORDER_TOP_RIGHT_RADIUS,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_RIGHT_RADIUS,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_LEFT_RADIUS,
+  GTK_CSS_PROPERTY_BORDER_TOP_COLOR,
+  GTK_CSS_PROPERTY_BORDER_RIGHT_COLOR,
+  GTK_CSS_PROPERTY_BORDER_BOTTOM_COLOR,
+  GTK_CSS_PROPERTY_BORDER_LEFT_COLOR,
+  GTK_CSS_PROPERTY_BORDER_IMAGE_SOURCE,
+  GTK_CSS_PROPERTY_BORDER_IMAGE_REPEAT,
+  GTK_CSS_PROPERTY_BORDER_IMAGE_SLICE,
+  GTK_CSS_PROPERTY_BORDER_IMAGE_WIDTH
+};
+
+static const guint outline_properties[] = {
+  GTK_CSS_PROPERTY_OUTLINE_STYLE,
+  GTK_CSS_PROPERTY_OUTLINE_WIDTH,
+  GTK_CSS_PROPERTY_OUTLINE_OFFSET,
+  GTK_CSS_PROPERTY_OUTLINE_TOP_LEFT_RADIUS,
+  GTK_CSS_PROPERTY_OUTLINE_TOP_RIGHT_RADIUS,
+  GTK_CSS_PROPERTY_OUTLINE_BOTTOM_RIGHT_RADIUS,
+  GTK_CSS_PROPERTY_OUTLINE_BOTTOM_LEFT_RADIUS,
+  GTK_CSS_PROPERTY_OUTLINE_COLOR
+};
+
+static const guint size_properties[] = {
+  GTK_CSS_PROPERTY_MARGIN_TOP,
+  GTK_CSS_PROPERTY_MARGIN_LEFT,
+  GTK_CSS_PROPERTY_MARGIN_BOTTOM,
+  GTK_CSS_PROPERTY_MARGIN_RIGHT,
+  GTK_CSS_PROPERTY_PADDING_TOP,
+  GTK_CSS_PROPERTY_PADDING_LEFT,
+  GTK_CSS_PROPERTY_PADDING_BOTTOM,
+  GTK_CSS_PROPERTY_PADDING_RIGHT,
+  GTK_CSS_PROPERTY_BORDER_SPACING,
+  GTK_CSS_PROPERTY_MIN_WIDTH,
+  GTK_CSS_PROPERTY_MIN_HEIGHT
+};
+
+static const guint animation_properties[] = {
+  GTK_CSS_PROPERTY_TRANSITION_PROPERTY,
+  GTK_CSS_PROPERTY_TRANSITION_DURATION,
+  GTK_CSS_PROPERTY_TRANSITION_TIMING_FUNCTION,
+  GTK_CSS_PROPERTY_TRANSITION_DELAY,
+  GTK_CSS_PROPERTY_ANIMATION_NAME,
+  GTK_CSS_PROPERTY_ANIMATION_DURATION,
+  GTK_CSS_PROPERTY_ANIMATION_TIMING_FUNCTION,
+  GTK_CSS_PROPERTY_ANIMATION_ITERATION_COUNT,
+  GTK_CSS_PROPERTY_ANIMATION_DIRECTION,
+  GTK_CSS_PROPERTY_ANIMATION_PLAY_STATE,
+  GTK_CSS_PROPERTY_ANIMATION_DELAY,
+  GTK_CSS_PROPERTY_ANIMATION_FILL_MODE
+};
+
+static const guint other_properties[] = {
+  GTK_CSS_PROPERTY_ICON_SOURCE,
+  GTK_CSS_PROPERTY_ICON_TRANSFORM,
+  GTK_CSS_PROPERTY_ICON_FILTER,
+  GTK_CSS_PROPERTY_OPACITY,
+  GTK_CSS_PROPERTY_FILTER,
+  GTK_CSS_PROPERTY_GTK_KEY_BINDINGS
+};
+
+static const struct {
+  const guint *properties;
+  guint n_properties;
+} value_groups[GTK_CSS_N_VALUE_GROUPS] = {
+  { core_properties, G_N_ELEMENTS (core_properties) },
+  { font_properties, G_N_ELEMENTS (font_properties) },
+  { font_variant_properties, G_N_ELEMENTS (font_variant_properties) },
+  { icon_properties, G_N_ELEMENTS (icon_properties) },
+  { background_properties, G_N_ELEMENTS (background_properties) },
+  { border_properties, G_N_ELEMENTS (border_properties) },
+  { outline_properties, G_N_ELEMENTS (outline_properties) },
+  { size_properties, G_N_ELEMENTS (size_properties) },
+  { animation_properties, G_N_ELEMENTS (animation_properties) },
+  { other_properties, G_N_ELEMENTS (other_properties) }
+};
+
+/* Filled in class_init */
+static guint8 property_group[GTK_CSS_PROPERTY_N_PROPERTIES];
+static guint8 property_index[GTK_CSS_PROPERTY_N_PROPERTIES];
+static gboolean group_is_inherited[GTK_CSS_N_VALUE_GROUPS];
+
+/* Non-inherited groups computed without specified values, for sharing */
+static GtkCssValues *unspecified_groups[GTK_CSS_N_VALUE_GROUPS];
+
+static GtkCssValues *
+gtk_css_values_new (guint group)
+{
+  GtkCssValues *values;
+  guint n_values = value_groups[group].n_properties;
+
+  values = g_malloc0 (sizeof (GtkCssValues) + (n_values - 1) * sizeof (GtkCssValue *));
+  values->ref_count = 1;
+  values->n_values = n_values;
+
+  return values;
+}
+
+static GtkCssValues *
+gtk_css_values_ref (GtkCssValues *values)
+{
+  values->ref_count++;
+
+  return values;
+}
+
+static void
+gtk_css_values_unref (GtkCssValues *values)
+{
+  guint i;
+
+  values->ref_count--;
+  if (values->ref_count > 0)
+    return;
+
+  for (i = 0; i < values->n_values; i++)
+    {
+      if (values->values[i])
+        _gtk_css_value_unref (values->values[i]);
+    }
+
+  g_free (values);
+}
+
+static GtkCssValues *
+gtk_css_values_copy (GtkCssValues *values,
+                     guint         group)
+{
+  GtkCssValues *copy;
+  guint i;
+
+  copy = gtk_css_values_new (group);
+  for (i = 0; i < values->n_values; i++)
+    {
+      if (values->values[i])
+        copy->values[i] = _gtk_css_value_ref (values->values[i]);
+    }
+
+  return copy;
+}
+
+static gboolean
+gtk_css_values_equal (const GtkCssValues *values1,
+                      const GtkCssValues *values2)
+{
+  guint i;
+
+  if (values1 == values2)
+    return TRUE;
+
+  for (i = 0; i < values1->n_values; i++)
+    {
+      if (!_gtk_css_value_equal0 (values1->values[i], values2->values[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 G_DEFINE_TYPE (GtkCssStaticStyle, gtk_css_static_style, GTK_TYPE_CSS_STYLE)
 
 static GtkCssValue *
@@ -47,8 +284,12 @@ gtk_css_static_style_get_value (GtkCssStyle *style,
 {
   /* This is called a lot, so we avoid a dynamic type check here */
   GtkCssStaticStyle *sstyle = (GtkCssStaticStyle *) style;
+  GtkCssValues *values = sstyle->groups[property_group[id]];
+
+  if (values == NULL)
+    return NULL;
 
-  return sstyle->values[id];
+  return values->values[property_index[id]];
 }
 
 static GtkCssSection *
@@ -70,11 +311,8 @@ gtk_css_static_style_dispose (GObject *object)
   GtkCssStaticStyle *style = GTK_CSS_STATIC_STYLE (object);
   guint i;
 
-  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
-    {
-      if (style->values[i])
-        _gtk_css_value_unref (style->values[i]);
-    }
+  for (i = 0; i < GTK_CSS_N_VALUE_GROUPS; i++)
+    g_clear_pointer (&style->groups[i], gtk_css_values_unref);
   if (style->sections)
     {
       g_ptr_array_unref (style->sections);
@@ -89,6 +327,27 @@ gtk_css_static_style_class_init (GtkCssStaticStyleClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
   GtkCssStyleClass *style_class = GTK_CSS_STYLE_CLASS (klass);
+  guint i, j, n_assigned = 0;
+
+  for (i = 0; i < GTK_CSS_N_VALUE_GROUPS; i++)
+    {
+      group_is_inherited[i] = TRUE;
+
+      for (j = 0; j < value_groups[i].n_properties; j++)
+        {
+          guint id = value_groups[i].properties[j];
+
+          property_group[id] = i;
+          property_index[id] = j;
+
+          if (!_gtk_css_style_property_is_inherit (_gtk_css_style_property_lookup_by_id (id)))
+            group_is_inherited[i] = FALSE;
+        }
+
+      n_assigned += value_groups[i].n_properties;
+    }
+
+  g_assert (n_assigned == GTK_CSS_PROPERTY_N_PROPERTIES);
 
   object_class->dispose = gtk_css_static_style_dispose;
 
@@ -114,9 +373,24 @@ gtk_css_static_style_set_value (GtkCssStaticStyle *style,
                                 GtkCssValue       *value,
                                 GtkCssSection     *section)
 {
-  if (style->values[id])
-    _gtk_css_value_unref (style->values[id]);
-  style->values[id] = _gtk_css_value_ref (value);
+  guint group = property_group[id];
+  GtkCssValues *values = style->groups[group];
+
+  if (values == NULL)
+    {
+      values = style->groups[group] = gtk_css_values_new (group);
+    }
+  else if (values->ref_count > 1)
+    {
+      /* Never modify a group that is shared with other styles */
+      style->groups[group] = gtk_css_values_copy (values, group);
+      gtk_css_values_unref (values);
+      values = style->groups[group];
+    }
+
+  if (values->values[property_index[id]])
+    _gtk_css_value_unref (values->values[property_index[id]]);
+  values->values[property_index[id]] = _gtk_css_value_ref (value);
 
   if (style->sections && style->sections->len > id && g_ptr_array_index (style->sections, id))
     {
@@ -166,6 +440,113 @@ gtk_css_static_style_get_default (void)
   return default_style;
 }
 
+/* Returns the group of @parent_style if it holds exactly the computed
+ * values that @parent_style returns, i.e. none of them are animated.
+ */
+static GtkCssValues *
+gtk_css_static_style_get_parent_group (GtkCssStyle *parent_style,
+                                       guint        group)
+{
+  if (parent_style == NULL)
+    return NULL;
+
+  if (GTK_IS_CSS_ANIMATED_STYLE (parent_style))
+    {
+      GtkCssAnimatedStyle *animated = GTK_CSS_ANIMATED_STYLE (parent_style);
+      guint i;
+
+      if (animated->animated_values)
+        {
+          for (i = 0; i < value_groups[group].n_properties; i++)
+            {
+              guint id = value_groups[group].properties[i];
+
+              if (id < animated->animated_values->len &&
+                  g_ptr_array_index (animated->animated_values, id))
+                return NULL;
+            }
+        }
+
+      parent_style = animated->style;
+    }
+
+  if (!GTK_IS_CSS_STATIC_STYLE (parent_style))
+    return NULL;
+
+  return GTK_CSS_STATIC_STYLE (parent_style)->groups[group];
+}
+
+static void
+gtk_css_static_style_resolve (GtkCssStaticStyle *style,
+                              GtkCssLookup      *lookup,
+                              GtkStyleProvider  *provider,
+                              GtkCssStyle       *parent_style)
+{
+  gboolean specified[GTK_CSS_N_VALUE_GROUPS] = { FALSE, };
+  gboolean shared[GTK_CSS_N_VALUE_GROUPS] = { FALSE, };
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if (lookup->values[i].value)
+        specified[property_group[i]] = TRUE;
+    }
+
+  for (i = 0; i < GTK_CSS_N_VALUE_GROUPS; i++)
+    {
+      GtkCssValues *parent_group;
+
+      if (specified[i] || !group_is_inherited[i])
+        continue;
+
+      parent_group = gtk_css_static_style_get_parent_group (parent_style, i);
+      if (parent_group)
+        {
+          style->groups[i] = gtk_css_values_ref (parent_group);
+          shared[i] = TRUE;
+        }
+    }
+
+  /* Properties are computed in id order, because computing a value
+   * may look at values with a lower id, such as color or font-size.
+   */
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if (shared[property_group[i]])
+        continue;
+
+      if (lookup->values[i].value ||
+          _gtk_bitmask_get (lookup->missing, i))
+        gtk_css_static_style_compute_value (style,
+                                            provider,
+                                            parent_style,
+                                            i,
+                                            lookup->values[i].value,
+                                            lookup->values[i].section);
+      /* else not a relevant property */
+    }
+
+  for (i = 0; i < GTK_CSS_N_VALUE_GROUPS; i++)
+    {
+      /* Inherited groups are shared with the parent above. Caching
+       * them here would keep things like the icon theme alive.
+       */
+      if (specified[i] || shared[i] || group_is_inherited[i] ||
+          style->groups[i] == NULL)
+        continue;
+
+      if (unspecified_groups[i] == NULL)
+        {
+          unspecified_groups[i] = gtk_css_values_ref (style->groups[i]);
+        }
+      else if (gtk_css_values_equal (style->groups[i], unspecified_groups[i]))
+        {
+          gtk_css_values_unref (style->groups[i]);
+          style->groups[i] = gtk_css_values_ref (unspecified_groups[i]);
+        }
+    }
+}
+
 GtkCssStyle *
 gtk_css_static_style_new_compute (GtkStyleProvider    *provider,
                                   const GtkCssMatcher *matcher,
@@ -187,10 +568,7 @@ gtk_css_static_style_new_compute (GtkStyleProvider    *provider,
 
   result->change = change;
 
-  _gtk_css_lookup_resolve (&lookup,
-                           provider,
-                           result,
-                           parent);
+  gtk_css_static_style_resolve (result, &lookup, provider, parent);
 
   _gtk_css_lookup_destroy (&lookup);
 
@@ -237,6 +615,48 @@ gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
   _gtk_css_value_unref (specified);
 }
 
+/*
+ * gtk_css_static_style_add_difference:
+ * @accumulated: the properties that are already known to differ
+ * @style: a #GtkCssStaticStyle
+ * @other: the #GtkCssStaticStyle to compare with
+ *
+ * Like gtk_css_style_add_difference(), but skips groups of
+ * properties that both styles share.
+ *
+ * Returns: @accumulated with the differing properties added
+ */
+GtkBitmask *
+gtk_css_static_style_add_difference (GtkBitmask        *accumulated,
+                                     GtkCssStaticStyle *style,
+                                     GtkCssStaticStyle *other)
+{
+  guint i, j;
+
+  for (i = 0; i < GTK_CSS_N_VALUE_GROUPS; i++)
+    {
+      GtkCssValues *values = style->groups[i];
+      GtkCssValues *other_values = other->groups[i];
+
+      if (values == other_values)
+        continue;
+
+      for (j = 0; j < value_groups[i].n_properties; j++)
+        {
+          guint id = value_groups[i].properties[j];
+
+          if (_gtk_bitmask_get (accumulated, id))
+            continue;
+
+          if (!_gtk_css_value_equal0 (values ? values->values[j] : NULL,
+                                      other_values ? other_values->values[j] : NULL))
+            accumulated = _gtk_bitmask_set (accumulated, id, TRUE);
+        }
+    }
+
+  return accumulated;
+}
+
 GtkCssChange
 gtk_css_static_style_get_change (GtkCssStaticStyle *style)
 {
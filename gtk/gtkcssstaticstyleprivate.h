@@ -34,12 +34,28 @@ G_BEGIN_DECLS
 
 typedef struct _GtkCssStaticStyle           GtkCssStaticStyle;
 typedef struct _GtkCssStaticStyleClass      GtkCssStaticStyleClass;
+typedef struct _GtkCssValues                GtkCssValues;
+
+typedef enum {
+  GTK_CSS_CORE_VALUES,
+  GTK_CSS_FONT_VALUES,
+  GTK_CSS_FONT_VARIANT_VALUES,
+  GTK_CSS_ICON_VALUES,
+  GTK_CSS_BACKGROUND_VALUES,
+  GTK_CSS_BORDER_VALUES,
+  GTK_CSS_OUTLINE_VALUES,
+  GTK_CSS_SIZE_VALUES,
+  GTK_CSS_ANIMATION_VALUES,
+  GTK_CSS_OTHER_VALUES,
+  /* add more */
+  GTK_CSS_N_VALUE_GROUPS
+} GtkCssValueGroup;
 
 struct _GtkCssStaticStyle
 {
   GtkCssStyle parent;
 
-  GtkCssValue           *values[GTK_CSS_PROPERTY_N_PROPERTIES]; /* the values */
+  GtkCssValues          *groups[GTK_CSS_N_VALUE_GROUPS]; /* the values, possibly shared */
   GPtrArray             *sections;             /* sections the values are defined in */
 
   GtkCssChange           change;               /* change as returned by value lookup */
@@ -66,6 +82,10 @@ void                    gtk_css_static_style_compute_value      (GtkCssStaticSty
 
 GtkCssChange            gtk_css_static_style_get_change         (GtkCssStaticStyle      *style);
 
+GtkBitmask *            gtk_css_static_style_add_difference     (GtkBitmask             *accumulated,
+                                                                 GtkCssStaticStyle      *style,
+                                                                 GtkCssStaticStyle      *other);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_STATIC_STYLE_PRIVATE_H__ */
@@ -19,6 +19,8 @@
 
 #include "gtkcssstringvalueprivate.h"
 
+#include "gtkcssserializerprivate.h"
+
 #include <string.h>
 
 struct _GtkCssValue {
@@ -116,6 +118,22 @@ out:
   ;
 }
 
+static void
+gtk_css_value_string_serialize (const GtkCssValue *value,
+                                GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_STRING);
+  gtk_css_serializer_write_string (serializer, value->string);
+}
+
+static void
+gtk_css_value_ident_serialize (const GtkCssValue *value,
+                               GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_IDENT);
+  gtk_css_serializer_write_string (serializer, value->string);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_STRING = {
   gtk_css_value_string_free,
   gtk_css_value_string_compute,
@@ -123,7 +141,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_STRING = {
   gtk_css_value_string_transition,
   NULL,
   NULL,
-  gtk_css_value_string_print
+  gtk_css_value_string_print,
+  gtk_css_value_string_serialize
 };
 
 static const GtkCssValueClass GTK_CSS_VALUE_IDENT = {
@@ -133,7 +152,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_IDENT = {
   gtk_css_value_string_transition,
   NULL,
   NULL,
-  gtk_css_value_ident_print
+  gtk_css_value_ident_print,
+  gtk_css_value_ident_serialize
 };
 
 GtkCssValue *
@@ -167,6 +187,18 @@ _gtk_css_string_value_parse (GtkCssParser *parser)
   return _gtk_css_string_value_new_take (s);
 }
 
+GtkCssValue *
+gtk_css_string_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  const char *string;
+
+  string = gtk_css_deserializer_read_string (deserializer);
+  if (gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+
+  return _gtk_css_string_value_new (string);
+}
+
 const char *
 _gtk_css_string_value_get (const GtkCssValue *value)
 {
@@ -207,6 +239,18 @@ _gtk_css_ident_value_try_parse (GtkCssParser *parser)
   return _gtk_css_ident_value_new_take (ident);
 }
 
+GtkCssValue *
+gtk_css_ident_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  const char *ident;
+
+  ident = gtk_css_deserializer_read_string (deserializer);
+  if (ident == NULL)
+    return NULL;
+
+  return _gtk_css_ident_value_new (ident);
+}
+
 const char *
 _gtk_css_ident_value_get (const GtkCssValue *value)
 {
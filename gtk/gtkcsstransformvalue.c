@@ -24,6 +24,7 @@
 
 #include "gtkcsstransformvalueprivate.h"
 #include "gtkcssnumbervalueprivate.h"
+#include "gtkcssserializerprivate.h"
 
 typedef union _GtkCssTransform GtkCssTransform;
 
@@ -702,6 +703,67 @@ gtk_css_value_transform_print (const GtkCssValue *value,
     }
 }
 
+static void
+gtk_css_transform_serialize (const GtkCssTransform *transform,
+                             GtkCssSerializer      *serializer)
+{
+  float f[16];
+  guint i;
+
+  gtk_css_serializer_write_uint32 (serializer, transform->type);
+
+  switch (transform->type)
+    {
+    case GTK_CSS_TRANSFORM_MATRIX:
+      graphene_matrix_to_float (&transform->matrix.matrix, f);
+      for (i = 0; i < 16; i++)
+        gtk_css_serializer_write_double (serializer, f[i]);
+      break;
+    case GTK_CSS_TRANSFORM_TRANSLATE:
+      gtk_css_serializer_write_value (serializer, transform->translate.x);
+      gtk_css_serializer_write_value (serializer, transform->translate.y);
+      gtk_css_serializer_write_value (serializer, transform->translate.z);
+      break;
+    case GTK_CSS_TRANSFORM_ROTATE:
+      gtk_css_serializer_write_value (serializer, transform->rotate.x);
+      gtk_css_serializer_write_value (serializer, transform->rotate.y);
+      gtk_css_serializer_write_value (serializer, transform->rotate.z);
+      gtk_css_serializer_write_value (serializer, transform->rotate.angle);
+      break;
+    case GTK_CSS_TRANSFORM_SCALE:
+      gtk_css_serializer_write_value (serializer, transform->scale.x);
+      gtk_css_serializer_write_value (serializer, transform->scale.y);
+      gtk_css_serializer_write_value (serializer, transform->scale.z);
+      break;
+    case GTK_CSS_TRANSFORM_SKEW:
+      gtk_css_serializer_write_value (serializer, transform->skew.x);
+      gtk_css_serializer_write_value (serializer, transform->skew.y);
+      break;
+    case GTK_CSS_TRANSFORM_SKEW_X:
+      gtk_css_serializer_write_value (serializer, transform->skew_x.skew);
+      break;
+    case GTK_CSS_TRANSFORM_SKEW_Y:
+      gtk_css_serializer_write_value (serializer, transform->skew_y.skew);
+      break;
+    case GTK_CSS_TRANSFORM_NONE:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+}
+
+static void
+gtk_css_value_transform_serialize (const GtkCssValue *value,
+                                   GtkCssSerializer  *serializer)
+{
+  guint i;
+
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_TRANSFORM);
+  gtk_css_serializer_write_uint32 (serializer, value->n_transforms);
+  for (i = 0; i < value->n_transforms; i++)
+    gtk_css_transform_serialize (&value->transforms[i], serializer);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_TRANSFORM = {
   gtk_css_value_transform_free,
   gtk_css_value_transform_compute,
@@ -709,7 +771,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_TRANSFORM = {
   gtk_css_value_transform_transition,
   NULL,
   NULL,
-  gtk_css_value_transform_print
+  gtk_css_value_transform_print,
+  gtk_css_value_transform_serialize
 };
 
 static GtkCssValue none_singleton = { &GTK_CSS_VALUE_TRANSFORM, 1, 0, {  { GTK_CSS_TRANSFORM_NONE } } };
@@ -1094,6 +1157,124 @@ _gtk_css_transform_value_parse (GtkCssParser *parser)
   return value;
 }
 
+static gboolean
+gtk_css_transform_deserialize (GtkCssTransform    *transform,
+                               GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *values[4] = { NULL, };
+  float f[16];
+  guint i, n_values;
+
+  transform->type = gtk_css_deserializer_read_uint32 (deserializer);
+
+  switch (transform->type)
+    {
+    case GTK_CSS_TRANSFORM_MATRIX:
+      for (i = 0; i < 16; i++)
+        f[i] = gtk_css_deserializer_read_double (deserializer);
+      graphene_matrix_init_from_float (&transform->matrix.matrix, f);
+      return !gtk_css_deserializer_has_failed (deserializer);
+    case GTK_CSS_TRANSFORM_ROTATE:
+      n_values = 4;
+      break;
+    case GTK_CSS_TRANSFORM_TRANSLATE:
+    case GTK_CSS_TRANSFORM_SCALE:
+      n_values = 3;
+      break;
+    case GTK_CSS_TRANSFORM_SKEW:
+      n_values = 2;
+      break;
+    case GTK_CSS_TRANSFORM_SKEW_X:
+    case GTK_CSS_TRANSFORM_SKEW_Y:
+      n_values = 1;
+      break;
+    case GTK_CSS_TRANSFORM_NONE:
+    default:
+      return FALSE;
+    }
+
+  for (i = 0; i < n_values; i++)
+    values[i] = gtk_css_deserializer_read_number (deserializer);
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      for (i = 0; i < n_values; i++)
+        g_clear_pointer (&values[i], _gtk_css_value_unref);
+      return FALSE;
+    }
+
+  switch (transform->type)
+    {
+    case GTK_CSS_TRANSFORM_TRANSLATE:
+      transform->translate.x = values[0];
+      transform->translate.y = values[1];
+      transform->translate.z = values[2];
+      break;
+    case GTK_CSS_TRANSFORM_ROTATE:
+      transform->rotate.x = values[0];
+      transform->rotate.y = values[1];
+      transform->rotate.z = values[2];
+      transform->rotate.angle = values[3];
+      break;
+    case GTK_CSS_TRANSFORM_SCALE:
+      transform->scale.x = values[0];
+      transform->scale.y = values[1];
+      transform->scale.z = values[2];
+      break;
+    case GTK_CSS_TRANSFORM_SKEW:
+      transform->skew.x = values[0];
+      transform->skew.y = values[1];
+      break;
+    case GTK_CSS_TRANSFORM_SKEW_X:
+      transform->skew_x.skew = values[0];
+      break;
+    case GTK_CSS_TRANSFORM_SKEW_Y:
+      transform->skew_y.skew = values[0];
+      break;
+    case GTK_CSS_TRANSFORM_MATRIX:
+    case GTK_CSS_TRANSFORM_NONE:
+    default:
+      g_assert_not_reached ();
+      break;
+    }
+
+  return TRUE;
+}
+
+GtkCssValue *
+gtk_css_transform_value_deserialize (GtkCssDeserializer *deserializer)
+{
+  GtkCssValue *value;
+  guint i, n_transforms;
+
+  n_transforms = gtk_css_deserializer_read_count (deserializer, sizeof (guint32));
+  if (gtk_css_deserializer_has_failed (deserializer))
+    return NULL;
+  if (n_transforms == 0)
+    return _gtk_css_transform_value_new_none ();
+
+  value = gtk_css_transform_value_alloc (n_transforms);
+  for (i = 0; i < n_transforms; i++)
+    {
+      if (!gtk_css_transform_deserialize (&value->transforms[i], deserializer))
+        {
+          value->n_transforms = i;
+          gtk_css_deserializer_fail (deserializer);
+          break;
+        }
+    }
+
+  if (gtk_css_deserializer_has_failed (deserializer))
+    {
+      for (i = 0; i < value->n_transforms; i++)
+        gtk_css_transform_clear (&value->transforms[i]);
+      g_slice_free1 (sizeof (GtkCssValue) + sizeof (GtkCssTransform) * (n_transforms - 1), value);
+      return NULL;
+    }
+
+  return value;
+}
+
 gboolean
 gtk_css_transform_value_get_matrix (const GtkCssValue *transform,
                                     graphene_matrix_t *matrix)
@@ -27,6 +27,7 @@ G_BEGIN_DECLS
 
 GtkCssValue *   _gtk_css_transform_value_new_none       (void);
 GtkCssValue *   _gtk_css_transform_value_parse          (GtkCssParser           *parser);
+GtkCssValue *   gtk_css_transform_value_deserialize     (GtkCssDeserializer     *deserializer);
 
 gboolean        gtk_css_transform_value_get_matrix      (const GtkCssValue      *transform,
                                                          graphene_matrix_t      *matrix);
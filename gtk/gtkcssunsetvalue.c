@@ -21,6 +21,7 @@
 
 #include "gtkcssinheritvalueprivate.h"
 #include "gtkcssinitialvalueprivate.h"
+#include "gtkcssserializerprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 
 struct _GtkCssValue {
@@ -81,6 +82,13 @@ gtk_css_value_unset_print (const GtkCssValue *value,
   g_string_append (string, "unset");
 }
 
+static void
+gtk_css_value_unset_serialize (const GtkCssValue *value,
+                               GtkCssSerializer  *serializer)
+{
+  gtk_css_serializer_write_uint32 (serializer, GTK_CSS_SERIALIZED_VALUE_UNSET);
+}
+
 static const GtkCssValueClass GTK_CSS_VALUE_UNSET = {
   gtk_css_value_unset_free,
   gtk_css_value_unset_compute,
@@ -88,7 +96,8 @@ static const GtkCssValueClass GTK_CSS_VALUE_UNSET = {
   gtk_css_value_unset_transition,
   NULL,
   NULL,
-  gtk_css_value_unset_print
+  gtk_css_value_unset_print,
+  gtk_css_value_unset_serialize
 };
 
 static GtkCssValue unset = { &GTK_CSS_VALUE_UNSET, 1 };
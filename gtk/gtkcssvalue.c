@@ -20,6 +20,7 @@
 #include "gtkprivate.h"
 #include "gtkcssvalueprivate.h"
 
+#include "gtkcssserializerprivate.h"
 #include "gtkcssstyleprivate.h"
 #include "gtkstyleproviderprivate.h"
 
@@ -175,6 +176,32 @@ _gtk_css_value_print (const GtkCssValue *value,
   value->class->print (value, string);
 }
 
+/**
+ * gtk_css_value_serialize:
+ * @value: the value to serialize
+ * @serializer: the serializer to write to
+ *
+ * Writes @value to @serializer, so that gtk_css_deserializer_read_value()
+ * can recreate it without parsing. Values that can't be serialized, like
+ * the ones referring to loaded images or icon themes, make @serializer
+ * fail.
+ **/
+void
+gtk_css_value_serialize (const GtkCssValue *value,
+                         GtkCssSerializer  *serializer)
+{
+  gtk_internal_return_if_fail (value != NULL);
+  gtk_internal_return_if_fail (serializer != NULL);
+
+  if (value->class->serialize == NULL)
+    {
+      gtk_css_serializer_fail (serializer);
+      return;
+    }
+
+  value->class->serialize (value, serializer);
+}
+
 /**
  * gtk_css_value_is_dynamic:
  * @value: a #GtkCssValue
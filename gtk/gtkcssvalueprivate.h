@@ -56,6 +56,9 @@ struct _GtkCssValueClass {
                                                        gint64                      monotonic_time);
   void          (* print)                             (const GtkCssValue          *value,
                                                        GString                    *string);
+  /* write the value in the format read by gtk_css_deserializer_read_value() (optional) */
+  void          (* serialize)                         (const GtkCssValue          *value,
+                                                       GtkCssSerializer           *serializer);
 };
 
 GType        _gtk_css_value_get_type                  (void) G_GNUC_CONST;
@@ -89,6 +92,8 @@ GtkCssValue *   gtk_css_value_get_dynamic_value       (GtkCssValue
 char *       _gtk_css_value_to_string                 (const GtkCssValue          *value);
 void         _gtk_css_value_print                     (const GtkCssValue          *value,
                                                        GString                    *string);
+void            gtk_css_value_serialize               (const GtkCssValue          *value,
+                                                       GtkCssSerializer           *serializer);
 
 G_END_DECLS
 
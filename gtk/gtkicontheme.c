@@ -231,9 +231,6 @@ struct _GtkIconInfo
   gdouble scale;
 
   SymbolicPixbufCache *symbolic_pixbuf_cache;
-
-  gint symbolic_width;
-  gint symbolic_height;
 };
 
 typedef struct
@@ -3305,8 +3302,6 @@ icon_info_dup (GtkIconInfo *icon_info)
   dup->is_resource = icon_info->is_resource;
   dup->min_size = icon_info->min_size;
   dup->max_size = icon_info->max_size;
-  dup->symbolic_width = icon_info->symbolic_width;
-  dup->symbolic_height = icon_info->symbolic_height;
 
   return dup;
 }
@@ -4030,17 +4025,6 @@ symbolic_cache_get_proxy (SymbolicPixbufCache *symbolic_cache,
   return symbolic_cache->proxy_pixbuf;
 }
 
-static gchar *
-rgba_to_string_noalpha (const GdkRGBA *rgba)
-{
-  GdkRGBA color;
-
-  color = *rgba;
-  color.alpha = 1.0;
-
-  return gdk_rgba_to_string (&color);
-}
-
 static void
 rgba_to_pixel(const GdkRGBA  *rgba,
 	      guint8 pixel[4])
@@ -4135,8 +4119,15 @@ gtk_icon_theme_color_symbolic_pixbuf (GdkPixbuf     *symbolic,
   return colored;
 }
 
+/* Both .symbolic.png files and symbolic SVGs are loaded as a mask
+ * that encodes the success, warning and error parts of the icon in
+ * its color channels (see gtk_make_symbolic_pixbuf_from_data()). The
+ * mask is rendered once per size and kept in icon_info->pixbuf, so
+ * new colors only need the cheap recoloring below, not another trip
+ * through the SVG loader.
+ */
 static GdkPixbuf *
-gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
+gtk_icon_info_load_symbolic_mask (GtkIconInfo    *icon_info,
                                  const GdkRGBA  *fg,
                                  const GdkRGBA  *success_color,
                                  const GdkRGBA  *warning_color,
@@ -4173,153 +4164,6 @@ gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
                                                error_color ? error_color : &error_default);
 }
 
-static GdkPixbuf *
-gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
-                                 const GdkRGBA  *fg,
-                                 const GdkRGBA  *success_color,
-                                 const GdkRGBA  *warning_color,
-                                 const GdkRGBA  *error_color,
-                                 GError        **error)
-{
-  GInputStream *stream;
-  GdkPixbuf *pixbuf;
-  gchar *css_fg;
-  gchar *css_success;
-  gchar *css_warning;
-  gchar *css_error;
-  gchar *data;
-  gchar *width;
-  gchar *height;
-  gchar *file_data, *escaped_file_data;
-  gsize file_len;
-  gint symbolic_size;
-  double alpha;
-  gchar alphastr[G_ASCII_DTOSTR_BUF_SIZE];
-
-  alpha = fg->alpha;
-
-  css_fg = rgba_to_string_noalpha (fg);
-
-  css_success = css_warning = css_error = NULL;
-
-  if (warning_color)
-    css_warning = rgba_to_string_noalpha (warning_color);
-  else
-    css_warning = g_strdup ("rgb(245,121,62)");
-
-  if (error_color)
-    css_error = rgba_to_string_noalpha (error_color);
-  else
-    css_error = g_strdup ("rgb(204,0,0)");
-
-  if (success_color)
-    css_success = rgba_to_string_noalpha (success_color);
-  else
-    css_success = g_strdup ("rgb(78,154,6)");
-
-  if (!g_file_load_contents (icon_info->icon_file, NULL, &file_data, &file_len, NULL, error))
-    return NULL;
-
-  if (!icon_info_ensure_scale_and_pixbuf (icon_info))
-    {
-      g_propagate_error (error, icon_info->load_error);
-      icon_info->load_error = NULL;
-      g_free (css_fg);
-      g_free (css_warning);
-      g_free (css_error);
-      g_free (css_success);
-      g_free (file_data);
-      return NULL;
-    }
-
-  if (icon_info->symbolic_width == 0 ||
-      icon_info->symbolic_height == 0)
-    {
-      /* Fetch size from the original icon */
-      stream = g_memory_input_stream_new_from_data (file_data, file_len, NULL);
-      pixbuf = gdk_pixbuf_new_from_stream (stream, NULL, error);
-      g_object_unref (stream);
-
-      if (!pixbuf)
-        {
-          g_free (css_fg);
-          g_free (css_warning);
-          g_free (css_error);
-          g_free (css_success);
-          g_free (file_data);
-          return NULL;
-        }
-
-      icon_info->symbolic_width = gdk_pixbuf_get_width (pixbuf);
-      icon_info->symbolic_height = gdk_pixbuf_get_height (pixbuf);
-      g_object_unref (pixbuf);
-    }
-
-  symbolic_size = MAX (icon_info->symbolic_width, icon_info->symbolic_height);
-
-  GTK_NOTE (ICONTHEME,
-  if (icon_info->dir_type == ICON_THEME_DIR_UNTHEMED)
-    g_message ("Symbolic icon %s is not in an icon theme directory",
-               icon_info->key.icon_names ? icon_info->key.icon_names[0] : icon_info->filename);
-  else if (icon_info->dir_size * icon_info->dir_scale != symbolic_size)
-    g_message ("Symbolic icon %s of size %d is in an icon theme directory of size %d",
-               icon_info->key.icon_names ? icon_info->key.icon_names[0] : icon_info->filename,
-               symbolic_size,
-               icon_info->dir_size * icon_info->dir_scale)
-  );
-
-  width = g_strdup_printf ("%d", icon_info->symbolic_width);
-  height = g_strdup_printf ("%d", icon_info->symbolic_height);
-
-  escaped_file_data = g_markup_escape_text (file_data, file_len);
-  g_free (file_data);
-
-  g_ascii_dtostr (alphastr, G_ASCII_DTOSTR_BUF_SIZE, CLAMP (alpha, 0, 1));
-
-  data = g_strconcat ("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n"
-                      "<svg version=\"1.1\"\n"
-                      "     xmlns=\"http://www.w3.org/2000/svg\"\n"
-                      "     xmlns:xi=\"http://www.w3.org/2001/XInclude\"\n"
-                      "     width=\"", width, "\"\n"
-                      "     height=\"", height, "\">\n"
-                      "  <style type=\"text/css\">\n"
-                      "    rect,path {\n"
-                      "      fill: ", css_fg," !important;\n"
-                      "    }\n"
-                      "    .warning {\n"
-                      "      fill: ", css_warning, " !important;\n"
-                      "    }\n"
-                      "    .error {\n"
-                      "      fill: ", css_error ," !important;\n"
-                      "    }\n"
-                      "    .success {\n"
-                      "      fill: ", css_success, " !important;\n"
-                      "    }\n"
-                      "  </style>\n"
-                      "  <g opacity=\"", alphastr, "\" ><xi:include href=\"data:text/xml,", escaped_file_data, "\"/></g>\n"
-                      "</svg>",
-                      NULL);
-  g_free (escaped_file_data);
-  g_free (css_fg);
-  g_free (css_warning);
-  g_free (css_error);
-  g_free (css_success);
-  g_free (width);
-  g_free (height);
-
-  stream = g_memory_input_stream_new_from_data (data, -1, g_free);
-  pixbuf = gdk_pixbuf_new_from_stream_at_scale (stream,
-                                                gdk_pixbuf_get_width (icon_info->pixbuf),
-                                                gdk_pixbuf_get_height (icon_info->pixbuf),
-                                                TRUE,
-                                                NULL,
-                                                error);
-  g_object_unref (stream);
-
-  return pixbuf;
-}
-
-
 static GdkPixbuf *
 gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
 				      const GdkRGBA  *fg,
@@ -4331,7 +4175,6 @@ gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
 {
   GdkPixbuf *pixbuf;
   SymbolicPixbufCache *symbolic_cache;
-  char *icon_uri;
 
   if (use_cache)
     {
@@ -4346,13 +4189,7 @@ gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
    */
   g_return_val_if_fail (fg != NULL, NULL);
 
-  icon_uri = g_file_get_uri (icon_info->icon_file);
-  if (g_str_has_suffix (icon_uri, ".symbolic.png"))
-    pixbuf = gtk_icon_info_load_symbolic_png (icon_info, fg, success_color, warning_color, error_color, error);
-  else
-    pixbuf = gtk_icon_info_load_symbolic_svg (icon_info, fg, success_color, warning_color, error_color, error);
-
-  g_free (icon_uri);
+  pixbuf = gtk_icon_info_load_symbolic_mask (icon_info, fg, success_color, warning_color, error_color, error);
 
   if (pixbuf != NULL)
     {
@@ -114,6 +114,11 @@
  * access to a particular row is needed often and your code is expected to
  * run on older versions of GTK+, it is worth keeping the iter around.
  *
+ * When adding many rows to a sorted #GtkListStore, use
+ * gtk_list_store_append_rowsv(). It sorts the store once after all rows
+ * have been added, instead of finding the sorted position of each row
+ * as it is inserted.
+ *
  * # Atomic Operations
  *
  * It is important to note that only the methods
@@ -2307,6 +2312,75 @@ gtk_list_store_insert_with_valuesv (GtkListStore *list_store,
   gtk_tree_path_free (path);
 }
 
+/**
+ * gtk_list_store_append_rowsv:
+ * @list_store: A #GtkListStore
+ * @n_rows: the number of rows to append
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows times @n_values GValues, holding
+ *     the values of the first row, followed by those of the second row,
+ *     and so on
+ * @n_values: the length of the @columns array
+ *
+ * Appends @n_rows rows to @list_store, filling in the values for
+ * @columns from @values.
+ *
+ * This is the same as calling gtk_list_store_insert_with_valuesv()
+ * for each row, but considerably faster for a sorted store: the rows
+ * are first appended in order, emitting #GtkTreeModel::row-inserted for
+ * each of them, and the store is then sorted once, emitting a single
+ * #GtkTreeModel::rows-reordered.
+ */
+void
+gtk_list_store_append_rowsv (GtkListStore *list_store,
+                             gint          n_rows,
+                             gint         *columns,
+                             GValue       *values,
+                             gint          n_values)
+{
+  GtkListStorePrivate *priv;
+  GtkTreePath *path;
+  gboolean maybe_need_sort = FALSE;
+  gint i;
+
+  g_return_if_fail (GTK_IS_LIST_STORE (list_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  priv = list_store->priv;
+
+  if (n_rows == 0)
+    return;
+
+  priv->columns_dirty = TRUE;
+
+  path = gtk_tree_path_new_from_indices (priv->length, -1);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      GtkTreeIter iter;
+      gboolean changed = FALSE;
+
+      iter.stamp = priv->stamp;
+      iter.user_data = g_sequence_append (priv->seq, NULL);
+
+      priv->length++;
+
+      gtk_list_store_set_vector_internal (list_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + i * n_values,
+                                          n_values);
+
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (list_store), path, &iter);
+      gtk_tree_path_next (path);
+    }
+
+  gtk_tree_path_free (path);
+
+  if (maybe_need_sort)
+    gtk_list_store_sort (list_store);
+}
+
 /* GtkBuildable custom tag implementation
  *
  * <columns>
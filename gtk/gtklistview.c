@@ -0,0 +1,1194 @@
+/* GTK - The GIMP Toolkit
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gtklistview
+ * @Short_description: A scrollable list for large models
+ * @Title: GtkListView
+ * @See_also: #GtkListBox, #GListModel
+ *
+ * GtkListView presents the items of a #GListModel as a vertical list.
+ * Unlike #GtkListBox it does not create a widget for every item in the
+ * model. Only the items in the visible area, plus some margin above and
+ * below it, get a row widget; when the list is scrolled, rows that move
+ * out of that range are recycled and bound to the items that move in.
+ * This keeps the cost of a GtkListView independent of the model size.
+ *
+ * Row widgets are created by the #GtkListViewCreateWidgetFunc passed to
+ * gtk_list_view_bind_model(), and pointed at an item by the
+ * #GtkListViewBindWidgetFunc. Since a row widget is reused for many
+ * items, the bind function must update all of its state.
+ *
+ * Items that have never been in view have not been measured, so their
+ * height is estimated from the average height of the rows that were.
+ * The scrollbar range is therefore approximate for large models, and
+ * settles as rows are measured.
+ *
+ * GtkListView implements #GtkScrollable and is meant to be put directly
+ * into a #GtkScrolledWindow. It only scrolls vertically; rows are always
+ * as wide as the list.
+ *
+ * The keyboard focus is kept on the row of the cursor item. The arrow
+ * keys, Page Up and Page Down, Home and End move the cursor, scrolling
+ * the list as needed. While the cursor item is scrolled out of the
+ * overscanned area, the list itself holds the focus and hands it back
+ * to the row when the item comes into view again.
+ *
+ * # CSS nodes
+ *
+ * GtkListView uses a single CSS node named listview. The row widgets
+ * are its children.
+ */
+
+#include "config.h"
+
+#include "gtklistview.h"
+
+#include "gtkadjustment.h"
+#include "gtkbindings.h"
+#include "gtkintl.h"
+#include "gtkmarshalers.h"
+#include "gtkprivate.h"
+#include "gtkscrollable.h"
+#include "gtksnapshot.h"
+#include "gtktypebuiltins.h"
+#include "gtkwidgetprivate.h"
+
+#include <string.h>
+
+/* The height assumed for rows before any row has been measured */
+#define DEFAULT_ROW_HEIGHT 32
+
+#define LOWEST_BIT(i) ((i) & -(i))
+
+/* The value of the cursor when there is none */
+#define NO_CURSOR G_MAXUINT
+
+/* A node of the Fenwick tree over the row heights. Node i covers the
+ * LOWEST_BIT (i) items ending at item i - 1, and only counts measured
+ * rows, so that the estimate for the others can change freely.
+ */
+typedef struct {
+  gint64 measured_height;
+  guint n_measured;
+} HeightNode;
+
+struct _GtkListView
+{
+  GtkWidget parent_instance;
+
+  GListModel *model;
+  GtkListViewCreateWidgetFunc create_widget_func;
+  GtkListViewBindWidgetFunc bind_widget_func;
+  gpointer user_data;
+  GDestroyNotify user_data_free_func;
+
+  /* One int per item: the measured height, or -1 if the item has not
+   * been measured at the current width. */
+  GArray *heights;
+  /* Prefix sums over heights, so finding the row at an offset does
+   * not need a walk from the first item. */
+  GArray *height_tree;
+  gint64 measured_height;
+  guint n_measured;
+  int last_width;
+
+  /* Bound row widgets for the items first_row .. first_row + rows->len */
+  guint first_row;
+  GPtrArray *rows;
+  /* Unbound row widgets, kept as children but not child-visible */
+  GPtrArray *pool;
+
+  /* The item whose row has, or should get, the keyboard focus */
+  guint cursor;
+
+  GtkAdjustment *hadjustment;
+  GtkAdjustment *vadjustment;
+  guint hscroll_policy : 1;
+  guint vscroll_policy : 1;
+  guint in_size_allocate : 1;
+  /* The cursor row lost the focus to the list when it was recycled */
+  guint focus_cursor : 1;
+};
+
+struct _GtkListViewClass
+{
+  GtkWidgetClass parent_class;
+};
+
+enum {
+  MOVE_CURSOR,
+  LAST_SIGNAL
+};
+
+static guint signals[LAST_SIGNAL] = { 0 };
+
+enum {
+  PROP_0,
+  PROP_HADJUSTMENT,
+  PROP_VADJUSTMENT,
+  PROP_HSCROLL_POLICY,
+  PROP_VSCROLL_POLICY
+};
+
+G_DEFINE_TYPE_WITH_CODE (GtkListView, gtk_list_view, GTK_TYPE_WIDGET,
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_SCROLLABLE, NULL))
+
+static int
+gtk_list_view_get_estimated_height (GtkListView *self)
+{
+  if (self->n_measured == 0)
+    return DEFAULT_ROW_HEIGHT;
+
+  return self->measured_height / self->n_measured;
+}
+
+static int
+gtk_list_view_get_row_height (GtkListView *self,
+                              guint        position,
+                              int          estimate)
+{
+  int height = g_array_index (self->heights, int, position);
+
+  return height >= 0 ? height : estimate;
+}
+
+static void
+gtk_list_view_rebuild_height_tree (GtkListView *self)
+{
+  guint n_items = self->heights->len;
+  guint i, parent;
+
+  g_array_set_size (self->height_tree, n_items + 1);
+  memset (self->height_tree->data, 0, (n_items + 1) * sizeof (HeightNode));
+
+  for (i = 1; i <= n_items; i++)
+    {
+      HeightNode *node = &g_array_index (self->height_tree, HeightNode, i);
+      int height = g_array_index (self->heights, int, i - 1);
+
+      if (height >= 0)
+        {
+          node->measured_height += height;
+          node->n_measured++;
+        }
+
+      parent = i + LOWEST_BIT (i);
+      if (parent <= n_items)
+        {
+          HeightNode *parent_node = &g_array_index (self->height_tree, HeightNode, parent);
+
+          parent_node->measured_height += node->measured_height;
+          parent_node->n_measured += node->n_measured;
+        }
+    }
+}
+
+/* Returns the offset of the item at @position from the top of the list */
+static gint64
+gtk_list_view_get_row_y (GtkListView *self,
+                         guint        position,
+                         int          estimate)
+{
+  gint64 y = 0;
+  guint i;
+
+  for (i = position; i > 0; i -= LOWEST_BIT (i))
+    {
+      HeightNode *node = &g_array_index (self->height_tree, HeightNode, i);
+
+      y += node->measured_height + (gint64) (LOWEST_BIT (i) - node->n_measured) * estimate;
+    }
+
+  return y;
+}
+
+/* Returns the position of the item that covers offset @y, or the number
+ * of items if @y is past the end. The offset of that item is stored
+ * in @row_y.
+ */
+static guint
+gtk_list_view_get_position_at_y (GtkListView *self,
+                                 gint64       y,
+                                 int          estimate,
+                                 gint64      *row_y)
+{
+  guint n_items = self->heights->len;
+  guint position = 0;
+  guint step;
+  gint64 offset = 0;
+
+  step = 1;
+  while (step <= n_items / 2)
+    step <<= 1;
+
+  /* Binary search on the tree: each step skips the rows below the
+   * next node if they all end at or before @y. */
+  for (; step > 0 && n_items > 0; step >>= 1)
+    {
+      HeightNode *node;
+      gint64 height;
+
+      if (position + step > n_items)
+        continue;
+
+      node = &g_array_index (self->height_tree, HeightNode, position + step);
+      height = node->measured_height + (gint64) (step - node->n_measured) * estimate;
+
+      if (offset + height <= y)
+        {
+          position += step;
+          offset += height;
+        }
+    }
+
+  *row_y = offset;
+
+  return position;
+}
+
+static void
+gtk_list_view_set_row_height (GtkListView *self,
+                              guint        position,
+                              int          height)
+{
+  int *old = &g_array_index (self->heights, int, position);
+  gint64 height_diff = 0;
+  int measured_diff = 0;
+  guint i;
+
+  if (*old == height)
+    return;
+
+  if (*old >= 0)
+    {
+      height_diff -= *old;
+      measured_diff--;
+    }
+
+  *old = height;
+
+  if (height >= 0)
+    {
+      height_diff += height;
+      measured_diff++;
+    }
+
+  self->measured_height += height_diff;
+  self->n_measured += measured_diff;
+
+  for (i = position + 1; i < self->height_tree->len; i += LOWEST_BIT (i))
+    {
+      HeightNode *node = &g_array_index (self->height_tree, HeightNode, i);
+
+      node->measured_height += height_diff;
+      node->n_measured += measured_diff;
+    }
+}
+
+static void
+gtk_list_view_forget_heights (GtkListView *self)
+{
+  guint i;
+
+  for (i = 0; i < self->heights->len; i++)
+    g_array_index (self->heights, int, i) = -1;
+
+  self->measured_height = 0;
+  self->n_measured = 0;
+
+  gtk_list_view_rebuild_height_tree (self);
+}
+
+static int
+gtk_list_view_get_total_height (GtkListView *self)
+{
+  gint64 total;
+
+  total = self->measured_height +
+          (gint64) (self->heights->len - self->n_measured) * gtk_list_view_get_estimated_height (self);
+
+  return MIN (total, G_MAXINT);
+}
+
+static GtkWidget *
+gtk_list_view_acquire_row (GtkListView *self)
+{
+  GtkWidget *row;
+
+  if (self->pool->len > 0)
+    {
+      row = g_ptr_array_remove_index_fast (self->pool, self->pool->len - 1);
+      gtk_widget_set_child_visible (row, TRUE);
+      return row;
+    }
+
+  row = self->create_widget_func (self->user_data);
+
+  /* Like gtk_list_box_bind_model(), accept both full and floating
+   * references from the create function.
+   */
+  if (g_object_is_floating (row))
+    g_object_ref_sink (row);
+
+  gtk_widget_show (row);
+  gtk_widget_set_parent (row, GTK_WIDGET (self));
+  g_object_unref (row);
+
+  return row;
+}
+
+static void
+gtk_list_view_release_row (GtkListView *self,
+                           GtkWidget   *row)
+{
+  /* Keep the focus in the list until the cursor row comes back */
+  if (gtk_widget_get_focus_child (GTK_WIDGET (self)) == row)
+    {
+      self->focus_cursor = TRUE;
+      gtk_widget_grab_focus (GTK_WIDGET (self));
+    }
+
+  gtk_widget_set_child_visible (row, FALSE);
+  g_ptr_array_add (self->pool, row);
+}
+
+static void
+gtk_list_view_release_rows_from (GtkListView *self,
+                                 guint        index)
+{
+  guint i;
+
+  for (i = index; i < self->rows->len; i++)
+    gtk_list_view_release_row (self, g_ptr_array_index (self->rows, i));
+
+  g_ptr_array_set_size (self->rows, MIN (index, self->rows->len));
+}
+
+static void
+gtk_list_view_clear_rows (GtkListView *self)
+{
+  guint i;
+
+  for (i = 0; i < self->rows->len; i++)
+    gtk_widget_unparent (g_ptr_array_index (self->rows, i));
+  g_ptr_array_set_size (self->rows, 0);
+
+  for (i = 0; i < self->pool->len; i++)
+    gtk_widget_unparent (g_ptr_array_index (self->pool, i));
+  g_ptr_array_set_size (self->pool, 0);
+
+  self->first_row = 0;
+}
+
+static void
+gtk_list_view_measure (GtkWidget      *widget,
+                       GtkOrientation  orientation,
+                       int             for_size,
+                       int            *minimum,
+                       int            *natural,
+                       int            *minimum_baseline,
+                       int            *natural_baseline)
+{
+  GtkListView *self = GTK_LIST_VIEW (widget);
+
+  if (orientation == GTK_ORIENTATION_HORIZONTAL)
+    {
+      guint i;
+
+      /* Only the bound rows can be measured cheaply; the list is
+       * scrollable, so this is a hint rather than a hard limit.
+       */
+      *minimum = *natural = 0;
+      for (i = 0; i < self->rows->len; i++)
+        {
+          int child_min, child_nat;
+
+          gtk_widget_measure (g_ptr_array_index (self->rows, i),
+                              GTK_ORIENTATION_HORIZONTAL, -1,
+                              &child_min, &child_nat, NULL, NULL);
+          *minimum = MAX (*minimum, child_min);
+          *natural = MAX (*natural, child_nat);
+        }
+    }
+  else
+    {
+      *minimum = 0;
+      *natural = gtk_list_view_get_total_height (self);
+    }
+}
+
+static GtkWidget *
+gtk_list_view_get_row (GtkListView *self,
+                       guint        position)
+{
+  if (position < self->first_row || position - self->first_row >= self->rows->len)
+    return NULL;
+
+  return g_ptr_array_index (self->rows, position - self->first_row);
+}
+
+/* Moves the keyboard focus to the row of the cursor item, or to the
+ * list itself while that item has no row. */
+static void
+gtk_list_view_focus_cursor (GtkListView *self)
+{
+  GtkWidget *row;
+
+  row = gtk_list_view_get_row (self, self->cursor);
+  if (row == NULL)
+    {
+      self->focus_cursor = TRUE;
+      gtk_widget_grab_focus (GTK_WIDGET (self));
+      return;
+    }
+
+  self->focus_cursor = FALSE;
+
+  if (gtk_widget_get_focus_child (GTK_WIDGET (self)) == row)
+    return;
+
+  if (!gtk_widget_child_focus (row, GTK_DIR_TAB_FORWARD))
+    gtk_widget_grab_focus (GTK_WIDGET (self));
+}
+
+/* The focus may have been moved into a row by other means than the
+ * cursor, such as a click, so pick up the row that has it */
+static void
+gtk_list_view_sync_cursor (GtkListView *self)
+{
+  GtkWidget *focus_child;
+  guint i;
+
+  focus_child = gtk_widget_get_focus_child (GTK_WIDGET (self));
+  if (focus_child == NULL)
+    return;
+
+  for (i = 0; i < self->rows->len; i++)
+    {
+      if (g_ptr_array_index (self->rows, i) == focus_child)
+        {
+          self->cursor = self->first_row + i;
+          return;
+        }
+    }
+}
+
+static void
+gtk_list_view_scroll_to_position (GtkListView *self,
+                                  guint        position)
+{
+  int estimate;
+  double value, page_size;
+  gint64 y;
+  int row_height;
+
+  estimate = gtk_list_view_get_estimated_height (self);
+  y = gtk_list_view_get_row_y (self, position, estimate);
+  row_height = gtk_list_view_get_row_height (self, position, estimate);
+
+  value = gtk_adjustment_get_value (self->vadjustment);
+  page_size = gtk_adjustment_get_page_size (self->vadjustment);
+
+  if (y < value)
+    value = y;
+  else if (y + row_height > value + page_size)
+    value = y + row_height - page_size;
+  else
+    return;
+
+  /* The estimate may put the item past the current range */
+  if (value + page_size > gtk_adjustment_get_upper (self->vadjustment))
+    gtk_adjustment_set_upper (self->vadjustment, value + page_size);
+
+  gtk_adjustment_set_value (self->vadjustment, value);
+}
+
+static void
+gtk_list_view_set_cursor (GtkListView *self,
+                          guint        position)
+{
+  self->cursor = position;
+
+  gtk_list_view_scroll_to_position (self, position);
+  gtk_list_view_focus_cursor (self);
+}
+
+/* Returns the position of the first item in the visible area */
+static guint
+gtk_list_view_get_first_visible (GtkListView *self)
+{
+  guint position;
+  gint64 y;
+
+  position = gtk_list_view_get_position_at_y (self,
+                                              gtk_adjustment_get_value (self->vadjustment),
+                                              gtk_list_view_get_estimated_height (self),
+                                              &y);
+
+  return MIN (position, self->heights->len - 1);
+}
+
+static void
+gtk_list_view_move_cursor (GtkListView     *self,
+                           GtkMovementStep  step,
+                           gint             count)
+{
+  guint n_items = self->heights->len;
+  guint position;
+
+  if (n_items == 0)
+    return;
+
+  gtk_list_view_sync_cursor (self);
+
+  if (self->cursor >= n_items)
+    {
+      gtk_list_view_set_cursor (self, gtk_list_view_get_first_visible (self));
+      return;
+    }
+
+  switch ((guint) step)
+    {
+    case GTK_MOVEMENT_BUFFER_ENDS:
+      position = count < 0 ? 0 : n_items - 1;
+      break;
+
+    case GTK_MOVEMENT_DISPLAY_LINES:
+      position = CLAMP ((gint64) self->cursor + count, 0, (gint64) n_items - 1);
+      break;
+
+    case GTK_MOVEMENT_PAGES:
+      {
+        int estimate = gtk_list_view_get_estimated_height (self);
+        gint64 y, row_y;
+
+        y = gtk_list_view_get_row_y (self, self->cursor, estimate) +
+            count * gtk_adjustment_get_page_increment (self->vadjustment);
+        position = gtk_list_view_get_position_at_y (self, MAX (y, 0), estimate, &row_y);
+        position = MIN (position, n_items - 1);
+
+        /* Move at least one row, even if the cursor row is taller than a page */
+        if (position == self->cursor)
+          position = CLAMP ((gint64) self->cursor + (count < 0 ? -1 : 1), 0, (gint64) n_items - 1);
+      }
+      break;
+
+    default:
+      return;
+    }
+
+  if (position == self->cursor)
+    {
+      gtk_widget_error_bell (GTK_WIDGET (self));
+      return;
+    }
+
+  gtk_list_view_set_cursor (self, position);
+}
+
+static gboolean
+gtk_list_view_focus (GtkWidget        *widget,
+                     GtkDirectionType  direction)
+{
+  GtkListView *self = GTK_LIST_VIEW (widget);
+  GtkWidget *focus_child;
+  guint n_items = self->heights->len;
+
+  if (n_items == 0)
+    return FALSE;
+
+  focus_child = gtk_widget_get_focus_child (widget);
+
+  if (focus_child != NULL || gtk_widget_has_focus (widget))
+    {
+      /* Let the row move the focus between its own children first */
+      if (focus_child != NULL && gtk_widget_child_focus (focus_child, direction))
+        return TRUE;
+
+      gtk_list_view_sync_cursor (self);
+
+      switch ((guint) direction)
+        {
+        case GTK_DIR_UP:
+          if (self->cursor == 0 || self->cursor >= n_items)
+            return FALSE;
+          gtk_list_view_set_cursor (self, self->cursor - 1);
+          return TRUE;
+
+        case GTK_DIR_DOWN:
+          if (self->cursor + 1 >= n_items)
+            return FALSE;
+          gtk_list_view_set_cursor (self, self->cursor + 1);
+          return TRUE;
+
+        default:
+          /* Tab moves out of the list */
+          return FALSE;
+        }
+    }
+
+  /* The focus enters the list */
+  if (self->cursor >= n_items)
+    self->cursor = gtk_list_view_get_first_visible (self);
+
+  gtk_list_view_set_cursor (self, self->cursor);
+
+  return TRUE;
+}
+
+static void
+gtk_list_view_add_move_binding (GtkBindingSet   *binding_set,
+                                guint            keyval,
+                                GtkMovementStep  step,
+                                gint             count)
+{
+  gtk_binding_entry_add_signal (binding_set, keyval, 0,
+                                "move-cursor", 2,
+                                GTK_TYPE_MOVEMENT_STEP, step,
+                                G_TYPE_INT, count,
+                                NULL);
+}
+
+/* Binds and allocates rows for the items from half a page above the
+ * visible area to half a page below it, with the view scrolled to @value.
+ */
+static void
+gtk_list_view_allocate_rows (GtkListView *self,
+                             int          width,
+                             int          height,
+                             int          value)
+{
+  GPtrArray *old_rows;
+  guint old_first_row;
+  guint n_items, position, i;
+  int overscan, estimate;
+  gint64 y;
+
+  n_items = self->heights->len;
+  overscan = height / 2;
+  estimate = gtk_list_view_get_estimated_height (self);
+
+  /* Find the first item that reaches into the overscanned area */
+  position = gtk_list_view_get_position_at_y (self, value - overscan, estimate, &y);
+
+  old_rows = self->rows;
+  old_first_row = self->first_row;
+  self->rows = g_ptr_array_sized_new (old_rows->len);
+  self->first_row = position;
+
+  for (; position < n_items && y < value + height + overscan; position++)
+    {
+      GtkAllocation child_allocation, child_clip;
+      GtkWidget *row = NULL;
+      int row_height;
+
+      if (position >= old_first_row && position - old_first_row < old_rows->len)
+        {
+          row = g_ptr_array_index (old_rows, position - old_first_row);
+          g_ptr_array_index (old_rows, position - old_first_row) = NULL;
+        }
+
+      if (row == NULL)
+        {
+          gpointer item;
+
+          row = gtk_list_view_acquire_row (self);
+          item = g_list_model_get_item (self->model, position);
+          self->bind_widget_func (row, item, self->user_data);
+          g_object_unref (item);
+        }
+
+      gtk_widget_measure (row, GTK_ORIENTATION_VERTICAL, width,
+                          &row_height, NULL, NULL, NULL);
+      gtk_list_view_set_row_height (self, position, row_height);
+
+      child_allocation.x = 0;
+      child_allocation.y = y - value;
+      child_allocation.width = width;
+      child_allocation.height = row_height;
+      /* Children are clipped in snapshot, so their clip is ignored */
+      gtk_widget_size_allocate (row, &child_allocation, -1, &child_clip);
+
+      g_ptr_array_add (self->rows, row);
+      y += row_height;
+    }
+
+  for (i = 0; i < old_rows->len; i++)
+    {
+      GtkWidget *row = g_ptr_array_index (old_rows, i);
+
+      if (row != NULL)
+        gtk_list_view_release_row (self, row);
+    }
+  g_ptr_array_unref (old_rows);
+}
+
+static void
+gtk_list_view_size_allocate (GtkWidget           *widget,
+                             const GtkAllocation *allocation,
+                             int                  baseline,
+                             GtkAllocation       *out_clip)
+{
+  GtkListView *self = GTK_LIST_VIEW (widget);
+  int width, height, value, total;
+
+  width = allocation->width;
+  height = allocation->height;
+
+  /* Row heights depend on the width, so a new width invalidates them all */
+  if (width != self->last_width)
+    {
+      gtk_list_view_forget_heights (self);
+      self->last_width = width;
+    }
+
+  /* Configuring the adjustments below emits value-changed, which must
+   * not queue another allocation. */
+  self->in_size_allocate = TRUE;
+
+  g_object_freeze_notify (G_OBJECT (self->hadjustment));
+  g_object_freeze_notify (G_OBJECT (self->vadjustment));
+
+  gtk_adjustment_configure (self->hadjustment,
+                            0, 0, width,
+                            width * 0.1, width * 0.9, width);
+
+  total = gtk_list_view_get_total_height (self);
+  value = CLAMP (gtk_adjustment_get_value (self->vadjustment), 0, MAX (total, height) - height);
+
+  gtk_list_view_allocate_rows (self, width, height, value);
+
+  /* Measuring may have corrected the estimate. If that moved the end of
+   * the list above the bottom of the view, lay out once more at the
+   * corrected position. */
+  total = gtk_list_view_get_total_height (self);
+  if (value > MAX (total, height) - height)
+    {
+      value = MAX (total, height) - height;
+      gtk_list_view_allocate_rows (self, width, height, value);
+      total = gtk_list_view_get_total_height (self);
+    }
+
+  /* Make sure the adjustment keeps the value the rows were laid out
+   * for; it will shrink to the real size on a later allocation. */
+  gtk_adjustment_configure (self->vadjustment,
+                            value,
+                            0,
+                            MAX (total, value + height),
+                            height * 0.1,
+                            height * 0.9,
+                            height);
+
+  g_object_thaw_notify (G_OBJECT (self->hadjustment));
+  g_object_thaw_notify (G_OBJECT (self->vadjustment));
+
+  self->in_size_allocate = FALSE;
+
+  if (self->focus_cursor && gtk_widget_has_focus (widget) &&
+      gtk_list_view_get_row (self, self->cursor) != NULL)
+    gtk_list_view_focus_cursor (self);
+}
+
+static void
+gtk_list_view_snapshot (GtkWidget   *widget,
+                        GtkSnapshot *snapshot)
+{
+  gtk_snapshot_push_clip (snapshot,
+                          &GRAPHENE_RECT_INIT (
+                            0, 0,
+                            gtk_widget_get_width (widget),
+                            gtk_widget_get_height (widget)),
+                          "ListView");
+
+  GTK_WIDGET_CLASS (gtk_list_view_parent_class)->snapshot (widget, snapshot);
+
+  gtk_snapshot_pop (snapshot);
+}
+
+static void
+gtk_list_view_items_changed (GListModel  *model,
+                             guint        position,
+                             guint        removed,
+                             guint        added,
+                             GtkListView *self)
+{
+  guint i, tail;
+
+  for (i = position; i < position + removed; i++)
+    gtk_list_view_set_row_height (self, i, -1);
+  g_array_remove_range (self->heights, position, removed);
+
+  tail = self->heights->len - position;
+  g_array_set_size (self->heights, self->heights->len + added);
+  memmove (&g_array_index (self->heights, int, position + added),
+           &g_array_index (self->heights, int, position),
+           tail * sizeof (int));
+  for (i = position; i < position + added; i++)
+    g_array_index (self->heights, int, i) = -1;
+
+  gtk_list_view_rebuild_height_tree (self);
+
+  if (self->cursor != NO_CURSOR && self->cursor >= position)
+    {
+      if (self->cursor >= position + removed)
+        self->cursor = self->cursor - removed + added;
+      else
+        self->cursor = NO_CURSOR;
+    }
+
+  /* Rows before the change keep their items. Rows after it keep them
+   * too if the whole change happened above them; otherwise they are
+   * unbound and get new items on the next allocation.
+   */
+  if (position + removed <= self->first_row)
+    self->first_row = self->first_row - removed + added;
+  else if (position < self->first_row + self->rows->len)
+    gtk_list_view_release_rows_from (self, position > self->first_row ? position - self->first_row : 0);
+
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+}
+
+static void
+gtk_list_view_adjustment_value_changed (GtkAdjustment *adjustment,
+                                        GtkListView   *self)
+{
+  if (self->in_size_allocate)
+    return;
+
+  gtk_widget_queue_allocate (GTK_WIDGET (self));
+}
+
+static void
+gtk_list_view_clear_adjustment (GtkListView    *self,
+                                GtkOrientation  orientation)
+{
+  GtkAdjustment **adjustmentp;
+
+  adjustmentp = orientation == GTK_ORIENTATION_HORIZONTAL ? &self->hadjustment : &self->vadjustment;
+
+  if (*adjustmentp)
+    {
+      g_signal_handlers_disconnect_by_func (*adjustmentp,
+                                            gtk_list_view_adjustment_value_changed,
+                                            self);
+      g_clear_object (adjustmentp);
+    }
+}
+
+static void
+gtk_list_view_set_adjustment (GtkListView    *self,
+                              GtkOrientation  orientation,
+                              GtkAdjustment  *adjustment)
+{
+  GtkAdjustment **adjustmentp;
+
+  adjustmentp = orientation == GTK_ORIENTATION_HORIZONTAL ? &self->hadjustment : &self->vadjustment;
+
+  if (adjustment && adjustment == *adjustmentp)
+    return;
+
+  if (!adjustment)
+    adjustment = gtk_adjustment_new (0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+
+  gtk_list_view_clear_adjustment (self, orientation);
+  *adjustmentp = g_object_ref_sink (adjustment);
+
+  g_signal_connect (adjustment, "value-changed",
+                    G_CALLBACK (gtk_list_view_adjustment_value_changed),
+                    self);
+
+  gtk_widget_queue_allocate (GTK_WIDGET (self));
+}
+
+static void
+gtk_list_view_clear_model (GtkListView *self)
+{
+  gtk_list_view_clear_rows (self);
+  self->cursor = NO_CURSOR;
+  self->focus_cursor = FALSE;
+  g_array_set_size (self->heights, 0);
+  g_array_set_size (self->height_tree, 1);
+  self->measured_height = 0;
+  self->n_measured = 0;
+
+  if (self->model)
+    {
+      g_signal_handlers_disconnect_by_func (self->model,
+                                            gtk_list_view_items_changed,
+                                            self);
+      g_clear_object (&self->model);
+    }
+
+  if (self->user_data_free_func)
+    self->user_data_free_func (self->user_data);
+
+  self->create_widget_func = NULL;
+  self->bind_widget_func = NULL;
+  self->user_data = NULL;
+  self->user_data_free_func = NULL;
+}
+
+static void
+gtk_list_view_set_property (GObject      *object,
+                            guint         prop_id,
+                            const GValue *value,
+                            GParamSpec   *pspec)
+{
+  GtkListView *self = GTK_LIST_VIEW (object);
+
+  switch (prop_id)
+    {
+    case PROP_HADJUSTMENT:
+      gtk_list_view_set_adjustment (self, GTK_ORIENTATION_HORIZONTAL, g_value_get_object (value));
+      break;
+
+    case PROP_VADJUSTMENT:
+      gtk_list_view_set_adjustment (self, GTK_ORIENTATION_VERTICAL, g_value_get_object (value));
+      break;
+
+    case PROP_HSCROLL_POLICY:
+      if (self->hscroll_policy != g_value_get_enum (value))
+        {
+          self->hscroll_policy = g_value_get_enum (value);
+          gtk_widget_queue_resize (GTK_WIDGET (self));
+          g_object_notify_by_pspec (object, pspec);
+        }
+      break;
+
+    case PROP_VSCROLL_POLICY:
+      if (self->vscroll_policy != g_value_get_enum (value))
+        {
+          self->vscroll_policy = g_value_get_enum (value);
+          gtk_widget_queue_resize (GTK_WIDGET (self));
+          g_object_notify_by_pspec (object, pspec);
+        }
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_list_view_get_property (GObject    *object,
+                            guint       prop_id,
+                            GValue     *value,
+                            GParamSpec *pspec)
+{
+  GtkListView *self = GTK_LIST_VIEW (object);
+
+  switch (prop_id)
+    {
+    case PROP_HADJUSTMENT:
+      g_value_set_object (value, self->hadjustment);
+      break;
+
+    case PROP_VADJUSTMENT:
+      g_value_set_object (value, self->vadjustment);
+      break;
+
+    case PROP_HSCROLL_POLICY:
+      g_value_set_enum (value, self->hscroll_policy);
+      break;
+
+    case PROP_VSCROLL_POLICY:
+      g_value_set_enum (value, self->vscroll_policy);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_list_view_dispose (GObject *object)
+{
+  GtkListView *self = GTK_LIST_VIEW (object);
+
+  gtk_list_view_clear_model (self);
+  gtk_list_view_clear_adjustment (self, GTK_ORIENTATION_HORIZONTAL);
+  gtk_list_view_clear_adjustment (self, GTK_ORIENTATION_VERTICAL);
+
+  G_OBJECT_CLASS (gtk_list_view_parent_class)->dispose (object);
+}
+
+static void
+gtk_list_view_finalize (GObject *object)
+{
+  GtkListView *self = GTK_LIST_VIEW (object);
+
+  g_array_unref (self->heights);
+  g_array_unref (self->height_tree);
+  g_ptr_array_unref (self->rows);
+  g_ptr_array_unref (self->pool);
+
+  G_OBJECT_CLASS (gtk_list_view_parent_class)->finalize (object);
+}
+
+static void
+gtk_list_view_class_init (GtkListViewClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+  GtkBindingSet *binding_set;
+
+  object_class->set_property = gtk_list_view_set_property;
+  object_class->get_property = gtk_list_view_get_property;
+  object_class->dispose = gtk_list_view_dispose;
+  object_class->finalize = gtk_list_view_finalize;
+
+  widget_class->measure = gtk_list_view_measure;
+  widget_class->size_allocate = gtk_list_view_size_allocate;
+  widget_class->snapshot = gtk_list_view_snapshot;
+  widget_class->focus = gtk_list_view_focus;
+
+  /* GtkScrollable implementation */
+  g_object_class_override_property (object_class, PROP_HADJUSTMENT,    "hadjustment");
+  g_object_class_override_property (object_class, PROP_VADJUSTMENT,    "vadjustment");
+  g_object_class_override_property (object_class, PROP_HSCROLL_POLICY, "hscroll-policy");
+  g_object_class_override_property (object_class, PROP_VSCROLL_POLICY, "vscroll-policy");
+
+  /**
+   * GtkListView::move-cursor:
+   * @self: the #GtkListView
+   * @step: the granularity of the move
+   * @count: the number of @step units to move
+   *
+   * Moves the cursor, and with it the keyboard focus, to another item
+   * and scrolls that item into view.
+   *
+   * This is a [keybinding signal][GtkBindingSignal], bound to the
+   * arrow keys, Page Up, Page Down, Home and End.
+   */
+  signals[MOVE_CURSOR] =
+    g_signal_new_class_handler (I_("move-cursor"),
+                                G_OBJECT_CLASS_TYPE (klass),
+                                G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+                                G_CALLBACK (gtk_list_view_move_cursor),
+                                NULL, NULL,
+                                _gtk_marshal_VOID__ENUM_INT,
+                                G_TYPE_NONE, 2,
+                                GTK_TYPE_MOVEMENT_STEP, G_TYPE_INT);
+
+  binding_set = gtk_binding_set_by_class (klass);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_Home, GTK_MOVEMENT_BUFFER_ENDS, -1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_KP_Home, GTK_MOVEMENT_BUFFER_ENDS, -1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_End, GTK_MOVEMENT_BUFFER_ENDS, 1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_KP_End, GTK_MOVEMENT_BUFFER_ENDS, 1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_Up, GTK_MOVEMENT_DISPLAY_LINES, -1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_KP_Up, GTK_MOVEMENT_DISPLAY_LINES, -1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_Down, GTK_MOVEMENT_DISPLAY_LINES, 1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_KP_Down, GTK_MOVEMENT_DISPLAY_LINES, 1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_Page_Up, GTK_MOVEMENT_PAGES, -1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_KP_Page_Up, GTK_MOVEMENT_PAGES, -1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_Page_Down, GTK_MOVEMENT_PAGES, 1);
+  gtk_list_view_add_move_binding (binding_set, GDK_KEY_KP_Page_Down, GTK_MOVEMENT_PAGES, 1);
+
+  gtk_widget_class_set_accessible_role (widget_class, ATK_ROLE_LIST);
+  gtk_widget_class_set_css_name (widget_class, I_("listview"));
+}
+
+static void
+gtk_list_view_init (GtkListView *self)
+{
+  gtk_widget_set_has_window (GTK_WIDGET (self), FALSE);
+  gtk_widget_set_can_focus (GTK_WIDGET (self), TRUE);
+
+  self->heights = g_array_new (FALSE, FALSE, sizeof (int));
+  self->height_tree = g_array_new (FALSE, TRUE, sizeof (HeightNode));
+  g_array_set_size (self->height_tree, 1);
+  self->rows = g_ptr_array_new ();
+  self->pool = g_ptr_array_new ();
+  self->last_width = -1;
+  self->cursor = NO_CURSOR;
+
+  gtk_list_view_set_adjustment (self, GTK_ORIENTATION_HORIZONTAL, NULL);
+  gtk_list_view_set_adjustment (self, GTK_ORIENTATION_VERTICAL, NULL);
+}
+
+/**
+ * gtk_list_view_new:
+ *
+ * Creates a new, empty #GtkListView.
+ *
+ * Returns: a new #GtkListView
+ */
+GtkWidget *
+gtk_list_view_new (void)
+{
+  return g_object_new (GTK_TYPE_LIST_VIEW, NULL);
+}
+
+/**
+ * gtk_list_view_bind_model:
+ * @self: a #GtkListView
+ * @model: (nullable): the #GListModel to show, or %NULL
+ * @create_widget_func: (nullable): a function that creates row widgets
+ * @bind_widget_func: (nullable): a function that makes a row widget
+ *     display an item
+ * @user_data: (closure): user data passed to the functions
+ * @user_data_free_func: function for freeing @user_data
+ *
+ * Makes @self show the items of @model. Any previously bound model is
+ * dropped, together with all row widgets created for it.
+ *
+ * Row widgets are only created for items near the visible area, and are
+ * reused for other items as the list scrolls, so @bind_widget_func will
+ * be called many times for the same widget.
+ *
+ * If @model is %NULL, @self is left empty.
+ */
+void
+gtk_list_view_bind_model (GtkListView                 *self,
+                          GListModel                  *model,
+                          GtkListViewCreateWidgetFunc  create_widget_func,
+                          GtkListViewBindWidgetFunc    bind_widget_func,
+                          gpointer                     user_data,
+                          GDestroyNotify               user_data_free_func)
+{
+  g_return_if_fail (GTK_IS_LIST_VIEW (self));
+  g_return_if_fail (model == NULL || G_IS_LIST_MODEL (model));
+  g_return_if_fail (model == NULL || create_widget_func != NULL);
+  g_return_if_fail (model == NULL || bind_widget_func != NULL);
+
+  gtk_list_view_clear_model (self);
+
+  if (model == NULL)
+    {
+      if (user_data_free_func)
+        user_data_free_func (user_data);
+
+      gtk_widget_queue_resize (GTK_WIDGET (self));
+      return;
+    }
+
+  self->model = g_object_ref (model);
+  self->create_widget_func = create_widget_func;
+  self->bind_widget_func = bind_widget_func;
+  self->user_data = user_data;
+  self->user_data_free_func = user_data_free_func;
+
+  g_array_set_size (self->heights, g_list_model_get_n_items (model));
+  gtk_list_view_forget_heights (self);
+
+  g_signal_connect (model, "items-changed",
+                    G_CALLBACK (gtk_list_view_items_changed), self);
+
+  gtk_widget_queue_resize (GTK_WIDGET (self));
+}
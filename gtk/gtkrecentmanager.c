@@ -172,6 +172,9 @@ struct _GtkRecentManagerPrivate
 
   GFileMonitor *monitor;
 
+  /* identifies the version of the file we last read or wrote */
+  gchar *file_stamp;
+
   guint changed_timeout;
   guint changed_age;
 };
@@ -383,6 +386,7 @@ gtk_recent_manager_finalize (GObject *object)
   GtkRecentManagerPrivate *priv = manager->priv;
 
   g_free (priv->filename);
+  g_free (priv->file_stamp);
 
   if (priv->recent_items != NULL)
     g_bookmark_file_free (priv->recent_items);
@@ -429,6 +433,139 @@ gtk_recent_manager_enabled_changed (GtkRecentManager *manager)
   gtk_recent_manager_changed (manager);
 }
 
+static gchar *
+make_file_stamp (GFileInfo *info,
+                 goffset    size)
+{
+  /* The etag only has the resolution of the file system timestamps,
+   * so two writes of the same size in quick succession can share it.
+   * Every write replaces the file with a new one though, which gets
+   * a new inode.
+   */
+  return g_strdup_printf ("%s:%" G_GUINT64_FORMAT ":%" G_GOFFSET_FORMAT,
+                          g_file_info_get_etag (info),
+                          g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_UNIX_INODE),
+                          size);
+}
+
+/* Returns a string that changes whenever the file at @filename is
+ * replaced or modified, or %NULL if it does not exist.
+ */
+static gchar *
+get_file_stamp (const gchar *filename)
+{
+  GFile *file;
+  GFileInfo *info;
+  gchar *stamp;
+
+  file = g_file_new_for_path (filename);
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_ETAG_VALUE ","
+                            G_FILE_ATTRIBUTE_UNIX_INODE ","
+                            G_FILE_ATTRIBUTE_STANDARD_SIZE,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, NULL);
+  g_object_unref (file);
+
+  if (info == NULL)
+    return NULL;
+
+  stamp = make_file_stamp (info, g_file_info_get_size (info));
+  g_object_unref (info);
+
+  return stamp;
+}
+
+/* Writes the recently used items list, and remembers the stamp of the
+ * file as it was written. Querying the file afterwards could pick up a
+ * write from another process that happened in between, which would
+ * then never be read. The stamp is taken from the stream before it is
+ * closed; the file it was written to keeps its inode and timestamp
+ * when it is renamed into place.
+ */
+static gboolean
+write_recent_items (GtkRecentManager  *manager,
+                    GError           **error)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GFile *file;
+  GFileOutputStream *stream;
+  GFileInfo *info = NULL;
+  gchar *contents;
+  gsize length;
+  gboolean retval;
+
+  contents = g_bookmark_file_to_data (priv->recent_items, &length, error);
+  if (contents == NULL)
+    return FALSE;
+
+  file = g_file_new_for_path (priv->filename);
+  stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, error);
+  g_object_unref (file);
+
+  if (stream == NULL)
+    {
+      g_free (contents);
+      return FALSE;
+    }
+
+  retval = g_output_stream_write_all (G_OUTPUT_STREAM (stream),
+                                      contents, length,
+                                      NULL, NULL, error);
+  g_free (contents);
+
+  if (retval)
+    {
+      info = g_file_output_stream_query_info (stream,
+                                              G_FILE_ATTRIBUTE_UNIX_INODE ","
+                                              G_FILE_ATTRIBUTE_ETAG_VALUE,
+                                              NULL, NULL);
+      retval = g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, error);
+    }
+  else
+    {
+      GCancellable *cancellable;
+
+      /* Closing with a cancelled cancellable discards what we wrote
+       * instead of replacing the file with it.
+       */
+      cancellable = g_cancellable_new ();
+      g_cancellable_cancel (cancellable);
+      g_output_stream_close (G_OUTPUT_STREAM (stream), cancellable, NULL);
+      g_object_unref (cancellable);
+    }
+
+  g_object_unref (stream);
+
+  if (retval)
+    {
+      g_free (priv->file_stamp);
+      /* Without the info, the next check just rereads our own write */
+      priv->file_stamp = info != NULL ? make_file_stamp (info, length) : NULL;
+    }
+
+  g_clear_object (&info);
+
+  return retval;
+}
+
+static gboolean
+file_stamp_changed (GtkRecentManager *manager)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  gchar *stamp;
+  gboolean changed;
+
+  if (priv->filename == NULL)
+    return FALSE;
+
+  stamp = get_file_stamp (priv->filename);
+  changed = g_strcmp0 (stamp, priv->file_stamp) != 0;
+  g_free (stamp);
+
+  return changed;
+}
+
 static void
 gtk_recent_manager_real_changed (GtkRecentManager *manager)
 {
@@ -487,9 +624,11 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
 
       if (priv->filename != NULL)
         {
+          /* this remembers what we wrote, so that we do not read it
+           * back when the file monitor tells us about it
+           */
           write_error = NULL;
-          g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
-          if (write_error)
+          if (!write_recent_items (manager, &write_error))
             {
               gchar *utf8 = g_filename_to_utf8 (priv->filename, -1, NULL, NULL, NULL);
               g_warning ("Attempting to store changes into '%s', but failed: %s",
@@ -518,7 +657,8 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
        * because the recently used resources file has been
        * changed (and not from us).
        */
-      build_recent_items_list (manager);
+      if (file_stamp_changed (manager))
+        build_recent_items_list (manager);
     }
 
   g_object_thaw_notify (G_OBJECT (manager));
@@ -538,7 +678,11 @@ gtk_recent_manager_monitor_changed (GFileMonitor      *monitor,
     case G_FILE_MONITOR_EVENT_CHANGED:
     case G_FILE_MONITOR_EVENT_CREATED:
     case G_FILE_MONITOR_EVENT_DELETED:
-      gtk_recent_manager_changed (manager);
+      /* our own writes, and repeated events for the same write,
+       * do not need a reload
+       */
+      if (file_stamp_changed (manager))
+        gtk_recent_manager_changed (manager);
       break;
 
     case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
@@ -672,6 +816,9 @@ build_recent_items_list (GtkRecentManager *manager)
        * object and hope for a better result when the next "changed" signal is
        * fired.
        */
+      g_free (priv->file_stamp);
+      priv->file_stamp = get_file_stamp (priv->filename);
+
       read_error = NULL;
       g_bookmark_file_load_from_file (priv->recent_items, priv->filename, &read_error);
       if (read_error)
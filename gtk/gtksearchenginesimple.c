@@ -32,21 +32,37 @@
 #include <string.h>
 
 #define BATCH_SIZE 500
+#define ENUMERATE_SIZE 100
+#define MAX_THREADS 8
 
 typedef struct
 {
   GtkSearchEngineSimple *engine;
   GCancellable *cancellable;
 
+  /* The directories still to visit are shared between the worker
+   * threads; an idle worker takes the next one from the queue.
+   */
+  GMutex lock;
+  GCond cond;
   GQueue *directories;
-
-  gint n_processed_files;
-  GList *hits;
+  gint n_busy;
+  gint n_threads;
 
   GtkQuery *query;
   gboolean recursive;
 } SearchThreadData;
 
+typedef struct
+{
+  SearchThreadData *data;
+
+  gint n_processed_files;
+  GList *hits;
+
+  GQueue subdirs;
+} SearchWorker;
+
 
 struct _GtkSearchEngineSimple
 {
@@ -89,13 +105,13 @@ gtk_search_engine_simple_dispose (GObject *object)
 }
 
 static void
-queue_if_local (SearchThreadData *data,
-                GFile            *file)
+queue_if_local (GQueue *directories,
+                GFile  *file)
 {
   if (file &&
       !_gtk_file_consider_as_remote (file) &&
       !g_file_has_uri_scheme (file, "recent"))
-    g_queue_push_tail (data->directories, g_object_ref (file));
+    g_queue_push_tail (directories, g_object_ref (file));
 }
 
 static SearchThreadData *
@@ -110,7 +126,10 @@ search_thread_data_new (GtkSearchEngineSimple *engine,
   data->directories = g_queue_new ();
   data->query = g_object_ref (query);
   data->recursive = _gtk_search_engine_get_recursive (GTK_SEARCH_ENGINE (engine));
-  queue_if_local (data, gtk_query_get_location (query));
+  queue_if_local (data->directories, gtk_query_get_location (query));
+
+  g_mutex_init (&data->lock);
+  g_cond_init (&data->cond);
 
   data->cancellable = g_cancellable_new ();
 
@@ -122,6 +141,8 @@ search_thread_data_free (SearchThreadData *data)
 {
   g_queue_foreach (data->directories, (GFunc)g_object_unref, NULL);
   g_queue_free (data->directories);
+  g_mutex_clear (&data->lock);
+  g_cond_clear (&data->cond);
   g_object_unref (data->cancellable);
   g_object_unref (data->query);
   g_object_unref (data->engine);
@@ -166,25 +187,25 @@ search_thread_add_hits_idle (gpointer user_data)
 }
 
 static void
-send_batch (SearchThreadData *data)
+send_batch (SearchWorker *worker)
 {
   Batch *batch;
 
-  data->n_processed_files = 0;
+  worker->n_processed_files = 0;
 
-  if (data->hits)
+  if (worker->hits)
     {
       guint id;
 
       batch = g_new (Batch, 1);
-      batch->hits = data->hits;
-      batch->thread_data = data;
+      batch->hits = worker->hits;
+      batch->thread_data = worker->data;
 
       id = g_idle_add (search_thread_add_hits_idle, batch);
       g_source_set_name_by_id (id, "[gtk+] search_thread_add_hits_idle");
     }
 
-  data->hits = NULL;
+  worker->hits = NULL;
 }
 
 static gboolean
@@ -207,12 +228,12 @@ is_indexed (GtkSearchEngineSimple *engine,
 }
 
 static void
-visit_directory (GFile *dir, SearchThreadData *data)
+visit_directory (GFile        *dir,
+                 SearchWorker *worker)
 {
+  SearchThreadData *data = worker->data;
   GFileEnumerator *enumerator;
-  GFileInfo *info;
-  GFile *child;
-  const gchar *display_name;
+  GList *infos, *l;
 
   enumerator = g_file_enumerate_children (dir,
                                           G_FILE_ATTRIBUTE_STANDARD_NAME ","
@@ -233,36 +254,48 @@ visit_directory (GFile *dir, SearchThreadData *data)
   if (enumerator == NULL)
     return;
 
-  while (g_file_enumerator_iterate (enumerator, &info, &child, data->cancellable, NULL))
+  /* Read the directory in chunks, rather than one entry at a time */
+  while ((infos = g_file_enumerator_next_files (enumerator, ENUMERATE_SIZE,
+                                                data->cancellable, NULL)) != NULL)
     {
-      if (info == NULL)
-        break;
+      for (l = infos; l; l = l->next)
+        {
+          GFileInfo *info = l->data;
+          const gchar *display_name;
+          GFile *child;
 
-      display_name = g_file_info_get_display_name (info);
-      if (display_name == NULL)
-        continue;
+          display_name = g_file_info_get_display_name (info);
+          if (display_name == NULL)
+            continue;
 
-      if (g_file_info_get_is_hidden (info))
-        continue;
+          if (g_file_info_get_is_hidden (info))
+            continue;
 
-      if (gtk_query_matches_string (data->query, display_name))
-        {
-          GtkSearchHit *hit;
+          child = g_file_enumerator_get_child (enumerator, info);
 
-          hit = g_new (GtkSearchHit, 1);
-          hit->file = g_object_ref (child);
-          hit->info = g_object_ref (info);
-          data->hits = g_list_prepend (data->hits, hit);
-        }
+          if (gtk_query_matches_string (data->query, display_name))
+            {
+              GtkSearchHit *hit;
+
+              hit = g_new (GtkSearchHit, 1);
+              hit->file = g_object_ref (child);
+              hit->info = g_object_ref (info);
+              worker->hits = g_list_prepend (worker->hits, hit);
+            }
+
+          worker->n_processed_files++;
+          if (worker->n_processed_files > BATCH_SIZE)
+            send_batch (worker);
+
+          if (data->recursive &&
+              g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
+              !is_indexed (data->engine, child))
+            queue_if_local (&worker->subdirs, child);
 
-      data->n_processed_files++;
-      if (data->n_processed_files > BATCH_SIZE)
-        send_batch (data);
+          g_object_unref (child);
+        }
 
-      if (data->recursive &&
-          g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
-          !is_indexed (data->engine, child))
-        queue_if_local (data, child);
+      g_list_free_full (infos, g_object_unref);
     }
 
   g_object_unref (enumerator);
@@ -271,24 +304,75 @@ visit_directory (GFile *dir, SearchThreadData *data)
 static gpointer
 search_thread_func (gpointer user_data)
 {
-  SearchThreadData *data;
-  GFile *dir;
-  guint id;
+  SearchThreadData *data = user_data;
+  SearchWorker worker = { data, 0, NULL, G_QUEUE_INIT };
+  gboolean last;
 
-  data = user_data;
+  g_mutex_lock (&data->lock);
 
-  while (!g_cancellable_is_cancelled (data->cancellable) &&
-         (dir = g_queue_pop_head (data->directories)) != NULL)
+  while (!g_cancellable_is_cancelled (data->cancellable))
     {
-      visit_directory (dir, data);
+      GFile *dir;
+
+      dir = g_queue_pop_head (data->directories);
+      if (dir == NULL)
+        {
+          /* Nothing is queued and nobody can queue more: we are done */
+          if (data->n_busy == 0)
+            break;
+
+          /* Wake up regularly to notice cancellation */
+          g_cond_wait_until (&data->cond, &data->lock,
+                             g_get_monotonic_time () + 50 * G_TIME_SPAN_MILLISECOND);
+          continue;
+        }
+
+      data->n_busy++;
+      g_mutex_unlock (&data->lock);
+
+      visit_directory (dir, &worker);
       g_object_unref (dir);
+
+      g_mutex_lock (&data->lock);
+      data->n_busy--;
+
+      /* Hand the subdirectories found to all workers at once */
+      while (!g_queue_is_empty (&worker.subdirs))
+        g_queue_push_tail (data->directories, g_queue_pop_head (&worker.subdirs));
+
+      g_cond_broadcast (&data->cond);
     }
 
+  g_mutex_unlock (&data->lock);
+
+  g_queue_foreach (&worker.subdirs, (GFunc)g_object_unref, NULL);
+  g_queue_clear (&worker.subdirs);
+
+  /* Flush before signing off: once the last worker is gone, data may
+   * be freed by search_thread_done_idle() at any time.
+   */
   if (!g_cancellable_is_cancelled (data->cancellable))
-    send_batch (data);
+    send_batch (&worker);
+  else
+    g_list_free_full (worker.hits, (GDestroyNotify)_gtk_search_hit_free);
+  worker.hits = NULL;
+
+  g_mutex_lock (&data->lock);
+  data->n_threads--;
+  last = data->n_threads == 0;
+  g_cond_broadcast (&data->cond);
+  g_mutex_unlock (&data->lock);
+
+  /* The last worker to finish reports back to the main thread. Nothing
+   * but the last one may touch data from here on.
+   */
+  if (last)
+    {
+      guint id;
 
-  id = g_idle_add (search_thread_done_idle, data);
-  g_source_set_name_by_id (id, "[gtk+] search_thread_done_idle");
+      id = g_idle_add (search_thread_done_idle, data);
+      g_source_set_name_by_id (id, "[gtk+] search_thread_done_idle");
+    }
 
   return NULL;
 }
@@ -298,6 +382,7 @@ gtk_search_engine_simple_start (GtkSearchEngine *engine)
 {
   GtkSearchEngineSimple *simple;
   SearchThreadData *data;
+  gint n_threads, i;
 
   simple = GTK_SEARCH_ENGINE_SIMPLE (engine);
 
@@ -309,7 +394,18 @@ gtk_search_engine_simple_start (GtkSearchEngine *engine)
 
   data = search_thread_data_new (simple, simple->query);
 
-  g_thread_unref (g_thread_new ("file-search", search_thread_func, data));
+  if (data->recursive)
+    n_threads = CLAMP (g_get_num_processors (), 2, MAX_THREADS);
+  else
+    n_threads = 1;
+
+  /* Set before starting any thread, so that an early finisher does not
+   * report back while others have yet to start.
+   */
+  data->n_threads = n_threads;
+
+  for (i = 0; i < n_threads; i++)
+    g_thread_unref (g_thread_new ("file-search", search_thread_func, data));
 
   simple->active_search = data;
 }
@@ -1217,6 +1217,57 @@ gtk_snapshot_pop (GtkSnapshot *snapshot)
     }
 }
 
+/*
+ * gtk_snapshot_pop_collect:
+ * @snapshot: a #GtkSnapshot
+ *
+ * Removes the top element from the stack of render nodes and
+ * returns it instead of appending it to the node underneath it.
+ *
+ * Returns: (transfer full) (nullable): the collected node
+ */
+GskRenderNode *
+gtk_snapshot_pop_collect (GtkSnapshot *snapshot)
+{
+  return gtk_snapshot_pop_internal (snapshot);
+}
+
+/*
+ * gtk_snapshot_append_node_at_offset:
+ * @snapshot: a #GtkSnapshot
+ * @node: a #GskRenderNode that was created at offset (0, 0)
+ *
+ * Appends @node to the current render node of @snapshot, translated
+ * by the current offset of @snapshot. This is used to place nodes
+ * that were recorded independently of @snapshot, like the render
+ * nodes cached by widgets.
+ */
+void
+gtk_snapshot_append_node_at_offset (GtkSnapshot   *snapshot,
+                                    GskRenderNode *node)
+{
+  const GtkSnapshotState *current_state = gtk_snapshot_get_current_state (snapshot);
+  graphene_matrix_t offset;
+  GskRenderNode *transform_node;
+
+  if (current_state->translate_x == 0 && current_state->translate_y == 0)
+    {
+      gtk_snapshot_append_node (snapshot, node);
+      return;
+    }
+
+  graphene_matrix_init_translate (&offset,
+                                  &GRAPHENE_POINT3D_INIT(
+                                      current_state->translate_x,
+                                      current_state->translate_y,
+                                      0
+                                  ));
+
+  transform_node = gsk_transform_node_new (node, &offset);
+  gtk_snapshot_append_node (snapshot, transform_node);
+  gsk_render_node_unref (transform_node);
+}
+
 /**
  * gtk_snapshot_get_renderer:
  * @snapshot: a #GtkSnapshot
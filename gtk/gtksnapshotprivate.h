@@ -88,6 +88,10 @@ struct _GdkSnapshot {
   GPtrArray             *nodes;
 };
 
+GskRenderNode * gtk_snapshot_pop_collect                (GtkSnapshot            *snapshot);
+void            gtk_snapshot_append_node_at_offset      (GtkSnapshot            *snapshot,
+                                                         GskRenderNode          *node);
+
 G_END_DECLS
 
 #endif /* __GTK_SNAPSHOT_PRIVATE_H__ */
@@ -4423,7 +4423,7 @@ forward_chars_with_skipping (GtkTextIter *iter,
           _gtk_text_btree_char_is_invisible (iter))
         ignored = TRUE;
 
-      if (!ignored && skip_decomp)
+      if (!ignored && skip_decomp && gtk_text_iter_get_char (iter) >= 0x80)
         {
           /* being UTF8 correct sucks: this accounts for extra
              offsets coming from canonical decompositions of
@@ -4460,6 +4460,14 @@ pointer_from_offset_skipping_decomp (const gchar *str,
 
   while (offset > 0)
     {
+      /* ASCII characters never decompose */
+      if ((guchar) *p < 0x80)
+        {
+          offset--;
+          p++;
+          continue;
+        }
+
       q = g_utf8_next_char (p);
       casefold = g_utf8_casefold (p, q - p);
       normal = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
@@ -4494,57 +4502,104 @@ exact_prefix_cmp (const gchar *string,
          type != G_UNICODE_NON_SPACING_MARK;
 }
 
+static gboolean
+str_is_ascii (const gchar *str,
+              gssize       len)
+{
+  const gchar *p;
+
+  for (p = str; len < 0 ? *p != '\0' : p < str + len; p++)
+    {
+      if ((guchar) *p >= 0x80)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* For ASCII, casefolding is g_ascii_tolower() and normalization does
+ * nothing, so we can compare in place instead of building a caseless
+ * copy of the haystack. @needle is already casefolded.
+ */
+static const gchar *
+ascii_strcasestr (const gchar *haystack,
+                  const gchar *needle)
+{
+  gsize needle_len = strlen (needle);
+  const gchar *p;
+
+  for (p = haystack; *p; p++)
+    {
+      if (g_ascii_tolower (*p) == needle[0] &&
+          g_ascii_strncasecmp (p, needle, needle_len) == 0)
+        return p;
+    }
+
+  return NULL;
+}
+
+static const gchar *
+ascii_strrcasestr (const gchar *haystack,
+                   const gchar *needle)
+{
+  gsize needle_len = strlen (needle);
+  gsize haystack_len = strlen (haystack);
+  const gchar *p;
+
+  if (haystack_len < needle_len)
+    return NULL;
+
+  for (p = haystack + haystack_len - needle_len; ; p--)
+    {
+      if (g_ascii_tolower (*p) == needle[0] &&
+          g_ascii_strncasecmp (p, needle, needle_len) == 0)
+        return p;
+
+      if (p == haystack)
+        break;
+    }
+
+  return NULL;
+}
+
 static const gchar *
 utf8_strcasestr (const gchar *haystack,
                  const gchar *needle)
 {
   gsize needle_len;
-  gsize haystack_len;
   const gchar *ret = NULL;
   gchar *p;
   gchar *casefold;
   gchar *caseless_haystack;
-  gint i;
 
   g_return_val_if_fail (haystack != NULL, NULL);
   g_return_val_if_fail (needle != NULL, NULL);
 
+  if (*needle == '\0')
+    return haystack;
+
+  if (str_is_ascii (haystack, -1))
+    return ascii_strcasestr (haystack, needle);
+
   casefold = g_utf8_casefold (haystack, -1);
   caseless_haystack = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
   g_free (casefold);
 
-  needle_len = g_utf8_strlen (needle, -1);
-  haystack_len = g_utf8_strlen (caseless_haystack, -1);
-
-  if (needle_len == 0)
-    {
-      ret = (gchar *)haystack;
-      goto finally;
-    }
-
-  if (haystack_len < needle_len)
-    {
-      ret = NULL;
-      goto finally;
-    }
-
-  p = (gchar *)caseless_haystack;
   needle_len = strlen (needle);
-  i = 0;
 
-  while (*p)
+  /* Matches of valid UTF-8 always start at a character boundary, so we
+   * can let strstr() skip ahead and only count characters once.
+   */
+  for (p = strstr (caseless_haystack, needle); p; p = strstr (g_utf8_next_char (p), needle))
     {
       if (exact_prefix_cmp (p, needle, needle_len))
         {
-          ret = pointer_from_offset_skipping_decomp (haystack, i);
-          goto finally;
+          ret = pointer_from_offset_skipping_decomp (haystack,
+                                                     g_utf8_strlen (caseless_haystack, p - caseless_haystack));
+          break;
         }
-
-      p = g_utf8_next_char (p);
-      i++;
     }
 
-finally:
   g_free (caseless_haystack);
 
   return ret;
@@ -4555,55 +4610,37 @@ utf8_strrcasestr (const gchar *haystack,
                   const gchar *needle)
 {
   gsize needle_len;
-  gsize haystack_len;
   const gchar *ret = NULL;
-  gchar *p;
+  gchar *p, *last;
   gchar *casefold;
   gchar *caseless_haystack;
-  gint i;
 
   g_return_val_if_fail (haystack != NULL, NULL);
   g_return_val_if_fail (needle != NULL, NULL);
 
+  if (*needle == '\0')
+    return haystack;
+
+  if (str_is_ascii (haystack, -1))
+    return ascii_strrcasestr (haystack, needle);
+
   casefold = g_utf8_casefold (haystack, -1);
   caseless_haystack = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
   g_free (casefold);
 
-  needle_len = g_utf8_strlen (needle, -1);
-  haystack_len = g_utf8_strlen (caseless_haystack, -1);
-
-  if (needle_len == 0)
-    {
-      ret = (gchar *)haystack;
-      goto finally;
-    }
-
-  if (haystack_len < needle_len)
-    {
-      ret = NULL;
-      goto finally;
-    }
-
-  i = haystack_len - needle_len;
-  p = g_utf8_offset_to_pointer (caseless_haystack, i);
   needle_len = strlen (needle);
 
-  while (TRUE)
+  last = NULL;
+  for (p = strstr (caseless_haystack, needle); p; p = strstr (g_utf8_next_char (p), needle))
     {
       if (exact_prefix_cmp (p, needle, needle_len))
-        {
-          ret = pointer_from_offset_skipping_decomp (haystack, i);
-          break;
-        }
-
-      if (p == caseless_haystack)
-        break;
-
-      p = g_utf8_prev_char (p);
-      i--;
+        last = p;
     }
 
-finally:
+  if (last)
+    ret = pointer_from_offset_skipping_decomp (haystack,
+                                               g_utf8_strlen (caseless_haystack, last - caseless_haystack));
+
   g_free (caseless_haystack);
 
   return ret;
@@ -4629,6 +4666,9 @@ utf8_caselessnmatch (const gchar *s1,
   g_return_val_if_fail (n1 > 0, FALSE);
   g_return_val_if_fail (n2 > 0, FALSE);
 
+  if (str_is_ascii (s1, n1) && str_is_ascii (s2, n2))
+    return n1 >= n2 && g_ascii_strncasecmp (s1, s2, n2) == 0;
+
   casefold = g_utf8_casefold (s1, n1);
   normalized_s1 = g_utf8_normalize (casefold, -1, G_NORMALIZE_NFD);
   g_free (casefold);
@@ -82,6 +82,7 @@
 #include "gtktextbufferprivate.h"
 #include "gtktextiterprivate.h"
 #include "gtktextutil.h"
+#include "gtkdebug.h"
 #include "gtkintl.h"
 
 #include <stdlib.h>
@@ -97,8 +98,20 @@ struct _GtkTextLayoutPrivate
      direction only influences the direction of the cursor line.
   */
   GtkTextLine *cursor_line;
+
+  /* Recently used line displays. Scrolling and redrawing get the
+   * same lines over and over, and rebuilding their PangoLayouts is
+   * what makes that expensive.
+   */
+  GHashTable *display_cache; /* GtkTextLine -> link in display_lru */
+  GQueue display_lru;        /* GtkTextLineDisplay, most recent first */
+  guint display_cache_hits;
+  guint display_cache_misses;
 };
 
+/* Comfortably more than the lines visible in a large view */
+#define DISPLAY_CACHE_SIZE 256
+
 static GtkTextLineData *gtk_text_layout_real_wrap (GtkTextLayout *layout,
                                                    GtkTextLine *line,
                                                    /* may be NULL */
@@ -126,6 +139,7 @@ static void gtk_text_layout_emit_changed           (GtkTextLayout     *layout,
 						    gint               new_height);
 
 static void gtk_text_layout_invalidate_all (GtkTextLayout *layout);
+static void gtk_text_layout_clear_display_cache (GtkTextLayout *layout);
 
 static PangoAttribute *gtk_text_attr_appearance_new (const GtkTextAppearance *appearance);
 
@@ -193,12 +207,7 @@ gtk_text_layout_dispose (GObject *object)
   g_clear_object (&layout->ltr_context);
   g_clear_object (&layout->rtl_context);
 
-  if (layout->one_display_cache)
-    {
-      GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-      layout->one_display_cache = NULL;
-      gtk_text_layout_free_line_display (layout, tmp_display);
-    }
+  gtk_text_layout_clear_display_cache (layout);
 
   if (layout->preedit_attrs != NULL)
     {
@@ -216,6 +225,13 @@ gtk_text_layout_finalize (GObject *object)
 
   layout = GTK_TEXT_LAYOUT (object);
 
+  GTK_NOTE (TEXT, g_message ("GtkTextLayout %p line display cache: %u hits, %u misses",
+                             layout,
+                             GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->display_cache_hits,
+                             GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->display_cache_misses));
+
+  g_hash_table_unref (GTK_TEXT_LAYOUT_GET_PRIVATE (layout)->display_cache);
+
   g_free (layout->preedit_string);
 
   G_OBJECT_CLASS (gtk_text_layout_parent_class)->finalize (object);
@@ -276,7 +292,12 @@ gtk_text_layout_class_init (GtkTextLayoutClass *klass)
 static void
 gtk_text_layout_init (GtkTextLayout *text_layout)
 {
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (text_layout);
+
   text_layout->cursor_visible = TRUE;
+
+  priv->display_cache = g_hash_table_new (NULL, NULL);
+  g_queue_init (&priv->display_lru);
 }
 
 GtkTextLayout*
@@ -295,6 +316,87 @@ free_style_cache (GtkTextLayout *text_layout)
     }
 }
 
+static void
+line_display_free (GtkTextLineDisplay *display)
+{
+  if (display->layout)
+    g_object_unref (display->layout);
+
+  if (display->cursors)
+    g_array_free (display->cursors, TRUE);
+
+  if (display->pg_bg_rgba)
+    gdk_rgba_free (display->pg_bg_rgba);
+
+  g_slice_free (GtkTextLineDisplay, display);
+}
+
+static void
+display_cache_remove (GtkTextLayout *layout,
+                      GList         *link)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display = link->data;
+
+  g_hash_table_remove (priv->display_cache, display->line);
+  g_queue_delete_link (&priv->display_lru, link);
+
+  line_display_free (display);
+}
+
+static void
+display_cache_add (GtkTextLayout      *layout,
+                   GtkTextLineDisplay *display)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+
+  if (priv->display_lru.length >= DISPLAY_CACHE_SIZE)
+    display_cache_remove (layout, priv->display_lru.tail);
+
+  /* Size-only displays come from validation walking the whole
+   * buffer; queue them for eviction first so they don't push out
+   * the lines that are on screen.
+   */
+  if (display->size_only)
+    g_queue_push_tail (&priv->display_lru, display);
+  else
+    g_queue_push_head (&priv->display_lru, display);
+
+  g_hash_table_insert (priv->display_cache,
+                       display->line,
+                       display->size_only ? priv->display_lru.tail : priv->display_lru.head);
+}
+
+/* Lines that never had line data can be freed without the layout
+ * hearing about it; drop their displays once the text has changed.
+ */
+static gboolean
+display_cache_drop_stale (GtkTextLayout *layout,
+                          GList         *link)
+{
+  GtkTextLineDisplay *display = link->data;
+
+  if (!display->check_stamp ||
+      display->chars_changed_stamp == _gtk_text_btree_get_chars_changed_stamp (_gtk_text_buffer_get_btree (layout->buffer)))
+    return FALSE;
+
+  display_cache_remove (layout, link);
+
+  return TRUE;
+}
+
+static void
+gtk_text_layout_clear_display_cache (GtkTextLayout *layout)
+{
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GtkTextLineDisplay *display;
+
+  g_hash_table_remove_all (priv->display_cache);
+
+  while ((display = g_queue_pop_head (&priv->display_lru)))
+    line_display_free (display);
+}
+
 /**
  * gtk_text_layout_set_buffer:
  * @buffer: (allow-none):
@@ -310,6 +412,7 @@ gtk_text_layout_set_buffer (GtkTextLayout *layout,
     return;
 
   free_style_cache (layout);
+  gtk_text_layout_clear_display_cache (layout);
 
   if (layout->buffer)
     {
@@ -635,18 +738,26 @@ text_layout_changed (GtkTextLayout *layout,
                      gint           new_height,
                      gboolean       cursors_only)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l, *next;
+
+  /* Invalidate the cached line displays that intersect the range.
    */
-  if (layout->one_display_cache)
+  for (l = priv->display_lru.head; l != NULL; l = next)
     {
-      GtkTextLine *line = layout->one_display_cache->line;
-      gint cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
-						    line, layout);
-      gint cache_height = layout->one_display_cache->height;
+      GtkTextLineDisplay *display = l->data;
+      gint cache_y;
 
-      if (cache_y + cache_height > y && cache_y < y + old_height)
-	gtk_text_layout_invalidate_cache (layout, line, cursors_only);
+      next = l->next;
+
+      if (display_cache_drop_stale (layout, l))
+        continue;
+
+      cache_y = _gtk_text_btree_find_line_top (_gtk_text_buffer_get_btree (layout->buffer),
+                                               display->line, layout);
+
+      if (cache_y + display->height > y && cache_y < y + old_height)
+	gtk_text_layout_invalidate_cache (layout, display->line, cursors_only);
     }
 
   gtk_text_layout_emit_changed (layout, y, old_height, new_height);
@@ -818,9 +929,13 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
                                   GtkTextLine   *line,
 				  gboolean       cursors_only)
 {
-  if (layout->one_display_cache && line == layout->one_display_cache->line)
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
+
+  link = g_hash_table_lookup (priv->display_cache, line);
+  if (link)
     {
-      GtkTextLineDisplay *display = layout->one_display_cache;
+      GtkTextLineDisplay *display = link->data;
 
       if (cursors_only)
 	{
@@ -831,10 +946,7 @@ gtk_text_layout_invalidate_cache (GtkTextLayout *layout,
 	  display->has_block_cursor = FALSE;
 	}
       else
-	{
-	  layout->one_display_cache = NULL;
-	  gtk_text_layout_free_line_display (layout, display);
-	}
+        display_cache_remove (layout, link);
     }
 }
 
@@ -926,31 +1038,39 @@ gtk_text_layout_real_invalidate_cursors (GtkTextLayout     *layout,
 					 const GtkTextIter *start,
 					 const GtkTextIter *end)
 {
-  /* Check if the range intersects our cached line display,
-   * and invalidate the cached line if so.
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *l, *next;
+
+  if (gtk_text_iter_compare (start, end) > 0)
+    {
+      const GtkTextIter *tmp = start;
+      start = end;
+      end = tmp;
+    }
+
+  /* Check if the range intersects our cached line displays,
+   * and invalidate the cached lines if so.
    */
-  if (layout->one_display_cache)
+  for (l = priv->display_lru.head; l != NULL; l = next)
     {
+      GtkTextLineDisplay *display = l->data;
       GtkTextIter line_start, line_end;
-      GtkTextLine *line = layout->one_display_cache->line;
 
-      gtk_text_layout_get_iter_at_line (layout, &line_start, line, 0);
+      next = l->next;
+
+      if (display_cache_drop_stale (layout, l))
+        continue;
+
+      gtk_text_layout_get_iter_at_line (layout, &line_start, display->line, 0);
 
       line_end = line_start;
       if (!gtk_text_iter_ends_line (&line_end))
 	gtk_text_iter_forward_to_line_end (&line_end);
 
-      if (gtk_text_iter_compare (start, end) > 0)
-	{
-	  const GtkTextIter *tmp = start;
-	  start = end;
-	  end = tmp;
-	}
-
       if (gtk_text_iter_compare (&line_start, end) <= 0 &&
 	  gtk_text_iter_compare (start, &line_end) <= 0)
 	{
-	  gtk_text_layout_invalidate_cache (layout, line, TRUE);
+	  gtk_text_layout_invalidate_cache (layout, display->line, TRUE);
 	}
     }
 
@@ -2247,6 +2367,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
 {
   GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
   GtkTextLineDisplay *display;
+  GList *link;
   GtkTextLineSegment *seg;
   GtkTextIter iter;
   GtkTextAttributes *style;
@@ -2268,30 +2389,39 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   
   g_return_val_if_fail (line != NULL, NULL);
 
-  if (layout->one_display_cache)
+  link = g_hash_table_lookup (priv->display_cache, line);
+  if (link && !display_cache_drop_stale (layout, link))
     {
-      if (line == layout->one_display_cache->line &&
-          (size_only || !layout->one_display_cache->size_only))
+      display = link->data;
+
+      if (size_only || !display->size_only)
 	{
+          priv->display_cache_hits++;
+
 	  if (!size_only)
-            update_text_display_cursors (layout, line, layout->one_display_cache);
-	  return layout->one_display_cache;
+            {
+              g_queue_unlink (&priv->display_lru, link);
+              g_queue_push_head_link (&priv->display_lru, link);
+              update_text_display_cursors (layout, line, display);
+            }
+
+	  return display;
 	}
       else
-        {
-          GtkTextLineDisplay *tmp_display = layout->one_display_cache;
-          layout->one_display_cache = NULL;
-          gtk_text_layout_free_line_display (layout, tmp_display);
-        }
+        display_cache_remove (layout, link);
     }
 
-  DV (g_print ("creating one line display cache (%s)\n", G_STRLOC));
+  priv->display_cache_misses++;
+
+  DV (g_print ("creating line display (%s)\n", G_STRLOC));
 
   display = g_slice_new0 (GtkTextLineDisplay);
 
   display->size_only = size_only;
   display->line = line;
   display->insert_index = -1;
+  display->chars_changed_stamp = _gtk_text_btree_get_chars_changed_stamp (_gtk_text_buffer_get_btree (layout->buffer));
+  display->check_stamp = _gtk_text_line_get_data (line, layout) == NULL;
 
   /* Special-case optimization for completely
    * invisible lines; makes it faster to deal
@@ -2607,7 +2737,7 @@ gtk_text_layout_get_line_display (GtkTextLayout *layout,
   if (tags != NULL)
     g_ptr_array_free (tags, TRUE);
 
-  layout->one_display_cache = display;
+  display_cache_add (layout, display);
 
   if (saw_widget)
     allocate_child_widgets (layout, display);
@@ -2619,19 +2749,15 @@ void
 gtk_text_layout_free_line_display (GtkTextLayout      *layout,
                                    GtkTextLineDisplay *display)
 {
-  if (display != layout->one_display_cache)
-    {
-      if (display->layout)
-        g_object_unref (display->layout);
-
-      if (display->cursors)
-        g_array_free (display->cursors, TRUE);
+  GtkTextLayoutPrivate *priv = GTK_TEXT_LAYOUT_GET_PRIVATE (layout);
+  GList *link;
 
-      if (display->pg_bg_rgba)
-        gdk_rgba_free (display->pg_bg_rgba);
+  /* Cached displays are owned by the cache */
+  link = g_hash_table_lookup (priv->display_cache, display->line);
+  if (link && link->data == display)
+    return;
 
-      g_slice_free (GtkTextLineDisplay, display);
-    }
+  line_display_free (display);
 }
 
 /* Functions to convert iter <=> index for the line of a GtkTextLineDisplay
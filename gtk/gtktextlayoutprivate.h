@@ -138,11 +138,6 @@ struct _GtkTextLayout
    * over long runs with the same style. */
   GtkTextAttributes *one_style_cache;
 
-  /* A cache of one line display. Getting the same line
-   * many times in a row is the most common case.
-   */
-  GtkTextLineDisplay *one_display_cache;
-
   /* Whether we are allowed to wrap right now */
   gint wrap_loop_count;
   
@@ -239,12 +234,18 @@ struct _GtkTextLineDisplay
   gint insert_index;		/* Byte index of insert cursor within para or -1 */
 
   GtkTextLine *line;
+  /* The btree's chars-changed stamp when the display was created */
+  guint chars_changed_stamp;
 
   GdkRectangle block_cursor;
   guint cursors_invalid : 1;
   guint has_block_cursor : 1;
   guint cursor_at_line_end : 1;
   guint size_only : 1;
+  /* Set if @line had no GtkTextLineData, so the layout is not told
+   * when it goes away and @chars_changed_stamp has to be checked.
+   */
+  guint check_stamp : 1;
 
   GdkRGBA *pg_bg_rgba;
 };
@@ -288,6 +288,9 @@ struct _GtkTreeModelFilterPrivate
   guint in_row_deleted       : 1;
   guint virtual_root_deleted : 1;
 
+  /* pending gtk_tree_model_filter_refilter_async() */
+  GTask *refilter_task;
+
   /* signal ids */
   gulong changed_id;
   gulong inserted_id;
@@ -490,6 +493,13 @@ static void         gtk_tree_model_filter_emit_row_inserted_for_path      (GtkTr
                                                                            GtkTreeModel           *c_model,
                                                                            GtkTreePath            *c_path,
                                                                            GtkTreeIter            *c_iter);
+static void         gtk_tree_model_filter_refilter_row_inserted           (GtkTreeModelFilter     *filter,
+                                                                           GtkTreePath            *c_path);
+static void         gtk_tree_model_filter_refilter_row_deleted            (GtkTreeModelFilter     *filter,
+                                                                           GtkTreePath            *c_path);
+static void         gtk_tree_model_filter_refilter_rows_reordered         (GtkTreeModelFilter     *filter,
+                                                                           GtkTreePath            *c_path,
+                                                                           gint                   *new_order);
 
 
 G_DEFINE_TYPE_WITH_CODE (GtkTreeModelFilter, gtk_tree_model_filter, G_TYPE_OBJECT,
@@ -2135,6 +2145,8 @@ gtk_tree_model_filter_row_inserted (GtkTreeModel *c_model,
       free_c_path = TRUE;
     }
 
+  gtk_tree_model_filter_refilter_row_inserted (filter, c_path);
+
   if (c_iter)
     real_c_iter = *c_iter;
   else
@@ -2540,6 +2552,8 @@ gtk_tree_model_filter_row_deleted (GtkTreeModel *c_model,
 
   g_return_if_fail (c_path != NULL);
 
+  gtk_tree_model_filter_refilter_row_deleted (filter, c_path);
+
   /* special case the deletion of an ancestor of the virtual root */
   if (filter->priv->virtual_root &&
       (gtk_tree_path_is_ancestor (c_path, filter->priv->virtual_root) ||
@@ -2724,6 +2738,8 @@ gtk_tree_model_filter_rows_reordered (GtkTreeModel *c_model,
 
   g_return_if_fail (new_order != NULL);
 
+  gtk_tree_model_filter_refilter_rows_reordered (filter, c_path, new_order);
+
   if (c_path == NULL || gtk_tree_path_get_depth (c_path) == 0)
     {
       length = gtk_tree_model_iter_n_children (c_model, NULL);
@@ -4246,6 +4262,659 @@ gtk_tree_model_filter_refilter (GtkTreeModelFilter *filter)
                           filter);
 }
 
+/* Bulk refiltering.
+ *
+ * Instead of pushing every child row through the row-changed handler,
+ * the levels that have been built are walked one by one.  For a chunk
+ * of rows the visibility is evaluated in a single pass, compared to
+ * the current state of the level, and only the differences are
+ * applied: first the rows that became hidden are removed, then the
+ * rows that became visible are inserted.  Rows whose visibility did
+ * not change do not cause any signal emission.
+ *
+ * Levels are identified by their path in child offsets (relative to
+ * the virtual root), so that they can be looked up again between idle
+ * slices.  Structural changes of the child model are applied to the
+ * queued paths and to the offset in the current level, so that the walk
+ * continues where it was; only a reordering of the current level makes
+ * that level start over.
+ */
+
+#define REFILTER_CHUNK_SIZE 256
+#define REFILTER_TIME_MS_PER_IDLE 10
+
+typedef struct
+{
+  GQueue levels;        /* GtkTreePath of the levels still to visit */
+  gint offset;          /* child offset to continue at in the head level */
+  guint serial;         /* incremented when the walk is adjusted */
+  guint source_id;
+} RefilterData;
+
+typedef struct
+{
+  FilterElt *elt;
+  GtkTreeIter c_iter;
+  gint offset;
+} RefilterRow;
+
+static void
+refilter_data_clear_levels (RefilterData *data)
+{
+  GtkTreePath *path;
+
+  while ((path = g_queue_pop_head (&data->levels)))
+    gtk_tree_path_free (path);
+}
+
+static void
+refilter_data_free (gpointer user_data)
+{
+  RefilterData *data = user_data;
+
+  if (data->source_id)
+    g_source_remove (data->source_id);
+
+  refilter_data_clear_levels (data);
+  g_slice_free (RefilterData, data);
+}
+
+/* Returns @c_path relative to the virtual root, or %NULL if it is not
+ * the virtual root or inside of it.
+ */
+static GtkTreePath *
+gtk_tree_model_filter_refilter_path (GtkTreeModelFilter *filter,
+                                     GtkTreePath        *c_path)
+{
+  if (!filter->priv->virtual_root)
+    return gtk_tree_path_copy (c_path);
+
+  if (!gtk_tree_path_compare (c_path, filter->priv->virtual_root))
+    return gtk_tree_path_new ();
+
+  return gtk_tree_model_filter_remove_root (c_path, filter->priv->virtual_root);
+}
+
+static void
+gtk_tree_model_filter_refilter_row_inserted (GtkTreeModelFilter *filter,
+                                             GtkTreePath        *c_path)
+{
+  RefilterData *data;
+  GtkTreePath *path;
+  GList *l;
+  gint depth, index;
+
+  if (!filter->priv->refilter_task)
+    return;
+
+  path = gtk_tree_model_filter_refilter_path (filter, c_path);
+  if (!path || gtk_tree_path_get_depth (path) == 0)
+    {
+      gtk_tree_path_free (path);
+      return;
+    }
+
+  data = g_task_get_task_data (filter->priv->refilter_task);
+  depth = gtk_tree_path_get_depth (path);
+  index = gtk_tree_path_get_indices (path)[depth - 1];
+  gtk_tree_path_up (path);
+
+  for (l = data->levels.head; l; l = l->next)
+    {
+      GtkTreePath *level_path = l->data;
+
+      if (l == data->levels.head &&
+          !gtk_tree_path_compare (level_path, path))
+        {
+          /* The row was inserted into the level being walked */
+          if (index < data->offset)
+            data->offset++;
+        }
+      else if (gtk_tree_path_is_descendant (level_path, path))
+        {
+          gint *indices = gtk_tree_path_get_indices (level_path);
+
+          if (indices[depth - 1] >= index)
+            indices[depth - 1]++;
+        }
+    }
+
+  data->serial++;
+
+  gtk_tree_path_free (path);
+}
+
+static void
+gtk_tree_model_filter_refilter_row_deleted (GtkTreeModelFilter *filter,
+                                            GtkTreePath        *c_path)
+{
+  RefilterData *data;
+  GtkTreePath *path;
+  GList *l, *next;
+  gint depth, index;
+
+  if (!filter->priv->refilter_task)
+    return;
+
+  path = gtk_tree_model_filter_refilter_path (filter, c_path);
+  if (!path || gtk_tree_path_get_depth (path) == 0)
+    {
+      gtk_tree_path_free (path);
+      return;
+    }
+
+  data = g_task_get_task_data (filter->priv->refilter_task);
+  depth = gtk_tree_path_get_depth (path);
+  index = gtk_tree_path_get_indices (path)[depth - 1];
+  gtk_tree_path_up (path);
+
+  for (l = data->levels.head; l; l = next)
+    {
+      GtkTreePath *level_path = l->data;
+
+      next = l->next;
+
+      if (l == data->levels.head &&
+          !gtk_tree_path_compare (level_path, path))
+        {
+          /* The row was deleted from the level being walked */
+          if (index < data->offset)
+            data->offset--;
+        }
+      else if (gtk_tree_path_is_descendant (level_path, path))
+        {
+          gint *indices = gtk_tree_path_get_indices (level_path);
+
+          if (indices[depth - 1] == index)
+            {
+              /* The level was below the deleted row */
+              if (l == data->levels.head)
+                data->offset = 0;
+
+              gtk_tree_path_free (level_path);
+              g_queue_delete_link (&data->levels, l);
+            }
+          else if (indices[depth - 1] > index)
+            indices[depth - 1]--;
+        }
+    }
+
+  data->serial++;
+
+  gtk_tree_path_free (path);
+}
+
+static void
+gtk_tree_model_filter_refilter_rows_reordered (GtkTreeModelFilter *filter,
+                                               GtkTreePath        *c_path,
+                                               gint               *new_order)
+{
+  RefilterData *data;
+  GtkTreePath *path;
+  GtkTreeIter c_iter;
+  GList *l, *next;
+  gint *old_to_new;
+  gint depth, length, i;
+  gboolean restart = FALSE;
+
+  if (!filter->priv->refilter_task)
+    return;
+
+  if (c_path && gtk_tree_path_get_depth (c_path) > 0)
+    {
+      path = gtk_tree_model_filter_refilter_path (filter, c_path);
+      if (!path)
+        return;
+
+      if (!gtk_tree_model_get_iter (filter->priv->child_model, &c_iter, c_path))
+        {
+          gtk_tree_path_free (path);
+          return;
+        }
+
+      length = gtk_tree_model_iter_n_children (filter->priv->child_model, &c_iter);
+    }
+  else
+    {
+      /* The root level is only walked without a virtual root */
+      if (filter->priv->virtual_root)
+        return;
+
+      path = gtk_tree_path_new ();
+      length = gtk_tree_model_iter_n_children (filter->priv->child_model, NULL);
+    }
+
+  data = g_task_get_task_data (filter->priv->refilter_task);
+  depth = gtk_tree_path_get_depth (path);
+
+  old_to_new = g_new (gint, length);
+  for (i = 0; i < length; i++)
+    old_to_new[new_order[i]] = i;
+
+  l = data->levels.head;
+  if (l && !gtk_tree_path_compare (l->data, path))
+    {
+      /* The rows that have been visited in the level being walked are
+       * scattered now, walk it again from the start.
+       */
+      data->offset = 0;
+      restart = TRUE;
+      l = l->next;
+    }
+
+  for (; l; l = next)
+    {
+      GtkTreePath *level_path = l->data;
+
+      next = l->next;
+
+      if (!gtk_tree_path_is_descendant (level_path, path))
+        continue;
+
+      if (restart)
+        {
+          /* Queued again by the new walk of the level */
+          gtk_tree_path_free (level_path);
+          g_queue_delete_link (&data->levels, l);
+        }
+      else
+        {
+          gint *indices = gtk_tree_path_get_indices (level_path);
+
+          if (indices[depth] < length)
+            indices[depth] = old_to_new[indices[depth]];
+        }
+    }
+
+  data->serial++;
+
+  g_free (old_to_new);
+  gtk_tree_path_free (path);
+}
+
+static void
+gtk_tree_model_filter_refilter_show_row (GtkTreeModelFilter *filter,
+                                         FilterLevel        *level,
+                                         RefilterRow        *row)
+{
+  FilterElt *elt = row->elt;
+  GtkTreeIter iter;
+  GtkTreePath *path;
+
+  if (!elt)
+    {
+      gint index;
+
+      elt = gtk_tree_model_filter_insert_elt_in_level (filter, &row->c_iter,
+                                                       level, row->offset,
+                                                       &index);
+    }
+
+  elt->visible_siter = g_sequence_insert_sorted (level->visible_seq, elt,
+                                                 filter_elt_cmp, NULL);
+
+  if (!gtk_tree_model_filter_elt_is_visible_in_target (level, elt))
+    return;
+
+  iter.stamp = filter->priv->stamp;
+  iter.user_data = level;
+  iter.user_data2 = elt;
+
+  path = gtk_tree_model_get_path (GTK_TREE_MODEL (filter), &iter);
+
+  if (!level->parent_level || level->ext_ref_count > 0)
+    gtk_tree_model_row_inserted (GTK_TREE_MODEL (filter), path, &iter);
+
+  if (level->parent_level && level->parent_elt->ext_ref_count > 0 &&
+      g_sequence_get_length (level->visible_seq) == 1)
+    {
+      /* First visible node in this level */
+      iter.user_data = level->parent_level;
+      iter.user_data2 = level->parent_elt;
+
+      gtk_tree_path_up (path);
+      gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (filter),
+                                            path, &iter);
+    }
+
+  gtk_tree_path_free (path);
+
+  if (gtk_tree_model_iter_has_child (filter->priv->child_model, &row->c_iter))
+    gtk_tree_model_filter_update_children (filter, level, elt);
+}
+
+/* Re-evaluates at most REFILTER_CHUNK_SIZE rows of the level at @path,
+ * starting at child offset @start.  Child levels that are encountered
+ * are appended to @levels.  Returns the offset to continue at, or -1
+ * if the level is done.
+ */
+static gint
+gtk_tree_model_filter_refilter_level (GtkTreeModelFilter *filter,
+                                      GtkTreePath        *path,
+                                      gint                start,
+                                      GQueue             *levels)
+{
+  FilterLevel *level;
+  FilterElt *parent_elt = NULL;
+  FilterElt dummy;
+  GSequenceIter *siter;
+  GtkTreeIter c_parent_iter;
+  GtkTreeIter *c_parent = NULL;
+  GtkTreeIter c_iter;
+  GPtrArray *hidden;
+  GArray *shown;
+  gint offset;
+  guint i;
+
+  if (filter->priv->virtual_root_deleted)
+    return -1;
+
+  if (gtk_tree_path_get_depth (path) == 0)
+    {
+      if (!filter->priv->root)
+        {
+          /* Nothing has been exposed yet, build the root level just
+           * like the row-changed handler would.
+           */
+          gtk_tree_model_filter_build_level (filter, NULL, NULL, TRUE);
+          return -1;
+        }
+
+      level = filter->priv->root;
+    }
+  else if (find_elt_with_offset (filter, path, NULL, &parent_elt))
+    level = parent_elt->children;
+  else
+    level = NULL;
+
+  /* The level might have been freed since it was queued */
+  if (!level)
+    return -1;
+
+  if (level->parent_elt)
+    {
+      GtkTreeIter parent_iter;
+
+      parent_iter.stamp = filter->priv->stamp;
+      parent_iter.user_data = level->parent_level;
+      parent_iter.user_data2 = level->parent_elt;
+
+      gtk_tree_model_filter_convert_iter_to_child_iter (filter,
+                                                        &c_parent_iter,
+                                                        &parent_iter);
+      c_parent = &c_parent_iter;
+    }
+  else if (filter->priv->virtual_root)
+    {
+      if (!gtk_tree_model_get_iter (filter->priv->child_model,
+                                    &c_parent_iter,
+                                    filter->priv->virtual_root))
+        return -1;
+
+      c_parent = &c_parent_iter;
+    }
+
+  if (!gtk_tree_model_iter_nth_child (filter->priv->child_model,
+                                      &c_iter, c_parent, start))
+    return -1;
+
+  /* first element with an offset >= start */
+  dummy.offset = start - 1;
+  siter = g_sequence_search (level->seq, &dummy, filter_elt_cmp, NULL);
+
+  hidden = g_ptr_array_new ();
+  shown = g_array_new (FALSE, FALSE, sizeof (RefilterRow));
+
+  offset = start;
+  do
+    {
+      FilterElt *elt = NULL;
+      gboolean current_state;
+      gboolean requested_state;
+
+      if (!g_sequence_iter_is_end (siter) && GET_ELT (siter)->offset == offset)
+        {
+          elt = GET_ELT (siter);
+          siter = g_sequence_iter_next (siter);
+        }
+
+      requested_state = gtk_tree_model_filter_visible (filter, &c_iter);
+      current_state = elt != NULL && elt->visible_siter != NULL;
+
+      if (current_state && !requested_state)
+        {
+          g_ptr_array_add (hidden, elt);
+        }
+      else if (!current_state && requested_state)
+        {
+          RefilterRow row;
+
+          row.elt = elt;
+          row.c_iter = c_iter;
+          row.offset = offset;
+          g_array_append_val (shown, row);
+        }
+
+      if (elt && elt->children)
+        {
+          GtkTreePath *child_path;
+
+          child_path = gtk_tree_path_copy (path);
+          gtk_tree_path_append_index (child_path, offset);
+          g_queue_push_tail (levels, child_path);
+        }
+
+      offset++;
+    }
+  while (gtk_tree_model_iter_next (filter->priv->child_model, &c_iter) &&
+         offset - start < REFILTER_CHUNK_SIZE);
+
+  if (offset - start < REFILTER_CHUNK_SIZE)
+    offset = -1;
+
+  for (i = 0; i < hidden->len; i++)
+    {
+      gtk_tree_model_filter_remove_elt_from_level (filter, level,
+                                                   g_ptr_array_index (hidden, i));
+
+      /* Hiding the last visible node can free a level that is not
+       * being monitored; the remaining rows do not matter then.
+       */
+      if (parent_elt && parent_elt->children != level)
+        {
+          level = NULL;
+          offset = -1;
+          break;
+        }
+    }
+
+  if (level && shown->len > 0)
+    {
+      gtk_tree_model_filter_increment_stamp (filter);
+
+      for (i = 0; i < shown->len; i++)
+        gtk_tree_model_filter_refilter_show_row (filter, level,
+                                                 &g_array_index (shown, RefilterRow, i));
+    }
+
+  g_ptr_array_unref (hidden);
+  g_array_unref (shown);
+
+  return offset;
+}
+
+/* Returns the result of @task, which may call its callback right away.
+ * The callback may start a new refilter, so @task must not be installed
+ * anymore at this point.
+ */
+static void
+gtk_tree_model_filter_refilter_complete (GtkTreeModelFilter *filter,
+                                         GTask              *task,
+                                         GError             *error)
+{
+  RefilterData *data = g_task_get_task_data (task);
+
+  g_assert (filter->priv->refilter_task != task);
+
+  if (data->source_id)
+    {
+      g_source_remove (data->source_id);
+      data->source_id = 0;
+    }
+
+  if (error)
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+
+  g_object_unref (task);
+}
+
+static gboolean
+gtk_tree_model_filter_refilter_idle (gpointer user_data)
+{
+  GtkTreeModelFilter *filter = user_data;
+  GTask *task = filter->priv->refilter_task;
+  RefilterData *data = g_task_get_task_data (task);
+  GError *error = NULL;
+  gint64 end_time;
+
+  end_time = g_get_monotonic_time () + REFILTER_TIME_MS_PER_IDLE * 1000;
+
+  do
+    {
+      GtkTreePath *path;
+      guint serial;
+      gint offset;
+
+      if (g_cancellable_set_error_if_cancelled (g_task_get_cancellable (task),
+                                                &error))
+        break;
+
+      path = g_queue_peek_head (&data->levels);
+      if (!path)
+        break;
+
+      serial = data->serial;
+      g_object_ref (task);
+      offset = gtk_tree_model_filter_refilter_level (filter, path,
+                                                     data->offset,
+                                                     &data->levels);
+
+      /* A signal handler started a new refilter */
+      if (filter->priv->refilter_task != task)
+        {
+          g_object_unref (task);
+          return G_SOURCE_REMOVE;
+        }
+      g_object_unref (task);
+
+      /* A handler changed the child model, the walk was adjusted */
+      if (serial != data->serial)
+        continue;
+
+      if (offset < 0)
+        {
+          gtk_tree_path_free (g_queue_pop_head (&data->levels));
+          data->offset = 0;
+        }
+      else
+        data->offset = offset;
+    }
+  while (g_get_monotonic_time () < end_time);
+
+  if (error || g_queue_is_empty (&data->levels))
+    {
+      data->source_id = 0;
+      filter->priv->refilter_task = NULL;
+      gtk_tree_model_filter_refilter_complete (filter, task, error);
+
+      return G_SOURCE_REMOVE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+/**
+ * gtk_tree_model_filter_refilter_async:
+ * @filter: A #GtkTreeModelFilter.
+ * @cancellable: (nullable): a #GCancellable, or %NULL
+ * @callback: (scope async): callback to call when the refiltering is done
+ * @user_data: (closure): the data to pass to @callback
+ *
+ * Re-evaluates the visibility of all rows, like
+ * gtk_tree_model_filter_refilter(), but spreads the work over several
+ * main loop iterations.
+ *
+ * Unlike gtk_tree_model_filter_refilter(), this function only emits
+ * #GtkTreeModel::row-inserted and #GtkTreeModel::row-deleted (and
+ * #GtkTreeModel::row-has-child-toggled where needed) for rows whose
+ * visibility actually changed. No #GtkTreeModel::row-changed signals
+ * are emitted. The model is consistent between iterations, but rows
+ * that have not been visited yet keep their old visibility.
+ *
+ * If the operation is cancelled, rows that were already visited keep
+ * their new visibility. Starting a new refilter while one is still
+ * running makes the running one finish with %G_IO_ERROR_CANCELLED.
+ */
+void
+gtk_tree_model_filter_refilter_async (GtkTreeModelFilter  *filter,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  GTask *task, *old_task;
+  RefilterData *data;
+
+  g_return_if_fail (GTK_IS_TREE_MODEL_FILTER (filter));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  task = g_task_new (filter, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_tree_model_filter_refilter_async);
+
+  data = g_slice_new0 (RefilterData);
+  g_queue_init (&data->levels);
+  g_queue_push_tail (&data->levels, gtk_tree_path_new ());
+  g_task_set_task_data (task, data, refilter_data_free);
+
+  data->source_id = g_idle_add (gtk_tree_model_filter_refilter_idle, filter);
+  g_source_set_name_by_id (data->source_id, "[gtk+] gtk_tree_model_filter_refilter_idle");
+
+  /* Install the new task before the old one returns, its callback may
+   * start yet another refilter.
+   */
+  old_task = filter->priv->refilter_task;
+  filter->priv->refilter_task = task;
+
+  if (old_task)
+    gtk_tree_model_filter_refilter_complete (filter, old_task,
+                                             g_error_new_literal (G_IO_ERROR,
+                                                                  G_IO_ERROR_CANCELLED,
+                                                                  _("Operation was cancelled")));
+}
+
+/**
+ * gtk_tree_model_filter_refilter_finish:
+ * @filter: A #GtkTreeModelFilter.
+ * @result: a #GAsyncResult
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an operation started with gtk_tree_model_filter_refilter_async().
+ *
+ * Returns: %TRUE if all rows were refiltered, %FALSE if the operation
+ *   was cancelled
+ */
+gboolean
+gtk_tree_model_filter_refilter_finish (GtkTreeModelFilter  *filter,
+                                       GAsyncResult        *result,
+                                       GError             **error)
+{
+  g_return_val_if_fail (GTK_IS_TREE_MODEL_FILTER (filter), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, filter), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
 /**
  * gtk_tree_model_filter_clear_cache:
  * @filter: A #GtkTreeModelFilter.
@@ -149,6 +149,15 @@ GtkTreePath  *gtk_tree_model_filter_convert_path_to_child_path (GtkTreeModelFilt
 GDK_AVAILABLE_IN_ALL
 void          gtk_tree_model_filter_refilter                   (GtkTreeModelFilter           *filter);
 GDK_AVAILABLE_IN_ALL
+void          gtk_tree_model_filter_refilter_async             (GtkTreeModelFilter           *filter,
+                                                                GCancellable                 *cancellable,
+                                                                GAsyncReadyCallback           callback,
+                                                                gpointer                      user_data);
+GDK_AVAILABLE_IN_ALL
+gboolean      gtk_tree_model_filter_refilter_finish            (GtkTreeModelFilter           *filter,
+                                                                GAsyncResult                 *result,
+                                                                GError                      **error);
+GDK_AVAILABLE_IN_ALL
 void          gtk_tree_model_filter_clear_cache                (GtkTreeModelFilter           *filter);
 
 G_END_DECLS
@@ -148,6 +148,9 @@ static gboolean gtk_tree_store_row_drop_possible  (GtkTreeDragDest   *drag_dest,
 /* Sortable Interfaces */
 
 static void     gtk_tree_store_sort                    (GtkTreeStore           *tree_store);
+static void     gtk_tree_store_sort_helper             (GtkTreeStore           *tree_store,
+							GNode                  *parent,
+							gboolean                recurse);
 static void     gtk_tree_store_sort_iter_changed       (GtkTreeStore           *tree_store,
 							GtkTreeIter            *iter,
 							gint                    column,
@@ -1648,6 +1651,106 @@ gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
   validate_tree ((GtkTreeStore *)tree_store);
 }
 
+/**
+ * gtk_tree_store_append_rowsv:
+ * @tree_store: A #GtkTreeStore
+ * @parent: (allow-none): A valid #GtkTreeIter, or %NULL
+ * @n_rows: the number of rows to append
+ * @columns: (array length=n_values): an array of column numbers
+ * @values: (array): an array of @n_rows times @n_values GValues, holding
+ *     the values of the first row, followed by those of the second row,
+ *     and so on
+ * @n_values: the length of the @columns array
+ *
+ * Appends @n_rows rows as children of @parent, or to the top level if
+ * @parent is %NULL, filling in the values for @columns from @values.
+ *
+ * This is the same as calling gtk_tree_store_insert_with_valuesv()
+ * for each row, but does not walk the existing children for every
+ * row, and sorts the level only once after all rows have been added,
+ * emitting a single #GtkTreeModel::rows-reordered.
+ */
+void
+gtk_tree_store_append_rowsv (GtkTreeStore *tree_store,
+                             GtkTreeIter  *parent,
+                             gint          n_rows,
+                             gint         *columns,
+                             GValue       *values,
+                             gint          n_values)
+{
+  GtkTreeStorePrivate *priv;
+  GtkTreePath *path;
+  GNode *parent_node;
+  GNode *last_node;
+  gboolean maybe_need_sort = FALSE;
+  gint i;
+
+  g_return_if_fail (GTK_IS_TREE_STORE (tree_store));
+  g_return_if_fail (n_rows >= 0);
+  g_return_if_fail (n_values == 0 || (columns != NULL && values != NULL));
+
+  priv = tree_store->priv;
+
+  if (parent)
+    g_return_if_fail (VALID_ITER (parent, tree_store));
+
+  if (n_rows == 0)
+    return;
+
+  if (parent)
+    {
+      parent_node = parent->user_data;
+      path = gtk_tree_store_get_path (GTK_TREE_MODEL (tree_store), parent);
+    }
+  else
+    {
+      parent_node = priv->root;
+      path = gtk_tree_path_new ();
+    }
+
+  priv->columns_dirty = TRUE;
+
+  last_node = g_node_last_child (parent_node);
+  gtk_tree_path_append_index (path, g_node_n_children (parent_node));
+
+  for (i = 0; i < n_rows; i++)
+    {
+      GtkTreeIter iter;
+      gboolean changed = FALSE;
+      GNode *new_node;
+
+      new_node = g_node_new (NULL);
+      g_node_insert_after (parent_node, last_node, new_node);
+      last_node = new_node;
+
+      iter.stamp = priv->stamp;
+      iter.user_data = new_node;
+
+      gtk_tree_store_set_vector_internal (tree_store, &iter,
+                                          &changed, &maybe_need_sort,
+                                          columns, values + i * n_values,
+                                          n_values);
+
+      gtk_tree_model_row_inserted (GTK_TREE_MODEL (tree_store), path, &iter);
+
+      if (parent_node != priv->root && new_node->prev == NULL)
+        {
+          gtk_tree_path_up (path);
+          gtk_tree_model_row_has_child_toggled (GTK_TREE_MODEL (tree_store), path, parent);
+          gtk_tree_path_append_index (path, 0);
+        }
+
+      gtk_tree_path_next (path);
+    }
+
+  gtk_tree_path_free (path);
+
+  if (maybe_need_sort && GTK_TREE_STORE_IS_SORTED (tree_store))
+    gtk_tree_store_sort_helper (tree_store, parent_node, FALSE);
+
+  validate_tree (tree_store);
+}
+
 /**
  * gtk_tree_store_prepend:
  * @tree_store: A #GtkTreeStore
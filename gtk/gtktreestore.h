@@ -128,6 +128,13 @@ void          gtk_tree_store_insert_with_valuesv (GtkTreeStore *tree_store,
 						  GValue       *values,
 						  gint          n_values);
 GDK_AVAILABLE_IN_ALL
+void          gtk_tree_store_append_rowsv     (GtkTreeStore *tree_store,
+					       GtkTreeIter  *parent,
+					       gint          n_rows,
+					       gint         *columns,
+					       GValue       *values,
+					       gint          n_values);
+GDK_AVAILABLE_IN_ALL
 void          gtk_tree_store_prepend          (GtkTreeStore *tree_store,
 					       GtkTreeIter  *iter,
 					       GtkTreeIter  *parent);
@@ -60,7 +60,7 @@
 #include "gtkselection.h"
 #include "gtksettingsprivate.h"
 #include "gtksizegroup-private.h"
-#include "gtksnapshot.h"
+#include "gtksnapshotprivate.h"
 #include "gtkstylecontextprivate.h"
 #include "gtktooltipprivate.h"
 #include "gtktypebuiltins.h"
@@ -698,12 +698,15 @@ static gboolean gtk_widget_class_get_visible_by_default (GtkWidgetClass *widget_
 static void gtk_widget_set_clip (GtkWidget *widget, const GtkAllocation *clip);
 static void _gtk_widget_propagate_hierarchy_changed (GtkWidget *widget,
                                                      GtkWidget *previous_toplevel);
+static void gtk_widget_invalidate_render_node (GtkWidget *widget);
 
 
 /* --- variables --- */
 static gint             GtkWidget_private_offset = 0;
 static gpointer         gtk_widget_parent_class = NULL;
 static guint            widget_signals[LAST_SIGNAL] = { 0 };
+static guint            render_node_generation = 0;
+static guint            render_node_debug_flags = 0;
 GtkTextDirection gtk_default_direction = GTK_TEXT_DIR_LTR;
 
 static GQuark		quark_accel_path = 0;
@@ -3016,6 +3019,7 @@ gtk_widget_init (GTypeInstance *instance, gpointer g_class)
   priv->alloc_needed = TRUE;
   priv->alloc_needed_on_child = TRUE;
   priv->focus_on_click = TRUE;
+  priv->draw_needed = TRUE;
 #ifdef G_ENABLE_DEBUG
   priv->highlight_resize = FALSE;
 #endif
@@ -3273,6 +3277,9 @@ gtk_widget_unparent (GtkWidget *widget)
   priv->prev_sibling = NULL;
   priv->next_sibling = NULL;
 
+  if (old_parent)
+    gtk_widget_invalidate_render_node (old_parent);
+
   /* parent may no longer expand if the removed
    * child was expand=TRUE and could therefore
    * be forcing it to.
@@ -3960,6 +3967,10 @@ gtk_widget_unrealize (GtkWidget *widget)
       gtk_widget_set_realized (widget, FALSE);
     }
 
+  /* Cached nodes may reference resources of the old renderer */
+  g_clear_pointer (&widget->priv->render_node, gsk_render_node_unref);
+  widget->priv->draw_needed = TRUE;
+
   gtk_widget_pop_verify_invariants (widget);
   g_object_unref (widget);
 }
@@ -4049,6 +4060,8 @@ gtk_widget_queue_draw (GtkWidget *widget)
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  gtk_widget_invalidate_render_node (widget);
+
   parent = _gtk_widget_get_parent (widget);
   rect = &widget->priv->clip;
 
@@ -4298,6 +4311,8 @@ gtk_widget_queue_draw_region (GtkWidget            *widget,
   if (cairo_region_is_empty (region))
     return;
 
+  gtk_widget_invalidate_render_node (widget);
+
   /* Just return if the widget isn't mapped */
   if (!_gtk_widget_get_mapped (widget))
     return;
@@ -4617,6 +4632,9 @@ gtk_widget_size_allocate (GtkWidget           *widget,
   gtk_widget_set_clip (widget, &priv->reported_clip);
   *out_clip = priv->clip;
 
+  /* The size_allocate vfunc may have moved children around */
+  gtk_widget_invalidate_render_node (widget);
+
   gtk_widget_ensure_resize (widget);
   priv->alloc_needed = FALSE;
   priv->alloc_needed_on_child = FALSE;
@@ -4627,6 +4645,11 @@ check_clip:
   position_changed |= (old_clip.x != priv->clip.x ||
                       old_clip.y != priv->clip.y);
 
+  if (size_changed || baseline_changed)
+    gtk_widget_invalidate_render_node (widget);
+  else if (position_changed && priv->parent)
+    gtk_widget_invalidate_render_node (priv->parent);
+
   if (_gtk_widget_get_mapped (widget))
     {
       if (position_changed || size_changed || baseline_changed)
@@ -7313,6 +7336,8 @@ gtk_widget_reposition_after (GtkWidget *widget,
         parent->priv->last_child = widget;
     }
 
+  gtk_widget_invalidate_render_node (parent);
+
   parent_flags = _gtk_widget_get_state_flags (parent);
 
   /* Merge both old state and current parent state,
@@ -9095,6 +9120,8 @@ gtk_widget_finalize (GObject *object)
 
   g_clear_object (&priv->context);
 
+  g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+
   _gtk_size_request_cache_free (&priv->requests);
 
   for (l = priv->event_controllers; l; l = l->next)
@@ -13826,12 +13853,12 @@ gtk_widget_maybe_add_debug_render_nodes (GtkWidget             *widget,
 #endif
 }
 
-void
-gtk_widget_snapshot (GtkWidget   *widget,
-                     GtkSnapshot *snapshot)
+static void
+gtk_widget_do_snapshot (GtkWidget   *widget,
+                        GtkSnapshot *snapshot)
 {
   GtkWidgetClass *klass = GTK_WIDGET_GET_CLASS (widget);
-  GtkWidgetPrivate *priv;
+  GtkWidgetPrivate *priv = widget->priv;
   GtkCssValue *filter_value;
   RenderMode mode;
   double opacity;
@@ -13840,26 +13867,11 @@ gtk_widget_snapshot (GtkWidget   *widget,
   GtkAllocation allocation;
   GtkBorder margin, border, padding;
 
-  if (!_gtk_widget_is_drawable (widget))
-    return;
-
-  if (_gtk_widget_get_alloc_needed (widget))
-    {
-      g_warning ("Trying to snapshot %s %p without a current allocation", G_OBJECT_TYPE_NAME (widget), widget);
-      return;
-    }
-
-  priv = widget->priv;
   offset_clip = priv->clip;
   offset_clip.x -= priv->allocation.x;
   offset_clip.y -= priv->allocation.y;
 
-  if (gtk_snapshot_clips_rect (snapshot, &offset_clip))
-    return;
-
-  opacity = widget->priv->alpha / 255.0;
-  if (opacity <= 0.0)
-    return;
+  opacity = priv->alpha / 255.0;
 
   /* Compatibility mode: if the widget does not have a render node, we draw
    * using gtk_widget_draw() on a temporary node
@@ -13966,6 +13978,93 @@ gtk_widget_snapshot (GtkWidget   *widget,
     gtk_snapshot_pop (snapshot);
 }
 
+void
+gtk_widget_snapshot (GtkWidget   *widget,
+                     GtkSnapshot *snapshot)
+{
+  GtkWidgetPrivate *priv;
+  cairo_rectangle_int_t offset_clip;
+  gboolean record_names;
+
+  if (!_gtk_widget_is_drawable (widget))
+    return;
+
+  if (_gtk_widget_get_alloc_needed (widget))
+    {
+      g_warning ("Trying to snapshot %s %p without a current allocation", G_OBJECT_TYPE_NAME (widget), widget);
+      return;
+    }
+
+  priv = widget->priv;
+  offset_clip = priv->clip;
+  offset_clip.x -= priv->allocation.x;
+  offset_clip.y -= priv->allocation.y;
+
+  if (gtk_snapshot_clips_rect (snapshot, &offset_clip))
+    return;
+
+  if (priv->alpha == 0)
+    return;
+
+  if (GTK_DEBUG_CHECK (NO_RENDER_CACHE))
+    {
+      g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+      gtk_widget_do_snapshot (widget, snapshot);
+      return;
+    }
+
+  record_names = gtk_snapshot_get_record_names (snapshot);
+
+  /* The cached node is recorded without a clip and relative to the
+   * widget's origin, so it can be reused no matter which part of the
+   * window gets redrawn, and whereever the parent places us.
+   */
+  if (priv->draw_needed ||
+      priv->render_node == NULL ||
+      priv->render_node_record_names != record_names ||
+      priv->render_node_generation != render_node_generation)
+    {
+      GskRenderNode *node;
+
+      /* Clear this first, so that draws queued while snapshotting
+       * are not lost.
+       */
+      priv->draw_needed = FALSE;
+
+      gtk_snapshot_push (snapshot, FALSE, "%s<%p>", gtk_widget_get_name (widget), widget);
+      gtk_widget_do_snapshot (widget, snapshot);
+      node = gtk_snapshot_pop_collect (snapshot);
+
+      g_clear_pointer (&priv->render_node, gsk_render_node_unref);
+      priv->render_node = node;
+      priv->render_node_record_names = record_names;
+      priv->render_node_generation = render_node_generation;
+    }
+
+  if (priv->render_node)
+    gtk_snapshot_append_node_at_offset (snapshot, priv->render_node);
+}
+
+/*
+ * gtk_widget_invalidate_render_node:
+ * @widget: a #GtkWidget
+ *
+ * Drops the render node cached by @widget and by all its ancestors,
+ * whose nodes contain the one of @widget.
+ */
+static void
+gtk_widget_invalidate_render_node (GtkWidget *widget)
+{
+  /* If a widget needs a redraw, all its ancestors do as well,
+   * so we can stop walking up once we find one.
+   */
+  while (widget != NULL && !widget->priv->draw_needed)
+    {
+      widget->priv->draw_needed = TRUE;
+      widget = widget->priv->parent;
+    }
+}
+
 static gboolean
 should_record_names (GtkWidget   *widget,
                      GskRenderer *renderer)
@@ -13983,7 +14082,8 @@ gtk_widget_render (GtkWidget            *widget,
   GtkSnapshot *snapshot;
   GskRenderer *renderer;
   GskRenderNode *root;
-  cairo_region_t *clip;
+  cairo_region_t *damage;
+  guint debug_flags;
 
   /* We only render double buffered on native windows */
   if (!gdk_window_has_native (window))
@@ -13993,22 +14093,48 @@ gtk_widget_render (GtkWidget            *widget,
   if (renderer == NULL)
     return;
 
-  context = gsk_renderer_begin_draw_frame (renderer, region);
-  clip = gdk_drawing_context_get_clip (context);
+  debug_flags = gtk_get_display_debug_flags (gtk_widget_get_display (widget));
+  if (debug_flags != render_node_debug_flags)
+    {
+      /* Debug flags change the contents of render nodes, so throw
+       * away all cached nodes when they change.
+       */
+      render_node_debug_flags = debug_flags;
+      render_node_generation++;
+    }
 
+  /* We snapshot the whole widget without a clip, so that the renderer
+   * can compare the result to the previous frame and only redraw what
+   * actually changed. Most of the tree comes from the widgets' render
+   * node caches anyway.
+   */
   snapshot = gtk_snapshot_new (renderer,
                                should_record_names (widget, renderer),
-                               clip,
+                               NULL,
                                "Render<%s>", G_OBJECT_TYPE_NAME (widget));
-  cairo_region_destroy (clip);
   gtk_widget_snapshot (widget, snapshot);
   root = gtk_snapshot_free_to_node (snapshot);
+
+  if (root != NULL)
+    damage = gsk_renderer_compute_damage (renderer, root, region);
+  else
+    damage = cairo_region_copy (region);
+
+  if (cairo_region_is_empty (damage))
+    {
+      g_clear_pointer (&root, gsk_render_node_unref);
+      cairo_region_destroy (damage);
+      return;
+    }
+
+  context = gsk_renderer_begin_draw_frame (renderer, damage);
+
   if (root != NULL)
     {
       gtk_inspector_record_render (widget,
                                    renderer,
                                    window,
-                                   region,
+                                   damage,
                                    context,
                                    root);
 
@@ -14016,8 +14142,8 @@ gtk_widget_render (GtkWidget            *widget,
       gsk_render_node_unref (root);
     }
 
-
   gsk_renderer_end_draw_frame (renderer, context);
+  cairo_region_destroy (damage);
 }
 
 /**
@@ -72,6 +72,10 @@ struct _GtkWidgetPrivate
   guint has_shape_mask        : 1;
   guint pass_through          : 1;
 
+  /* Render node caching */
+  guint draw_needed               : 1; /* the cached render_node is outdated */
+  guint render_node_record_names  : 1; /* render_node was recorded with node names */
+
   /* Queue-resize related flags */
   guint resize_needed         : 1; /* queue_resize() has been called but no get_preferred_size() yet */
   guint alloc_needed          : 1; /* this widget needs a size_allocate() call */
@@ -165,6 +169,12 @@ struct _GtkWidgetPrivate
 
   /* Pointer cursor */
   GdkCursor *cursor;
+
+  /* The render node created by the last snapshot, relative to
+   * the widget's allocation and without any clip applied.
+   */
+  GskRenderNode *render_node;
+  guint render_node_generation;
 };
 
 GtkCssNode *  gtk_widget_get_css_node       (GtkWidget *widget);
@@ -2,53 +2,103 @@
 
 #include <gsk/gskcairoblurprivate.h>
 
+static int size = 2000;
+static int runs = 3;
+static int max_radius = 16;
+static gboolean only_a8 = FALSE;
+static gboolean only_argb32 = FALSE;
+
+static GOptionEntry options[] = {
+  { "size", 's', 0, G_OPTION_ARG_INT, &size, "Width and height of the surface", "PIXELS" },
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Number of timed runs per radius", "COUNT" },
+  { "max-radius", 'm', 0, G_OPTION_ARG_INT, &max_radius, "Largest radius to test", "RADIUS" },
+  { "a8", 0, 0, G_OPTION_ARG_NONE, &only_a8, "Only test A8 surfaces", NULL },
+  { "argb32", 0, 0, G_OPTION_ARG_NONE, &only_argb32, "Only test ARGB32 surfaces", NULL },
+  { NULL }
+};
+
 static void
 init_surface (cairo_t *cr)
 {
   int w = cairo_image_surface_get_width (cairo_get_target (cr));
   int h = cairo_image_surface_get_height (cairo_get_target (cr));
 
-  cairo_set_source_rgb (cr, 0, 0, 0);
-  cairo_fill (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_rgba (cr, 0, 0, 0, 0);
+  cairo_paint (cr);
 
-  cairo_set_source_rgb (cr, 1, 1, 1);
+  cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+  cairo_set_source_rgba (cr, 1, 0.5, 0.25, 1);
   cairo_arc (cr, w/2, h/2, w/2, 0, 2*G_PI);
   cairo_fill (cr);
 }
 
-int
-main (int argc, char **argv)
+static void
+run_benchmark (cairo_format_t  format,
+               const char     *name)
 {
   cairo_surface_t *surface;
   cairo_t *cr;
   GTimer *timer;
-  double msec;
+  double msec, best;
   int i, j;
-  int size;
 
+  surface = cairo_image_surface_create (format, size, size);
+  cr = cairo_create (surface);
   timer = g_timer_new ();
 
-  size = 2000;
+  g_print ("%s, %dx%d, best of %d runs:\n", name, size, size, runs);
 
-  surface = cairo_image_surface_create (CAIRO_FORMAT_A8, size, size);
+  for (i = 2; i <= max_radius; i++)
+    {
+      /* One untimed run to warm up caches and the thread pool */
+      init_surface (cr);
+      gsk_cairo_blur_surface (surface, i, GSK_BLUR_X | GSK_BLUR_Y);
 
-  cr = cairo_create (surface);
+      best = G_MAXDOUBLE;
+      for (j = 0; j < runs; j++)
+        {
+          init_surface (cr);
+          g_timer_start (timer);
+          gsk_cairo_blur_surface (surface, i, GSK_BLUR_X | GSK_BLUR_Y);
+          msec = g_timer_elapsed (timer, NULL) * 1000;
+          best = MIN (best, msec);
+        }
 
-  /* We do everything three times, first two as warmup */
-  for (j = 0; j < 2; j++)
-    {
-      for (i = 1; i < 16; i++)
-	{
-	  init_surface (cr);
-	  g_timer_start (timer);
-	  gsk_cairo_blur_surface (surface, i, GSK_BLUR_X | GSK_BLUR_Y);
-	  msec = g_timer_elapsed (timer, NULL) * 1000;
-	  if (j == 1)
-	    g_print ("Radius %2d: %.2f msec, %.2f kpixels/msec:\n", i, msec, size*size/(msec*1000));
-	}
+      g_print ("  Radius %2d: %8.2f msec, %8.2f kpixels/msec\n",
+               i, best, (double) size * size / (best * 1000));
     }
 
   g_timer_destroy (timer);
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+
+  context = g_option_context_new ("- benchmark the cairo blur");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (size <= 0 || runs <= 0)
+    {
+      g_printerr ("Size and number of runs must be positive\n");
+      return 1;
+    }
+
+  if (!only_argb32)
+    run_benchmark (CAIRO_FORMAT_A8, "A8");
+  if (!only_a8)
+    run_benchmark (CAIRO_FORMAT_ARGB32, "ARGB32");
 
   return 0;
 }
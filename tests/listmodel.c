@@ -1,4 +1,5 @@
 #include <gtk/gtk.h>
+#include <stdlib.h>
 
 enum
 {
@@ -114,6 +115,22 @@ create_widget (gpointer item,
   return label;
 }
 
+static GtkWidget *
+create_row (gpointer user_data)
+{
+  return gtk_label_new ("");
+}
+
+static void
+bind_row (GtkWidget *widget,
+          gpointer   item,
+          gpointer   user_data)
+{
+  MyObject *obj = (MyObject *)item;
+
+  gtk_label_set_label (GTK_LABEL (widget), obj->label);
+}
+
 static gint
 compare_items (gconstpointer a, gconstpointer b, gpointer data)
 {
@@ -169,12 +186,15 @@ main (int argc, char *argv[])
 {
   GtkWidget *window, *grid, *sw, *box, *button;
   GListStore *store;
-  gint i;
+  gint i, n_items;
 
   gtk_init ();
 
+  /* Pass a large item count to compare how the widgets scale */
+  n_items = argc > 1 ? atoi (argv[1]) : 100;
+
   store = g_list_store_new (my_object_get_type ());
-  for (i = 0; i < 100; i++)
+  for (i = 0; i < n_items; i++)
     {
       MyObject *obj;
       gchar *label;
@@ -216,6 +236,18 @@ main (int argc, char *argv[])
   gtk_flow_box_bind_model (GTK_FLOW_BOX (box), G_LIST_MODEL (store), create_widget, NULL, NULL);
   gtk_container_add (GTK_CONTAINER (sw), box);
 
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_scrolled_window_set_policy (GTK_SCROLLED_WINDOW (sw),
+                                  GTK_POLICY_NEVER,
+                                  GTK_POLICY_AUTOMATIC);
+  gtk_widget_set_hexpand (sw, TRUE);
+  gtk_widget_set_vexpand (sw, TRUE);
+  gtk_grid_attach (GTK_GRID (grid), sw, 2, 0, 1, 1);
+
+  box = gtk_list_view_new ();
+  gtk_list_view_bind_model (GTK_LIST_VIEW (box), G_LIST_MODEL (store), create_row, bind_row, NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (sw), box);
+
   button = gtk_button_new_with_label ("Add some");
   g_signal_connect (button, "clicked", G_CALLBACK (add_some), store);
   gtk_grid_attach (GTK_GRID (grid), button, 0, 1, 1, 1);
@@ -2,8 +2,36 @@
 #include <math.h>
 
 GtkAdjustment *adjustment;
+GtkWidget *stats_label;
 int cursor_x, cursor_y;
 
+/* Counters for the current one second interval */
+static guint n_events;
+static guint n_positions;
+static guint max_history;
+static gint64 dispatch_time;
+
+static gboolean
+update_stats (gpointer data)
+{
+  char *text;
+
+  text = g_strdup_printf ("%u events, %u positions, longest history %u, %.2f µs/event",
+                          n_events, n_positions, max_history,
+                          n_events ? (double) dispatch_time / n_events : 0.0);
+  gtk_label_set_label (GTK_LABEL (stats_label), text);
+  if (n_events)
+    g_print ("%s\n", text);
+  g_free (text);
+
+  n_events = 0;
+  n_positions = 0;
+  max_history = 0;
+  dispatch_time = 0;
+
+  return G_SOURCE_CONTINUE;
+}
+
 static gboolean
 event_cb (GtkWidget *window,
           GdkEvent  *event)
@@ -13,6 +41,23 @@ event_cb (GtkWidget *window,
     {
       gdouble x, y;
       float processing_ms = gtk_adjustment_get_value (adjustment);
+      GList *history;
+      gint64 start;
+      guint len;
+
+      /* Time how long it takes to get at the coalesced positions,
+       * before the simulated processing time kicks in.
+       */
+      start = g_get_monotonic_time ();
+      history = gdk_event_get_motion_history (event);
+      len = g_list_length (history);
+      g_list_free (history);
+      dispatch_time += g_get_monotonic_time () - start;
+
+      n_events++;
+      n_positions += len + 1;
+      max_history = MAX (max_history, len);
+
       g_usleep (processing_ms * 1000);
 
       gdk_event_get_coords ((GdkEvent *)event, &x, &y);
@@ -65,6 +110,10 @@ main (int argc, char **argv)
   gtk_widget_set_halign (label, GTK_ALIGN_CENTER);
   gtk_box_pack_end (GTK_BOX (vbox), label);
 
+  stats_label = gtk_label_new ("");
+  gtk_box_pack_end (GTK_BOX (vbox), stats_label);
+  g_timeout_add_seconds (1, update_stats, NULL);
+
   da = gtk_drawing_area_new ();
   gtk_drawing_area_set_draw_func (GTK_DRAWING_AREA (da), on_draw, NULL, NULL);
   gtk_widget_set_vexpand (da, TRUE);
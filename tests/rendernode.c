@@ -1,14 +1,17 @@
 #include <gtk/gtk.h>
+#include <string.h>
 
 static gboolean benchmark = FALSE;
 static gboolean dump_variant = FALSE;
 static gboolean fallback = FALSE;
+static gboolean compare_formats = FALSE;
 static int runs = 1;
 
 static GOptionEntry options[] = {
   { "benchmark", 'b', 0, G_OPTION_ARG_NONE, &benchmark, "Time operations", NULL },
   { "dump-variant", 'd', 0, G_OPTION_ARG_NONE, &dump_variant, "Dump GVariant structure", NULL },
   { "fallback", '\0', 0, G_OPTION_ARG_NONE, &fallback, "Draw node without a renderer", NULL },
+  { "compare-formats", 'c', 0, G_OPTION_ARG_NONE, &compare_formats, "Time saving and loading the node in the current format", NULL },
   { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Render the test N times", "N" },
   { NULL }
 };
@@ -41,7 +44,7 @@ main(int argc, char **argv)
       g_printerr ("Number of runs given with -r/--runs must be at least 1 and not %d.\n", runs);
       return 1;
     }
-  if (!(argc == 3 || (argc == 2 && (dump_variant || benchmark))))
+  if (!(argc == 3 || (argc == 2 && (dump_variant || benchmark || compare_formats))))
     {
       g_printerr ("Usage: %s [OPTIONS] NODE-FILE PNG-FILE\n", argv[0]);
       return 1;
@@ -54,7 +57,11 @@ main(int argc, char **argv)
     }
 
   bytes = g_bytes_new_take (contents, len);
-  if (dump_variant)
+  if (dump_variant && len >= 8 && memcmp (contents, "GSKNODE", 8) == 0)
+    {
+      g_printerr ("Node file is not in the GVariant format.\n");
+    }
+  else if (dump_variant)
     {
       GVariant *variant = g_variant_new_from_bytes (G_VARIANT_TYPE ("(suuv)"), bytes, FALSE);
       char *s;
@@ -83,6 +90,43 @@ main(int argc, char **argv)
       return 1;
     }
 
+  if (compare_formats)
+    {
+      GskRenderNode *loaded;
+      char *bytes_string;
+
+      /* If the file was written by an older version, the load above went
+       * through the GVariant code, so this compares both formats. */
+      start = g_get_monotonic_time ();
+      bytes = gsk_render_node_serialize (node);
+      end = g_get_monotonic_time ();
+      bytes_string = g_format_size (g_bytes_get_size (bytes));
+      g_print ("Saved %s in %.4gs\n", bytes_string, (double) (end - start) / G_USEC_PER_SEC);
+
+      for (run = 0; run < runs; run++)
+        {
+          start = g_get_monotonic_time ();
+          loaded = gsk_render_node_deserialize (bytes, &error);
+          end = g_get_monotonic_time ();
+          if (loaded == NULL)
+            {
+              g_printerr ("Could not load saved node: %s\n", error->message);
+              return 1;
+            }
+          g_print ("Run %d: Loaded %s in %.4gs\n", run, bytes_string, (double) (end - start) / G_USEC_PER_SEC);
+          gsk_render_node_unref (loaded);
+        }
+
+      g_free (bytes_string);
+      g_bytes_unref (bytes);
+
+      if (argc == 2 && !benchmark)
+        {
+          gsk_render_node_unref (node);
+          return 0;
+        }
+    }
+
   if (fallback)
     {
       graphene_rect_t bounds;
@@ -0,0 +1,112 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+static int n_lines = 200000;
+static int runs = 3;
+
+static GOptionEntry options[] = {
+  { "lines", 'l', 0, G_OPTION_ARG_INT, &n_lines, "Number of lines in the buffer", "COUNT" },
+  { "runs", 'r', 0, G_OPTION_ARG_INT, &runs, "Number of timed runs per search", "COUNT" },
+  { NULL }
+};
+
+static GtkTextBuffer *
+create_buffer (void)
+{
+  GtkTextBuffer *buffer;
+  GString *str;
+  int i;
+
+  str = g_string_new (NULL);
+  for (i = 0; i < n_lines; i++)
+    {
+      if (i % 10 == 7)
+        g_string_append_printf (str, "2017-08-01 12:%02d:%02d Übergröße für Datei %d überschritten\n", i / 60 % 60, i % 60, i);
+      else
+        g_string_append_printf (str, "2017-08-01 12:%02d:%02d INFO worker %d processed request %d in %d ms\n", i / 60 % 60, i % 60, i % 8, i, i % 997);
+    }
+  g_string_append (str, "2017-08-01 13:00:00 ERROR Needle In The Haystack\n");
+
+  buffer = gtk_text_buffer_new (NULL);
+  gtk_text_buffer_set_text (buffer, str->str, str->len);
+  g_string_free (str, TRUE);
+
+  return buffer;
+}
+
+static void
+run_search (GtkTextBuffer      *buffer,
+            const char         *needle,
+            GtkTextSearchFlags  flags,
+            gboolean            backward,
+            const char         *name)
+{
+  GtkTextIter iter, match_start, match_end;
+  GTimer *timer;
+  double msec, best;
+  gboolean found = FALSE;
+  int i;
+
+  timer = g_timer_new ();
+  best = G_MAXDOUBLE;
+
+  for (i = 0; i < runs; i++)
+    {
+      if (backward)
+        gtk_text_buffer_get_end_iter (buffer, &iter);
+      else
+        gtk_text_buffer_get_start_iter (buffer, &iter);
+
+      g_timer_start (timer);
+      if (backward)
+        found = gtk_text_iter_backward_search (&iter, needle, flags, &match_start, &match_end, NULL);
+      else
+        found = gtk_text_iter_forward_search (&iter, needle, flags, &match_start, &match_end, NULL);
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+      best = MIN (best, msec);
+    }
+
+  g_print ("  %-40s %10.2f msec%s\n", name, best, found ? "" : " (not found)");
+
+  g_timer_destroy (timer);
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GtkTextBuffer *buffer;
+
+  context = g_option_context_new ("- benchmark text iter searching");
+  g_option_context_add_main_entries (context, options, NULL);
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  if (n_lines <= 0 || runs <= 0)
+    {
+      g_printerr ("Number of lines and runs must be positive\n");
+      return 1;
+    }
+
+  gtk_init ();
+
+  buffer = create_buffer ();
+
+  g_print ("%d lines, best of %d runs:\n", n_lines, runs);
+
+  run_search (buffer, "Needle In", 0, FALSE, "forward");
+  run_search (buffer, "needle in", GTK_TEXT_SEARCH_CASE_INSENSITIVE, FALSE, "forward, case insensitive");
+  run_search (buffer, "ÜBERSCHRITTEN\n2017-08-01 13", GTK_TEXT_SEARCH_CASE_INSENSITIVE, FALSE, "forward, multi-line, case insensitive");
+  run_search (buffer, "2017-08-01 12:00:00 INFO worker 0", 0, TRUE, "backward");
+  run_search (buffer, "2017-08-01 12:00:00 info worker 0", GTK_TEXT_SEARCH_CASE_INSENSITIVE, TRUE, "backward, case insensitive");
+
+  g_object_unref (buffer);
+
+  return 0;
+}
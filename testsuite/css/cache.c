@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2018 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+/* Themes loaded by name are cached in $XDG_CACHE_HOME/gtk-4.0/css.
+ * GTK only loads a theme once per process, so every load that is
+ * checked here happens in a subprocess, and the parent inspects the
+ * cache file in between.
+ */
+
+static const char round_trip_css[] =
+  "@define-color accent #3584e4;\n"
+  "@define-color accent_shade shade(@accent, 0.8);\n"
+  "\n"
+  "@keyframes spin {\n"
+  "  from { -gtk-icon-transform: rotate(0deg); }\n"
+  "  to { -gtk-icon-transform: rotate(1turn); }\n"
+  "}\n"
+  "\n"
+  "@keyframes pulse {\n"
+  "  0% { opacity: 1; color: @accent; }\n"
+  "  50% { opacity: 0.5; }\n"
+  "  100% { opacity: 1; color: @accent_shade; }\n"
+  "}\n"
+  "\n"
+  "* {\n"
+  "  transition: all 200ms ease-in-out;\n"
+  "}\n"
+  "\n"
+  "button {\n"
+  "  color: @accent;\n"
+  "  background-image: linear-gradient(to bottom, alpha(@accent, 0.5), mix(red, blue, 0.3));\n"
+  "  border-radius: 3px 4px;\n"
+  "  box-shadow: inset 0 1px rgba(255, 255, 255, 0.1), 0 0 2px black;\n"
+  "  padding: 2px 4px;\n"
+  "}\n"
+  "\n"
+  "button:hover > label.title,\n"
+  "entry#main:not(:disabled) {\n"
+  "  background-image: radial-gradient(circle at 50% 50%, red, blue 80%);\n"
+  "  font-feature-settings: \"liga\" 0, \"tnum\";\n"
+  "  font-family: \"Cantarell\", sans-serif;\n"
+  "  font-weight: bold;\n"
+  "}\n"
+  "\n"
+  ".spinner:checked {\n"
+  "  animation: spin 1s linear infinite, pulse 2s ease-in 3;\n"
+  "  -gtk-icon-source: -gtk-icontheme(\"process-working-symbolic\");\n"
+  "  -gtk-icon-palette: success #4e9a06, error @accent;\n"
+  "}\n"
+  "\n"
+  "row:nth-child(2n+1) ~ row + row:backdrop {\n"
+  "  margin: calc(1px + 2em);\n"
+  "  opacity: 0.5;\n"
+  "  filter: blur(2px) opacity(50%);\n"
+  "  text-decoration: underline wavy @accent;\n"
+  "  font-variant-ligatures: no-common-ligatures;\n"
+  "  -gtk-icon-transform: scale(2) translate(1px, 2px);\n"
+  "  background: image(-gtk-icontheme(\"missing-symbolic\"), cross-fade(25% -gtk-icontheme(\"a\"), linear-gradient(45deg, red, blue)), @accent_shade) center / cover no-repeat;\n"
+  "  border-image: -gtk-scaled(-gtk-icontheme(\"b\"), linear-gradient(yellow, blue)) 4 stretch;\n"
+  "}\n";
+
+static char *
+get_theme_path (const char *name)
+{
+  return g_build_filename (g_get_user_data_dir (), "themes", name, "gtk-4.0", "gtk.css", NULL);
+}
+
+static char *
+get_cache_path (const char *name)
+{
+  char *path, *uri, *checksum, *basename, *cache;
+  GFile *file;
+
+  /* must match gtk_css_provider_get_cache_filename() */
+  path = get_theme_path (name);
+  file = g_file_new_for_path (path);
+  uri = g_file_get_uri (file);
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, uri, -1);
+  basename = g_strconcat (checksum, ".cache", NULL);
+  cache = g_build_filename (g_get_user_cache_dir (), "gtk-4.0", "css", basename, NULL);
+
+  g_free (basename);
+  g_free (checksum);
+  g_free (uri);
+  g_object_unref (file);
+  g_free (path);
+
+  return cache;
+}
+
+static void
+write_theme (const char *name,
+             const char *css)
+{
+  GError *error = NULL;
+  char *path, *dir;
+
+  path = get_theme_path (name);
+  dir = g_path_get_dirname (path);
+  g_assert_cmpint (g_mkdir_with_parents (dir, 0755), ==, 0);
+  g_file_set_contents (path, css, -1, &error);
+  g_assert_no_error (error);
+
+  g_free (dir);
+  g_free (path);
+}
+
+/* Parses the theme file directly, never going through the cache */
+static char *
+parse_theme (const char *name)
+{
+  GtkCssProvider *provider;
+  char *path, *result;
+
+  path = get_theme_path (name);
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_path (provider, path);
+  result = gtk_css_provider_to_string (provider);
+
+  g_object_unref (provider);
+  g_free (path);
+
+  return result;
+}
+
+static gboolean
+cache_exists (const char *name)
+{
+  char *cache;
+  gboolean result;
+
+  cache = get_cache_path (name);
+  result = g_file_test (cache, G_FILE_TEST_EXISTS);
+  g_free (cache);
+
+  return result;
+}
+
+static void
+test_print_named_subprocess (gconstpointer name)
+{
+  GtkCssProvider *provider;
+  char *s;
+
+  provider = gtk_css_provider_get_named (name, NULL);
+  s = gtk_css_provider_to_string (provider);
+  g_print ("%s", s);
+  g_free (s);
+}
+
+/* Loads the named theme in a fresh process and checks what it printed */
+static void
+assert_named_theme (const char *subprocess,
+                    const char *expected)
+{
+  g_test_trap_subprocess (subprocess, 0, 0);
+  g_test_trap_assert_passed ();
+  g_test_trap_assert_stdout (expected);
+}
+
+static void
+test_round_trip (void)
+{
+  char *expected;
+
+  write_theme ("cache-round-trip", round_trip_css);
+  expected = parse_theme ("cache-round-trip");
+  g_assert_false (cache_exists ("cache-round-trip"));
+
+  /* parses the theme and writes the cache */
+  assert_named_theme ("/css/cache/round-trip/subprocess", expected);
+  g_assert_true (cache_exists ("cache-round-trip"));
+
+  /* loads the theme from the cache */
+  assert_named_theme ("/css/cache/round-trip/subprocess", expected);
+
+  g_free (expected);
+}
+
+static void
+test_unchanged (void)
+{
+  GError *error = NULL;
+  GFileInfo *info;
+  GFile *file;
+  char *path, *expected;
+
+  write_theme ("cache-unchanged", "a { color: red; }");
+  expected = parse_theme ("cache-unchanged");
+  assert_named_theme ("/css/cache/unchanged/subprocess", expected);
+  g_assert_true (cache_exists ("cache-unchanged"));
+
+  /* Same size and modification time, so the cache is trusted without
+   * looking at the contents. */
+  path = get_theme_path ("cache-unchanged");
+  file = g_file_new_for_path (path);
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_TIME_MODIFIED "," G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL,
+                            &error);
+  g_assert_no_error (error);
+  write_theme ("cache-unchanged", "a { color: tan; }");
+  g_file_set_attributes_from_info (file, info, G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+
+  assert_named_theme ("/css/cache/unchanged/subprocess", expected);
+
+  g_object_unref (info);
+  g_object_unref (file);
+  g_free (path);
+  g_free (expected);
+}
+
+static void
+test_stale (void)
+{
+  char *expected;
+
+  write_theme ("cache-stale", "a { color: red; }");
+  expected = parse_theme ("cache-stale");
+  assert_named_theme ("/css/cache/stale/subprocess", expected);
+  g_assert_true (cache_exists ("cache-stale"));
+  g_free (expected);
+
+  write_theme ("cache-stale", "a { color: blue; }");
+  expected = parse_theme ("cache-stale");
+  assert_named_theme ("/css/cache/stale/subprocess", expected);
+  g_free (expected);
+}
+
+static void
+test_corrupt (void)
+{
+  GError *error = NULL;
+  char *cache, *contents, *expected;
+  gsize length, new_length;
+
+  write_theme ("cache-corrupt", round_trip_css);
+  expected = parse_theme ("cache-corrupt");
+  assert_named_theme ("/css/cache/corrupt/subprocess", expected);
+
+  cache = get_cache_path ("cache-corrupt");
+  g_file_get_contents (cache, &contents, &length, &error);
+  g_assert_no_error (error);
+  g_file_set_contents (cache, contents, length / 2, &error);
+  g_assert_no_error (error);
+
+  /* falls back to parsing and replaces the broken cache */
+  assert_named_theme ("/css/cache/corrupt/subprocess", expected);
+  g_free (contents);
+  g_file_get_contents (cache, &contents, &new_length, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (new_length, ==, length);
+
+  g_free (contents);
+  g_free (cache);
+  g_free (expected);
+}
+
+static void
+test_parsing_error (void)
+{
+  write_theme ("cache-parsing-error", "a { color: red; } b { colr: blue; }");
+
+  g_test_expect_message ("Gtk", G_LOG_LEVEL_WARNING, "Theme parsing error*");
+  gtk_css_provider_get_named ("cache-parsing-error", NULL);
+  g_test_assert_expected_messages ();
+
+  g_assert_false (cache_exists ("cache-parsing-error"));
+}
+
+static void
+test_binding_set (void)
+{
+  write_theme ("cache-binding-set",
+               "@binding-set cache-test { bind \"<Control>a\" { \"activate\" () }; }\n"
+               "a { -gtk-key-bindings: cache-test; }");
+
+  gtk_css_provider_get_named ("cache-binding-set", NULL);
+
+  g_assert_false (cache_exists ("cache-binding-set"));
+}
+
+static void
+remove_recursively (const char *path)
+{
+  GDir *dir;
+  const char *name;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir)
+    {
+      while ((name = g_dir_read_name (dir)))
+        {
+          char *child = g_build_filename (path, name, NULL);
+          remove_recursively (child);
+          g_free (child);
+        }
+      g_dir_close (dir);
+    }
+
+  g_remove (path);
+}
+
+int
+main (int argc, char *argv[])
+{
+  char *dir, *path;
+  gboolean owns_dir;
+  int result;
+
+  /* The subprocesses have to use the same directories as the parent,
+   * and GLib only reads the XDG variables once, so set them up before
+   * initializing GTK. */
+  dir = g_strdup (g_getenv ("GTK_CSS_CACHE_TEST_DIR"));
+  owns_dir = dir == NULL;
+  if (owns_dir)
+    {
+      dir = g_dir_make_tmp ("gtk-css-cache-XXXXXX", NULL);
+      g_assert_nonnull (dir);
+      g_setenv ("GTK_CSS_CACHE_TEST_DIR", dir, TRUE);
+    }
+
+  path = g_build_filename (dir, "cache", NULL);
+  g_setenv ("XDG_CACHE_HOME", path, TRUE);
+  g_free (path);
+  path = g_build_filename (dir, "data", NULL);
+  g_setenv ("XDG_DATA_HOME", path, TRUE);
+  g_free (path);
+
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/css/cache/round-trip", test_round_trip);
+  g_test_add_data_func ("/css/cache/round-trip/subprocess", "cache-round-trip", test_print_named_subprocess);
+  g_test_add_func ("/css/cache/unchanged", test_unchanged);
+  g_test_add_data_func ("/css/cache/unchanged/subprocess", "cache-unchanged", test_print_named_subprocess);
+  g_test_add_func ("/css/cache/stale", test_stale);
+  g_test_add_data_func ("/css/cache/stale/subprocess", "cache-stale", test_print_named_subprocess);
+  g_test_add_func ("/css/cache/corrupt", test_corrupt);
+  g_test_add_data_func ("/css/cache/corrupt/subprocess", "cache-corrupt", test_print_named_subprocess);
+  g_test_add_func ("/css/cache/parsing-error", test_parsing_error);
+  g_test_add_func ("/css/cache/binding-set", test_binding_set);
+
+  result = g_test_run ();
+
+  if (owns_dir)
+    remove_recursively (dir);
+  g_free (dir);
+
+  return result;
+}
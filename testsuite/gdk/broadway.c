@@ -0,0 +1,147 @@
+#include <string.h>
+#include <gio/gio.h>
+
+#include "broadway-output.h"
+
+/* broadway-output.c is linked in on its own, without the server */
+gboolean
+broadway_node_equal (BroadwayNode *a,
+                     BroadwayNode *b)
+{
+  return FALSE;
+}
+
+gboolean
+broadway_node_deep_equal (BroadwayNode *a,
+                          BroadwayNode *b)
+{
+  return FALSE;
+}
+
+static GBytes *
+make_texture_data (void)
+{
+  guchar data[65536];
+  gsize i;
+
+  /* Something like a mostly flat image */
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = (i % 4 == 3 || i % 1024 < 16) ? 0xff : 0x40;
+
+  return g_bytes_new (data, sizeof (data));
+}
+
+/* Sends a texture upload and returns everything written to the socket */
+static GBytes *
+send_texture (gboolean  deflate,
+              guint64  *payload_bytes,
+              guint64  *wire_bytes)
+{
+  GOutputStream *out;
+  BroadwayOutput *output;
+  GBytes *texture, *written;
+
+  out = g_memory_output_stream_new_resizable ();
+  output = broadway_output_new (out, 0);
+  if (deflate)
+    broadway_output_enable_deflate (output);
+
+  texture = make_texture_data ();
+  broadway_output_upload_texture (output, 1, texture);
+  g_assert_true (broadway_output_flush (output));
+  broadway_output_get_stats (output, payload_bytes, wire_bytes);
+
+  g_output_stream_close (out, NULL, NULL);
+  written = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (out));
+
+  g_bytes_unref (texture);
+  broadway_output_free (output);
+  g_object_unref (out);
+
+  return written;
+}
+
+static void
+test_frame_plain (void)
+{
+  guint64 payload_bytes, wire_bytes;
+  GBytes *written;
+  const guchar *data;
+  gsize len;
+
+  written = send_texture (FALSE, &payload_bytes, &wire_bytes);
+  data = g_bytes_get_data (written, &len);
+
+  g_assert_cmpuint (payload_bytes, >, 65536);
+  /* FIN + binary, then a 64 bit length */
+  g_assert_cmpuint (data[0], ==, 0x82);
+  g_assert_cmpuint (data[1], ==, 127);
+  g_assert_cmpuint (wire_bytes, ==, payload_bytes + 10);
+  g_assert_cmpuint (len, ==, wire_bytes);
+
+  g_bytes_unref (written);
+}
+
+static void
+test_frame_deflate (void)
+{
+  static const guchar tail[] = { 0x00, 0x00, 0xff, 0xff };
+  guint64 payload_bytes, wire_bytes;
+  GBytes *written;
+  const guchar *data;
+  gsize len, header_len, payload_len;
+  GConverter *inflater;
+  GByteArray *in;
+  guchar *inflated;
+  gsize bytes_read, bytes_written;
+  GConverterResult res;
+
+  written = send_texture (TRUE, &payload_bytes, &wire_bytes);
+  data = g_bytes_get_data (written, &len);
+
+  g_assert_cmpuint (len, ==, wire_bytes);
+  g_assert_cmpuint (wire_bytes, <, payload_bytes / 4);
+
+  /* FIN + RSV1 + binary */
+  g_assert_cmpuint (data[0], ==, 0xc2);
+  payload_len = data[1] & 0x7f;
+  header_len = 2;
+  if (payload_len == 126)
+    {
+      payload_len = (data[2] << 8) | data[3];
+      header_len = 4;
+    }
+  g_assert_cmpuint (payload_len, <, 126 * 126);
+  g_assert_cmpuint (header_len + payload_len, ==, len);
+
+  in = g_byte_array_new ();
+  g_byte_array_append (in, data + header_len, payload_len);
+  g_byte_array_append (in, tail, sizeof (tail));
+
+  inflater = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_RAW));
+  inflated = g_malloc (payload_bytes + 1);
+  res = g_converter_convert (inflater,
+                             in->data, in->len,
+                             inflated, payload_bytes + 1,
+                             G_CONVERTER_FLUSH,
+                             &bytes_read, &bytes_written, NULL);
+  g_assert_cmpint (res, !=, G_CONVERTER_ERROR);
+  g_assert_cmpuint (bytes_read, ==, in->len);
+  g_assert_cmpuint (bytes_written, ==, payload_bytes);
+
+  g_free (inflated);
+  g_object_unref (inflater);
+  g_byte_array_unref (in);
+  g_bytes_unref (written);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/broadway/frame/plain", test_frame_plain);
+  g_test_add_func ("/broadway/frame/deflate", test_frame_deflate);
+
+  return g_test_run ();
+}
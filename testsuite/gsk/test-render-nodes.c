@@ -22,6 +22,7 @@
 #include <glib/gstdio.h>
 #include <gtk/gtk.h>
 #include <stdlib.h>
+#include <math.h>
 #include "reftest-compare.h"
 
 static void
@@ -588,6 +589,33 @@ transformed_clip (void)
   return container_node;
 }
 
+static GskRenderNode *
+blur (void)
+{
+  GskRenderNode *child;
+  GskRenderNode *nodes[2];
+  GskRenderNode *container;
+
+  child = colors ();
+  nodes[0] = gsk_blur_node_new (child, 10);
+  gsk_render_node_unref (child);
+
+  child = cairo ();
+  nodes[1] = gsk_shadow_node_new (child,
+                                  (const GskShadow[1]) {
+                                    { .color = { 0.0, 0.0, 0.0, 0.5 }, .dx = 20, .dy = 20, .radius = 15 }
+                                  },
+                                  1);
+  gsk_render_node_unref (child);
+
+  container = gsk_container_node_new (nodes, 2);
+
+  gsk_render_node_unref (nodes[0]);
+  gsk_render_node_unref (nodes[1]);
+
+  return container;
+}
+
 static const struct {
   const char *name;
   GskRenderNode * (* func) (void);
@@ -602,7 +630,22 @@ static const struct {
   { "transform.node", transform },
   { "opacity.node", opacity },
   { "color-matrix1.node", color_matrix1},
-  { "transformed-clip.node", transformed_clip}
+  { "transformed-clip.node", transformed_clip},
+  { "blur.node", blur }
+};
+
+/* Nodes that don't need any files, for the tiled tests */
+static const struct {
+  const char *name;
+  GskRenderNode * (* func) (void);
+} tiled_functions[] = {
+  { "colors", colors },
+  { "cairo", cairo },
+  { "repeat", repeat },
+  { "blendmode", blendmode },
+  { "cross-fade", cross_fade },
+  { "color-matrix1", color_matrix1 },
+  { "blur", blur }
 };
 
 /*** test setup ***/
@@ -696,6 +739,21 @@ load_node_file (GFile *file, gboolean generate)
       return;
     }
 
+  /* Render what we get back from saving the node, so that the
+   * current format gets tested too */
+  bytes = gsk_render_node_serialize (node);
+  gsk_render_node_unref (node);
+  node = gsk_render_node_deserialize (bytes, &error);
+  g_bytes_unref (bytes);
+
+  if (node == NULL)
+    {
+      g_test_message ("Could not reload node: %s\n", error->message);
+      g_clear_error (&error);
+      g_test_fail ();
+      return;
+    }
+
   window = gdk_window_new_toplevel (gdk_display_get_default(), 10 , 10);
   renderer = gsk_renderer_new_for_window (window);
   texture = gsk_renderer_render_texture (renderer, node, NULL);
@@ -771,6 +829,190 @@ load_node_file (GFile *file, gboolean generate)
   g_free (node_file);
 }
 
+/*** tiled rendering ***/
+
+/* With GSK_CAIRO_THREADS set, the cairo renderer draws in tiles. Check
+ * that this gives the same result as drawing the node in one go, both
+ * into textures and into window surfaces. The latter have a device
+ * offset for partial redraws, and a device scale with GDK_SCALE=2.
+ */
+
+static cairo_surface_t *
+create_scaled_surface (int width,
+                       int height,
+                       int scale)
+{
+  cairo_surface_t *surface;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width * scale, height * scale);
+  cairo_surface_set_device_scale (surface, scale, scale);
+
+  return surface;
+}
+
+static void
+compare_tiled (cairo_surface_t *surface,
+               cairo_surface_t *ref_surface,
+               const char      *name)
+{
+  cairo_surface_t *diff_surface;
+
+  diff_surface = reftest_compare_surfaces (surface, ref_surface);
+  if (diff_surface)
+    {
+      save_image (surface, name, ".out.png");
+      save_image (ref_surface, name, ".ref.png");
+      save_image (diff_surface, name, ".diff.png");
+      cairo_surface_destroy (diff_surface);
+      g_test_fail ();
+    }
+}
+
+static void
+test_tiled_texture (gconstpointer data)
+{
+  GskRenderNode *node = ((GskRenderNode * (*) (void)) data) ();
+  GskRenderer *renderer;
+  GdkWindow *window;
+  GdkTexture *texture;
+  graphene_rect_t bounds;
+  cairo_surface_t *surface, *ref_surface;
+  cairo_t *cr;
+
+  gsk_render_node_get_bounds (node, &bounds);
+
+  window = gdk_window_new_toplevel (gdk_display_get_default (), 10, 10);
+  renderer = gsk_renderer_new_for_window (window);
+  texture = gsk_renderer_render_texture (renderer, node, NULL);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        gdk_texture_get_width (texture),
+                                        gdk_texture_get_height (texture));
+  gdk_texture_download (texture,
+                        cairo_image_surface_get_data (surface),
+                        cairo_image_surface_get_stride (surface));
+  cairo_surface_mark_dirty (surface);
+
+  ref_surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                            gdk_texture_get_width (texture),
+                                            gdk_texture_get_height (texture));
+  cr = cairo_create (ref_surface);
+  cairo_translate (cr, - bounds.origin.x, - bounds.origin.y);
+  gsk_render_node_draw (node, cr);
+  cairo_destroy (cr);
+
+  compare_tiled (surface, ref_surface, "tiled-texture.node");
+
+  cairo_surface_destroy (surface);
+  cairo_surface_destroy (ref_surface);
+  g_object_unref (texture);
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+  gdk_window_destroy (window);
+  g_object_unref (window);
+  gsk_render_node_unref (node);
+}
+
+static void
+render_tiled_in_window (GskRenderNode *node,
+                        gboolean       partial)
+{
+  GskRenderer *renderer;
+  GdkWindow *window;
+  GdkDrawingContext *context;
+  graphene_rect_t bounds;
+  cairo_region_t *region;
+  cairo_surface_t *surface, *ref_surface;
+  cairo_t *cr;
+  int width, height, scale;
+
+  gsk_render_node_get_bounds (node, &bounds);
+  width = ceil (bounds.origin.x + bounds.size.width);
+  height = ceil (bounds.origin.y + bounds.size.height);
+
+  if (partial)
+    region = cairo_region_create_rectangle (&(GdkRectangle) { width / 5, height / 3, width / 2, height / 2 });
+  else
+    region = cairo_region_create_rectangle (&(GdkRectangle) { 0, 0, width, height });
+
+  window = gdk_window_new_toplevel (gdk_display_get_default (), width, height);
+  scale = gdk_window_get_scale_factor (window);
+  renderer = gsk_renderer_new_for_window (window);
+
+  context = gsk_renderer_begin_draw_frame (renderer, region);
+  gsk_renderer_render (renderer, node, context);
+
+  /* Copy out what got drawn before the frame is over */
+  surface = create_scaled_surface (width, height, scale);
+  cr = cairo_create (surface);
+  cairo_set_source_surface (cr, cairo_get_target (gdk_drawing_context_get_cairo_context (context)), 0, 0);
+  gdk_cairo_region (cr, region);
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  gsk_renderer_end_draw_frame (renderer, context);
+
+  ref_surface = create_scaled_surface (width, height, scale);
+  cr = cairo_create (ref_surface);
+  gdk_cairo_region (cr, region);
+  cairo_clip (cr);
+  gsk_render_node_draw (node, cr);
+  cairo_destroy (cr);
+
+  compare_tiled (surface, ref_surface, partial ? "tiled-partial.node" : "tiled-window.node");
+
+  cairo_surface_destroy (surface);
+  cairo_surface_destroy (ref_surface);
+  cairo_region_destroy (region);
+  gsk_renderer_unrealize (renderer);
+  g_object_unref (renderer);
+  gdk_window_destroy (window);
+  g_object_unref (window);
+}
+
+static void
+test_tiled_window (gconstpointer data)
+{
+  GskRenderNode *node = ((GskRenderNode * (*) (void)) data) ();
+
+  render_tiled_in_window (node, FALSE);
+
+  gsk_render_node_unref (node);
+}
+
+static void
+test_tiled_partial (gconstpointer data)
+{
+  GskRenderNode *node = ((GskRenderNode * (*) (void)) data) ();
+
+  render_tiled_in_window (node, TRUE);
+
+  gsk_render_node_unref (node);
+}
+
+static void
+add_tiled_tests (void)
+{
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (tiled_functions); i++)
+    {
+      char *path;
+
+      path = g_strdup_printf ("/tiled/%s/texture", tiled_functions[i].name);
+      g_test_add_data_func (path, tiled_functions[i].func, test_tiled_texture);
+      g_free (path);
+
+      path = g_strdup_printf ("/tiled/%s/window", tiled_functions[i].name);
+      g_test_add_data_func (path, tiled_functions[i].func, test_tiled_window);
+      g_free (path);
+
+      path = g_strdup_printf ("/tiled/%s/partial", tiled_functions[i].name);
+      g_test_add_data_func (path, tiled_functions[i].func, test_tiled_partial);
+      g_free (path);
+    }
+}
+
 static void
 test_node_file (GFile *file)
 {
@@ -901,6 +1143,9 @@ main (int argc, char **argv)
       add_tests_for_files_in_directory (dir);
 
       g_object_unref (dir);
+
+      if (g_getenv ("GSK_CAIRO_THREADS") != NULL)
+        add_tiled_tests ();
     }
   else if (strcmp (argv[1], "--generate") == 0)
     {
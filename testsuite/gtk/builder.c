@@ -22,6 +22,7 @@
 #include <locale.h>
 #include <math.h>
 
+#include <glib/gstdio.h>
 #include <gtk/gtk.h>
 #include <gdk/gdkkeysyms.h>
 
@@ -2672,6 +2673,299 @@ test_file_filter (void)
   g_object_unref (builder);
 }
 
+/* Runs gtk4-builder-tool compile on @xml, returns the compiled data
+ * or %NULL if the tool is not available */
+static gchar *
+compile_ui (const gchar *xml,
+            gsize       *length)
+{
+  const gchar *tool;
+  const gchar *argv[6];
+  gchar *ui_path, *compiled_path;
+  gchar *compiled;
+  gint fd, status;
+  GError *error = NULL;
+
+  tool = g_getenv ("GTK_BUILDER_TOOL");
+  if (tool == NULL)
+    return NULL;
+
+  fd = g_file_open_tmp ("compiled-XXXXXX.ui", &ui_path, &error);
+  g_assert_no_error (error);
+  g_close (fd, NULL);
+  g_file_set_contents (ui_path, xml, -1, &error);
+  g_assert_no_error (error);
+  compiled_path = g_strconcat (ui_path, ".compiled", NULL);
+
+  argv[0] = tool;
+  argv[1] = "compile";
+  argv[2] = "--output";
+  argv[3] = compiled_path;
+  argv[4] = ui_path;
+  argv[5] = NULL;
+  g_spawn_sync (NULL, (gchar **) argv, NULL, G_SPAWN_DEFAULT,
+                NULL, NULL, NULL, NULL, &status, &error);
+  g_assert_no_error (error);
+  g_spawn_check_exit_status (status, &error);
+  g_assert_no_error (error);
+
+  g_file_get_contents (compiled_path, &compiled, length, &error);
+  g_assert_no_error (error);
+
+  g_unlink (compiled_path);
+  g_unlink (ui_path);
+  g_free (compiled_path);
+  g_free (ui_path);
+
+  return compiled;
+}
+
+static void
+compare_object_properties (GObject *a,
+                           GObject *b)
+{
+  GParamSpec **pspecs;
+  guint n_pspecs, i;
+
+  g_assert (G_OBJECT_TYPE (a) == G_OBJECT_TYPE (b));
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (a), &n_pspecs);
+  for (i = 0; i < n_pspecs; i++)
+    {
+      GParamSpec *pspec = pspecs[i];
+      GValue value_a = G_VALUE_INIT;
+      GValue value_b = G_VALUE_INIT;
+
+      if (!(pspec->flags & G_PARAM_READABLE))
+        continue;
+
+      /* Objects and boxed values are compared by the callers */
+      switch (G_TYPE_FUNDAMENTAL (G_PARAM_SPEC_VALUE_TYPE (pspec)))
+        {
+        case G_TYPE_BOOLEAN:
+        case G_TYPE_INT:
+        case G_TYPE_UINT:
+        case G_TYPE_LONG:
+        case G_TYPE_ULONG:
+        case G_TYPE_INT64:
+        case G_TYPE_UINT64:
+        case G_TYPE_FLOAT:
+        case G_TYPE_DOUBLE:
+        case G_TYPE_ENUM:
+        case G_TYPE_FLAGS:
+        case G_TYPE_STRING:
+          break;
+        default:
+          continue;
+        }
+
+      g_value_init (&value_a, G_PARAM_SPEC_VALUE_TYPE (pspec));
+      g_value_init (&value_b, G_PARAM_SPEC_VALUE_TYPE (pspec));
+      g_object_get_property (a, pspec->name, &value_a);
+      g_object_get_property (b, pspec->name, &value_b);
+
+      if (g_param_values_cmp (pspec, &value_a, &value_b) != 0)
+        g_error ("%s.%s differs between the .ui file and its compiled form",
+                 G_OBJECT_TYPE_NAME (a), pspec->name);
+
+      g_value_unset (&value_a);
+      g_value_unset (&value_b);
+    }
+
+  g_free (pspecs);
+}
+
+static void
+test_compiled (void)
+{
+  const gchar buffer[] =
+    "<interface>\n"
+    "  <!-- comments and whitespace are not kept -->\n"
+    "  <object class=\"GtkSizeGroup\" id=\"sizegroup\">\n"
+    "    <property name=\"mode\">GTK_SIZE_GROUP_BOTH</property>\n"
+    "    <widgets>\n"
+    "      <widget name=\"label\"/>\n"
+    "      <widget name=\"entry\"/>\n"
+    "    </widgets>\n"
+    "  </object>\n"
+    "  <menu id=\"menu\">\n"
+    "    <section>\n"
+    "      <item>\n"
+    "        <attribute name=\"label\">Item</attribute>\n"
+    "      </item>\n"
+    "    </section>\n"
+    "  </menu>\n"
+    "  <object class=\"GtkBox\" id=\"box\">\n"
+    "    <property name=\"orientation\">vertical</property>\n"
+    "    <property name=\"homogeneous\">yes</property>\n"
+    "    <child>\n"
+    "      <object class=\"GtkLabel\" id=\"label\">\n"
+    "        <property name=\"label\">Hello &amp; welcome</property>\n"
+    "        <property name=\"justify\">2</property>\n"
+    "        <property name=\"wrap\">True</property>\n"
+    "        <property name=\"selectable\">0</property>\n"
+    "        <attributes>\n"
+    "          <attribute name=\"weight\" value=\"bold\"/>\n"
+    "        </attributes>\n"
+    "        <style>\n"
+    "          <class name=\"compiled\"/>\n"
+    "        </style>\n"
+    "      </object>\n"
+    "    </child>\n"
+    "    <child>\n"
+    "      <object class=\"GtkEntry\" id=\"entry\">\n"
+    "        <property name=\"input-hints\">spellcheck | GTK_INPUT_HINT_LOWERCASE</property>\n"
+    "        <property name=\"input-purpose\">digits</property>\n"
+    "        <property name=\"visibility\">false</property>\n"
+    "      </object>\n"
+    "    </child>\n"
+    "  </object>\n"
+    "</interface>\n";
+  const gchar *ids[] = { "sizegroup", "menu", "box", "label", "entry" };
+  GtkBuilder *builder, *compiled_builder;
+  gchar *compiled;
+  gsize length;
+  GObject *obj;
+  GError *error = NULL;
+  guint i;
+
+  compiled = compile_ui (buffer, &length);
+  if (compiled == NULL)
+    {
+      g_test_skip ("GTK_BUILDER_TOOL is not set");
+      return;
+    }
+
+  builder = builder_new_from_string (buffer, -1, NULL);
+
+  compiled_builder = gtk_builder_new ();
+  gtk_builder_add_from_string (compiled_builder, compiled, length, &error);
+  g_assert_no_error (error);
+
+  for (i = 0; i < G_N_ELEMENTS (ids); i++)
+    compare_object_properties (gtk_builder_get_object (builder, ids[i]),
+                               gtk_builder_get_object (compiled_builder, ids[i]));
+
+  /* Enums, flags and booleans were stored as numbers */
+  obj = gtk_builder_get_object (compiled_builder, "box");
+  g_assert_cmpint (gtk_orientable_get_orientation (GTK_ORIENTABLE (obj)), ==, GTK_ORIENTATION_VERTICAL);
+  g_assert (gtk_box_get_homogeneous (GTK_BOX (obj)));
+  obj = gtk_builder_get_object (compiled_builder, "entry");
+  g_assert_cmpuint (gtk_entry_get_input_hints (GTK_ENTRY (obj)), ==, GTK_INPUT_HINT_SPELLCHECK | GTK_INPUT_HINT_LOWERCASE);
+  g_assert_cmpint (gtk_entry_get_input_purpose (GTK_ENTRY (obj)), ==, GTK_INPUT_PURPOSE_DIGITS);
+  g_assert (!gtk_entry_get_visibility (GTK_ENTRY (obj)));
+
+  /* The structure and the custom elements, which are kept as XML */
+  obj = gtk_builder_get_object (compiled_builder, "label");
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (obj)), ==, "Hello & welcome");
+  g_assert (gtk_widget_get_parent (GTK_WIDGET (obj)) == GTK_WIDGET (gtk_builder_get_object (compiled_builder, "box")));
+  g_assert (gtk_style_context_has_class (gtk_widget_get_style_context (GTK_WIDGET (obj)), "compiled"));
+  g_assert_nonnull (gtk_label_get_attributes (GTK_LABEL (obj)));
+
+  obj = gtk_builder_get_object (compiled_builder, "sizegroup");
+  g_assert_cmpuint (g_slist_length (gtk_size_group_get_widgets (GTK_SIZE_GROUP (obj))), ==, 2);
+
+  obj = gtk_builder_get_object (compiled_builder, "menu");
+  g_assert (G_IS_MENU_MODEL (obj));
+  g_assert_cmpint (g_menu_model_get_n_items (G_MENU_MODEL (obj)), ==, 1);
+
+  g_object_unref (builder);
+  g_object_unref (compiled_builder);
+  g_free (compiled);
+}
+
+static gint
+get_error_line (const GError *error)
+{
+  gint line = -1;
+
+  if (g_str_has_prefix (error->message, "<input>:"))
+    line = g_ascii_strtoll (error->message + strlen ("<input>:"), NULL, 10);
+
+  return line;
+}
+
+static void
+test_compiled_errors (void)
+{
+  /* The errors happen on the line given, in core elements or inside
+   * of elements that are kept as XML fragments. */
+  const struct {
+    const gchar *buffer;
+    gint line;
+    gboolean same_position;
+  } tests[] = {
+    { "<interface>\n"
+      "  <object class=\"GtkBox\" id=\"box\">\n"
+      "    <child>\n"
+      "      <object class=\"GtkNoSuchThing\" id=\"thing\"/>\n"
+      "    </child>\n"
+      "  </object>\n"
+      "</interface>\n", 4, TRUE },
+    { "<interface>\n"
+      "  <object class=\"GtkBox\" id=\"box\">\n"
+      "    <property name=\"orientation\">vertical</property>\n"
+      "    <property name=\"no-such-property\">1</property>\n"
+      "  </object>\n"
+      "</interface>\n", 4, TRUE },
+    { "<interface>\n"
+      "  <object class=\"GtkLabel\" id=\"label\">\n"
+      "    <property name=\"label\">Text</property>\n"
+      "    <style>\n"
+      "      <class name=\"first\"/>\n"
+      "\n"
+      "      <class/>\n"
+      "    </style>\n"
+      "  </object>\n"
+      "</interface>\n", 7, FALSE },
+    { "<interface>\n"
+      "  <object class=\"GtkSizeGroup\" id=\"sizegroup\">\n"
+      "    <widgets>\n"
+      "\n"
+      "      <widget name=\"missing\"/>\n"
+      "    </widgets>\n"
+      "  </object>\n"
+      "</interface>\n", 5, FALSE },
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (tests); i++)
+    {
+      GtkBuilder *builder;
+      GError *error = NULL, *compiled_error = NULL;
+      gchar *compiled;
+      gsize length;
+
+      compiled = compile_ui (tests[i].buffer, &length);
+      if (compiled == NULL)
+        {
+          g_test_skip ("GTK_BUILDER_TOOL is not set");
+          return;
+        }
+
+      builder = gtk_builder_new ();
+      g_assert (!gtk_builder_add_from_string (builder, tests[i].buffer, -1, &error));
+      g_object_unref (builder);
+
+      builder = gtk_builder_new ();
+      g_assert (!gtk_builder_add_from_string (builder, compiled, length, &compiled_error));
+      g_object_unref (builder);
+
+      g_assert_nonnull (error);
+      g_assert_error (compiled_error, error->domain, error->code);
+      g_assert_cmpint (get_error_line (error), ==, tests[i].line);
+      g_assert_cmpint (get_error_line (compiled_error), ==, tests[i].line);
+
+      /* Fragments start at the first column of their line */
+      if (tests[i].same_position)
+        g_assert_cmpstr (compiled_error->message, ==, error->message);
+
+      g_error_free (error);
+      g_error_free (compiled_error);
+      g_free (compiled);
+    }
+}
+
 int
 main (int argc, char **argv)
 {
@@ -2724,6 +3018,8 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/Property Bindings", test_property_bindings);
   g_test_add_func ("/Builder/anaconda-signal", test_anaconda_signal);
   g_test_add_func ("/Builder/FileFilter", test_file_filter);
+  g_test_add_func ("/Builder/Compiled", test_compiled);
+  g_test_add_func ("/Builder/Compiled/Errors", test_compiled_errors);
 
   return g_test_run();
 }
@@ -1375,6 +1375,269 @@ unfiltered_hide_single (FilterTest    *fixture,
   check_level_length (fixture->filter, NULL, LEVEL_LENGTH - 1);
 }
 
+typedef struct
+{
+  gboolean done;
+  gboolean retval;
+  GError *error;
+} RefilterResult;
+
+static void
+refilter_async_done (GObject      *source,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  RefilterResult *res = user_data;
+
+  res->retval = gtk_tree_model_filter_refilter_finish (GTK_TREE_MODEL_FILTER (source),
+                                                       result, &res->error);
+  res->done = TRUE;
+}
+
+static gboolean
+filter_test_refilter_async (FilterTest    *fixture,
+                            GCancellable  *cancellable,
+                            GError       **error)
+{
+  RefilterResult res = { FALSE, FALSE, NULL };
+
+  gtk_tree_model_filter_refilter_async (fixture->filter, cancellable,
+                                        refilter_async_done, &res);
+  while (!res.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (res.retval == (res.error == NULL));
+  if (res.error)
+    g_propagate_error (error, res.error);
+
+  return res.retval;
+}
+
+static void
+unfiltered_hide_single_async (FilterTest    *fixture,
+                              gconstpointer  user_data)
+
+{
+  GError *error = NULL;
+
+  signal_monitor_append_signal (fixture->monitor, ROW_CHANGED, "2");
+  signal_monitor_append_signal (fixture->monitor, ROW_HAS_CHILD_TOGGLED, "2");
+  set_path_visibility (fixture, "2", FALSE);
+
+  signal_monitor_assert_is_empty (fixture->monitor);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH);
+
+  /* Only the row whose visibility changed is signalled, there are
+   * no row-changed emissions for the other rows.
+   */
+  signal_monitor_append_signal (fixture->monitor, ROW_DELETED, "2");
+  gtk_tree_model_filter_set_visible_column (fixture->filter, 1);
+  filter_test_refilter_async (fixture, NULL, &error);
+  g_assert_no_error (error);
+
+  check_filter_model (fixture);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH - 1);
+
+  filter_test_block_signals (fixture);
+  set_path_visibility (fixture, "2", TRUE);
+  filter_test_unblock_signals (fixture);
+
+  signal_monitor_append_signal (fixture->monitor, ROW_INSERTED, "2");
+  signal_monitor_append_signal (fixture->monitor, ROW_HAS_CHILD_TOGGLED, "2");
+  filter_test_refilter_async (fixture, NULL, &error);
+  g_assert_no_error (error);
+
+  check_filter_model (fixture);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH);
+}
+
+static void
+unfiltered_hide_single_async_cancelled (FilterTest    *fixture,
+                                        gconstpointer  user_data)
+
+{
+  GCancellable *cancellable;
+  GError *error = NULL;
+
+  signal_monitor_append_signal (fixture->monitor, ROW_CHANGED, "2");
+  signal_monitor_append_signal (fixture->monitor, ROW_HAS_CHILD_TOGGLED, "2");
+  set_path_visibility (fixture, "2", FALSE);
+  signal_monitor_assert_is_empty (fixture->monitor);
+
+  gtk_tree_model_filter_set_visible_column (fixture->filter, 1);
+
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  g_assert (!filter_test_refilter_async (fixture, cancellable, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&error);
+  g_object_unref (cancellable);
+
+  signal_monitor_assert_is_empty (fixture->monitor);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH);
+
+  signal_monitor_append_signal (fixture->monitor, ROW_DELETED, "2");
+  filter_test_refilter_async (fixture, NULL, &error);
+  g_assert_no_error (error);
+
+  check_filter_model (fixture);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH - 1);
+}
+
+static void
+unfiltered_hide_single_child_root_expanded_async (FilterTest    *fixture,
+                                                  gconstpointer  user_data)
+
+{
+  GError *error = NULL;
+
+  filter_test_block_signals (fixture);
+  set_path_visibility (fixture, "2:2", FALSE);
+  filter_test_unblock_signals (fixture);
+
+  /* The child level is walked after the root level */
+  signal_monitor_append_signal (fixture->monitor, ROW_DELETED, "2:2");
+  gtk_tree_model_filter_set_visible_column (fixture->filter, 1);
+  filter_test_refilter_async (fixture, NULL, &error);
+  g_assert_no_error (error);
+
+  check_filter_model (fixture);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH);
+  check_level_length (fixture->filter, "2", LEVEL_LENGTH - 1);
+}
+
+static void
+unfiltered_hide_child_level_root_expanded_async (FilterTest    *fixture,
+                                                 gconstpointer  user_data)
+
+{
+  GError *error = NULL;
+  int i;
+
+  filter_test_block_signals (fixture);
+  set_path_visibility (fixture, "2:0", FALSE);
+  set_path_visibility (fixture, "2:1", FALSE);
+  set_path_visibility (fixture, "2:2", FALSE);
+  set_path_visibility (fixture, "2:3", FALSE);
+  set_path_visibility (fixture, "2:4", FALSE);
+  filter_test_unblock_signals (fixture);
+
+  /* Hiding the last visible child toggles the parent */
+  for (i = 0; i < LEVEL_LENGTH; i++)
+    signal_monitor_append_signal (fixture->monitor, ROW_DELETED, "2:0");
+  signal_monitor_append_signal (fixture->monitor, ROW_HAS_CHILD_TOGGLED, "2");
+  gtk_tree_model_filter_set_visible_column (fixture->filter, 1);
+  filter_test_refilter_async (fixture, NULL, &error);
+  g_assert_no_error (error);
+
+  check_filter_model (fixture);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH);
+  check_level_length (fixture->filter, "2", 0);
+
+  /* And showing the first one toggles it back */
+  filter_test_block_signals (fixture);
+  set_path_visibility (fixture, "2:3", TRUE);
+  filter_test_unblock_signals (fixture);
+
+  signal_monitor_append_signal (fixture->monitor, ROW_HAS_CHILD_TOGGLED, "2");
+  filter_test_refilter_async (fixture, NULL, &error);
+  g_assert_no_error (error);
+
+  check_filter_model (fixture);
+  check_level_length (fixture->filter, "2", 1);
+}
+
+static void
+unfiltered_vroot_hide_single_async (FilterTest    *fixture,
+                                    gconstpointer  user_data)
+
+{
+  GtkTreePath *path = (GtkTreePath *)user_data;
+  GError *error = NULL;
+
+  filter_test_block_signals (fixture);
+  set_path_visibility (fixture, "2:2", FALSE);
+  filter_test_unblock_signals (fixture);
+
+  /* Rows outside of the virtual root are not looked at */
+  signal_monitor_append_signal (fixture->monitor, ROW_DELETED, "2");
+  gtk_tree_model_filter_set_visible_column (fixture->filter, 1);
+  filter_test_refilter_async (fixture, NULL, &error);
+  g_assert_no_error (error);
+
+  check_filter_model_with_root (fixture, path);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH - 1);
+}
+
+typedef struct
+{
+  FilterTest *fixture;
+  RefilterResult first;
+  RefilterResult second;
+  RefilterResult third;
+} SupersedeData;
+
+static void
+supersede_first_done (GObject      *source,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  SupersedeData *data = user_data;
+
+  refilter_async_done (source, result, &data->first);
+
+  /* This may run from within the call that cancelled us */
+  gtk_tree_model_filter_refilter_async (data->fixture->filter, NULL,
+                                        refilter_async_done, &data->third);
+}
+
+static gboolean
+supersede_start_second (gpointer user_data)
+{
+  SupersedeData *data = user_data;
+
+  gtk_tree_model_filter_refilter_async (data->fixture->filter, NULL,
+                                        refilter_async_done, &data->second);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+unfiltered_hide_single_async_superseded (FilterTest    *fixture,
+                                         gconstpointer  user_data)
+
+{
+  SupersedeData data = { fixture, };
+
+  filter_test_block_signals (fixture);
+  set_path_visibility (fixture, "2", FALSE);
+  filter_test_unblock_signals (fixture);
+
+  gtk_tree_model_filter_set_visible_column (fixture->filter, 1);
+
+  /* Only the last refilter gets to do any work */
+  signal_monitor_append_signal (fixture->monitor, ROW_DELETED, "2");
+
+  gtk_tree_model_filter_refilter_async (fixture->filter, NULL,
+                                        supersede_first_done, &data);
+  g_idle_add_full (G_PRIORITY_HIGH_IDLE, supersede_start_second, &data, NULL);
+
+  while (!data.first.done || !data.second.done || !data.third.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (!data.first.retval);
+  g_assert_error (data.first.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&data.first.error);
+  g_assert (!data.second.retval);
+  g_assert_error (data.second.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&data.second.error);
+  g_assert (data.third.retval);
+  g_assert_no_error (data.third.error);
+
+  check_filter_model (fixture);
+  check_level_length (fixture->filter, NULL, LEVEL_LENGTH - 1);
+}
+
 static void
 unfiltered_hide_single_root_expanded (FilterTest    *fixture,
                                       gconstpointer  user_data)
@@ -6755,6 +7018,195 @@ specific_bug_679910 (void)
   g_object_unref (store);
 }
 
+/* More rows than the async refilter looks at in one go */
+#define LARGE_LENGTH 1000
+
+static GtkTreeStore *
+create_large_store (int n_rows)
+{
+  GtkTreeStore *store;
+  int i;
+
+  store = gtk_tree_store_new (2, G_TYPE_STRING, G_TYPE_BOOLEAN);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      gchar *name = g_strdup_printf ("%d", i);
+
+      gtk_tree_store_insert_with_values (store, NULL, NULL, i,
+                                         0, name,
+                                         1, i % 3 != 0,
+                                         -1);
+      g_free (name);
+    }
+
+  return store;
+}
+
+static void
+check_large_filter (GtkTreeModel *filter,
+                    GtkTreeStore *store)
+{
+  GtkTreeIter store_iter, filter_iter;
+  gboolean store_valid, filter_valid;
+
+  store_valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &store_iter);
+  filter_valid = gtk_tree_model_get_iter_first (filter, &filter_iter);
+
+  while (store_valid)
+    {
+      gboolean visible;
+
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &store_iter, 1, &visible, -1);
+
+      if (visible)
+        {
+          gchar *store_name, *filter_name;
+
+          g_assert (filter_valid);
+
+          gtk_tree_model_get (GTK_TREE_MODEL (store), &store_iter, 0, &store_name, -1);
+          gtk_tree_model_get (filter, &filter_iter, 0, &filter_name, -1);
+          g_assert_cmpstr (store_name, ==, filter_name);
+          g_free (store_name);
+          g_free (filter_name);
+
+          filter_valid = gtk_tree_model_iter_next (filter, &filter_iter);
+        }
+
+      store_valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &store_iter);
+    }
+
+  g_assert (!filter_valid);
+}
+
+static void
+specific_refilter_async_large (void)
+{
+  GtkTreeStore *store;
+  GtkTreeModel *filter;
+  SignalMonitor *monitor;
+  RefilterResult res = { FALSE, FALSE, NULL };
+  int i;
+
+  store = create_large_store (LARGE_LENGTH);
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (store), NULL);
+  monitor = signal_monitor_new (filter);
+
+  /* Build the root level */
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, LARGE_LENGTH);
+
+  /* Every third row goes away, across several chunks */
+  for (i = 0; i < LARGE_LENGTH; i += 3)
+    {
+      gchar *path = g_strdup_printf ("%d", i / 3 * 2);
+
+      signal_monitor_append_signal (monitor, ROW_DELETED, path);
+      g_free (path);
+    }
+
+  gtk_tree_model_filter_set_visible_column (GTK_TREE_MODEL_FILTER (filter), 1);
+  gtk_tree_model_filter_refilter_async (GTK_TREE_MODEL_FILTER (filter), NULL,
+                                        refilter_async_done, &res);
+  while (!res.done)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (res.retval);
+  g_assert_no_error (res.error);
+  signal_monitor_assert_is_empty (monitor);
+  check_large_filter (filter, store);
+
+  signal_monitor_free (monitor);
+  g_object_unref (filter);
+  g_object_unref (store);
+}
+
+typedef struct
+{
+  GtkTreeStore *store;
+  gboolean filtering;
+  int n_appended;
+  RefilterResult res;
+} StreamingData;
+
+static gboolean
+streaming_visible_func (GtkTreeModel *model,
+                        GtkTreeIter  *iter,
+                        gpointer      user_data)
+{
+  StreamingData *data = user_data;
+  gboolean visible;
+
+  if (!data->filtering)
+    return TRUE;
+
+  /* Make sure a single idle slice can't get through all rows */
+  g_usleep (10);
+
+  gtk_tree_model_get (model, iter, 1, &visible, -1);
+
+  return visible;
+}
+
+static gboolean
+streaming_append_row (gpointer user_data)
+{
+  StreamingData *data = user_data;
+
+  if (data->res.done)
+    return G_SOURCE_REMOVE;
+
+  gtk_tree_store_insert_with_values (data->store, NULL, NULL, -1,
+                                     0, "appended",
+                                     1, data->n_appended % 2 == 0,
+                                     -1);
+  data->n_appended++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+specific_refilter_async_streaming (void)
+{
+  GtkTreeModel *filter;
+  StreamingData data = { NULL, };
+  guint source_id;
+
+  data.store = create_large_store (5 * LARGE_LENGTH);
+  filter = gtk_tree_model_filter_new (GTK_TREE_MODEL (data.store), NULL);
+  gtk_tree_model_filter_set_visible_func (GTK_TREE_MODEL_FILTER (filter),
+                                          streaming_visible_func,
+                                          &data, NULL);
+
+  /* Build the root level */
+  g_assert_cmpint (gtk_tree_model_iter_n_children (filter, NULL), ==, 5 * LARGE_LENGTH);
+
+  /* A row is added to the child model in every main loop iteration
+   * while the refilter runs; it still has to get to the end.
+   */
+  data.filtering = TRUE;
+  gtk_tree_model_filter_refilter_async (GTK_TREE_MODEL_FILTER (filter), NULL,
+                                        refilter_async_done, &data.res);
+  source_id = g_idle_add (streaming_append_row, &data);
+
+  while (!data.res.done && data.n_appended < LARGE_LENGTH)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert (data.res.done);
+  g_assert (data.res.retval);
+  g_assert_no_error (data.res.error);
+  g_assert_cmpint (data.n_appended, >, 0);
+
+  /* Let the append source notice that we are done */
+  while (g_main_context_iteration (NULL, FALSE));
+  g_assert (g_main_context_find_source_by_id (NULL, source_id) == NULL);
+
+  check_large_filter (filter, data.store);
+
+  g_object_unref (filter);
+  g_object_unref (data.store);
+}
+
 static int row_changed_count;
 static int filter_row_changed_count;
 
@@ -6908,11 +7360,41 @@ register_filter_model_tests (void)
               filter_test_setup_unfiltered,
               unfiltered_hide_single,
               filter_test_teardown);
+  g_test_add ("/TreeModelFilter/unfiltered/hide-single/async",
+              FilterTest, NULL,
+              filter_test_setup_unfiltered,
+              unfiltered_hide_single_async,
+              filter_test_teardown);
+  g_test_add ("/TreeModelFilter/unfiltered/hide-single/async-cancelled",
+              FilterTest, NULL,
+              filter_test_setup_unfiltered,
+              unfiltered_hide_single_async_cancelled,
+              filter_test_teardown);
   g_test_add ("/TreeModelFilter/unfiltered/hide-single/root-expanded",
               FilterTest, NULL,
               filter_test_setup_unfiltered_root_expanded,
               unfiltered_hide_single_root_expanded,
               filter_test_teardown);
+  g_test_add ("/TreeModelFilter/unfiltered/hide-single/async-superseded",
+              FilterTest, NULL,
+              filter_test_setup_unfiltered,
+              unfiltered_hide_single_async_superseded,
+              filter_test_teardown);
+  g_test_add ("/TreeModelFilter/unfiltered/hide-single-child/root-expanded/async",
+              FilterTest, NULL,
+              filter_test_setup_unfiltered_root_expanded,
+              unfiltered_hide_single_child_root_expanded_async,
+              filter_test_teardown);
+  g_test_add ("/TreeModelFilter/unfiltered/hide-child-level/root-expanded/async",
+              FilterTest, NULL,
+              filter_test_setup_unfiltered_root_expanded,
+              unfiltered_hide_child_level_root_expanded_async,
+              filter_test_teardown);
+  g_test_add ("/TreeModelFilter/unfiltered/hide-single/vroot/async",
+              FilterTest, gtk_tree_path_new_from_indices (2, -1),
+              filter_test_setup_unfiltered,
+              unfiltered_vroot_hide_single_async,
+              filter_test_teardown);
   g_test_add ("/TreeModelFilter/unfiltered/hide-single-child",
               FilterTest, NULL,
               filter_test_setup_unfiltered,
@@ -7185,6 +7667,10 @@ register_filter_model_tests (void)
                    specific_bug_659022_row_deleted_free_level);
   g_test_add_func ("/TreeModelFilter/specific/bug-679910",
                    specific_bug_679910);
+  g_test_add_func ("/TreeModelFilter/specific/refilter-async/large",
+                   specific_refilter_async_large);
+  g_test_add_func ("/TreeModelFilter/specific/refilter-async/streaming",
+                   specific_refilter_async_streaming);
 
   g_test_add_func ("/TreeModelFilter/signal/row-changed", test_row_changed);
 }
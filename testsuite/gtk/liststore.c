@@ -223,6 +223,66 @@ list_store_test_append (void)
   g_object_unref (store);
 }
 
+static void
+count_signal (gpointer data)
+{
+  (*(int *)data)++;
+}
+
+static void
+list_store_test_append_rows_sorted (void)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  GValue values[3] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+  int data[] = { 3, 9, 1 };
+  int expected[] = { 1, 3, 5, 9 };
+  int columns[] = { 0 };
+  int inserted = 0;
+  int reordered = 0;
+  gboolean valid;
+  int i;
+
+  store = gtk_list_store_new (1, G_TYPE_INT);
+  gtk_tree_sortable_set_sort_column_id (GTK_TREE_SORTABLE (store), 0,
+                                        GTK_SORT_ASCENDING);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, 5, -1);
+
+  g_signal_connect_swapped (store, "row-inserted",
+                            G_CALLBACK (count_signal), &inserted);
+  g_signal_connect_swapped (store, "rows-reordered",
+                            G_CALLBACK (count_signal), &reordered);
+
+  for (i = 0; i < G_N_ELEMENTS (data); i++)
+    {
+      g_value_init (&values[i], G_TYPE_INT);
+      g_value_set_int (&values[i], data[i]);
+    }
+
+  gtk_list_store_append_rowsv (store, G_N_ELEMENTS (data), columns, values, 1);
+
+  g_assert_cmpint (inserted, ==, 3);
+  g_assert_cmpint (reordered, ==, 1);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), NULL), ==, 4);
+
+  valid = gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  for (i = 0; i < G_N_ELEMENTS (expected); i++)
+    {
+      int value;
+
+      g_assert (valid);
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, expected[i]);
+      valid = gtk_tree_model_iter_next (GTK_TREE_MODEL (store), &iter);
+    }
+  g_assert (!valid);
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    g_value_unset (&values[i]);
+
+  g_object_unref (store);
+}
+
 static void
 list_store_test_prepend (void)
 {
@@ -1023,6 +1083,8 @@ register_list_store_tests (void)
 	           list_store_test_insert_high_values);
   g_test_add_func ("/ListStore/append",
 		   list_store_test_append);
+  g_test_add_func ("/ListStore/append-rows-sorted",
+		   list_store_test_append_rows_sorted);
   g_test_add_func ("/ListStore/prepend",
 		   list_store_test_prepend);
   g_test_add_func ("/ListStore/insert-after",
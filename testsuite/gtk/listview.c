@@ -0,0 +1,383 @@
+#include <gtk/gtk.h>
+
+#define ROW_HEIGHT 20
+#define WIDTH 200
+#define HEIGHT 100
+
+typedef struct {
+  guint n_created;
+  guint n_bound;
+  gboolean freed;
+} Counters;
+
+static GtkWidget *
+create_row (gpointer user_data)
+{
+  Counters *counters = user_data;
+  GtkWidget *label;
+
+  counters->n_created++;
+
+  label = gtk_label_new (NULL);
+  gtk_widget_set_size_request (label, -1, ROW_HEIGHT);
+
+  return label;
+}
+
+static void
+bind_row (GtkWidget *widget,
+          gpointer   item,
+          gpointer   user_data)
+{
+  Counters *counters = user_data;
+
+  counters->n_bound++;
+
+  gtk_label_set_text (GTK_LABEL (widget), g_object_get_data (item, "text"));
+}
+
+static void
+free_counters (gpointer user_data)
+{
+  Counters *counters = user_data;
+
+  counters->freed = TRUE;
+}
+
+static GObject *
+create_item (const char *text)
+{
+  GObject *item;
+
+  item = g_object_new (G_TYPE_OBJECT, NULL);
+  g_object_set_data_full (item, "text", g_strdup (text), g_free);
+
+  return item;
+}
+
+static GListStore *
+create_model (guint n_items)
+{
+  GListStore *store;
+  guint i;
+
+  store = g_list_store_new (G_TYPE_OBJECT);
+
+  for (i = 0; i < n_items; i++)
+    {
+      char *text = g_strdup_printf ("%u", i);
+      GObject *item = create_item (text);
+
+      g_list_store_append (store, item);
+
+      g_object_unref (item);
+      g_free (text);
+    }
+
+  return store;
+}
+
+static GtkWidget *
+create_list (GListModel *model,
+             Counters   *counters)
+{
+  GtkWidget *list;
+
+  list = gtk_list_view_new ();
+  g_object_ref_sink (list);
+  gtk_widget_show (list);
+
+  gtk_list_view_bind_model (GTK_LIST_VIEW (list), model,
+                            create_row, bind_row,
+                            counters, free_counters);
+
+  return list;
+}
+
+static void
+allocate (GtkWidget *list)
+{
+  GtkAllocation allocation = { 0, 0, WIDTH, HEIGHT };
+  GtkAllocation clip;
+  int min, nat;
+
+  gtk_widget_measure (list, GTK_ORIENTATION_HORIZONTAL, -1, &min, &nat, NULL, NULL);
+  gtk_widget_measure (list, GTK_ORIENTATION_VERTICAL, WIDTH, &min, &nat, NULL, NULL);
+  gtk_widget_size_allocate (list, &allocation, -1, &clip);
+}
+
+static void
+scroll_to (GtkWidget *list,
+           double     value)
+{
+  GtkAdjustment *adjustment;
+
+  adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (list));
+  gtk_adjustment_set_value (adjustment, value);
+  allocate (list);
+}
+
+static int
+compare_rows (gconstpointer a,
+              gconstpointer b)
+{
+  GtkAllocation alloc_a, alloc_b;
+
+  gtk_widget_get_allocation (*(GtkWidget **) a, &alloc_a);
+  gtk_widget_get_allocation (*(GtkWidget **) b, &alloc_b);
+
+  return alloc_a.y - alloc_b.y;
+}
+
+static guint
+find_item (GListModel *model,
+           const char *text)
+{
+  guint i;
+
+  for (i = 0; i < g_list_model_get_n_items (model); i++)
+    {
+      GObject *item = g_list_model_get_item (model, i);
+      gboolean found = g_str_equal (g_object_get_data (item, "text"), text);
+
+      g_object_unref (item);
+
+      if (found)
+        return i;
+    }
+
+  g_assert_not_reached ();
+  return 0;
+}
+
+/* Checks that the bound rows show consecutive items of @model, are
+ * stacked without gaps and cover the visible area. Returns the position
+ * of the first bound item. */
+static guint
+check_rows (GtkWidget  *list,
+            GListModel *model)
+{
+  GPtrArray *rows;
+  GtkWidget *child;
+  GtkAllocation first, last;
+  guint position, i;
+
+  rows = g_ptr_array_new ();
+  for (child = gtk_widget_get_first_child (list);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (gtk_widget_get_child_visible (child))
+        g_ptr_array_add (rows, child);
+    }
+
+  g_assert_cmpuint (rows->len, >, 0);
+  g_ptr_array_sort (rows, compare_rows);
+
+  position = find_item (model, gtk_label_get_text (g_ptr_array_index (rows, 0)));
+
+  for (i = 0; i < rows->len; i++)
+    {
+      GtkWidget *row = g_ptr_array_index (rows, i);
+      GObject *item = g_list_model_get_item (model, position + i);
+      GtkAllocation allocation;
+
+      g_assert_nonnull (item);
+      g_assert_cmpstr (gtk_label_get_text (GTK_LABEL (row)), ==, g_object_get_data (item, "text"));
+      g_object_unref (item);
+
+      gtk_widget_get_allocation (row, &allocation);
+      g_assert_cmpint (allocation.width, ==, WIDTH);
+      g_assert_cmpint (allocation.height, ==, ROW_HEIGHT);
+
+      if (i > 0)
+        {
+          GtkAllocation previous;
+
+          gtk_widget_get_allocation (g_ptr_array_index (rows, i - 1), &previous);
+          g_assert_cmpint (previous.y + previous.height, ==, allocation.y);
+        }
+    }
+
+  gtk_widget_get_allocation (g_ptr_array_index (rows, 0), &first);
+  gtk_widget_get_allocation (g_ptr_array_index (rows, rows->len - 1), &last);
+  g_assert_cmpint (first.y, <=, 0);
+  if (position + rows->len < g_list_model_get_n_items (model))
+    g_assert_cmpint (last.y + last.height, >=, HEIGHT);
+
+  g_ptr_array_unref (rows);
+
+  return position;
+}
+
+static void
+test_bind_model (void)
+{
+  Counters counters = { 0, };
+  GListStore *store;
+  GtkWidget *list;
+
+  store = create_model (1000);
+  list = create_list (G_LIST_MODEL (store), &counters);
+  allocate (list);
+
+  g_assert_cmpuint (check_rows (list, G_LIST_MODEL (store)), ==, 0);
+  /* Only the visible rows and the overscan get widgets */
+  g_assert_cmpuint (counters.n_created, <=, 2 * HEIGHT / ROW_HEIGHT + 2);
+  g_assert_cmpuint (counters.n_bound, ==, counters.n_created);
+
+  gtk_list_view_bind_model (GTK_LIST_VIEW (list), NULL, NULL, NULL, NULL, NULL);
+  g_assert_true (counters.freed);
+  g_assert_null (gtk_widget_get_first_child (list));
+
+  g_object_unref (list);
+  g_object_unref (store);
+}
+
+static void
+test_items_changed (void)
+{
+  Counters counters = { 0, };
+  GListStore *store;
+  GtkWidget *list;
+  GObject *item;
+  guint n_bound;
+
+  store = create_model (1000);
+  list = create_list (G_LIST_MODEL (store), &counters);
+  allocate (list);
+  check_rows (list, G_LIST_MODEL (store));
+
+  /* Changes below the bound rows don't rebind anything */
+  n_bound = counters.n_bound;
+  g_list_store_remove (store, 500);
+  allocate (list);
+  check_rows (list, G_LIST_MODEL (store));
+  g_assert_cmpuint (counters.n_bound, ==, n_bound);
+
+  /* Replacing a bound item rebinds it and the rows below it */
+  item = create_item ("new");
+  g_list_store_splice (store, 1, 1, (gpointer *) &item, 1);
+  g_object_unref (item);
+  allocate (list);
+  g_assert_cmpuint (check_rows (list, G_LIST_MODEL (store)), ==, 0);
+  g_assert_cmpuint (counters.n_bound, >, n_bound);
+
+  /* Inserting above the bound rows keeps them bound to their items,
+   * only the one row that scrolls in needs a new item */
+  scroll_to (list, 300 * ROW_HEIGHT);
+  check_rows (list, G_LIST_MODEL (store));
+  n_bound = counters.n_bound;
+  item = create_item ("top");
+  g_list_store_insert (store, 0, item);
+  g_object_unref (item);
+  allocate (list);
+  check_rows (list, G_LIST_MODEL (store));
+  g_assert_cmpuint (counters.n_bound, ==, n_bound + 1);
+
+  /* Removing all bound items */
+  g_list_store_splice (store, 0, g_list_model_get_n_items (G_LIST_MODEL (store)) - 10, NULL, 0);
+  allocate (list);
+  check_rows (list, G_LIST_MODEL (store));
+
+  g_object_unref (list);
+  g_object_unref (store);
+}
+
+static void
+test_recycling (void)
+{
+  Counters counters = { 0, };
+  GListStore *store;
+  GtkWidget *list;
+  GtkAdjustment *adjustment;
+  double upper;
+  guint i;
+
+  store = create_model (100000);
+  list = create_list (G_LIST_MODEL (store), &counters);
+  allocate (list);
+
+  adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (list));
+  upper = gtk_adjustment_get_upper (adjustment);
+  g_assert_cmpfloat (upper, ==, 100000.0 * ROW_HEIGHT);
+
+  for (i = 0; i <= 20; i++)
+    {
+      scroll_to (list, i * (upper - HEIGHT) / 20);
+      check_rows (list, G_LIST_MODEL (store));
+    }
+
+  /* Scrolling through the whole list reuses the same few widgets. A jump
+   * binds the new rows before it releases the old ones, so there can be
+   * two sets of them. */
+  g_assert_cmpuint (counters.n_created, <=, 2 * (2 * HEIGHT / ROW_HEIGHT + 2));
+  g_assert_cmpuint (counters.n_bound, >, counters.n_created);
+
+  /* The last row ends at the bottom */
+  scroll_to (list, upper);
+  g_assert_cmpfloat (gtk_adjustment_get_value (adjustment), ==, upper - HEIGHT);
+  g_assert_cmpuint (check_rows (list, G_LIST_MODEL (store)), <, 100000 - HEIGHT / ROW_HEIGHT);
+
+  g_object_unref (list);
+  g_object_unref (store);
+}
+
+static void
+test_move_cursor (void)
+{
+  Counters counters = { 0, };
+  GListStore *store;
+  GtkWidget *list;
+  GtkAdjustment *adjustment;
+
+  store = create_model (1000);
+  list = create_list (G_LIST_MODEL (store), &counters);
+  allocate (list);
+  adjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (list));
+
+  /* The first move puts the cursor on the first visible item */
+  g_signal_emit_by_name (list, "move-cursor", GTK_MOVEMENT_BUFFER_ENDS, 1);
+  allocate (list);
+  g_assert_cmpfloat (gtk_adjustment_get_value (adjustment), ==, 0);
+
+  g_signal_emit_by_name (list, "move-cursor", GTK_MOVEMENT_BUFFER_ENDS, 1);
+  allocate (list);
+  g_assert_cmpfloat (gtk_adjustment_get_value (adjustment), ==, 1000 * ROW_HEIGHT - HEIGHT);
+  check_rows (list, G_LIST_MODEL (store));
+
+  /* A page up moves the cursor by 90 pixels, to item 994 */
+  g_signal_emit_by_name (list, "move-cursor", GTK_MOVEMENT_PAGES, -1);
+  allocate (list);
+  g_assert_cmpfloat (gtk_adjustment_get_value (adjustment), ==, 994 * ROW_HEIGHT);
+
+  g_signal_emit_by_name (list, "move-cursor", GTK_MOVEMENT_DISPLAY_LINES, -1);
+  allocate (list);
+  g_assert_cmpfloat (gtk_adjustment_get_value (adjustment), ==, 993 * ROW_HEIGHT);
+
+  /* Moving down within the visible area does not scroll */
+  g_signal_emit_by_name (list, "move-cursor", GTK_MOVEMENT_DISPLAY_LINES, 2);
+  allocate (list);
+  g_assert_cmpfloat (gtk_adjustment_get_value (adjustment), ==, 993 * ROW_HEIGHT);
+
+  g_signal_emit_by_name (list, "move-cursor", GTK_MOVEMENT_BUFFER_ENDS, -1);
+  allocate (list);
+  g_assert_cmpfloat (gtk_adjustment_get_value (adjustment), ==, 0);
+  g_assert_cmpuint (check_rows (list, G_LIST_MODEL (store)), ==, 0);
+
+  g_object_unref (list);
+  g_object_unref (store);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/listview/bind-model", test_bind_model);
+  g_test_add_func ("/listview/items-changed", test_items_changed);
+  g_test_add_func ("/listview/recycling", test_recycling);
+  g_test_add_func ("/listview/move-cursor", test_move_cursor);
+
+  return g_test_run ();
+}
@@ -0,0 +1,435 @@
+#include <gtk/gtk.h>
+
+/* A widget that fills its area with a color and counts how often it
+ * is recorded. Its parent allocates it at @area. */
+typedef struct {
+  GtkWidget parent_instance;
+
+  GdkRGBA color;
+  GtkAllocation area;
+  guint n_snapshots;
+} TestWidget;
+
+typedef GtkWidgetClass TestWidgetClass;
+
+static GType test_widget_get_type (void);
+G_DEFINE_TYPE (TestWidget, test_widget, GTK_TYPE_WIDGET)
+
+#define TEST_WIDGET(w) (G_TYPE_CHECK_INSTANCE_CAST ((w), test_widget_get_type (), TestWidget))
+
+static void
+test_widget_size_allocate (GtkWidget           *widget,
+                           const GtkAllocation *allocation,
+                           int                  baseline,
+                           GtkAllocation       *out_clip)
+{
+  GtkWidget *child;
+
+  for (child = gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      GtkAllocation child_clip;
+
+      gtk_widget_size_allocate (child, &TEST_WIDGET (child)->area, -1, &child_clip);
+      gdk_rectangle_union (out_clip, &child_clip, out_clip);
+    }
+}
+
+static void
+test_widget_snapshot (GtkWidget   *widget,
+                      GtkSnapshot *snapshot)
+{
+  TestWidget *self = TEST_WIDGET (widget);
+
+  self->n_snapshots++;
+
+  gtk_snapshot_append_color (snapshot,
+                             &self->color,
+                             &GRAPHENE_RECT_INIT (0, 0,
+                                                  gtk_widget_get_width (widget),
+                                                  gtk_widget_get_height (widget)),
+                             "TestWidget");
+
+  GTK_WIDGET_CLASS (test_widget_parent_class)->snapshot (widget, snapshot);
+}
+
+static void
+test_widget_dispose (GObject *object)
+{
+  GtkWidget *child;
+
+  while ((child = gtk_widget_get_first_child (GTK_WIDGET (object))))
+    gtk_widget_unparent (child);
+
+  G_OBJECT_CLASS (test_widget_parent_class)->dispose (object);
+}
+
+static void
+test_widget_class_init (TestWidgetClass *klass)
+{
+  G_OBJECT_CLASS (klass)->dispose = test_widget_dispose;
+
+  klass->size_allocate = test_widget_size_allocate;
+  klass->snapshot = test_widget_snapshot;
+}
+
+static void
+test_widget_init (TestWidget *self)
+{
+  gtk_widget_set_has_window (GTK_WIDGET (self), FALSE);
+}
+
+static GtkWidget *
+test_widget_new (GtkWidget  *parent,
+                 const char *color,
+                 int         x,
+                 int         y,
+                 int         width,
+                 int         height)
+{
+  TestWidget *self;
+
+  self = g_object_new (test_widget_get_type (), NULL);
+  gdk_rgba_parse (&self->color, color);
+  self->area = (GtkAllocation) { x, y, width, height };
+  gtk_widget_set_size_request (GTK_WIDGET (self), width, height);
+
+  if (parent)
+    gtk_widget_set_parent (GTK_WIDGET (self), parent);
+
+  gtk_widget_show (GTK_WIDGET (self));
+
+  return GTK_WIDGET (self);
+}
+
+static void
+test_widget_set_color (GtkWidget  *widget,
+                       const char *color)
+{
+  gdk_rgba_parse (&TEST_WIDGET (widget)->color, color);
+  gtk_widget_queue_draw (widget);
+}
+
+/* root (red, 100x100)
+ * ├── a (green, 0,0 40x40)
+ * └── b (blue, 20,20 40x40, above a)
+ *     └── leaf (yellow, 10,10 10x10)
+ */
+typedef struct {
+  GtkWidget *window;
+  GtkWidget *root;
+  GtkWidget *a;
+  GtkWidget *b;
+  GtkWidget *leaf;
+} Tree;
+
+#define RED    0xffff0000
+#define GREEN  0xff00ff00
+#define BLUE   0xff0000ff
+#define YELLOW 0xffffff00
+
+static void
+create_tree (Tree *tree)
+{
+  tree->window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  tree->root = test_widget_new (NULL, "red", 0, 0, 100, 100);
+  gtk_container_add (GTK_CONTAINER (tree->window), tree->root);
+  tree->a = test_widget_new (tree->root, "lime", 0, 0, 40, 40);
+  tree->b = test_widget_new (tree->root, "blue", 20, 20, 40, 40);
+  tree->leaf = test_widget_new (tree->b, "yellow", 10, 10, 10, 10);
+
+  gtk_widget_show (tree->window);
+}
+
+static void
+destroy_tree (Tree *tree)
+{
+  gtk_widget_destroy (tree->window);
+}
+
+static void
+reset_counts (Tree *tree)
+{
+  TEST_WIDGET (tree->root)->n_snapshots = 0;
+  TEST_WIDGET (tree->a)->n_snapshots = 0;
+  TEST_WIDGET (tree->b)->n_snapshots = 0;
+  TEST_WIDGET (tree->leaf)->n_snapshots = 0;
+}
+
+#define assert_snapshots(widget, n) \
+  g_assert_cmpuint (TEST_WIDGET (widget)->n_snapshots, ==, (n))
+
+/* Does what a frame does after the children of @root changed */
+static void
+relayout (GtkWidget *root)
+{
+  GtkAllocation allocation, clip;
+
+  gtk_widget_get_allocation (root, &allocation);
+  gtk_widget_size_allocate (root, &allocation, -1, &clip);
+}
+
+static cairo_surface_t *
+render (GtkWidget *root)
+{
+  GtkSnapshot *snapshot;
+  GskRenderNode *node;
+  GtkAllocation allocation;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  gtk_widget_get_allocation (root, &allocation);
+
+  snapshot = gtk_snapshot_new (NULL, FALSE, NULL, "Test");
+  gtk_widget_snapshot_child (gtk_widget_get_parent (root), root, snapshot);
+  node = gtk_snapshot_free_to_node (snapshot);
+  g_assert_nonnull (node);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, allocation.width, allocation.height);
+  cr = cairo_create (surface);
+  cairo_translate (cr, -allocation.x, -allocation.y);
+  gsk_render_node_draw (node, cr);
+  cairo_destroy (cr);
+  cairo_surface_flush (surface);
+
+  gsk_render_node_unref (node);
+
+  return surface;
+}
+
+static guint32
+get_pixel (cairo_surface_t *surface,
+           int              x,
+           int              y)
+{
+  const guchar *data = cairo_image_surface_get_data (surface);
+
+  return *(const guint32 *) (data + y * cairo_image_surface_get_stride (surface) + 4 * x);
+}
+
+static void
+assert_surfaces_equal (cairo_surface_t *surface1,
+                       cairo_surface_t *surface2)
+{
+  int width, height, stride, y;
+
+  width = cairo_image_surface_get_width (surface1);
+  height = cairo_image_surface_get_height (surface1);
+  stride = cairo_image_surface_get_stride (surface1);
+
+  g_assert_cmpint (cairo_image_surface_get_width (surface2), ==, width);
+  g_assert_cmpint (cairo_image_surface_get_height (surface2), ==, height);
+
+  for (y = 0; y < height; y++)
+    {
+      g_assert_true (memcmp (cairo_image_surface_get_data (surface1) + y * stride,
+                             cairo_image_surface_get_data (surface2) + y * stride,
+                             4 * width) == 0);
+    }
+}
+
+static void
+test_reuse (void)
+{
+  Tree tree;
+  cairo_surface_t *surface1, *surface2;
+
+  create_tree (&tree);
+
+  reset_counts (&tree);
+  surface1 = render (tree.root);
+  assert_snapshots (tree.root, 1);
+  assert_snapshots (tree.a, 1);
+  assert_snapshots (tree.b, 1);
+  assert_snapshots (tree.leaf, 1);
+
+  g_assert_cmphex (get_pixel (surface1, 90, 90), ==, RED);
+  g_assert_cmphex (get_pixel (surface1, 5, 5), ==, GREEN);
+  g_assert_cmphex (get_pixel (surface1, 25, 25), ==, BLUE);
+  g_assert_cmphex (get_pixel (surface1, 35, 35), ==, YELLOW);
+
+  /* Nothing changed, so nothing is recorded again */
+  reset_counts (&tree);
+  surface2 = render (tree.root);
+  assert_snapshots (tree.root, 0);
+  assert_snapshots (tree.a, 0);
+  assert_snapshots (tree.b, 0);
+  assert_snapshots (tree.leaf, 0);
+  assert_surfaces_equal (surface1, surface2);
+
+  cairo_surface_destroy (surface1);
+  cairo_surface_destroy (surface2);
+  destroy_tree (&tree);
+}
+
+static void
+test_queue_draw_leaf (void)
+{
+  Tree tree;
+  cairo_surface_t *surface1, *surface2;
+
+  create_tree (&tree);
+  surface1 = render (tree.root);
+
+  /* A redraw of the leaf re-records it and its ancestors, but
+   * not the sibling of its parent */
+  reset_counts (&tree);
+  gtk_widget_queue_draw (tree.leaf);
+  surface2 = render (tree.root);
+  assert_snapshots (tree.root, 1);
+  assert_snapshots (tree.a, 0);
+  assert_snapshots (tree.b, 1);
+  assert_snapshots (tree.leaf, 1);
+  assert_surfaces_equal (surface1, surface2);
+  cairo_surface_destroy (surface2);
+
+  /* The new node is used */
+  reset_counts (&tree);
+  test_widget_set_color (tree.leaf, "white");
+  surface2 = render (tree.root);
+  assert_snapshots (tree.a, 0);
+  assert_snapshots (tree.leaf, 1);
+  g_assert_cmphex (get_pixel (surface2, 35, 35), ==, 0xffffffff);
+  g_assert_cmphex (get_pixel (surface2, 25, 25), ==, BLUE);
+
+  cairo_surface_destroy (surface1);
+  cairo_surface_destroy (surface2);
+  destroy_tree (&tree);
+}
+
+static void
+test_move_child (void)
+{
+  Tree tree;
+  cairo_surface_t *surface;
+  GtkAllocation clip;
+
+  create_tree (&tree);
+  cairo_surface_destroy (render (tree.root));
+
+  /* Moving a child only re-records its parent, which places
+   * the unchanged node of the child somewhere else */
+  reset_counts (&tree);
+  TEST_WIDGET (tree.a)->area.x = 60;
+  TEST_WIDGET (tree.a)->area.y = 60;
+  gtk_widget_size_allocate (tree.a, &TEST_WIDGET (tree.a)->area, -1, &clip);
+  surface = render (tree.root);
+  assert_snapshots (tree.root, 1);
+  assert_snapshots (tree.a, 0);
+  assert_snapshots (tree.b, 0);
+  assert_snapshots (tree.leaf, 0);
+  g_assert_cmphex (get_pixel (surface, 5, 5), ==, RED);
+  g_assert_cmphex (get_pixel (surface, 70, 70), ==, GREEN);
+  g_assert_cmphex (get_pixel (surface, 35, 35), ==, YELLOW);
+
+  cairo_surface_destroy (surface);
+  destroy_tree (&tree);
+}
+
+static void
+test_reorder_child (void)
+{
+  Tree tree;
+  cairo_surface_t *surface;
+
+  create_tree (&tree);
+  surface = render (tree.root);
+  g_assert_cmphex (get_pixel (surface, 25, 25), ==, BLUE);
+  cairo_surface_destroy (surface);
+
+  /* Raising a above b re-records the parent only */
+  reset_counts (&tree);
+  gtk_widget_insert_after (tree.a, tree.root, tree.b);
+  relayout (tree.root);
+  surface = render (tree.root);
+  assert_snapshots (tree.root, 1);
+  assert_snapshots (tree.a, 0);
+  assert_snapshots (tree.b, 0);
+  assert_snapshots (tree.leaf, 0);
+  g_assert_cmphex (get_pixel (surface, 25, 25), ==, GREEN);
+  g_assert_cmphex (get_pixel (surface, 45, 45), ==, BLUE);
+
+  cairo_surface_destroy (surface);
+  destroy_tree (&tree);
+}
+
+static void
+test_remove_child (void)
+{
+  Tree tree;
+  cairo_surface_t *surface;
+
+  create_tree (&tree);
+  cairo_surface_destroy (render (tree.root));
+
+  reset_counts (&tree);
+  g_object_ref (tree.b);
+  gtk_widget_unparent (tree.b);
+  relayout (tree.root);
+  surface = render (tree.root);
+  assert_snapshots (tree.root, 1);
+  assert_snapshots (tree.a, 0);
+  g_assert_cmphex (get_pixel (surface, 5, 5), ==, GREEN);
+  g_assert_cmphex (get_pixel (surface, 35, 35), ==, RED);
+  g_assert_cmphex (get_pixel (surface, 50, 50), ==, RED);
+  g_object_unref (tree.b);
+
+  cairo_surface_destroy (surface);
+  destroy_tree (&tree);
+}
+
+static void
+test_no_render_cache (void)
+{
+  Tree tree;
+  cairo_surface_t *cached, *uncached;
+  guint flags;
+
+  create_tree (&tree);
+  cached = render (tree.root);
+
+  flags = gtk_get_debug_flags ();
+  gtk_set_debug_flags (flags | GTK_DEBUG_NO_RENDER_CACHE);
+
+  reset_counts (&tree);
+  uncached = render (tree.root);
+#ifdef G_ENABLE_DEBUG
+  /* Every widget is recorded every time */
+  assert_snapshots (tree.root, 1);
+  assert_snapshots (tree.a, 1);
+  assert_snapshots (tree.b, 1);
+  assert_snapshots (tree.leaf, 1);
+#endif
+  assert_surfaces_equal (cached, uncached);
+  cairo_surface_destroy (uncached);
+
+  test_widget_set_color (tree.leaf, "white");
+  uncached = render (tree.root);
+
+  gtk_set_debug_flags (flags);
+
+  cairo_surface_destroy (cached);
+  cached = render (tree.root);
+  assert_surfaces_equal (cached, uncached);
+  g_assert_cmphex (get_pixel (cached, 35, 35), ==, 0xffffffff);
+
+  cairo_surface_destroy (cached);
+  cairo_surface_destroy (uncached);
+  destroy_tree (&tree);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/rendercache/reuse", test_reuse);
+  g_test_add_func ("/rendercache/queue-draw-leaf", test_queue_draw_leaf);
+  g_test_add_func ("/rendercache/move-child", test_move_child);
+  g_test_add_func ("/rendercache/reorder-child", test_reorder_child);
+  g_test_add_func ("/rendercache/remove-child", test_remove_child);
+  g_test_add_func ("/rendercache/no-render-cache", test_no_render_cache);
+
+  return g_test_run ();
+}
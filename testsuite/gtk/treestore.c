@@ -226,6 +226,57 @@ tree_store_test_append (void)
   g_object_unref (store);
 }
 
+static void
+count_signal (gpointer data)
+{
+  (*(int *)data)++;
+}
+
+static void
+tree_store_test_append_rows (void)
+{
+  GtkTreeStore *store;
+  GtkTreeIter parent, iter;
+  GValue values[3] = { G_VALUE_INIT, G_VALUE_INIT, G_VALUE_INIT };
+  int columns[] = { 0 };
+  int inserted = 0;
+  int toggled = 0;
+  int i;
+
+  store = gtk_tree_store_new (1, G_TYPE_INT);
+  gtk_tree_store_append (store, &parent, NULL);
+
+  g_signal_connect_swapped (store, "row-inserted",
+                            G_CALLBACK (count_signal), &inserted);
+  g_signal_connect_swapped (store, "row-has-child-toggled",
+                            G_CALLBACK (count_signal), &toggled);
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    {
+      g_value_init (&values[i], G_TYPE_INT);
+      g_value_set_int (&values[i], i);
+    }
+
+  gtk_tree_store_append_rowsv (store, &parent, 2, columns, values, 1);
+  gtk_tree_store_append_rowsv (store, &parent, 1, columns, values + 2, 1);
+
+  g_assert_cmpint (inserted, ==, 3);
+  g_assert_cmpint (toggled, ==, 1);
+  g_assert_cmpint (gtk_tree_model_iter_n_children (GTK_TREE_MODEL (store), &parent), ==, 3);
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    {
+      int value;
+
+      g_assert (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, &parent, i));
+      gtk_tree_model_get (GTK_TREE_MODEL (store), &iter, 0, &value, -1);
+      g_assert_cmpint (value, ==, i);
+      g_value_unset (&values[i]);
+    }
+
+  g_object_unref (store);
+}
+
 static void
 tree_store_test_prepend (void)
 {
@@ -1085,6 +1136,8 @@ register_tree_store_tests (void)
 	           tree_store_test_insert_high_values);
   g_test_add_func ("/TreeStore/append",
 		   tree_store_test_append);
+  g_test_add_func ("/TreeStore/append-rows",
+		   tree_store_test_append_rows);
   g_test_add_func ("/TreeStore/prepend",
 		   tree_store_test_prepend);
   g_test_add_func ("/TreeStore/insert-after",